@@ -127,8 +127,10 @@ template<class T> class MEM_CacheLimiter {
   typedef size_t (*MEM_CacheLimiter_DataSize_Func)(void *data);
   typedef int (*MEM_CacheLimiter_ItemPriority_Func)(void *item, int default_priority);
   typedef bool (*MEM_CacheLimiter_ItemDestroyable_Func)(void *item);
+  typedef size_t (*MEM_CacheLimiter_UnmanagedMemory_Func)(void);
 
-  MEM_CacheLimiter(MEM_CacheLimiter_DataSize_Func data_size_func) : data_size_func(data_size_func)
+  MEM_CacheLimiter(MEM_CacheLimiter_DataSize_Func data_size_func)
+      : data_size_func(data_size_func), unmanaged_memory_func(NULL)
   {
   }
 
@@ -164,6 +166,9 @@ template<class T> class MEM_CacheLimiter {
       for (i = 0; i < queue.size(); i++) {
         size += data_size_func(queue[i]->get()->get_data());
       }
+      if (unmanaged_memory_func) {
+        size += unmanaged_memory_func();
+      }
     }
     else {
       size = MEM_get_memory_in_use();
@@ -204,9 +209,15 @@ template<class T> class MEM_CacheLimiter {
         cur_size = mem_in_use;
       }
 
+      size_t unmanaged_size = unmanaged_memory_func ? unmanaged_memory_func() : 0;
+
       if (elem->destroy_if_possible()) {
         if (data_size_func) {
           mem_in_use -= cur_size;
+          /* The destructor may have kept some of the data outside of the managed items. */
+          if (unmanaged_memory_func) {
+            mem_in_use += unmanaged_memory_func() - unmanaged_size;
+          }
         }
         else {
           mem_in_use -= cur_size - MEM_get_memory_in_use();
@@ -240,6 +251,11 @@ template<class T> class MEM_CacheLimiter {
     this->item_destroyable_func = item_destroyable_func;
   }
 
+  void set_unmanaged_memory_func(MEM_CacheLimiter_UnmanagedMemory_Func unmanaged_memory_func)
+  {
+    this->unmanaged_memory_func = unmanaged_memory_func;
+  }
+
  private:
   typedef MEM_CacheLimiterHandle<T> *MEM_CacheElementPtr;
   typedef std::vector<MEM_CacheElementPtr, MEM_Allocator<MEM_CacheElementPtr>> MEM_CacheQueue;
@@ -305,6 +321,7 @@ template<class T> class MEM_CacheLimiter {
   MEM_CacheLimiter_DataSize_Func data_size_func;
   MEM_CacheLimiter_ItemPriority_Func item_priority_func;
   MEM_CacheLimiter_ItemDestroyable_Func item_destroyable_func;
+  MEM_CacheLimiter_UnmanagedMemory_Func unmanaged_memory_func;
 };
 
 #endif  // __MEM_CACHELIMITER_H__
@@ -31,6 +31,9 @@ typedef int (*MEM_CacheLimiter_ItemPriority_Func)(void *, int);
 /* function to check whether item could be destroyed */
 typedef bool (*MEM_CacheLimiter_ItemDestroyable_Func)(void *);
 
+/* function used to measure memory used by the cache outside of the managed objects */
+typedef size_t (*MEM_CacheLimiter_UnmanagedMemory_Func)(void);
+
 #ifndef __MEM_CACHELIMITER_H__
 void MEM_CacheLimiter_set_maximum(size_t m);
 size_t MEM_CacheLimiter_get_maximum(void);
@@ -133,6 +136,13 @@ void MEM_CacheLimiter_ItemPriority_Func_set(MEM_CacheLimiterC *This,
 void MEM_CacheLimiter_ItemDestroyable_Func_set(
     MEM_CacheLimiterC *This, MEM_CacheLimiter_ItemDestroyable_Func item_destroyable_func);
 
+/**
+ * Set function measuring memory the cache uses outside of its managed objects, for example
+ * for objects the destructor kept in a compressed form. Counts towards the memory limit.
+ */
+void MEM_CacheLimiter_UnmanagedMemory_Func_set(
+    MEM_CacheLimiterC *This, MEM_CacheLimiter_UnmanagedMemory_Func unmanaged_memory_func);
+
 size_t MEM_CacheLimiter_get_memory_in_use(MEM_CacheLimiterC *This);
 
 #ifdef __cplusplus
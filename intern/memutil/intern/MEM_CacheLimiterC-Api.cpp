@@ -209,6 +209,12 @@ void MEM_CacheLimiter_ItemDestroyable_Func_set(
   cast(This)->get_cache()->set_item_destroyable_func(item_destroyable_func);
 }
 
+void MEM_CacheLimiter_UnmanagedMemory_Func_set(
+    MEM_CacheLimiterC *This, MEM_CacheLimiter_UnmanagedMemory_Func unmanaged_memory_func)
+{
+  cast(This)->get_cache()->set_unmanaged_memory_func(unmanaged_memory_func);
+}
+
 size_t MEM_CacheLimiter_get_memory_in_use(MEM_CacheLimiterC *This)
 {
   return cast(This)->get_cache()->get_memory_in_use();
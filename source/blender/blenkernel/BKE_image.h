@@ -120,6 +120,7 @@ void BKE_image_tag_time(struct Image *ima);
 /* should be used in conjunction with an ID * to Image. */
 struct ImageUser;
 struct RenderData;
+struct RenderLayer;
 struct RenderPass;
 struct RenderResult;
 
@@ -246,6 +247,13 @@ void BKE_image_user_id_eval_animation(struct Depsgraph *depsgraph, struct ID *id
  * don't correct for wrong indices here.
  */
 struct RenderPass *BKE_image_multilayer_index(struct RenderResult *rr, struct ImageUser *iuser);
+/**
+ * Read pixels of passes of multi-layer images which are loaded lazily, for code accessing the
+ * passes of #Image.rr directly instead of through image buffers.
+ *
+ * \param rl: Render layer to read passes of, or null to read all passes.
+ */
+void BKE_image_multilayer_ensure_loaded(struct Image *ima, struct RenderLayer *rl);
 
 /**
  * Sets index offset for multi-view files.
@@ -567,6 +575,11 @@ void BKE_image_partial_update_mark_region(struct Image *image,
                                           const rcti *updated_region);
 /** \brief Mark the whole image to be updated. */
 void BKE_image_partial_update_mark_full_update(struct Image *image);
+/**
+ * \brief Id of the last update marked on the image. Ids are unique among all images and never
+ * reused, so comparing them tells whether the image buffers changed without collecting changes.
+ */
+uint64_t BKE_image_partial_update_id(struct Image *image);
 
 #ifdef __cplusplus
 }
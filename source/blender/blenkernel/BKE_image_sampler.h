@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Sampling of images on the CPU, for geometry nodes, modifiers and other users which evaluate
+ * images at arbitrary coordinates.
+ *
+ * Instead of converting whole image buffers to float, byte and other non-RGBA float buffers are
+ * read through a cache of small float tiles, converted on demand when they're first sampled. Tiles
+ * are shared by all samplers of an image and are limited by the memory cache limit together with
+ * image buffers. RGBA float buffers are read directly. UDIM tiles are only loaded when a sample
+ * falls inside of them.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Image;
+struct ImageUser;
+
+typedef struct ImageSampler ImageSampler;
+
+typedef enum eImageSamplerInterpolation {
+  IMAGE_SAMPLER_INTERPOLATION_CLOSEST = 0,
+  IMAGE_SAMPLER_INTERPOLATION_LINEAR = 1,
+  IMAGE_SAMPLER_INTERPOLATION_CUBIC = 2,
+} eImageSamplerInterpolation;
+
+typedef enum eImageSamplerExtension {
+  IMAGE_SAMPLER_EXTENSION_REPEAT = 0,
+  IMAGE_SAMPLER_EXTENSION_EXTEND = 1,
+  IMAGE_SAMPLER_EXTENSION_CLIP = 2,
+} eImageSamplerExtension;
+
+/**
+ * Create a sampler of the image buffers given image user refers to, the tile of the image user is
+ * ignored for UDIM images as it follows from the sampled coordinates.
+ *
+ * Image buffers which are needed are acquired on first use and kept until the sampler is freed.
+ * Samplers can be used from multiple threads at the same time.
+ */
+ImageSampler *BKE_image_sampler_new(struct Image *image,
+                                    const struct ImageUser *iuser,
+                                    eImageSamplerInterpolation interpolation,
+                                    eImageSamplerExtension extension);
+void BKE_image_sampler_free(ImageSampler *sampler);
+
+/**
+ * Sample the image at given texture coordinates, where 0 to 1 covers the whole image, or the
+ * first UDIM tile of UDIM images.
+ *
+ * \param r_color: Scene linear color, with alpha stored like the float buffer of the image would.
+ * \return False when the image buffer of the sampled UDIM tile can't be loaded, #r_color is
+ * cleared then.
+ */
+bool BKE_image_sampler_sample(ImageSampler *sampler, const float uv[2], float r_color[4]);
+
+/**
+ * Free tiles cached for sampling the image. Doesn't lock the image, callers are expected to have
+ * exclusive access to the image or hold its cache mutex.
+ */
+void BKE_image_sample_cache_free(struct Image *image);
+
+#ifdef __cplusplus
+}
+#endif
@@ -365,6 +365,17 @@ void BKE_mesh_recalc_looptri_with_normals(const struct MLoop *mloop,
                                           int totpoly,
                                           struct MLoopTri *mlooptri,
                                           const float (*poly_normals)[3]);
+/**
+ * Update a tessellation calculated by #BKE_mesh_recalc_looptri after only the vertex positions
+ * changed. The triangulation of triangles only depends on the topology so they are skipped, only
+ * quads and n-gons are tessellated again.
+ */
+void BKE_mesh_recalc_looptri_positions_changed(const struct MLoop *mloop,
+                                               const struct MPoly *mpoly,
+                                               const struct MVert *mvert,
+                                               int totloop,
+                                               int totpoly,
+                                               struct MLoopTri *mlooptri);
 
 /* *** mesh_normals.cc *** */
 
@@ -22,6 +22,7 @@ struct MLoop;
 struct MLoopTri;
 struct MVertTri;
 struct Mesh;
+struct MeshElemMap;
 struct Object;
 struct Scene;
 
@@ -49,6 +50,45 @@ void BKE_mesh_runtime_looptri_recalc(struct Mesh *mesh);
  * \note This is a ported copy of dm_getLoopTriArray(dm).
  */
 const struct MLoopTri *BKE_mesh_runtime_looptri_ensure(const struct Mesh *mesh);
+/**
+ * Initialize the #MLoopTri cache of `mesh_dst`, a copy of `mesh_src` whose vertex positions are
+ * about to be deformed. Triangles are reused from the cache of the source mesh (which is
+ * calculated if needed and kept for following evaluations), quads and n-gons are tessellated
+ * again when the cache is accessed.
+ */
+void BKE_mesh_runtime_looptri_copy_deformed(struct Mesh *mesh_dst, const struct Mesh *mesh_src);
+
+/**
+ * Vertex, edge or face adjacency map in compressed sparse row layout: the indices used by element
+ * `i` are `indices[offsets[i]]` up to `indices[offsets[i + 1]]`, in ascending order. Maps are
+ * reference counted, so they can be shared by the mesh runtime and its users.
+ */
+typedef struct MeshTopologyMap {
+  /** `groups_num + 1` offsets into #indices. */
+  const int *offsets;
+  const int *indices;
+  /** The same map in the layout of #BKE_mesh_vert_poly_map_create, pointing into #indices. */
+  const struct MeshElemMap *elem_map;
+  int groups_num;
+  /** Number of references, the map is freed when the last one is released. */
+  int users;
+} MeshTopologyMap;
+
+/**
+ * Cached adjacency maps, with the same indices as #BKE_mesh_vert_poly_map_create and related
+ * functions. The maps are computed in parallel on first use, and are cached until
+ * #BKE_mesh_runtime_clear_geometry is called for a topology change.
+ *
+ * \return A new reference, to release with #BKE_mesh_topology_map_release. The map stays valid
+ * after the mesh changes or is freed.
+ * \note These functions only fill a cache, and therefore the mesh argument can
+ * be considered logically const. Concurrent access is protected by a mutex.
+ */
+const MeshTopologyMap *BKE_mesh_runtime_vert_poly_map_acquire(const struct Mesh *mesh);
+const MeshTopologyMap *BKE_mesh_runtime_vert_edge_map_acquire(const struct Mesh *mesh);
+const MeshTopologyMap *BKE_mesh_runtime_edge_poly_map_acquire(const struct Mesh *mesh);
+void BKE_mesh_topology_map_release(const MeshTopologyMap *map);
+
 bool BKE_mesh_runtime_ensure_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_clear_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_reset_edit_data(struct Mesh *mesh);
@@ -40,6 +40,7 @@ struct MVert;
 struct Main;
 struct Mesh;
 struct MeshElemMap;
+struct MeshTopologyMap;
 struct Object;
 struct PBVH;
 struct Paint;
@@ -506,18 +507,19 @@ typedef struct SculptSession {
 
   float *vmask;
 
-  /* Mesh connectivity maps. */
+  /* Mesh connectivity maps, references to the maps cached by the mesh runtime and their
+   * #MeshTopologyMap.elem_map, see #BKE_sculptsession_topology_map_release. */
   /* Vertices to adjacent polys. */
-  struct MeshElemMap *pmap;
-  int *pmap_mem;
+  const struct MeshElemMap *pmap;
+  const struct MeshTopologyMap *pmap_ref;
 
   /* Edges to adjacent polys. */
-  struct MeshElemMap *epmap;
-  int *epmap_mem;
+  const struct MeshElemMap *epmap;
+  const struct MeshTopologyMap *epmap_ref;
 
   /* Vertices to adjacent edges. */
-  struct MeshElemMap *vemap;
-  int *vemap_mem;
+  const struct MeshElemMap *vemap;
+  const struct MeshTopologyMap *vemap_ref;
 
   /* Mesh Face Sets */
   /* Total number of polys of the base mesh. */
@@ -663,6 +665,11 @@ typedef struct SculptSession {
 
 void BKE_sculptsession_free(struct Object *ob);
 void BKE_sculptsession_free_deformMats(struct SculptSession *ss);
+/**
+ * Release a connectivity map of the sculpt session, like `ss->pmap` and `ss->pmap_ref`.
+ */
+void BKE_sculptsession_topology_map_release(const struct MeshElemMap **map,
+                                            const struct MeshTopologyMap **map_ref);
 void BKE_sculptsession_free_vwpaint_data(struct SculptSession *ss);
 void BKE_sculptsession_bm_to_me(struct Object *ob, bool reorder);
 void BKE_sculptsession_bm_to_me_for_render(struct Object *object);
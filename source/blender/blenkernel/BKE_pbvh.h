@@ -281,6 +281,10 @@ typedef enum {
 } PBVHTopologyUpdateMode;
 /**
  * Collapse short edges, subdivide long edges.
+ *
+ * The nodes are scanned for edges to collapse or subdivide in parallel, the edits themselves run
+ * on a single thread: BMesh element pools, node ownership of vertices and faces and the BMLog are
+ * shared by the whole mesh.
  */
 bool BKE_pbvh_bmesh_update_topology(PBVH *pbvh,
                                     PBVHTopologyUpdateMode mode,
@@ -35,7 +35,8 @@ typedef struct bMovieHandle {
                       int recty,
                       const char *suffix,
                       struct ReportList *reports);
-  void (*end_movie)(void *context_v);
+  /** Returns false when the movie could not be written completely. */
+  bool (*end_movie)(void *context_v);
 
   /* Optional function. */
   void (*get_movie_path)(char *string,
@@ -52,7 +52,11 @@ int BKE_ffmpeg_start(void *context_v,
                      struct ReportList *reports,
                      bool preview,
                      const char *suffix);
-void BKE_ffmpeg_end(void *context_v);
+/**
+ * Finish writing the movie file.
+ * \return false when frames that were still being encoded failed to be written.
+ */
+bool BKE_ffmpeg_end(void *context_v);
 int BKE_ffmpeg_append(void *context_v,
                       struct RenderData *rd,
                       int start_frame,
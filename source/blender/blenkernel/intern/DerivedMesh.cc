@@ -1137,6 +1137,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
     }
     else {
       mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
+      if (deformed_verts) {
+        /* Only deform modifiers, the topology of the input mesh is unchanged so its
+         * tessellation can be reused, only quads and n-gons depend on the new positions. */
+        BKE_mesh_runtime_looptri_copy_deformed(mesh_final, mesh_input);
+      }
     }
   }
   if (deformed_verts) {
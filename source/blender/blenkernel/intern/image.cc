@@ -68,6 +68,7 @@
 #include "BKE_idtype.h"
 #include "BKE_image.h"
 #include "BKE_image_format.h"
+#include "BKE_image_sampler.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
@@ -129,6 +130,7 @@ static void image_runtime_reset_on_copy(struct Image *image)
 
   image->runtime.partial_update_register = nullptr;
   image->runtime.partial_update_user = nullptr;
+  image->runtime.sample_cache = nullptr;
 }
 
 static void image_runtime_free_data(struct Image *image)
@@ -328,6 +330,7 @@ static void image_blend_write(BlendWriter *writer, ID *id, const void *id_addres
   BLI_listbase_clear(&ima->anims);
   ima->runtime.partial_update_register = nullptr;
   ima->runtime.partial_update_user = nullptr;
+  ima->runtime.sample_cache = nullptr;
   for (int i = 0; i < 3; i++) {
     for (int j = 0; j < 2; j++) {
       ima->gputexture[i][j] = nullptr;
@@ -602,6 +605,7 @@ void BKE_image_free_buffers_ex(Image *ima, bool do_lock)
     BLI_mutex_lock(static_cast<ThreadMutex *>(ima->runtime.cache_mutex));
   }
   image_free_cached_frames(ima);
+  BKE_image_sample_cache_free(ima);
 
   image_free_anims(ima);
 
@@ -612,6 +616,12 @@ void BKE_image_free_buffers_ex(Image *ima, bool do_lock)
 
   BKE_image_free_gputextures(ima);
 
+  /* Buffers loaded again may differ, users comparing #BKE_image_partial_update_id must see the
+   * change. */
+  if (ima->runtime.partial_update_register) {
+    BKE_image_partial_update_mark_full_update(ima);
+  }
+
   if (do_lock) {
     BLI_mutex_unlock(static_cast<ThreadMutex *>(ima->runtime.cache_mutex));
   }
@@ -3710,8 +3720,75 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
   /* set proper views */
   image_init_multilayer_multiview(ima, ima->rr);
 }
+
+/**
+ * Open a multilayer OpenEXR file without reading any pixels, passes are read by the render-result
+ * when image buffers of them are acquired. This avoids reading all passes of large files when
+ * only a few of them are displayed or used.
+ *
+ * Whether the file is multilayer is detected from its header, so this is also used for the first
+ * load of an image. Other OpenEXR files only have their header read twice.
+ *
+ * \return false when the file isn't a multilayer OpenEXR file, it should be loaded as usual then.
+ */
+static bool image_load_multilayer_lazy(Image *ima, const char *filepath, int framenr)
+{
+  if (!IMB_ispic_type_matches(filepath, IMB_FTYPE_OPENEXR)) {
+    return false;
+  }
+
+  void *exrhandle = IMB_exr_get_handle();
+  int width, height;
+  /* Header only image buffer to pass the metadata to the stamp info. */
+  ImBuf *metadata_ibuf = IMB_allocImBuf(0, 0, 32, 0);
+  if (!IMB_exr_begin_read_lazy(exrhandle, filepath, &width, &height, metadata_ibuf)) {
+    IMB_exr_close(exrhandle);
+    IMB_freeImBuf(metadata_ibuf);
+    return false;
+  }
+
+  /* only load rr once for multiview */
+  if (!ima->rr) {
+    ima->rr = RE_MultilayerConvertLazy(exrhandle, width, height);
+    ima->rr->framenr = framenr;
+    BKE_stamp_info_from_imbuf(ima->rr, metadata_ibuf);
+  }
+  else {
+    IMB_exr_close(exrhandle);
+  }
+  IMB_freeImBuf(metadata_ibuf);
+
+  /* set proper views */
+  image_init_multilayer_multiview(ima, ima->rr);
+  return true;
+}
 #endif /* WITH_OPENEXR */
 
+/** Read pixels of a lazily loaded multilayer pass, see #image_load_multilayer_lazy. */
+static bool image_multilayer_pass_ensure_loaded(Image *ima, RenderPass *rpass)
+{
+  return RE_RenderPassEnsureLoaded(
+      ima->rr, rpass, ima->colorspace_settings.name, ima->alpha_mode == IMA_ALPHA_PREMUL);
+}
+
+void BKE_image_multilayer_ensure_loaded(Image *ima, RenderLayer *rl)
+{
+  BLI_mutex_lock(static_cast<ThreadMutex *>(ima->runtime.cache_mutex));
+
+  if (ima->rr) {
+    LISTBASE_FOREACH (RenderLayer *, layer, &ima->rr->layers) {
+      if (rl && layer != rl) {
+        continue;
+      }
+      LISTBASE_FOREACH (RenderPass *, rpass, &layer->passes) {
+        image_multilayer_pass_ensure_loaded(ima, rpass);
+      }
+    }
+  }
+
+  BLI_mutex_unlock(static_cast<ThreadMutex *>(ima->runtime.cache_mutex));
+}
+
 /** Common stuff to do with images after loading. */
 static void image_init_after_load(Image *ima, ImageUser *iuser, ImBuf *UNUSED(ibuf))
 {
@@ -3793,7 +3870,7 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int e
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+    if (rpass && image_multilayer_pass_ensure_loaded(ima, rpass)) {
       // printf("load from pass %s\n", rpass->name);
       /* since we free  render results, we copy the rect */
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
@@ -3971,6 +4048,15 @@ static ImBuf *load_image_single(Image *ima,
 
     BKE_image_user_file_path(&iuser_t, ima, filepath);
 
+#ifdef WITH_OPENEXR
+    if (image_load_multilayer_lazy(ima, filepath, cfra)) {
+      ima->type = IMA_TYPE_MULTILAYER;
+      /* Pixels are read into the render-result on demand, intentionally leave ibuf null. */
+      *r_cache_ibuf = false;
+      return nullptr;
+    }
+#endif
+
     /* read ibuf */
     flag |= IB_metadata;
     flag |= imbuf_alpha_flags_for_image(ima);
@@ -4102,7 +4188,7 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+    if (rpass && image_multilayer_pass_ensure_loaded(ima, rpass)) {
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
       image_init_after_load(ima, iuser, ibuf);
@@ -59,6 +59,8 @@
 
 #include "BLI_vector.hh"
 
+#include "atomic_ops.h"
+
 namespace blender::bke::image::partial_update {
 
 /** \brief Size of chunks to track changes. */
@@ -76,6 +78,17 @@ constexpr int CHUNK_SIZE = 256;
  */
 constexpr int MAX_HISTORY_LEN = 4;
 
+/**
+ * \brief Source of #PartialUpdateRegisterImpl::update_id, shared by all images so that ids are
+ * never reused, even when a register is freed and created again.
+ */
+static uint64_t last_update_id = 0;
+
+static uint64_t next_update_id()
+{
+  return atomic_add_and_fetch_uint64(&last_update_id, 1);
+}
+
 /**
  * \brief get the chunk number for the give pixel coordinate.
  *
@@ -356,6 +369,9 @@ struct PartialUpdateRegisterImpl {
   /** \brief The current changeset. New changes will be added to this changeset. */
   Changeset current_changeset;
 
+  /** \brief Changes on every marked update, see #BKE_image_partial_update_id. */
+  uint64_t update_id = next_update_id();
+
   void update_resolution(const ImageTile *image_tile, const ImBuf *image_buffer)
   {
     TileChangeset &tile_changeset = current_changeset[image_tile];
@@ -369,6 +385,7 @@ struct PartialUpdateRegisterImpl {
 
   void mark_full_update()
   {
+    update_id = next_update_id();
     history.clear();
     last_changeset_id++;
     current_changeset.clear();
@@ -377,6 +394,7 @@ struct PartialUpdateRegisterImpl {
 
   void mark_region(const ImageTile *image_tile, const rcti *updated_region)
   {
+    update_id = next_update_id();
     TileChangeset &tile_changeset = current_changeset[image_tile];
     tile_changeset.mark_region(updated_region);
     current_changeset.has_dirty_chunks |= tile_changeset.has_dirty_chunks();
@@ -581,4 +599,10 @@ void BKE_image_partial_update_mark_full_update(Image *image)
   PartialUpdateRegisterImpl *partial_updater = unwrap(image_partial_update_register_ensure(image));
   partial_updater->mark_full_update();
 }
+
+uint64_t BKE_image_partial_update_id(Image *image)
+{
+  PartialUpdateRegisterImpl *partial_updater = unwrap(image_partial_update_register_ensure(image));
+  return partial_updater->update_id;
+}
 }
@@ -0,0 +1,698 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <cmath>
+#include <mutex>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_map.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_color.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.h"
+#include "BLI_set.hh"
+#include "BLI_task.hh"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_image_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+
+#include "BKE_image.h"
+#include "BKE_image_partial_update.hh"
+#include "BKE_image_sampler.h"
+
+using namespace blender;
+using namespace blender::bke::image::partial_update;
+
+/* -------------------------------------------------------------------- */
+/** \name Sample Cache
+ *
+ * Tiles of image buffers converted to premultiplied scene linear float, stored in a #MovieCache
+ * per image so the cache limiter frees the least recently used tiles together with other cached
+ * image buffers. Float buffers with four channels are read directly and have no tiles. Guarded by
+ * the cache mutex of the image.
+ * \{ */
+
+/** Size of the tiles in pixels. */
+#define IMAGE_SAMPLE_TILE_SIZE 64
+
+struct ImageSampleCacheKey {
+  int tile_number;
+  int framenr;
+  int tx, ty;
+  short multi_index, view, layer, pass;
+};
+
+struct ImageSampleCache {
+  struct MovieCache *tiles;
+  /** Detects changes of the image buffers, which invalidate their tiles. */
+  struct PartialUpdateUser *partial_update_user;
+};
+
+static unsigned int image_sample_cache_hashhash(const void *key_v)
+{
+  const ImageSampleCacheKey *key = static_cast<const ImageSampleCacheKey *>(key_v);
+
+  size_t hash = BLI_ghashutil_uinthash(uint(key->tile_number));
+  hash = BLI_ghashutil_combine_hash(hash, BLI_ghashutil_uinthash(uint(key->framenr)));
+  hash = BLI_ghashutil_combine_hash(hash, BLI_ghashutil_uinthash(uint(key->tx)));
+  hash = BLI_ghashutil_combine_hash(hash, BLI_ghashutil_uinthash(uint(key->ty)));
+  return uint(hash);
+}
+
+static bool image_sample_cache_key_equal(const ImageSampleCacheKey &a,
+                                         const ImageSampleCacheKey &b)
+{
+  return a.tile_number == b.tile_number && a.framenr == b.framenr && a.tx == b.tx &&
+         a.ty == b.ty && a.multi_index == b.multi_index && a.view == b.view &&
+         a.layer == b.layer && a.pass == b.pass;
+}
+
+static bool image_sample_cache_hashcmp(const void *a_v, const void *b_v)
+{
+  const ImageSampleCacheKey *a = static_cast<const ImageSampleCacheKey *>(a_v);
+  const ImageSampleCacheKey *b = static_cast<const ImageSampleCacheKey *>(b_v);
+
+  return !image_sample_cache_key_equal(*a, *b);
+}
+
+static MovieCache *image_sample_cache_tiles_create()
+{
+  return IMB_moviecache_create("Image Sample Cache",
+                               sizeof(ImageSampleCacheKey),
+                               image_sample_cache_hashhash,
+                               image_sample_cache_hashcmp);
+}
+
+static bool image_sample_cache_tile_number_check(ImBuf *UNUSED(ibuf),
+                                                 void *userkey,
+                                                 void *userdata)
+{
+  const ImageSampleCacheKey *key = static_cast<const ImageSampleCacheKey *>(userkey);
+  const int tile_number = *static_cast<const int *>(userdata);
+
+  return key->tile_number == tile_number;
+}
+
+/**
+ * Create the sample cache of the image, or drop tiles of image buffers which changed since the
+ * last call. Must be called with the cache mutex of the image locked.
+ */
+static void image_sample_cache_ensure_valid(Image *image)
+{
+  ImageSampleCache *cache = image->runtime.sample_cache;
+  if (cache == nullptr) {
+    cache = MEM_cnew<ImageSampleCache>(__func__);
+    cache->tiles = image_sample_cache_tiles_create();
+    cache->partial_update_user = BKE_image_partial_update_create(image);
+    image->runtime.sample_cache = cache;
+  }
+
+  switch (BKE_image_partial_update_collect_changes(image, cache->partial_update_user)) {
+    case ePartialUpdateCollectResult::FullUpdateNeeded: {
+      IMB_moviecache_free(cache->tiles);
+      cache->tiles = image_sample_cache_tiles_create();
+      break;
+    }
+    case ePartialUpdateCollectResult::PartialChangesDetected: {
+      /* Changes are rare while sampling, drop all tiles of the changed UDIM tiles instead of
+       * tracking which tiles are affected. */
+      PartialUpdateRegion changed_region;
+      while (BKE_image_partial_update_get_next_change(cache->partial_update_user,
+                                                      &changed_region) ==
+             ePartialUpdateIterResult::ChangeAvailable) {
+        IMB_moviecache_cleanup(
+            cache->tiles, image_sample_cache_tile_number_check, &changed_region.tile_number);
+      }
+      break;
+    }
+    case ePartialUpdateCollectResult::NoChangesDetected:
+      break;
+  }
+}
+
+void BKE_image_sample_cache_free(Image *image)
+{
+  ImageSampleCache *cache = image->runtime.sample_cache;
+  if (cache == nullptr) {
+    return;
+  }
+
+  IMB_moviecache_free(cache->tiles);
+  BKE_image_partial_update_free(cache->partial_update_user);
+  MEM_freeN(cache);
+  image->runtime.sample_cache = nullptr;
+}
+
+/** \return The cached buffer referenced, or null. */
+static ImBuf *image_sample_cache_get(Image *image, const ImageSampleCacheKey &key)
+{
+  ThreadMutex *mutex = static_cast<ThreadMutex *>(image->runtime.cache_mutex);
+  ImBuf *ibuf = nullptr;
+
+  BLI_mutex_lock(mutex);
+  if (image->runtime.sample_cache) {
+    ibuf = IMB_moviecache_get(image->runtime.sample_cache->tiles, (void *)&key, nullptr);
+  }
+  BLI_mutex_unlock(mutex);
+
+  return ibuf;
+}
+
+/**
+ * Cache a buffer, unless another thread cached one for the same key already.
+ *
+ * \return The cached buffer, the reference of the caller to given buffer is handed over.
+ */
+static ImBuf *image_sample_cache_put(Image *image, const ImageSampleCacheKey &key, ImBuf *ibuf)
+{
+  ThreadMutex *mutex = static_cast<ThreadMutex *>(image->runtime.cache_mutex);
+  ImBuf *cached_ibuf = nullptr;
+
+  BLI_mutex_lock(mutex);
+  /* The cache is freed when image buffers are, the buffer is only used by the caller then. */
+  if (image->runtime.sample_cache) {
+    MovieCache *tiles = image->runtime.sample_cache->tiles;
+    cached_ibuf = IMB_moviecache_get(tiles, (void *)&key, nullptr);
+    if (cached_ibuf == nullptr) {
+      IMB_moviecache_put(tiles, (void *)&key, ibuf);
+    }
+  }
+  BLI_mutex_unlock(mutex);
+
+  if (cached_ibuf) {
+    IMB_freeImBuf(ibuf);
+    return cached_ibuf;
+  }
+  return ibuf;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Image Buffer Pixels
+ * \{ */
+
+/** Float buffers with four channels are sampled directly, other buffers through cached tiles. */
+static bool image_sample_is_direct(const ImBuf *ibuf)
+{
+  return ibuf->rect_float && ibuf->channels == 4;
+}
+
+/**
+ * Read pixels of a row of the image buffer as premultiplied scene linear float, converted like
+ * #IMB_float_from_rect does.
+ */
+static void image_sample_read_row(const ImBuf *ibuf,
+                                  const int y,
+                                  const int x_begin,
+                                  MutableSpan<float4> r_row)
+{
+  const int width = int(r_row.size());
+
+  if (ibuf->rect_float) {
+    const int channels = ibuf->channels;
+    const float *src = ibuf->rect_float + (size_t(y) * ibuf->x + x_begin) * channels;
+    if (channels == 4) {
+      memcpy(r_row.data(), src, sizeof(float4) * width);
+      return;
+    }
+    for (const int x : IndexRange(width)) {
+      const float *pixel = src + x * channels;
+      if (channels == 1) {
+        r_row[x] = float4(pixel[0], pixel[0], pixel[0], 1.0f);
+      }
+      else {
+        r_row[x] = float4(pixel[0], pixel[1], (channels > 2) ? pixel[2] : 0.0f, 1.0f);
+      }
+    }
+    return;
+  }
+
+  float *dst = reinterpret_cast<float *>(r_row.data());
+  const uchar *src = reinterpret_cast<const uchar *>(ibuf->rect) +
+                     (size_t(y) * ibuf->x + x_begin) * 4;
+  IMB_buffer_float_from_byte(
+      dst, src, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false, width, 1, width, ibuf->x);
+  IMB_colormanagement_colorspace_to_scene_linear(dst, width, 1, 4, ibuf->rect_colorspace, false);
+  if (IMB_alpha_affects_rgb(ibuf)) {
+    for (float4 &pixel : r_row) {
+      straight_to_premul_v4(pixel);
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Sampler
+ * \{ */
+
+/** Number of tiles each thread keeps referenced, to look them up without locking. */
+#define IMAGE_SAMPLER_LOCAL_TILES 16
+
+struct ImageSamplerSource {
+  ImBuf *ibuf = nullptr;
+  void *lock = nullptr;
+  bool is_acquired = false;
+};
+
+struct ImageSamplerLocalTile {
+  ImageSampleCacheKey key;
+  ImBuf *ibuf;
+};
+
+struct ImageSamplerLocalData {
+  ImageSamplerLocalTile tiles[IMAGE_SAMPLER_LOCAL_TILES] = {};
+  /** Image buffers of UDIM tiles, to look them up without locking. Null for tiles that can't be
+   * loaded. */
+  Map<int, const ImBuf *> sources;
+};
+
+struct ImageSampler {
+  Image *image;
+  ImageUser iuser;
+  eImageSamplerInterpolation interpolation;
+  eImageSamplerExtension extension;
+
+  /** Key of the image buffers the image user refers to. */
+  ImageSampleCacheKey base_key;
+  bool is_tiled;
+  int first_tile_number;
+  Set<int> tile_numbers;
+
+  /** Image buffers of UDIM tiles, acquired when a tile is first sampled. */
+  std::mutex sources_mutex;
+  Map<int, ImageSamplerSource> sources;
+
+  threading::EnumerableThreadSpecific<ImageSamplerLocalData> local_data;
+};
+
+ImageSampler *BKE_image_sampler_new(Image *image,
+                                    const ImageUser *iuser,
+                                    const eImageSamplerInterpolation interpolation,
+                                    const eImageSamplerExtension extension)
+{
+  ImageSampler *sampler = MEM_new<ImageSampler>(__func__);
+  sampler->image = image;
+  sampler->iuser = *iuser;
+  sampler->interpolation = interpolation;
+  sampler->extension = extension;
+
+  sampler->is_tiled = image->source == IMA_SRC_TILED;
+  sampler->first_tile_number = BKE_image_get_tile(image, 0)->tile_number;
+  LISTBASE_FOREACH (const ImageTile *, tile, &image->tiles) {
+    sampler->tile_numbers.add(tile->tile_number);
+  }
+
+  ImageSampleCacheKey &key = sampler->base_key;
+  memset(&key, 0, sizeof(key));
+  key.framenr = iuser->framenr;
+  key.multi_index = iuser->multi_index;
+  key.view = iuser->view;
+  key.layer = iuser->layer;
+  key.pass = iuser->pass;
+
+  ThreadMutex *mutex = static_cast<ThreadMutex *>(image->runtime.cache_mutex);
+  BLI_mutex_lock(mutex);
+  image_sample_cache_ensure_valid(image);
+  BLI_mutex_unlock(mutex);
+
+  return sampler;
+}
+
+void BKE_image_sampler_free(ImageSampler *sampler)
+{
+  for (ImageSamplerLocalData &local : sampler->local_data) {
+    for (ImageSamplerLocalTile &local_tile : local.tiles) {
+      if (local_tile.ibuf) {
+        IMB_freeImBuf(local_tile.ibuf);
+      }
+    }
+  }
+  for (ImageSamplerSource &source : sampler->sources.values()) {
+    if (source.ibuf) {
+      BKE_image_release_ibuf(sampler->image, source.ibuf, source.lock);
+    }
+  }
+  MEM_delete(sampler);
+}
+
+/** \return The image buffer of the UDIM tile, kept acquired until the sampler is freed. */
+static ImBuf *image_sampler_source_acquire(ImageSampler *sampler, const int tile_number)
+{
+  std::lock_guard lock(sampler->sources_mutex);
+  ImageSamplerSource &source = sampler->sources.lookup_or_add_default(tile_number);
+
+  if (!source.is_acquired) {
+    source.is_acquired = true;
+    /* Loading may use multiple threads, isolate it so this thread doesn't pick up sampling work
+     * which needs the mutex while waiting. */
+    threading::isolate_task([&]() {
+      ImageUser iuser = sampler->iuser;
+      iuser.tile = tile_number;
+      source.ibuf = BKE_image_acquire_ibuf(sampler->image, &iuser, &source.lock);
+    });
+    if (source.ibuf && source.ibuf->rect == nullptr && source.ibuf->rect_float == nullptr) {
+      BKE_image_release_ibuf(sampler->image, source.ibuf, source.lock);
+      source.ibuf = nullptr;
+    }
+  }
+
+  return source.ibuf;
+}
+
+static const ImBuf *image_sampler_source(ImageSampler *sampler,
+                                         ImageSamplerLocalData &local,
+                                         const int tile_number)
+{
+  return local.sources.lookup_or_add_cb(
+      tile_number, [&]() { return image_sampler_source_acquire(sampler, tile_number); });
+}
+
+/**
+ * Create a tile of the image buffer, converted to premultiplied scene linear float a row at a
+ * time, so the conversion of byte and other buffers is done once per tile instead of once for
+ * every pixel lookup.
+ */
+static ImBuf *image_sampler_tile_create(const ImBuf *source, const ImageSampleCacheKey &key)
+{
+  const int x_begin = key.tx * IMAGE_SAMPLE_TILE_SIZE;
+  const int y_begin = key.ty * IMAGE_SAMPLE_TILE_SIZE;
+  const int tile_width = min_ii(source->x - x_begin, IMAGE_SAMPLE_TILE_SIZE);
+  const int tile_height = min_ii(source->y - y_begin, IMAGE_SAMPLE_TILE_SIZE);
+
+  ImBuf *tile = IMB_allocImBuf(tile_width, tile_height, 32, IB_rectfloat);
+  if (tile == nullptr) {
+    return nullptr;
+  }
+
+  float4 *dst = reinterpret_cast<float4 *>(tile->rect_float);
+  for (const int y : IndexRange(tile_height)) {
+    image_sample_read_row(
+        source, y_begin + y, x_begin, MutableSpan<float4>(dst + y * tile_width, tile_width));
+  }
+
+  return tile;
+}
+
+/**
+ * \return The tile containing the pixel, created if it isn't cached. Only valid until the next
+ * tile is looked up by this thread.
+ */
+static const ImBuf *image_sampler_tile(ImageSampler *sampler,
+                                       ImageSamplerLocalData &local,
+                                       const ImBuf *source,
+                                       const ImageSampleCacheKey &key)
+{
+  ImageSamplerLocalTile *local_tile =
+      &local.tiles[image_sample_cache_hashhash(&key) % IMAGE_SAMPLER_LOCAL_TILES];
+  if (local_tile->ibuf && image_sample_cache_key_equal(local_tile->key, key)) {
+    return local_tile->ibuf;
+  }
+
+  ImBuf *tile = image_sample_cache_get(sampler->image, key);
+  if (tile == nullptr) {
+    tile = image_sampler_tile_create(source, key);
+    if (tile == nullptr) {
+      return nullptr;
+    }
+    tile = image_sample_cache_put(sampler->image, key, tile);
+  }
+
+  if (local_tile->ibuf) {
+    IMB_freeImBuf(local_tile->ibuf);
+  }
+  local_tile->key = key;
+  local_tile->ibuf = tile;
+  return tile;
+}
+
+/** Pixels of the image buffer of a UDIM tile. */
+struct ImageSamplerPixels {
+  ImageSampler *sampler;
+  ImageSamplerLocalData *local;
+  const ImBuf *source;
+  ImageSampleCacheKey key;
+  int width, height;
+  bool is_direct;
+
+  float4 pixel(const int x, const int y)
+  {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+      return float4(0.0f);
+    }
+    if (is_direct) {
+      return reinterpret_cast<const float4 *>(source->rect_float)[size_t(y) * width + x];
+    }
+    key.tx = x / IMAGE_SAMPLE_TILE_SIZE;
+    key.ty = y / IMAGE_SAMPLE_TILE_SIZE;
+    const ImBuf *tile = image_sampler_tile(sampler, *local, source, key);
+    if (tile == nullptr) {
+      return float4(0.0f);
+    }
+    const int tile_x = x % IMAGE_SAMPLE_TILE_SIZE;
+    const int tile_y = y % IMAGE_SAMPLE_TILE_SIZE;
+    return reinterpret_cast<const float4 *>(tile->rect_float)[tile_y * tile->x + tile_x];
+  }
+};
+
+static int wrap_periodic(int x, const int width)
+{
+  x %= width;
+  if (x < 0) {
+    x += width;
+  }
+  return x;
+}
+
+static int wrap_clamp(const int x, const int width)
+{
+  return std::clamp(x, 0, width - 1);
+}
+
+static float frac(const float x, int *ix)
+{
+  const int i = (int)x - ((x < 0.0f) ? 1 : 0);
+  *ix = i;
+  return x - (float)i;
+}
+
+static float4 image_sampler_cubic(ImageSamplerPixels &pixels,
+                                  const float px,
+                                  const float py,
+                                  const eImageSamplerExtension extension)
+{
+  const int width = pixels.width;
+  const int height = pixels.height;
+  int pix, piy, nix, niy;
+  const float tx = frac(px * (float)width - 0.5f, &pix);
+  const float ty = frac(py * (float)height - 0.5f, &piy);
+  int ppix, ppiy, nnix, nniy;
+
+  switch (extension) {
+    case IMAGE_SAMPLER_EXTENSION_REPEAT: {
+      pix = wrap_periodic(pix, width);
+      piy = wrap_periodic(piy, height);
+      ppix = wrap_periodic(pix - 1, width);
+      ppiy = wrap_periodic(piy - 1, height);
+      nix = wrap_periodic(pix + 1, width);
+      niy = wrap_periodic(piy + 1, height);
+      nnix = wrap_periodic(pix + 2, width);
+      nniy = wrap_periodic(piy + 2, height);
+      break;
+    }
+    case IMAGE_SAMPLER_EXTENSION_CLIP: {
+      ppix = pix - 1;
+      ppiy = piy - 1;
+      nix = pix + 1;
+      niy = piy + 1;
+      nnix = pix + 2;
+      nniy = piy + 2;
+      break;
+    }
+    case IMAGE_SAMPLER_EXTENSION_EXTEND: {
+      ppix = wrap_clamp(pix - 1, width);
+      ppiy = wrap_clamp(piy - 1, height);
+      nix = wrap_clamp(pix + 1, width);
+      niy = wrap_clamp(piy + 1, height);
+      nnix = wrap_clamp(pix + 2, width);
+      nniy = wrap_clamp(piy + 2, height);
+      pix = wrap_clamp(pix, width);
+      piy = wrap_clamp(piy, height);
+      break;
+    }
+    default:
+      return float4(0.0f);
+  }
+
+  const int xc[4] = {ppix, pix, nix, nnix};
+  const int yc[4] = {ppiy, piy, niy, nniy};
+  float u[4], v[4];
+
+  u[0] = (((-1.0f / 6.0f) * tx + 0.5f) * tx - 0.5f) * tx + (1.0f / 6.0f);
+  u[1] = ((0.5f * tx - 1.0f) * tx) * tx + (2.0f / 3.0f);
+  u[2] = ((-0.5f * tx + 0.5f) * tx + 0.5f) * tx + (1.0f / 6.0f);
+  u[3] = (1.0f / 6.0f) * tx * tx * tx;
+
+  v[0] = (((-1.0f / 6.0f) * ty + 0.5f) * ty - 0.5f) * ty + (1.0f / 6.0f);
+  v[1] = ((0.5f * ty - 1.0f) * ty) * ty + (2.0f / 3.0f);
+  v[2] = ((-0.5f * ty + 0.5f) * ty + 0.5f) * ty + (1.0f / 6.0f);
+  v[3] = (1.0f / 6.0f) * ty * ty * ty;
+
+  float4 result(0.0f);
+  for (int j = 0; j < 4; j++) {
+    result += v[j] * (u[0] * pixels.pixel(xc[0], yc[j]) + u[1] * pixels.pixel(xc[1], yc[j]) +
+                      u[2] * pixels.pixel(xc[2], yc[j]) + u[3] * pixels.pixel(xc[3], yc[j]));
+  }
+  return result;
+}
+
+static float4 image_sampler_linear(ImageSamplerPixels &pixels,
+                                   const float px,
+                                   const float py,
+                                   const eImageSamplerExtension extension)
+{
+  const int width = pixels.width;
+  const int height = pixels.height;
+  int pix, piy, nix, niy;
+  const float nfx = frac(px * (float)width - 0.5f, &pix);
+  const float nfy = frac(py * (float)height - 0.5f, &piy);
+
+  switch (extension) {
+    case IMAGE_SAMPLER_EXTENSION_CLIP: {
+      nix = pix + 1;
+      niy = piy + 1;
+      break;
+    }
+    case IMAGE_SAMPLER_EXTENSION_EXTEND: {
+      nix = wrap_clamp(pix + 1, width);
+      niy = wrap_clamp(piy + 1, height);
+      pix = wrap_clamp(pix, width);
+      piy = wrap_clamp(piy, height);
+      break;
+    }
+    default:
+    case IMAGE_SAMPLER_EXTENSION_REPEAT:
+      pix = wrap_periodic(pix, width);
+      piy = wrap_periodic(piy, height);
+      nix = wrap_periodic(pix + 1, width);
+      niy = wrap_periodic(piy + 1, height);
+      break;
+  }
+
+  const float ptx = 1.0f - nfx;
+  const float pty = 1.0f - nfy;
+
+  return pixels.pixel(pix, piy) * ptx * pty + pixels.pixel(nix, piy) * nfx * pty +
+         pixels.pixel(pix, niy) * ptx * nfy + pixels.pixel(nix, niy) * nfx * nfy;
+}
+
+static float4 image_sampler_closest(ImageSamplerPixels &pixels,
+                                    const float px,
+                                    const float py,
+                                    const eImageSamplerExtension extension)
+{
+  const int width = pixels.width;
+  const int height = pixels.height;
+  int ix, iy;
+  frac(px * (float)width, &ix);
+  frac(py * (float)height, &iy);
+
+  switch (extension) {
+    case IMAGE_SAMPLER_EXTENSION_REPEAT: {
+      ix = wrap_periodic(ix, width);
+      iy = wrap_periodic(iy, height);
+      return pixels.pixel(ix, iy);
+    }
+    case IMAGE_SAMPLER_EXTENSION_CLIP: {
+      if (ix < 0 || iy < 0 || ix > width || iy > height) {
+        return float4(0.0f);
+      }
+      ATTR_FALLTHROUGH;
+    }
+    case IMAGE_SAMPLER_EXTENSION_EXTEND: {
+      ix = wrap_clamp(ix, width);
+      iy = wrap_clamp(iy, height);
+      return pixels.pixel(ix, iy);
+    }
+    default:
+      return float4(0.0f);
+  }
+}
+
+static float4 image_sampler_sample_source(ImageSampler *sampler,
+                                          ImageSamplerLocalData &local,
+                                          const int tile_number,
+                                          const ImBuf *source,
+                                          const float2 co)
+{
+  ImageSamplerPixels pixels;
+  pixels.sampler = sampler;
+  pixels.local = &local;
+  pixels.source = source;
+  pixels.key = sampler->base_key;
+  pixels.key.tile_number = tile_number;
+  pixels.width = source->x;
+  pixels.height = source->y;
+  pixels.is_direct = image_sample_is_direct(source);
+
+  switch (sampler->interpolation) {
+    case IMAGE_SAMPLER_INTERPOLATION_CLOSEST:
+      return image_sampler_closest(pixels, co.x, co.y, sampler->extension);
+    case IMAGE_SAMPLER_INTERPOLATION_LINEAR:
+      return image_sampler_linear(pixels, co.x, co.y, sampler->extension);
+    case IMAGE_SAMPLER_INTERPOLATION_CUBIC:
+      return image_sampler_cubic(pixels, co.x, co.y, sampler->extension);
+  }
+  return float4(0.0f);
+}
+
+/** Same tile lookup as #BKE_image_get_tile_from_pos, without going over the list of tiles. */
+static int image_sampler_tile_from_uv(const ImageSampler *sampler, float2 &co)
+{
+  if (!sampler->is_tiled || co.x < 0.0f || co.y < 0.0f || co.x >= 10.0f) {
+    return sampler->first_tile_number;
+  }
+
+  const int ix = int(co.x);
+  const int iy = int(co.y);
+  const int tile_number = 1001 + 10 * iy + ix;
+  if (!sampler->tile_numbers.contains(tile_number)) {
+    return sampler->first_tile_number;
+  }
+
+  co -= float2(float(ix), float(iy));
+  return tile_number;
+}
+
+bool BKE_image_sampler_sample(ImageSampler *sampler, const float uv[2], float r_color[4])
+{
+  ImageSamplerLocalData &local = sampler->local_data.local();
+
+  float2 co(uv[0], uv[1]);
+  const int tile_number = image_sampler_tile_from_uv(sampler, co);
+  const ImBuf *source = image_sampler_source(sampler, local, tile_number);
+  if (source == nullptr) {
+    zero_v4(r_color);
+    return false;
+  }
+
+  copy_v4_v4(r_color, image_sampler_sample_source(sampler, local, tile_number, source, co));
+  return true;
+}
+
+/** \} */
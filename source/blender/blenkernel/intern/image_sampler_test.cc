@@ -0,0 +1,316 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_image_partial_update.hh"
+#include "BKE_image_sampler.h"
+#include "BKE_main.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_color.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+
+#include "PIL_time.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+
+#include "DNA_image_types.h"
+
+namespace blender::bke::image::tests {
+
+/* Generated float images convert the fill color from sRGB to linear, which keeps these as is. */
+constexpr float green_color[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+constexpr float red_color[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+
+class ImageSamplerTest : public testing::Test {
+ protected:
+  Main *bmain;
+  ImageUser image_user = {nullptr};
+
+  void SetUp() override
+  {
+    CLG_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    IMB_init();
+
+    bmain = BKE_main_new();
+    BKE_imageuser_default(&image_user);
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+
+    IMB_moviecache_destruct();
+    IMB_exit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+
+  Image *create_image(const int width,
+                      const int height,
+                      const float color[4],
+                      bool tiled,
+                      bool is_float = true)
+  {
+    return BKE_image_add_generated(bmain,
+                                   width,
+                                   height,
+                                   "Test Image",
+                                   is_float ? 128 : 32,
+                                   is_float,
+                                   IMA_GENTYPE_BLANK,
+                                   color,
+                                   false,
+                                   false,
+                                   tiled);
+  }
+
+  /** Fill the byte buffer of the image with a checker pattern of single pixels. */
+  void fill_checker(Image *image)
+  {
+    ImBuf *ibuf = BKE_image_acquire_ibuf(image, &image_user, nullptr);
+    uchar *rect = reinterpret_cast<uchar *>(ibuf->rect);
+    for (int y = 0; y < ibuf->y; y++) {
+      for (int x = 0; x < ibuf->x; x++) {
+        memset(rect + (size_t(y) * ibuf->x + x) * 4, ((x + y) % 2) ? 255 : 0, 4);
+      }
+    }
+    BKE_image_release_ibuf(image, ibuf, nullptr);
+    BKE_image_partial_update_mark_full_update(image);
+  }
+};
+
+static void expect_color(ImageSampler *sampler,
+                         const float u,
+                         const float v,
+                         const float expected[4])
+{
+  const float uv[2] = {u, v};
+  float color[4];
+  EXPECT_TRUE(BKE_image_sampler_sample(sampler, uv, color));
+  for (int i = 0; i < 4; i++) {
+    EXPECT_NEAR(color[i], expected[i], 1e-5f);
+  }
+}
+
+TEST_F(ImageSamplerTest, constant_color)
+{
+  for (const bool is_float : {true, false}) {
+    /* Not a power of two, and larger than a tile of the cache. */
+    Image *image = create_image(300, 70, green_color, false, is_float);
+
+    for (const eImageSamplerInterpolation interpolation : {IMAGE_SAMPLER_INTERPOLATION_CLOSEST,
+                                                           IMAGE_SAMPLER_INTERPOLATION_LINEAR,
+                                                           IMAGE_SAMPLER_INTERPOLATION_CUBIC}) {
+      ImageSampler *sampler = BKE_image_sampler_new(
+          image, &image_user, interpolation, IMAGE_SAMPLER_EXTENSION_REPEAT);
+      expect_color(sampler, 0.5f, 0.5f, green_color);
+      expect_color(sampler, 0.99f, 0.01f, green_color);
+      expect_color(sampler, -3.3f, 7.6f, green_color);
+      BKE_image_sampler_free(sampler);
+    }
+  }
+}
+
+TEST_F(ImageSamplerTest, byte_tiles)
+{
+  Image *image = create_image(256, 256, green_color, false, false);
+  fill_checker(image);
+
+  const float black[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  const float average[4] = {0.5f, 0.5f, 0.5f, 0.5f};
+
+  ImageSampler *sampler = BKE_image_sampler_new(
+      image, &image_user, IMAGE_SAMPLER_INTERPOLATION_LINEAR, IMAGE_SAMPLER_EXTENSION_REPEAT);
+  /* At pixel centers. */
+  expect_color(sampler, 0.5f / 256.0f, 0.5f / 256.0f, black);
+  expect_color(sampler, 1.5f / 256.0f, 0.5f / 256.0f, white);
+  expect_color(sampler, 201.5f / 256.0f, 100.5f / 256.0f, white);
+  /* Between pixels, also across the edges of the cached tiles. */
+  expect_color(sampler, 1.0f / 256.0f, 0.5f / 256.0f, average);
+  expect_color(sampler, 64.0f / 256.0f, 10.5f / 256.0f, average);
+  expect_color(sampler, 20.5f / 256.0f, 128.0f / 256.0f, average);
+  BKE_image_sampler_free(sampler);
+}
+
+TEST_F(ImageSamplerTest, clip_extension)
+{
+  Image *image = create_image(16, 16, green_color, false);
+  const float transparent[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+  ImageSampler *sampler = BKE_image_sampler_new(
+      image, &image_user, IMAGE_SAMPLER_INTERPOLATION_LINEAR, IMAGE_SAMPLER_EXTENSION_CLIP);
+  expect_color(sampler, 0.5f, 0.5f, green_color);
+  expect_color(sampler, 2.5f, 0.5f, transparent);
+  expect_color(sampler, 0.5f, -1.5f, transparent);
+  BKE_image_sampler_free(sampler);
+}
+
+TEST_F(ImageSamplerTest, changed_image)
+{
+  Image *image = create_image(128, 128, green_color, false, false);
+
+  ImageSampler *sampler = BKE_image_sampler_new(
+      image, &image_user, IMAGE_SAMPLER_INTERPOLATION_CLOSEST, IMAGE_SAMPLER_EXTENSION_REPEAT);
+  expect_color(sampler, 0.5f, 0.5f, green_color);
+  BKE_image_sampler_free(sampler);
+
+  /* Cached tiles must not be used once the image changed. */
+  ImBuf *ibuf = BKE_image_acquire_ibuf(image, &image_user, nullptr);
+  for (int i = 0; i < ibuf->x * ibuf->y; i++) {
+    rgba_float_to_uchar(reinterpret_cast<uchar *>(ibuf->rect) + i * 4, red_color);
+  }
+  BKE_image_release_ibuf(image, ibuf, nullptr);
+  BKE_image_partial_update_mark_full_update(image);
+
+  sampler = BKE_image_sampler_new(
+      image, &image_user, IMAGE_SAMPLER_INTERPOLATION_CLOSEST, IMAGE_SAMPLER_EXTENSION_REPEAT);
+  expect_color(sampler, 0.5f, 0.5f, red_color);
+  BKE_image_sampler_free(sampler);
+}
+
+TEST_F(ImageSamplerTest, udim_tiles)
+{
+  Image *image = create_image(32, 32, green_color, true);
+  ImageTile *tile = BKE_image_add_tile(image, 1002, nullptr);
+  ASSERT_TRUE(BKE_image_fill_tile(image, tile, 64, 16, red_color, IMA_GENTYPE_BLANK, 32, true));
+
+  ImageSampler *sampler = BKE_image_sampler_new(
+      image, &image_user, IMAGE_SAMPLER_INTERPOLATION_LINEAR, IMAGE_SAMPLER_EXTENSION_REPEAT);
+  expect_color(sampler, 0.5f, 0.5f, green_color);
+  expect_color(sampler, 1.5f, 0.5f, red_color);
+  /* Coordinates outside of existing tiles repeat the first tile. */
+  expect_color(sampler, 2.5f, 0.5f, green_color);
+  expect_color(sampler, -0.5f, 0.5f, green_color);
+  BKE_image_sampler_free(sampler);
+}
+
+TEST_F(ImageSamplerTest, missing_image)
+{
+  Image *image = create_image(16, 16, green_color, false);
+  image->source = IMA_SRC_FILE;
+  STRNCPY(image->filepath, "//missing_image_sampler_test.png");
+  BKE_image_free_buffers(image);
+
+  ImageSampler *sampler = BKE_image_sampler_new(
+      image, &image_user, IMAGE_SAMPLER_INTERPOLATION_LINEAR, IMAGE_SAMPLER_EXTENSION_REPEAT);
+  const float uv[2] = {0.5f, 0.5f};
+  float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  EXPECT_FALSE(BKE_image_sampler_sample(sampler, uv, color));
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(color[i], 0.0f);
+  }
+  BKE_image_sampler_free(sampler);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Benchmarks
+ * \{ */
+
+/**
+ * Bilinear lookup with repeat extension in the float buffer, the way the geometry nodes Image
+ * Texture node sampled images before using #ImageSampler.
+ */
+static void sample_float_buffer_linear(const ImBuf *ibuf, const float uv[2], float r_color[4])
+{
+  const float px = uv[0] * ibuf->x - 0.5f;
+  const float py = uv[1] * ibuf->y - 0.5f;
+  const int ix = int(floorf(px));
+  const int iy = int(floorf(py));
+  const float fx = px - ix;
+  const float fy = py - iy;
+  const auto wrap = [](int x, const int size) {
+    x %= size;
+    return x < 0 ? x + size : x;
+  };
+  const int x0 = wrap(ix, ibuf->x), x1 = wrap(ix + 1, ibuf->x);
+  const int y0 = wrap(iy, ibuf->y), y1 = wrap(iy + 1, ibuf->y);
+  const float *rect = ibuf->rect_float;
+  for (int i = 0; i < 4; i++) {
+    r_color[i] = (rect[(size_t(y0) * ibuf->x + x0) * 4 + i] * (1.0f - fx) +
+                  rect[(size_t(y0) * ibuf->x + x1) * 4 + i] * fx) *
+                     (1.0f - fy) +
+                 (rect[(size_t(y1) * ibuf->x + x0) * 4 + i] * (1.0f - fx) +
+                  rect[(size_t(y1) * ibuf->x + x1) * 4 + i] * fx) *
+                     fy;
+  }
+}
+
+TEST_F(ImageSamplerTest, DISABLED_benchmark_4k)
+{
+  const int samples_num = 3840 * 2160;
+  RandomNumberGenerator rng(0);
+  Array<float2> uvs(samples_num);
+  for (float2 &uv : uvs) {
+    uv = float2(rng.get_float(), rng.get_float());
+  }
+
+  for (const bool is_float : {false, true}) {
+    Image *image = BKE_image_add_generated(bmain,
+                                           3840,
+                                           2160,
+                                           "Benchmark Image",
+                                           is_float ? 128 : 32,
+                                           is_float,
+                                           IMA_GENTYPE_GRID_COLOR,
+                                           green_color,
+                                           false,
+                                           false,
+                                           false);
+
+    /* Previous node path: convert to float once, then read the float buffer. */
+    double start_time = PIL_check_seconds_timer();
+    ImBuf *ibuf = BKE_image_acquire_ibuf(image, &image_user, nullptr);
+    IMB_float_from_rect(ibuf);
+    const double convert_time = PIL_check_seconds_timer() - start_time;
+    float color[4];
+    start_time = PIL_check_seconds_timer();
+    for (const float2 &uv : uvs) {
+      sample_float_buffer_linear(ibuf, uv, color);
+    }
+    const double direct_time = PIL_check_seconds_timer() - start_time;
+    /* Drop the float copy again so the sampler reads the byte buffer. */
+    if (!is_float) {
+      imb_freerectfloatImBuf(ibuf);
+    }
+    BKE_image_release_ibuf(image, ibuf, nullptr);
+
+    printf("%-5s float buffer: %8.2f ms conversion, %8.2f ms sampling\n",
+           is_float ? "float" : "byte",
+           convert_time * 1000.0,
+           direct_time * 1000.0);
+
+    for (const char *pass : {"cold", "warm"}) {
+      ImageSampler *sampler = BKE_image_sampler_new(
+          image, &image_user, IMAGE_SAMPLER_INTERPOLATION_LINEAR, IMAGE_SAMPLER_EXTENSION_REPEAT);
+      start_time = PIL_check_seconds_timer();
+      for (const float2 &uv : uvs) {
+        BKE_image_sampler_sample(sampler, uv, color);
+      }
+      const double sampler_time = PIL_check_seconds_timer() - start_time;
+      BKE_image_sampler_free(sampler);
+
+      printf("%-5s sampler, %s: %8.2f ms\n",
+             is_float ? "float" : "byte",
+             pass,
+             sampler_time * 1000.0);
+    }
+  }
+}
+
+/** \} */
+
+}  // namespace blender::bke::image::tests
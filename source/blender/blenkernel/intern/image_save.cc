@@ -385,6 +385,10 @@ static bool image_save_single(ReportList *reports,
 
   /* we need renderresult for exr and rendered multiview */
   rr = BKE_image_acquire_renderresult(opts->scene, ima);
+  if (rr && ima->rr == rr) {
+    /* Passes of multi-layer images may not have been read yet. */
+    BKE_image_multilayer_ensure_loaded(ima, nullptr);
+  }
   const bool is_mono = rr ? BLI_listbase_count_at_most(&rr->views, 2) < 2 :
                             BLI_listbase_count_at_most(&ima->views, 2) < 2;
   const bool is_exr_rr = rr && ELEM(imf->imtype, R_IMF_IMTYPE_OPENEXR, R_IMF_IMTYPE_MULTILAYER) &&
@@ -1905,6 +1905,7 @@ void BKE_mesh_vert_coords_apply(Mesh *mesh, const float (*vert_coords)[3])
     copy_v3_v3(mv->co, vert_coords[i]);
   }
   BKE_mesh_normals_tag_dirty(mesh);
+  mesh->runtime.looptris_positions_dirty = true;
 }
 
 void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
@@ -1919,6 +1920,7 @@ void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
     mul_v3_m4v3(mv->co, mat, vert_coords[i]);
   }
   BKE_mesh_normals_tag_dirty(mesh);
+  mesh->runtime.looptris_positions_dirty = true;
 }
 
 void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spacearr)
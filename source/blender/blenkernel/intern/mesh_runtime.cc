@@ -13,16 +13,20 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_math_geom.h"
 #include "BLI_task.hh"
 
 #include "BKE_bvhutils.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_shrinkwrap.h"
 #include "BKE_subdiv_ccg.h"
 
+static void mesh_topology_maps_free(Mesh *mesh);
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Runtime Struct Utils
  * \{ */
@@ -87,7 +91,9 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   runtime->bvh_cache = nullptr;
   runtime->shrinkwrap_data = nullptr;
   runtime->subsurf_face_dot_tags = nullptr;
+  runtime->topology_maps = nullptr;
 
+  runtime->looptris_positions_dirty = false;
   runtime->vert_normals_dirty = true;
   runtime->poly_normals_dirty = true;
   runtime->vert_normals = nullptr;
@@ -160,6 +166,23 @@ void BKE_mesh_runtime_looptri_recalc(Mesh *mesh)
                  mesh->runtime.looptris.array,
                  mesh->runtime.looptris.array_wip);
   mesh->runtime.looptris.array_wip = nullptr;
+  mesh->runtime.looptris_positions_dirty = false;
+}
+
+/**
+ * Tessellate the quads and n-gons of the existing #MLoopTri cache again after positions changed.
+ *
+ * \note This function must always be thread-protected by caller.
+ */
+static void mesh_looptri_update_positions(Mesh *mesh)
+{
+  BKE_mesh_recalc_looptri_positions_changed(mesh->mloop,
+                                            mesh->mpoly,
+                                            mesh->mvert,
+                                            mesh->totloop,
+                                            mesh->totpoly,
+                                            mesh->runtime.looptris.array);
+  mesh->runtime.looptris_positions_dirty = false;
 }
 
 int BKE_mesh_runtime_looptri_len(const Mesh *mesh)
@@ -179,6 +202,11 @@ const MLoopTri *BKE_mesh_runtime_looptri_ensure(const Mesh *mesh)
 
   if (looptri != nullptr) {
     BLI_assert(BKE_mesh_runtime_looptri_len(mesh) == mesh->runtime.looptris.len);
+    if (mesh->runtime.looptris_positions_dirty) {
+      /* Must isolate multithreaded tasks while holding a mutex lock. */
+      blender::threading::isolate_task(
+          [&]() { mesh_looptri_update_positions(const_cast<Mesh *>(mesh)); });
+    }
   }
   else {
     /* Must isolate multithreaded tasks while holding a mutex lock. */
@@ -192,6 +220,26 @@ const MLoopTri *BKE_mesh_runtime_looptri_ensure(const Mesh *mesh)
   return looptri;
 }
 
+void BKE_mesh_runtime_looptri_copy_deformed(Mesh *mesh_dst, const Mesh *mesh_src)
+{
+  BLI_assert(mesh_dst->runtime.looptris.array == nullptr);
+  BLI_assert(mesh_dst->totpoly == mesh_src->totpoly && mesh_dst->totloop == mesh_src->totloop);
+
+  /* Keep the tessellation of the source mesh around, it is reused every time it's deformed. */
+  const MLoopTri *looptri_src = BKE_mesh_runtime_looptri_ensure(mesh_src);
+  const int looptris_len = BKE_mesh_runtime_looptri_len(mesh_src);
+  if (looptri_src == nullptr || looptris_len == 0) {
+    return;
+  }
+
+  mesh_dst->runtime.looptris.array = static_cast<MLoopTri *>(
+      MEM_malloc_arrayN(looptris_len, sizeof(MLoopTri), __func__));
+  memcpy(mesh_dst->runtime.looptris.array, looptri_src, sizeof(MLoopTri) * looptris_len);
+  mesh_dst->runtime.looptris.len = looptris_len;
+  mesh_dst->runtime.looptris.len_alloc = looptris_len;
+  mesh_dst->runtime.looptris_positions_dirty = true;
+}
+
 void BKE_mesh_runtime_verttri_from_looptri(MVertTri *r_verttri,
                                            const MLoop *mloop,
                                            const MLoopTri *looptri,
@@ -249,6 +297,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.bvh_cache = nullptr;
   }
   MEM_SAFE_FREE(mesh->runtime.looptris.array);
+  mesh->runtime.looptris_positions_dirty = false;
   /* TODO(sergey): Does this really belong here? */
   if (mesh->runtime.subdiv_ccg != nullptr) {
     BKE_subdiv_ccg_destroy(mesh->runtime.subdiv_ccg);
@@ -257,6 +306,191 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   BKE_shrinkwrap_discard_boundary_data(mesh);
 
   MEM_SAFE_FREE(mesh->runtime.subsurf_face_dot_tags);
+  mesh_topology_maps_free(mesh);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Topology Maps
+ * \{ */
+
+struct MeshTopologyMaps {
+  MeshTopologyMap *vert_poly = nullptr;
+  MeshTopologyMap *vert_edge = nullptr;
+  MeshTopologyMap *edge_poly = nullptr;
+};
+
+void BKE_mesh_topology_map_release(const MeshTopologyMap *map)
+{
+  MeshTopologyMap *map_mut = const_cast<MeshTopologyMap *>(map);
+  if (atomic_sub_and_fetch_int32(&map_mut->users, 1) > 0) {
+    return;
+  }
+  MEM_freeN((void *)map->offsets);
+  MEM_freeN((void *)map->indices);
+  MEM_freeN((void *)map->elem_map);
+  MEM_freeN(map_mut);
+}
+
+static void mesh_topology_map_clear(MeshTopologyMap *&map)
+{
+  if (map) {
+    BKE_mesh_topology_map_release(map);
+    map = nullptr;
+  }
+}
+
+static void mesh_topology_maps_free(Mesh *mesh)
+{
+  MeshTopologyMaps *maps = mesh->runtime.topology_maps;
+  if (maps == nullptr) {
+    return;
+  }
+  /* Users holding a reference keep their maps, only the reference of the cache is released. */
+  mesh_topology_map_clear(maps->vert_poly);
+  mesh_topology_map_clear(maps->vert_edge);
+  mesh_topology_map_clear(maps->edge_poly);
+  MEM_delete(maps);
+  mesh->runtime.topology_maps = nullptr;
+}
+
+/**
+ * Build a map from each of the `groups_num` elements to the items using them.
+ * `foreach_group(item, fn)` calls `fn` with every group used by the item.
+ *
+ * \return The map with a single user.
+ */
+template<typename ForeachGroupFn>
+static MeshTopologyMap *mesh_topology_map_build(const int groups_num,
+                                                const int items_num,
+                                                const ForeachGroupFn &foreach_group)
+{
+  using namespace blender;
+
+  int *offsets = static_cast<int *>(MEM_calloc_arrayN(groups_num + 1, sizeof(int), __func__));
+  threading::parallel_for(IndexRange(items_num), 4096, [&](const IndexRange range) {
+    for (const int item : range) {
+      foreach_group(item, [&](const int group) { atomic_add_and_fetch_int32(&offsets[group], 1); });
+    }
+  });
+
+  int offset = 0;
+  for (const int group : IndexRange(groups_num)) {
+    const int count = offsets[group];
+    offsets[group] = offset;
+    offset += count;
+  }
+  offsets[groups_num] = offset;
+
+  int *indices = static_cast<int *>(MEM_malloc_arrayN(offset, sizeof(int), __func__));
+  MeshElemMap *elem_map = static_cast<MeshElemMap *>(
+      MEM_malloc_arrayN(groups_num, sizeof(MeshElemMap), __func__));
+
+  Array<int> fill(groups_num, 0);
+  threading::parallel_for(IndexRange(items_num), 4096, [&](const IndexRange range) {
+    for (const int item : range) {
+      foreach_group(item, [&](const int group) {
+        const int index = atomic_fetch_and_add_int32(&fill[group], 1);
+        indices[offsets[group] + index] = item;
+      });
+    }
+  });
+
+  /* Items are added in any order from multiple threads, sort them to get the same maps as the
+   * single threaded functions in `mesh_mapping.c`. */
+  threading::parallel_for(IndexRange(groups_num), 4096, [&](const IndexRange range) {
+    for (const int group : range) {
+      int *group_indices = indices + offsets[group];
+      const int count = offsets[group + 1] - offsets[group];
+      std::sort(group_indices, group_indices + count);
+      elem_map[group].indices = group_indices;
+      elem_map[group].count = count;
+    }
+  });
+
+  MeshTopologyMap *map = MEM_cnew<MeshTopologyMap>(__func__);
+  map->offsets = offsets;
+  map->indices = indices;
+  map->elem_map = elem_map;
+  map->groups_num = groups_num;
+  map->users = 1;
+  return map;
+}
+
+static const MeshTopologyMap *mesh_topology_map_acquire(
+    const Mesh *mesh,
+    MeshTopologyMap *MeshTopologyMaps::*map_member,
+    const int groups_num,
+    const int items_num,
+    const blender::FunctionRef<void(int item, blender::FunctionRef<void(int)>)> foreach_group)
+{
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
+  BLI_mutex_lock(mesh_eval_mutex);
+
+  Mesh_Runtime &runtime = const_cast<Mesh_Runtime &>(mesh->runtime);
+  if (runtime.topology_maps == nullptr) {
+    runtime.topology_maps = MEM_new<MeshTopologyMaps>(__func__);
+  }
+  MeshTopologyMap *&map = runtime.topology_maps->*map_member;
+
+  if (map == nullptr) {
+    /* Must isolate multithreaded tasks while holding a mutex lock. */
+    blender::threading::isolate_task(
+        [&]() { map = mesh_topology_map_build(groups_num, items_num, foreach_group); });
+  }
+  atomic_add_and_fetch_int32(&map->users, 1);
+
+  BLI_mutex_unlock(mesh_eval_mutex);
+
+  return map;
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_vert_poly_map_acquire(const Mesh *mesh)
+{
+  const MPoly *mpoly = mesh->mpoly;
+  const MLoop *mloop = mesh->mloop;
+  return mesh_topology_map_acquire(
+      mesh,
+      &MeshTopologyMaps::vert_poly,
+      mesh->totvert,
+      mesh->totpoly,
+      [&](const int poly, const blender::FunctionRef<void(int)> fn) {
+        const MPoly &mp = mpoly[poly];
+        for (const int loop : blender::IndexRange(mp.loopstart, mp.totloop)) {
+          fn(mloop[loop].v);
+        }
+      });
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_vert_edge_map_acquire(const Mesh *mesh)
+{
+  const MEdge *medge = mesh->medge;
+  return mesh_topology_map_acquire(mesh,
+                                   &MeshTopologyMaps::vert_edge,
+                                   mesh->totvert,
+                                   mesh->totedge,
+                                   [&](const int edge, const blender::FunctionRef<void(int)> fn) {
+                                     fn(medge[edge].v1);
+                                     fn(medge[edge].v2);
+                                   });
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_edge_poly_map_acquire(const Mesh *mesh)
+{
+  const MPoly *mpoly = mesh->mpoly;
+  const MLoop *mloop = mesh->mloop;
+  return mesh_topology_map_acquire(
+      mesh,
+      &MeshTopologyMaps::edge_poly,
+      mesh->totedge,
+      mesh->totpoly,
+      [&](const int poly, const blender::FunctionRef<void(int)> fn) {
+        const MPoly &mp = mpoly[poly];
+        for (const int loop : blender::IndexRange(mp.loopstart, mp.totloop)) {
+          fn(mloop[loop].e);
+        }
+      });
 }
 
 /** \} */
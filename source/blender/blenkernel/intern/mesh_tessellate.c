@@ -586,6 +586,9 @@ struct TessellationUserData {
 
   /** Optional pre-calculated polygon normals array. */
   const float (*poly_normals)[3];
+
+  /** Leave triangles untouched, see #BKE_mesh_recalc_looptri_positions_changed. */
+  bool skip_tris;
 };
 
 struct TessellationUserTLS {
@@ -598,6 +601,9 @@ static void mesh_calc_tessellation_for_face_fn(void *__restrict userdata,
 {
   const struct TessellationUserData *data = userdata;
   struct TessellationUserTLS *tls_data = tls->userdata_chunk;
+  if (data->skip_tris && data->mpoly[index].totloop == 3) {
+    return;
+  }
   const int tri_index = poly_to_tri_count(index, data->mpoly[index].loopstart);
   mesh_calc_tessellation_for_face_impl(data->mloop,
                                        data->mpoly,
@@ -615,6 +621,9 @@ static void mesh_calc_tessellation_for_face_with_normal_fn(void *__restrict user
 {
   const struct TessellationUserData *data = userdata;
   struct TessellationUserTLS *tls_data = tls->userdata_chunk;
+  if (data->skip_tris && data->mpoly[index].totloop == 3) {
+    return;
+  }
   const int tri_index = poly_to_tri_count(index, data->mpoly[index].loopstart);
   mesh_calc_tessellation_for_face_impl(data->mloop,
                                        data->mpoly,
@@ -638,10 +647,11 @@ static void mesh_calc_tessellation_for_face_free_fn(const void *__restrict UNUSE
 static void mesh_recalc_looptri__multi_threaded(const MLoop *mloop,
                                                 const MPoly *mpoly,
                                                 const MVert *mvert,
-                                                int UNUSED(totloop),
+                                                int totloop,
                                                 int totpoly,
                                                 MLoopTri *mlooptri,
-                                                const float (*poly_normals)[3])
+                                                const float (*poly_normals)[3],
+                                                const bool skip_tris)
 {
   struct TessellationUserTLS tls_data_dummy = {NULL};
 
@@ -651,10 +661,12 @@ static void mesh_recalc_looptri__multi_threaded(const MLoop *mloop,
       .mvert = mvert,
       .mlooptri = mlooptri,
       .poly_normals = poly_normals,
+      .skip_tris = skip_tris,
   };
 
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = totloop >= MESH_FACE_TESSELLATE_THREADED_LIMIT;
 
   settings.userdata_chunk = &tls_data_dummy;
   settings.userdata_chunk_size = sizeof(tls_data_dummy);
@@ -680,7 +692,8 @@ void BKE_mesh_recalc_looptri(const MLoop *mloop,
     mesh_recalc_looptri__single_threaded(mloop, mpoly, mvert, totloop, totpoly, mlooptri, NULL);
   }
   else {
-    mesh_recalc_looptri__multi_threaded(mloop, mpoly, mvert, totloop, totpoly, mlooptri, NULL);
+    mesh_recalc_looptri__multi_threaded(
+        mloop, mpoly, mvert, totloop, totpoly, mlooptri, NULL, false);
   }
 }
 
@@ -699,8 +712,20 @@ void BKE_mesh_recalc_looptri_with_normals(const MLoop *mloop,
   }
   else {
     mesh_recalc_looptri__multi_threaded(
-        mloop, mpoly, mvert, totloop, totpoly, mlooptri, poly_normals);
+        mloop, mpoly, mvert, totloop, totpoly, mlooptri, poly_normals, false);
   }
 }
 
+void BKE_mesh_recalc_looptri_positions_changed(const MLoop *mloop,
+                                               const MPoly *mpoly,
+                                               const MVert *mvert,
+                                               int totloop,
+                                               int totpoly,
+                                               MLoopTri *mlooptri)
+{
+  /* Threading is disabled for small meshes by the parallel range settings. */
+  mesh_recalc_looptri__multi_threaded(
+      mloop, mpoly, mvert, totloop, totpoly, mlooptri, NULL, true);
+}
+
 /** \} */
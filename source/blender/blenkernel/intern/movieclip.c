@@ -872,6 +872,7 @@ static bool put_imbuf_cache(
         "movieclip", sizeof(MovieClipImBufCacheKey), moviecache_hashhash, moviecache_hashcmp);
 
     IMB_moviecache_set_getdata_callback(moviecache, moviecache_keydata);
+    IMB_moviecache_set_compression(moviecache, true);
     IMB_moviecache_set_priority_callback(moviecache,
                                          moviecache_getprioritydata,
                                          moviecache_getitempriority,
@@ -449,9 +449,7 @@ void multires_force_sculpt_rebuild(Object *object)
     object->sculpt->pbvh = NULL;
   }
 
-  MEM_SAFE_FREE(ss->pmap);
-
-  MEM_SAFE_FREE(ss->pmap_mem);
+  BKE_sculptsession_topology_map_release(&ss->pmap, &ss->pmap_ref);
 }
 
 void multires_force_external_reload(Object *object)
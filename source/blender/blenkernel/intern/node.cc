@@ -243,6 +243,13 @@ static void ntree_free_data(ID *id)
     }
   }
 
+  /* Compositor results may have been computed from this tree. Localized and evaluated copies are
+   * freed after each execution, the results stay valid for the original tree. */
+  if (ntree->type == NTREE_COMPOSIT &&
+      !(ntree->id.tag & (LIB_TAG_LOCALIZED | LIB_TAG_COPIED_ON_WRITE))) {
+    ntreeCompositClearCaches();
+  }
+
   /* XXX not nice, but needed to free localized node groups properly */
   free_localized_node_groups(ntree);
 
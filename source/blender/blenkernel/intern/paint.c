@@ -1340,6 +1340,16 @@ void BKE_sculptsession_free_deformMats(SculptSession *ss)
   MEM_SAFE_FREE(ss->deform_imats);
 }
 
+void BKE_sculptsession_topology_map_release(const MeshElemMap **map,
+                                            const MeshTopologyMap **map_ref)
+{
+  if (*map_ref) {
+    BKE_mesh_topology_map_release(*map_ref);
+  }
+  *map = NULL;
+  *map_ref = NULL;
+}
+
 void BKE_sculptsession_free_vwpaint_data(struct SculptSession *ss)
 {
   struct SculptVertexPaintGeomMap *gmap = NULL;
@@ -1416,14 +1426,9 @@ static void sculptsession_free_pbvh(Object *object)
     ss->pbvh = NULL;
   }
 
-  MEM_SAFE_FREE(ss->pmap);
-  MEM_SAFE_FREE(ss->pmap_mem);
-
-  MEM_SAFE_FREE(ss->epmap);
-  MEM_SAFE_FREE(ss->epmap_mem);
-
-  MEM_SAFE_FREE(ss->vemap);
-  MEM_SAFE_FREE(ss->vemap_mem);
+  BKE_sculptsession_topology_map_release(&ss->pmap, &ss->pmap_ref);
+  BKE_sculptsession_topology_map_release(&ss->epmap, &ss->epmap_ref);
+  BKE_sculptsession_topology_map_release(&ss->vemap, &ss->vemap_ref);
 
   MEM_SAFE_FREE(ss->persistent_base);
 
@@ -1472,14 +1477,9 @@ void BKE_sculptsession_free(Object *ob)
 
     sculptsession_free_pbvh(ob);
 
-    MEM_SAFE_FREE(ss->pmap);
-    MEM_SAFE_FREE(ss->pmap_mem);
-
-    MEM_SAFE_FREE(ss->epmap);
-    MEM_SAFE_FREE(ss->epmap_mem);
-
-    MEM_SAFE_FREE(ss->vemap);
-    MEM_SAFE_FREE(ss->vemap_mem);
+    BKE_sculptsession_topology_map_release(&ss->pmap, &ss->pmap_ref);
+    BKE_sculptsession_topology_map_release(&ss->epmap, &ss->epmap_ref);
+    BKE_sculptsession_topology_map_release(&ss->vemap, &ss->vemap_ref);
 
     if (ss->bm_log) {
       BM_log_free(ss->bm_log);
@@ -1717,8 +1717,8 @@ static void sculpt_update_object(Depsgraph *depsgraph,
   BKE_pbvh_face_sets_color_set(ss->pbvh, me->face_sets_color_seed, me->face_sets_color_default);
 
   if (need_pmap && ob->type == OB_MESH && !ss->pmap) {
-    BKE_mesh_vert_poly_map_create(
-        &ss->pmap, &ss->pmap_mem, me->mpoly, me->mloop, me->totvert, me->totpoly, me->totloop);
+    ss->pmap_ref = BKE_mesh_runtime_vert_poly_map_acquire(me);
+    ss->pmap = ss->pmap_ref->elem_map;
 
     if (ss->pbvh) {
       BKE_pbvh_pmap_set(ss->pbvh, ss->pmap);
@@ -234,46 +234,65 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
   pbvh->totnode = totnode;
 }
 
-/* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+static int compare_ints(const void *a_v, const void *b_v)
 {
-  void *key, **value_p;
+  const int a = *(const int *)a_v;
+  const int b = *(const int *)b_v;
+  return (a > b) - (a < b);
+}
 
-  key = POINTER_FROM_INT(vertex);
-  if (!BLI_ghash_ensure_p(map, key, &value_p)) {
-    int value_i;
-    if (!pbvh->vert_bitmap[vertex]) {
-      pbvh->vert_bitmap[vertex] = true;
-      value_i = *uniq_verts;
-      (*uniq_verts)++;
+/* Index of `vertex` in the sorted array `verts`, which must contain it. */
+static int sorted_verts_find(const int *verts, int verts_num, int vertex)
+{
+  int lo = 0, hi = verts_num - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (verts[mid] < vertex) {
+      lo = mid + 1;
     }
     else {
-      value_i = ~(*face_verts);
-      (*face_verts)++;
+      hi = mid;
     }
-    *value_p = POINTER_FROM_INT(value_i);
-    return value_i;
   }
-
-  return POINTER_AS_INT(*value_p);
+  BLI_assert(verts[lo] == vertex);
+  return lo;
 }
 
-/* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+/* Lower the owner of a vertex to `leaf_index` unless a leaf with a lower index claimed it. */
+static void vert_owner_claim(int *owner, int leaf_index)
 {
+  int old = *owner;
+  while (leaf_index < old) {
+    const int prev = atomic_cas_int32(owner, old, leaf_index);
+    if (prev == old) {
+      break;
+    }
+    old = prev;
+  }
+}
+
+typedef struct PBVHLeafBuildData {
+  PBVH *pbvh;
+  PBVHNode **leaves;
+  /* Lowest index of the leaves using each vertex, that leaf stores it as a unique vertex. */
+  int *vert_owner;
+} PBVHLeafBuildData;
+
+/* Find the vertices used by the faces in this node, as a sorted array of unique vertex indices
+ * stored in `vert_indices`. The face corners index into that array for now. */
+static void build_mesh_leaf_node_verts_task_cb(void *__restrict userdata,
+                                               const int n,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHLeafBuildData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = data->leaves[n];
   bool has_visible = false;
 
-  node->uniq_verts = node->face_verts = 0;
   const int totface = node->totprim;
 
-  /* reserve size is rough guess */
-  GHash *map = BLI_ghash_int_new_ex("build_mesh_leaf_node gh", 2 * totface);
-
   int(*face_vert_indices)[3] = MEM_mallocN(sizeof(int[3]) * totface, "bvh node face vert indices");
-
-  node->face_vert_indices = (const int(*)[3])face_vert_indices;
+  int *verts = MEM_mallocN(sizeof(int) * 3 * totface, "bvh node vert indices");
 
   if (pbvh->respect_hide == false) {
     has_visible = true;
@@ -282,8 +301,7 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      verts[i * 3 + j] = pbvh->mloop[lt->tri[j]].v;
     }
 
     if (has_visible == false) {
@@ -293,38 +311,81 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
     }
   }
 
-  int *vert_indices = MEM_callocN(sizeof(int) * (node->uniq_verts + node->face_verts),
-                                  "bvh node vert indices");
-  node->vert_indices = vert_indices;
-
-  /* Build the vertex list, unique verts first */
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, map) {
-    void *value = BLI_ghashIterator_getValue(&gh_iter);
-    int ndx = POINTER_AS_INT(value);
-
-    if (ndx < 0) {
-      ndx = -ndx + node->uniq_verts - 1;
+  /* Flat sorted array instead of a hash map, leaves can hold many thousands of vertices. */
+  int verts_num = 0;
+  if (totface) {
+    qsort(verts, (size_t)totface * 3, sizeof(int), compare_ints);
+    verts_num = 1;
+    for (int i = 1; i < totface * 3; i++) {
+      if (verts[i] != verts[verts_num - 1]) {
+        verts[verts_num++] = verts[i];
+      }
     }
-
-    vert_indices[ndx] = POINTER_AS_INT(BLI_ghashIterator_getKey(&gh_iter));
   }
 
   for (int i = 0; i < totface; i++) {
-    const int sides = 3;
-
-    for (int j = 0; j < sides; j++) {
-      if (face_vert_indices[i][j] < 0) {
-        face_vert_indices[i][j] = -face_vert_indices[i][j] + node->uniq_verts - 1;
-      }
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      face_vert_indices[i][j] = sorted_verts_find(verts, verts_num, pbvh->mloop[lt->tri[j]].v);
     }
   }
 
+  for (int i = 0; i < verts_num; i++) {
+    vert_owner_claim(&data->vert_owner[verts[i]], n);
+  }
+
+  node->vert_indices = verts;
+  node->uniq_verts = verts_num;
+  node->face_verts = 0;
+  node->face_vert_indices = (const int(*)[3])face_vert_indices;
+
   BKE_pbvh_node_mark_rebuild_draw(node);
 
   BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+}
 
-  BLI_ghash_free(map, NULL, NULL);
+/* Reorder the vertex list, unique verts first, once every leaf has claimed its vertices. */
+static void build_mesh_leaf_node_order_task_cb(void *__restrict userdata,
+                                               const int n,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHLeafBuildData *data = userdata;
+  PBVHNode *node = data->leaves[n];
+
+  const int *verts = node->vert_indices;
+  const int verts_num = node->uniq_verts;
+  int *vert_indices = MEM_mallocN(sizeof(int) * verts_num, "bvh node vert indices");
+  int *local_to_node = MEM_mallocN(sizeof(int) * verts_num, __func__);
+
+  int uniq_verts = 0;
+  for (int i = 0; i < verts_num; i++) {
+    if (data->vert_owner[verts[i]] == n) {
+      local_to_node[i] = uniq_verts++;
+    }
+  }
+  int face_verts = 0;
+  for (int i = 0; i < verts_num; i++) {
+    if (data->vert_owner[verts[i]] != n) {
+      local_to_node[i] = uniq_verts + face_verts++;
+    }
+  }
+  for (int i = 0; i < verts_num; i++) {
+    vert_indices[local_to_node[i]] = verts[i];
+  }
+
+  int(*face_vert_indices)[3] = (int(*)[3])node->face_vert_indices;
+  for (int i = 0; i < node->totprim; i++) {
+    for (int j = 0; j < 3; j++) {
+      face_vert_indices[i][j] = local_to_node[face_vert_indices[i][j]];
+    }
+  }
+
+  MEM_freeN((void *)verts);
+  MEM_freeN(local_to_node);
+
+  node->vert_indices = vert_indices;
+  node->uniq_verts = uniq_verts;
+  node->face_verts = face_verts;
 }
 
 static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
@@ -388,14 +449,21 @@ void BKE_pbvh_sync_face_sets_to_grids(PBVH *pbvh)
   }
 }
 
-static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
+static void build_grid_leaf_node_task_cb(void *__restrict userdata,
+                                         const int n,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
 {
+  PBVHLeafBuildData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = data->leaves[n];
+
   int totquads = BKE_pbvh_count_grid_quads(
       pbvh->grid_hidden, node->prim_indices, node->totprim, pbvh->gridkey.grid_size);
   BKE_pbvh_node_fully_hidden_set(node, (totquads == 0));
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
+/* The per-leaf data is filled in afterwards by #build_leaf_nodes, in parallel. */
 static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
 {
   pbvh->nodes[node_index].flag |= PBVH_Leaf;
@@ -405,13 +473,43 @@ static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, in
 
   /* Still need vb for searches */
   update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
+}
+
+/* Find the vertices used by each leaf and update the draw buffers. Vertices shared between
+ * leaves are stored as unique vertices in the leaf with the lowest index, so the result does not
+ * depend on the order the threads run in. */
+static void build_leaf_nodes(PBVH *pbvh)
+{
+  PBVHNode **leaves = MEM_mallocN(sizeof(*leaves) * pbvh->totnode, __func__);
+  int leaves_num = 0;
+  for (int i = 0; i < pbvh->totnode; i++) {
+    if (pbvh->nodes[i].flag & PBVH_Leaf) {
+      leaves[leaves_num++] = &pbvh->nodes[i];
+    }
+  }
+
+  PBVHLeafBuildData data = {
+      .pbvh = pbvh,
+      .leaves = leaves,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, leaves_num);
 
   if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
+    data.vert_owner = MEM_malloc_arrayN(pbvh->totvert, sizeof(int), __func__);
+    copy_vn_i(data.vert_owner, pbvh->totvert, INT_MAX);
+
+    BLI_task_parallel_range(0, leaves_num, &data, build_mesh_leaf_node_verts_task_cb, &settings);
+    BLI_task_parallel_range(0, leaves_num, &data, build_mesh_leaf_node_order_task_cb, &settings);
+
+    MEM_freeN(data.vert_owner);
   }
   else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
+    BLI_task_parallel_range(0, leaves_num, &data, build_grid_leaf_node_task_cb, &settings);
   }
+
+  MEM_freeN(leaves);
 }
 
 /* Return zero if all primitives in the node can be drawn with the
@@ -537,6 +635,69 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
 
   pbvh->totnode = 1;
   build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_leaf_nodes(pbvh);
+}
+
+typedef struct PBVHPrimBBCData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHPrimBBCData;
+
+static void pbvh_prim_bbc_calc_task_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  PBVHPrimBBCData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  BBC *bbc = data->prim_bbc + i;
+  BB *cb = tls->userdata_chunk;
+
+  BB_reset((BB *)bbc);
+
+  if (pbvh->looptri) {
+    const MLoopTri *lt = &pbvh->looptri[i];
+    for (int j = 0; j < 3; j++) {
+      BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+    }
+  }
+  else {
+    const CCGKey *key = &pbvh->gridkey;
+    CCGElem *grid = pbvh->grids[i];
+    for (int j = 0; j < key->grid_area; j++) {
+      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+    }
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(cb, bbc->bcentroid);
+}
+
+static void pbvh_prim_bbc_calc_reduce(const void *__restrict UNUSED(userdata),
+                                      void *__restrict chunk_join,
+                                      void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+/* Store the AABB and the AABB centroid of every primitive, and the bounds of the centroids in
+ * `r_cb`. */
+static void pbvh_prim_bbc_calc(PBVH *pbvh, BBC *prim_bbc, int totprim, BB *r_cb)
+{
+  PBVHPrimBBCData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+
+  BB_reset(r_cb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = r_cb;
+  settings.userdata_chunk_size = sizeof(*r_cb);
+  settings.func_reduce = pbvh_prim_bbc_calc_reduce;
+  BLI_task_parallel_range(0, totprim, &data, pbvh_prim_bbc_calc_task_cb, &settings);
 }
 
 void BKE_pbvh_build_mesh(PBVH *pbvh,
@@ -572,26 +733,9 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
-
   /* For each face, store the AABB and the AABB centroid */
   prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
-
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  pbvh_prim_bbc_calc(pbvh, prim_bbc, looptri_num, &cb);
 
   if (looptri_num) {
     pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
@@ -599,9 +743,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
 
   MEM_freeN(prim_bbc);
 
-  /* Clear the bitmap so it can be used as an update tag later on. */
-  memset(pbvh->vert_bitmap, 0, sizeof(bool) * totvert);
-
   BKE_pbvh_update_active_vcol(pbvh, mesh);
 }
 
@@ -625,25 +766,10 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   pbvh->leaf_limit = max_ii(LEAF_LIMIT / (gridsize * gridsize), 1);
 
   BB cb;
-  BB_reset(&cb);
 
   /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
-
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  pbvh_prim_bbc_calc(pbvh, prim_bbc, totgrid, &cb);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
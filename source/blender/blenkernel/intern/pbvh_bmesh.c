@@ -11,6 +11,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_DerivedMesh.h"
@@ -734,6 +735,17 @@ typedef struct EdgeQueue {
 #endif
 } EdgeQueue;
 
+typedef struct EdgeQueueCandidate {
+  BMEdge *e;
+  float priority;
+} EdgeQueueCandidate;
+
+/* Edges found while scanning a single node, before they are added to the queue. */
+typedef struct EdgeQueueCandidates {
+  EdgeQueueCandidate *data;
+  int len, len_alloc;
+} EdgeQueueCandidates;
+
 typedef struct {
   EdgeQueue *q;
   BLI_mempool *pool;
@@ -741,6 +753,9 @@ typedef struct {
   int cd_vert_mask_offset;
   int cd_vert_node_offset;
   int cd_face_node_offset;
+  /* When set, edges are collected here instead of being inserted in the queue,
+   * see #edge_queue_create_from_nodes. */
+  EdgeQueueCandidates *candidates;
 } EdgeQueueContext;
 
 /* only tag'd edges are in the queue */
@@ -821,6 +836,32 @@ static bool check_mask(EdgeQueueContext *eq_ctx, BMVert *v)
   return BM_ELEM_CD_GET_FLOAT(v, eq_ctx->cd_vert_mask_offset) < 1.0f;
 }
 
+static void edge_queue_candidates_append(EdgeQueueCandidates *candidates,
+                                         BMEdge *e,
+                                         float priority)
+{
+  if (candidates->len == candidates->len_alloc) {
+    candidates->len_alloc = max_ii(64, candidates->len_alloc * 2);
+    candidates->data = MEM_reallocN(candidates->data,
+                                    sizeof(*candidates->data) * candidates->len_alloc);
+  }
+  candidates->data[candidates->len].e = e;
+  candidates->data[candidates->len].priority = priority;
+  candidates->len++;
+}
+
+static void edge_queue_heap_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priority)
+{
+  BMVert **pair = BLI_mempool_alloc(eq_ctx->pool);
+  pair[0] = e->v1;
+  pair[1] = e->v2;
+  BLI_heapsimple_insert(eq_ctx->q->heap, priority, pair);
+#ifdef USE_EDGEQUEUE_TAG
+  BLI_assert(EDGE_QUEUE_TEST(e) == false);
+  EDGE_QUEUE_ENABLE(e);
+#endif
+}
+
 static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priority)
 {
   /* Don't let topology update affect fully masked vertices. This used to
@@ -833,14 +874,12 @@ static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priorit
        (check_mask(eq_ctx, e->v1) || check_mask(eq_ctx, e->v2))) &&
       !(BM_elem_flag_test_bool(e->v1, BM_ELEM_HIDDEN) ||
         BM_elem_flag_test_bool(e->v2, BM_ELEM_HIDDEN))) {
-    BMVert **pair = BLI_mempool_alloc(eq_ctx->pool);
-    pair[0] = e->v1;
-    pair[1] = e->v2;
-    BLI_heapsimple_insert(eq_ctx->q->heap, priority, pair);
-#ifdef USE_EDGEQUEUE_TAG
-    BLI_assert(EDGE_QUEUE_TEST(e) == false);
-    EDGE_QUEUE_ENABLE(e);
-#endif
+    if (eq_ctx->candidates) {
+      edge_queue_candidates_append(eq_ctx->candidates, e, priority);
+    }
+    else {
+      edge_queue_heap_insert(eq_ctx, e, priority);
+    }
   }
 }
 
@@ -978,6 +1017,80 @@ static void short_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
   }
 }
 
+typedef struct EdgeQueueThreadData {
+  EdgeQueueContext *eq_ctx;
+  PBVHNode **nodes;
+  EdgeQueueCandidates *candidates;
+  void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f);
+} EdgeQueueThreadData;
+
+static void edge_queue_create_task_cb(void *__restrict userdata,
+                                      const int n,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgeQueueThreadData *data = userdata;
+  EdgeQueueContext eq_ctx = *data->eq_ctx;
+  eq_ctx.candidates = &data->candidates[n];
+
+  GSetIterator gs_iter;
+
+  /* Check each face */
+  GSET_ITER (gs_iter, data->nodes[n]->bm_faces) {
+    BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
+
+    data->face_add(&eq_ctx, f);
+  }
+}
+
+/* Check the faces of the leaf nodes marked for topology update in parallel. The edges found are
+ * inserted afterwards in node order, giving the same queue as checking the nodes one by one:
+ * scanning only reads the mesh, only the insertion sets the edge tags. */
+static void edge_queue_create_from_nodes(EdgeQueueContext *eq_ctx,
+                                         PBVH *pbvh,
+                                         void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f))
+{
+  PBVHNode **nodes = MEM_mallocN(sizeof(*nodes) * pbvh->totnode, __func__);
+  int totnode = 0;
+
+  for (int n = 0; n < pbvh->totnode; n++) {
+    PBVHNode *node = &pbvh->nodes[n];
+
+    /* Check leaf nodes marked for topology update */
+    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
+        !(node->flag & PBVH_FullyHidden)) {
+      nodes[totnode++] = node;
+    }
+  }
+
+  EdgeQueueThreadData data = {
+      .eq_ctx = eq_ctx,
+      .nodes = nodes,
+      .candidates = MEM_calloc_arrayN(totnode, sizeof(EdgeQueueCandidates), __func__),
+      .face_add = face_add,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totnode);
+  BLI_task_parallel_range(0, totnode, &data, edge_queue_create_task_cb, &settings);
+
+  for (int n = 0; n < totnode; n++) {
+    EdgeQueueCandidates *candidates = &data.candidates[n];
+    for (int i = 0; i < candidates->len; i++) {
+      BMEdge *e = candidates->data[i].e;
+#ifdef USE_EDGEQUEUE_TAG
+      if (EDGE_QUEUE_TEST(e)) {
+        continue;
+      }
+#endif
+      edge_queue_heap_insert(eq_ctx, e, candidates->data[i].priority);
+    }
+    MEM_SAFE_FREE(candidates->data);
+  }
+
+  MEM_freeN(data.candidates);
+  MEM_freeN(nodes);
+}
+
 /* Create a priority queue containing vertex pairs connected by a long
  * edge as defined by PBVH.bm_max_edge_len.
  *
@@ -1023,22 +1136,7 @@ static void long_edge_queue_create(EdgeQueueContext *eq_ctx,
   pbvh_bmesh_edge_tag_verify(pbvh);
 #endif
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        long_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_create_from_nodes(eq_ctx, pbvh, long_edge_queue_face_add);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -1082,22 +1180,7 @@ static void short_edge_queue_create(EdgeQueueContext *eq_ctx,
     eq_ctx->q->edge_queue_tri_in_range = edge_queue_tri_in_sphere;
   }
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        short_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_create_from_nodes(eq_ctx, pbvh, short_edge_queue_face_add);
 }
 
 /*************************** Topology update **************************/
@@ -1220,6 +1303,10 @@ static void pbvh_bmesh_split_edge(EdgeQueueContext *eq_ctx,
   BM_edge_kill(pbvh->bm, e);
 }
 
+/**
+ * Split the queued edges in queue order. Unlike building the queue this runs on a single thread:
+ * BMesh element pools, vertex and face node ownership and the BMLog are shared by the whole mesh.
+ */
 static bool pbvh_bmesh_subdivide_long_edges(EdgeQueueContext *eq_ctx,
                                             PBVH *pbvh,
                                             BLI_Buffer *edge_loops)
@@ -1440,6 +1527,7 @@ static void pbvh_bmesh_collapse_edge(PBVH *pbvh,
   BM_vert_kill(pbvh->bm, v_del);
 }
 
+/** Collapse the queued edges in queue order, single threaded like subdividing. */
 static bool pbvh_bmesh_collapse_short_edges(EdgeQueueContext *eq_ctx,
                                             PBVH *pbvh,
                                             BLI_Buffer *deleted_faces)
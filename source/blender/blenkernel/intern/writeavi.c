@@ -38,8 +38,9 @@ static int start_stub(void *UNUSED(context_v),
   return 0;
 }
 
-static void end_stub(void *UNUSED(context_v))
+static bool end_stub(void *UNUSED(context_v))
 {
+  return true;
 }
 
 static int append_stub(void *UNUSED(context_v),
@@ -76,7 +77,7 @@ static int start_avi(void *context_v,
                      ReportList *reports,
                      bool preview,
                      const char *suffix);
-static void end_avi(void *context_v);
+static bool end_avi(void *context_v);
 static int append_avi(void *context_v,
                       RenderData *rd,
                       int start_frame,
@@ -272,15 +273,15 @@ static int append_avi(void *context_v,
   return 1;
 }
 
-static void end_avi(void *context_v)
+static bool end_avi(void *context_v)
 {
   AviMovie *avi = context_v;
 
   if (avi == NULL) {
-    return;
+    return true;
   }
 
-  AVI_close_compress(avi);
+  return AVI_close_compress(avi) == AVI_ERROR_NONE;
 }
 
 static void *context_create_avi(void)
@@ -51,6 +51,17 @@
 
 #  include "ffmpeg_compat.h"
 
+/* Frame based scaling API, which can convert slices of a frame in multiple threads. */
+#  if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+#    define FFMPEG_SWSCALE_THREADING
+#  endif
+
+/**
+ * Number of rendered frames that can wait to be encoded. Rendering blocks when the encoder is this
+ * many frames behind, bounding memory usage.
+ */
+#  define FFMPEG_ENCODE_QUEUE_SIZE 3
+
 struct StampData;
 
 typedef struct FFMpegContext {
@@ -76,10 +87,21 @@ typedef struct FFMpegContext {
   AVFrame *current_frame; /* Image frame in output pixel format. */
   int video_time;
 
-  /* Image frame in Blender's own pixel format, may need conversion to the output pixel format. */
-  AVFrame *img_convert_frame;
+  /* Converts frames in Blender's own pixel format to the output pixel format, if different. */
   struct SwsContext *img_convert_ctx;
 
+  /* Video frames are converted and encoded in a separate thread, so rendering continues while the
+   * encoder runs. Rendered frames are copied into one of the `encode_frames` (in Blender's own
+   * pixel format) taken from `encode_free_frames`, and pushed to `encode_queue`. */
+  ListBase encode_thread;
+  ThreadQueue *encode_queue;
+  ThreadQueue *encode_free_frames;
+  AVFrame *encode_frames[FFMPEG_ENCODE_QUEUE_SIZE];
+  /* Set by the encoder thread on errors, protected by `outfile_mutex`. */
+  bool encode_failed;
+  /* Video packets are written by the encoder thread, audio packets by the rendering thread. */
+  ThreadMutex outfile_mutex;
+
   uint8_t *audio_input_buffer;
   uint8_t *audio_deinterleave_buffer;
   int audio_input_samples;
@@ -112,12 +134,7 @@ static void ffmpeg_filepath_get(FFMpegContext *context,
 
 static void delete_picture(AVFrame *f)
 {
-  if (f) {
-    if (f->data[0]) {
-      MEM_freeN(f->data[0]);
-    }
-    av_free(f);
-  }
+  av_frame_free(&f);
 }
 
 static int request_float_audio_buffer(int codec_id)
@@ -200,7 +217,9 @@ static int write_audio_frame(FFMpegContext *context)
 
     pkt->flags |= AV_PKT_FLAG_KEY;
 
+    BLI_mutex_lock(&context->outfile_mutex);
     int write_ret = av_interleaved_write_frame(context->outfile, pkt);
+    BLI_mutex_unlock(&context->outfile_mutex);
     if (write_ret != 0) {
       fprintf(stderr, "Error writing audio packet: %s\n", av_err2str(write_ret));
       success = -1;
@@ -219,27 +238,23 @@ static int write_audio_frame(FFMpegContext *context)
 static AVFrame *alloc_picture(int pix_fmt, int width, int height)
 {
   AVFrame *f;
-  uint8_t *buf;
-  int size;
 
   /* allocate space for the struct */
   f = av_frame_alloc();
   if (!f) {
     return NULL;
   }
-  size = av_image_get_buffer_size(pix_fmt, width, height, 1);
-  /* allocate the actual picture buffer */
-  buf = MEM_mallocN(size, "AVFrame buffer");
-  if (!buf) {
-    free(f);
-    return NULL;
-  }
-
-  av_image_fill_arrays(f->data, f->linesize, buf, pix_fmt, width, height, 1);
   f->format = pix_fmt;
   f->width = width;
   f->height = height;
 
+  /* Allocate the actual picture buffer, reference counted so the encoder doesn't need to copy it.
+   * Without alignment so lines are contiguous like Blender's buffers. */
+  if (av_frame_get_buffer(f, 1) < 0) {
+    av_frame_free(&f);
+    return NULL;
+  }
+
   return f;
 }
 
@@ -304,10 +319,11 @@ static const char **get_file_extensions(int format)
   }
 }
 
-/* Write a frame to the output file */
-static int write_video_frame(FFMpegContext *context, AVFrame *frame, ReportList *reports)
+/* Write a frame to the output file, called from the encoder thread. */
+static bool write_video_frame(FFMpegContext *context, AVFrame *frame)
 {
-  int ret, success = 1;
+  int ret;
+  bool success = true;
   AVPacket *packet = av_packet_alloc();
 
   AVCodecContext *c = context->video_codec;
@@ -319,7 +335,7 @@ static int write_video_frame(FFMpegContext *context, AVFrame *frame, ReportList
   if (ret < 0) {
     /* Can't send frame to encoder. This shouldn't happen. */
     fprintf(stderr, "Can't send video frame: %s\n", av_err2str(ret));
-    success = -1;
+    success = false;
   }
 
   while (ret >= 0) {
@@ -340,14 +356,16 @@ static int write_video_frame(FFMpegContext *context, AVFrame *frame, ReportList
     my_guess_pkt_duration(context->outfile, context->video_stream, packet);
 #  endif
 
-    if (av_interleaved_write_frame(context->outfile, packet) != 0) {
-      success = -1;
+    BLI_mutex_lock(&context->outfile_mutex);
+    const int write_ret = av_interleaved_write_frame(context->outfile, packet);
+    BLI_mutex_unlock(&context->outfile_mutex);
+    if (write_ret != 0) {
+      success = false;
       break;
     }
   }
 
   if (!success) {
-    BKE_report(reports, RPT_ERROR, "Error writing frame");
     PRINT("Error writing frame: %s\n", av_err2str(ret));
   }
 
@@ -356,34 +374,26 @@ static int write_video_frame(FFMpegContext *context, AVFrame *frame, ReportList
   return success;
 }
 
-/* read and encode a frame of video from the buffer */
-static AVFrame *generate_video_frame(FFMpegContext *context, const uint8_t *pixels)
+/* Copy the rendered pixels into a frame in Blender's own pixel format. */
+static void copy_video_frame(FFMpegContext *context, AVFrame *rgb_frame, const uint8_t *pixels)
 {
   AVCodecParameters *codec = context->video_stream->codecpar;
   int height = codec->height;
-  AVFrame *rgb_frame;
-
-  if (context->img_convert_frame != NULL) {
-    /* Pixel format conversion is needed. */
-    rgb_frame = context->img_convert_frame;
-  }
-  else {
-    /* The output pixel format is Blender's internal pixel format. */
-    rgb_frame = context->current_frame;
-  }
 
   /* Copy the Blender pixels into the FFmpeg datastructure, taking care of endianness and flipping
-   * the image vertically. */
-  int linesize = rgb_frame->linesize[0];
+   * the image vertically. Rows of the frame may be padded, #av_frame_make_writable can also
+   * allocate the frame again with another alignment, the rendered pixels are tightly packed. */
+  const size_t src_stride = (size_t)codec->width * 4;
+  const int linesize = rgb_frame->linesize[0];
   for (int y = 0; y < height; y++) {
-    uint8_t *target = rgb_frame->data[0] + linesize * (height - y - 1);
-    const uint8_t *src = pixels + linesize * y;
+    uint8_t *target = rgb_frame->data[0] + (size_t)linesize * (height - y - 1);
+    const uint8_t *src = pixels + src_stride * y;
 
 #  if ENDIAN_ORDER == L_ENDIAN
-    memcpy(target, src, linesize);
+    memcpy(target, src, src_stride);
 
 #  elif ENDIAN_ORDER == B_ENDIAN
-    const uint8_t *end = src + linesize;
+    const uint8_t *end = src + src_stride;
     while (src != end) {
       target[3] = src[0];
       target[2] = src[1];
@@ -397,22 +407,154 @@ static AVFrame *generate_video_frame(FFMpegContext *context, const uint8_t *pixe
 #    error ENDIAN_ORDER should either be L_ENDIAN or B_ENDIAN.
 #  endif
   }
+}
 
-  /* Convert to the output pixel format, if it's different that Blender's internal one. */
-  if (context->img_convert_frame != NULL) {
-    BLI_assert(context->img_convert_ctx != NULL);
-    sws_scale(context->img_convert_ctx,
-              (const uint8_t *const *)rgb_frame->data,
-              rgb_frame->linesize,
-              0,
-              codec->height,
-              context->current_frame->data,
-              context->current_frame->linesize);
+/* Convert to the output pixel format, if it's different that Blender's internal one. */
+static AVFrame *convert_video_frame(FFMpegContext *context, AVFrame *rgb_frame)
+{
+  if (context->img_convert_ctx == NULL) {
+    return rgb_frame;
+  }
+
+  /* The encoder may still reference the pixels of the previous frame. */
+  if (av_frame_make_writable(context->current_frame) < 0) {
+    return NULL;
   }
 
+#  ifdef FFMPEG_SWSCALE_THREADING
+  if (sws_scale_frame(context->img_convert_ctx, context->current_frame, rgb_frame) < 0) {
+    return NULL;
+  }
+#  else
+  sws_scale(context->img_convert_ctx,
+            (const uint8_t *const *)rgb_frame->data,
+            rgb_frame->linesize,
+            0,
+            rgb_frame->height,
+            context->current_frame->data,
+            context->current_frame->linesize);
+#  endif
+
   return context->current_frame;
 }
 
+static void *ffmpeg_encode_thread(void *context_v)
+{
+  FFMpegContext *context = context_v;
+  AVFrame *rgb_frame;
+
+  /* Runs until the queue is set to not wait, and all frames in it are encoded. */
+  while ((rgb_frame = BLI_thread_queue_pop(context->encode_queue))) {
+    AVFrame *frame = convert_video_frame(context, rgb_frame);
+    const bool success = frame && write_video_frame(context, frame);
+
+    if (!success) {
+      BLI_mutex_lock(&context->outfile_mutex);
+      context->encode_failed = true;
+      BLI_mutex_unlock(&context->outfile_mutex);
+    }
+
+    BLI_thread_queue_push(context->encode_free_frames, rgb_frame);
+  }
+
+  return NULL;
+}
+
+static bool ffmpeg_encode_thread_start(FFMpegContext *context)
+{
+  AVCodecContext *c = context->video_codec;
+
+  context->encode_queue = BLI_thread_queue_init();
+  context->encode_free_frames = BLI_thread_queue_init();
+  context->encode_failed = false;
+
+  for (int i = 0; i < FFMPEG_ENCODE_QUEUE_SIZE; i++) {
+    context->encode_frames[i] = alloc_picture(AV_PIX_FMT_RGBA, c->width, c->height);
+    if (context->encode_frames[i] == NULL) {
+      return false;
+    }
+    BLI_thread_queue_push(context->encode_free_frames, context->encode_frames[i]);
+  }
+
+  BLI_threadpool_init(&context->encode_thread, ffmpeg_encode_thread, 1);
+  BLI_threadpool_insert(&context->encode_thread, context);
+  return true;
+}
+
+/* Wait for all queued frames to be encoded and stop the encoder thread. */
+static void ffmpeg_encode_thread_end(FFMpegContext *context)
+{
+  if (context->encode_queue == NULL) {
+    return;
+  }
+
+  BLI_thread_queue_nowait(context->encode_queue);
+  if (!BLI_listbase_is_empty(&context->encode_thread)) {
+    BLI_threadpool_end(&context->encode_thread);
+  }
+
+  BLI_thread_queue_free(context->encode_queue);
+  BLI_thread_queue_free(context->encode_free_frames);
+  context->encode_queue = NULL;
+  context->encode_free_frames = NULL;
+
+  for (int i = 0; i < FFMPEG_ENCODE_QUEUE_SIZE; i++) {
+    delete_picture(context->encode_frames[i]);
+    context->encode_frames[i] = NULL;
+  }
+}
+
+/* Queue a frame of video from the buffer to be encoded. */
+static bool ffmpeg_encode_frame_push(FFMpegContext *context, const uint8_t *pixels)
+{
+  /* Blocks until the encoder is done with one of the queued frames. */
+  AVFrame *rgb_frame = BLI_thread_queue_pop(context->encode_free_frames);
+
+  /* Frames in Blender's own pixel format are encoded directly, and the encoder may still
+   * reference them. */
+  if (av_frame_make_writable(rgb_frame) < 0) {
+    BLI_thread_queue_push(context->encode_free_frames, rgb_frame);
+    return false;
+  }
+
+  copy_video_frame(context, rgb_frame, pixels);
+  BLI_thread_queue_push(context->encode_queue, rgb_frame);
+
+  BLI_mutex_lock(&context->outfile_mutex);
+  const bool success = !context->encode_failed;
+  BLI_mutex_unlock(&context->outfile_mutex);
+  return success;
+}
+
+/* Converter between Blender's own pixel format and the output pixel format of the codec. */
+static struct SwsContext *ffmpeg_sws_get_context(int width, int height, int dst_format)
+{
+#  ifdef FFMPEG_SWSCALE_THREADING
+  struct SwsContext *ctx = sws_alloc_context();
+  if (ctx == NULL) {
+    return NULL;
+  }
+  av_opt_set_int(ctx, "srcw", width, 0);
+  av_opt_set_int(ctx, "srch", height, 0);
+  av_opt_set_int(ctx, "src_format", AV_PIX_FMT_RGBA, 0);
+  av_opt_set_int(ctx, "dstw", width, 0);
+  av_opt_set_int(ctx, "dsth", height, 0);
+  av_opt_set_int(ctx, "dst_format", dst_format, 0);
+  av_opt_set_int(ctx, "sws_flags", SWS_BICUBIC, 0);
+  /* Convert slices of the frame in parallel. */
+  av_opt_set_int(ctx, "threads", BLI_system_thread_count(), 0);
+
+  if (sws_init_context(ctx, NULL, NULL) < 0) {
+    sws_freeContext(ctx);
+    return NULL;
+  }
+  return ctx;
+#  else
+  return sws_getContext(
+      width, height, AV_PIX_FMT_RGBA, width, height, dst_format, SWS_BICUBIC, NULL, NULL, NULL);
+#  endif
+}
+
 static AVRational calc_time_base(uint den, double num, int codec_id)
 {
   /* Convert the input 'num' to an integer. Simply shift the decimal places until we get an integer
@@ -651,11 +793,13 @@ static AVStream *alloc_video_stream(FFMpegContext *context,
     c->thread_count = BLI_system_thread_count();
   }
 
+  /* Allow all threading methods the codec supports, it uses frame threading when it can. */
+  c->thread_type = 0;
   if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
-    c->thread_type = FF_THREAD_FRAME;
+    c->thread_type |= FF_THREAD_FRAME;
   }
-  else if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
-    c->thread_type = FF_THREAD_SLICE;
+  if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    c->thread_type |= FF_THREAD_SLICE;
   }
 
   int ret = avcodec_open2(c, codec, &opts);
@@ -670,27 +814,16 @@ static AVStream *alloc_video_stream(FFMpegContext *context,
   }
   av_dict_free(&opts);
 
-  /* FFmpeg expects its data in the output pixel format. */
-  context->current_frame = alloc_picture(c->pix_fmt, c->width, c->height);
-
   if (c->pix_fmt == AV_PIX_FMT_RGBA) {
     /* Output pixel format is the same we use internally, no conversion necessary. */
-    context->img_convert_frame = NULL;
+    context->current_frame = NULL;
     context->img_convert_ctx = NULL;
   }
   else {
-    /* Output pixel format is different, allocate frame for conversion. */
-    context->img_convert_frame = alloc_picture(AV_PIX_FMT_RGBA, c->width, c->height);
-    context->img_convert_ctx = sws_getContext(c->width,
-                                              c->height,
-                                              AV_PIX_FMT_RGBA,
-                                              c->width,
-                                              c->height,
-                                              c->pix_fmt,
-                                              SWS_BICUBIC,
-                                              NULL,
-                                              NULL,
-                                              NULL);
+    /* Output pixel format is different, frames are converted by the encoder thread into the
+     * output pixel format FFmpeg expects. */
+    context->current_frame = alloc_picture(c->pix_fmt, c->width, c->height);
+    context->img_convert_ctx = ffmpeg_sws_get_context(c->width, c->height, c->pix_fmt);
   }
 
   avcodec_parameters_from_context(st->codecpar, c);
@@ -1036,6 +1169,12 @@ static int start_ffmpeg_impl(FFMpegContext *context,
         &of->metadata, context->stamp_data, ffmpeg_add_metadata_callback, false);
   }
 
+  if (context->video_stream && !ffmpeg_encode_thread_start(context)) {
+    BKE_report(reports, RPT_ERROR, "Could not allocate video frames");
+    PRINT("Could not allocate video frames\n");
+    goto fail;
+  }
+
   int ret = avformat_write_header(of, NULL);
   if (ret < 0) {
     BKE_report(reports,
@@ -1051,6 +1190,8 @@ static int start_ffmpeg_impl(FFMpegContext *context,
   return 1;
 
 fail:
+  ffmpeg_encode_thread_end(context);
+
   if (of->pb) {
     avio_close(of->pb);
   }
@@ -1248,7 +1389,7 @@ int BKE_ffmpeg_start(void *context_v,
   return success;
 }
 
-static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit);
+static bool end_ffmpeg_impl(FFMpegContext *context, int is_autosplit);
 
 #  ifdef WITH_AUDASPACE
 static void write_audio_frames(FFMpegContext *context, double to_pts)
@@ -1276,14 +1417,15 @@ int BKE_ffmpeg_append(void *context_v,
                       ReportList *reports)
 {
   FFMpegContext *context = context_v;
-  AVFrame *avframe;
   int success = 1;
 
   PRINT("Writing frame %i, render width=%d, render height=%d\n", frame, rectx, recty);
 
   if (context->video_stream) {
-    avframe = generate_video_frame(context, (unsigned char *)pixels);
-    success = (avframe && write_video_frame(context, avframe, reports));
+    success = ffmpeg_encode_frame_push(context, (const uint8_t *)pixels);
+    if (!success) {
+      BKE_report(reports, RPT_ERROR, "Error writing frame");
+    }
 #  ifdef WITH_AUDASPACE
     /* Add +1 frame because we want to encode audio up until the next video frame. */
     write_audio_frames(
@@ -1293,8 +1435,15 @@ int BKE_ffmpeg_append(void *context_v,
 #  endif
 
     if (context->ffmpeg_autosplit) {
-      if (avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE) {
-        end_ffmpeg_impl(context, true);
+      BLI_mutex_lock(&context->outfile_mutex);
+      const int64_t file_size = avio_tell(context->outfile->pb);
+      BLI_mutex_unlock(&context->outfile_mutex);
+
+      if (file_size > FFMPEG_AUTOSPLIT_SIZE) {
+        if (!end_ffmpeg_impl(context, true)) {
+          BKE_report(reports, RPT_ERROR, "Error writing frame");
+          success = 0;
+        }
         context->ffmpeg_autosplit_count++;
 
         success &= start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
@@ -1305,7 +1454,7 @@ int BKE_ffmpeg_append(void *context_v,
   return success;
 }
 
-static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
+static bool end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 {
   PRINT("Closing ffmpeg...\n");
 
@@ -1320,6 +1469,12 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
   UNUSED_VARS(is_autosplit);
 #  endif
 
+  /* Encode frames still in the queue before flushing the encoder. Errors of the encoder thread
+   * may not have been reported yet, for the last queued frames. */
+  ffmpeg_encode_thread_end(context);
+  const bool success = !context->encode_failed;
+  context->encode_failed = false;
+
   if (context->video_stream) {
     PRINT("Flushing delayed video frames...\n");
     flush_ffmpeg(context->video_codec, context->video_stream, context->outfile);
@@ -1350,10 +1505,6 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
     delete_picture(context->current_frame);
     context->current_frame = NULL;
   }
-  if (context->img_convert_frame != NULL) {
-    delete_picture(context->img_convert_frame);
-    context->img_convert_frame = NULL;
-  }
 
   if (context->outfile != NULL && context->outfile->oformat) {
     if (!(context->outfile->oformat->flags & AVFMT_NOFILE)) {
@@ -1388,12 +1539,14 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
     sws_freeContext(context->img_convert_ctx);
     context->img_convert_ctx = NULL;
   }
+
+  return success;
 }
 
-void BKE_ffmpeg_end(void *context_v)
+bool BKE_ffmpeg_end(void *context_v)
 {
   FFMpegContext *context = context_v;
-  end_ffmpeg_impl(context, false);
+  return end_ffmpeg_impl(context, false);
 }
 
 void BKE_ffmpeg_preset_set(RenderData *rd, int preset)
@@ -1557,6 +1710,7 @@ void *BKE_ffmpeg_context_create(void)
   context->ffmpeg_preview = false;
   context->stamp_data = NULL;
   context->audio_time_total = 0.0;
+  BLI_mutex_init(&context->outfile_mutex);
 
   return context;
 }
@@ -1570,6 +1724,7 @@ void BKE_ffmpeg_context_free(void *context_v)
   if (context->stamp_data) {
     MEM_freeN(context->stamp_data);
   }
+  BLI_mutex_end(&context->outfile_mutex);
   MEM_freeN(context);
 }
 
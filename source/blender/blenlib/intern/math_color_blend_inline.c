@@ -591,8 +591,71 @@ MINLINE void blend_color_interpolate_byte(uchar dst[4],
   }
 }
 
+#  ifdef BLI_HAVE_SSE2
+
+/**
+ * Four straight alpha byte colors interpolated as `(mfac * src1 + fac * src2) >> 8` for each
+ * channel, like the sequencer cross effect. \a fac and \a mfac hold factors in [0, 256] adding up
+ * to 256 in all their 16 bit lanes.
+ */
+MALWAYS_INLINE __m128i blend_color_cross_byte4_simd(const __m128i src1,
+                                                    const __m128i src2,
+                                                    const __m128i fac,
+                                                    const __m128i mfac)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src1, zero), mfac),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(src2, zero), fac));
+  const __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src1, zero), mfac),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(src2, zero), fac));
+  return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+/**
+ * `(fac * src[3] * src[c]) >> 16` for all channels of four byte colors, as used by the sequencer
+ * add and subtract effects. \a fac holds a factor in [0, 256] in all its 16 bit lanes.
+ */
+MALWAYS_INLINE __m128i blend_color_alpha_scale_byte4_simd(const __m128i src, const __m128i fac)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = _mm_unpacklo_epi8(src, zero);
+  const __m128i hi = _mm_unpackhi_epi8(src, zero);
+  /* Alpha of each color in all its channels. */
+  const __m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)),
+                                               _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)),
+                                               _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_packus_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(alpha_lo, fac), lo),
+                          _mm_mulhi_epu16(_mm_mullo_epi16(alpha_hi, fac), hi));
+}
+
+/**
+ * RGB channels of four byte colors \a rgb with the alpha channel of \a alpha.
+ */
+MALWAYS_INLINE __m128i blend_color_rgb_alpha_byte4_simd(const __m128i rgb, const __m128i alpha)
+{
+  const __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000);
+  return _mm_or_si128(_mm_and_si128(alpha_mask, alpha), _mm_andnot_si128(alpha_mask, rgb));
+}
+
+#  endif /* BLI_HAVE_SSE2 */
+
 /* premultiplied alpha float blending modes */
 
+#  ifdef BLI_HAVE_SSE2
+
+/**
+ * RGB channels of \a rgb with the alpha channel of \a alpha.
+ * The SIMD blend modes below give the exact same results as their scalar version.
+ */
+MALWAYS_INLINE __m128 blend_color_rgb_alpha_simd(const __m128 rgb, const __m128 alpha)
+{
+  const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  return _bli_math_blend_sse(mask, rgb, alpha);
+}
+
+#  endif /* BLI_HAVE_SSE2 */
+
 MINLINE void blend_color_mix_float(float dst[4], const float src1[4], const float src2[4])
 {
   if (src2[3] != 0.0f) {
@@ -600,10 +663,17 @@ MINLINE void blend_color_mix_float(float dst[4], const float src1[4], const floa
     const float t = src2[3];
     const float mt = 1.0f - t;
 
+#  ifdef BLI_HAVE_SSE2
+    /* Alpha gives `mt * src1[3] + t` too. */
+    const __m128 c1 = _mm_loadu_ps(src1);
+    const __m128 c2 = _mm_loadu_ps(src2);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mt), c1), c2));
+#  else
     dst[0] = mt * src1[0] + src2[0];
     dst[1] = mt * src1[1] + src2[1];
     dst[2] = mt * src1[2] + src2[2];
     dst[3] = mt * src1[3] + t;
+#  endif
   }
   else {
     /* no op */
@@ -615,10 +685,17 @@ MINLINE void blend_color_add_float(float dst[4], const float src1[4], const floa
 {
   if (src2[3] != 0.0f) {
     /* unpremul > add > premul, simplified */
+#  ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(src1);
+    const __m128 c2 = _mm_loadu_ps(src2);
+    const __m128 rgb = _mm_add_ps(c1, _mm_mul_ps(c2, _mm_set1_ps(src1[3])));
+    _mm_storeu_ps(dst, blend_color_rgb_alpha_simd(rgb, c1));
+#  else
     dst[0] = src1[0] + src2[0] * src1[3];
     dst[1] = src1[1] + src2[1] * src1[3];
     dst[2] = src1[2] + src2[2] * src1[3];
     dst[3] = src1[3];
+#  endif
   }
   else {
     /* no op */
@@ -630,10 +707,18 @@ MINLINE void blend_color_sub_float(float dst[4], const float src1[4], const floa
 {
   if (src2[3] != 0.0f) {
     /* unpremul > subtract > premul, simplified */
+#  ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(src1);
+    const __m128 c2 = _mm_loadu_ps(src2);
+    const __m128 rgb = _mm_max_ps(_mm_sub_ps(c1, _mm_mul_ps(c2, _mm_set1_ps(src1[3]))),
+                                  _mm_setzero_ps());
+    _mm_storeu_ps(dst, blend_color_rgb_alpha_simd(rgb, c1));
+#  else
     dst[0] = max_ff(src1[0] - src2[0] * src1[3], 0.0f);
     dst[1] = max_ff(src1[1] - src2[1] * src1[3], 0.0f);
     dst[2] = max_ff(src1[2] - src2[2] * src1[3], 0.0f);
     dst[3] = src1[3];
+#  endif
   }
   else {
     /* no op */
@@ -648,10 +733,18 @@ MINLINE void blend_color_mul_float(float dst[4], const float src1[4], const floa
     const float t = src2[3];
     const float mt = 1.0f - t;
 
+#  ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(src1);
+    const __m128 c2 = _mm_loadu_ps(src2);
+    const __m128 rgb = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mt), c1),
+                                  _mm_mul_ps(_mm_mul_ps(c1, c2), _mm_set1_ps(src1[3])));
+    _mm_storeu_ps(dst, blend_color_rgb_alpha_simd(rgb, c1));
+#  else
     dst[0] = mt * src1[0] + src1[0] * src2[0] * src1[3];
     dst[1] = mt * src1[1] + src1[1] * src2[1] * src1[3];
     dst[2] = mt * src1[2] + src1[2] * src2[2] * src1[3];
     dst[3] = src1[3];
+#  endif
   }
   else {
     /* no op */
@@ -668,10 +761,19 @@ MINLINE void blend_color_lighten_float(float dst[4], const float src1[4], const
     const float mt = 1.0f - t;
     const float map_alpha = src1[3] / src2[3];
 
+#  ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(src1);
+    const __m128 c2 = _mm_loadu_ps(src2);
+    const __m128 lightest = _mm_max_ps(c1, _mm_mul_ps(c2, _mm_set1_ps(map_alpha)));
+    const __m128 rgb = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mt), c1),
+                                  _mm_mul_ps(_mm_set1_ps(t), lightest));
+    _mm_storeu_ps(dst, blend_color_rgb_alpha_simd(rgb, c1));
+#  else
     dst[0] = mt * src1[0] + t * max_ff(src1[0], src2[0] * map_alpha);
     dst[1] = mt * src1[1] + t * max_ff(src1[1], src2[1] * map_alpha);
     dst[2] = mt * src1[2] + t * max_ff(src1[2], src2[2] * map_alpha);
     dst[3] = src1[3];
+#  endif
   }
   else {
     /* no op */
@@ -688,10 +790,19 @@ MINLINE void blend_color_darken_float(float dst[4], const float src1[4], const f
     const float mt = 1.0f - t;
     const float map_alpha = src1[3] / src2[3];
 
+#  ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(src1);
+    const __m128 c2 = _mm_loadu_ps(src2);
+    const __m128 darkest = _mm_min_ps(c1, _mm_mul_ps(c2, _mm_set1_ps(map_alpha)));
+    const __m128 rgb = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mt), c1),
+                                  _mm_mul_ps(_mm_set1_ps(t), darkest));
+    _mm_storeu_ps(dst, blend_color_rgb_alpha_simd(rgb, c1));
+#  else
     dst[0] = mt * src1[0] + t * min_ff(src1[0], src2[0] * map_alpha);
     dst[1] = mt * src1[1] + t * min_ff(src1[1], src2[1] * map_alpha);
     dst[2] = mt * src1[2] + t * min_ff(src1[2], src2[2] * map_alpha);
     dst[3] = src1[3];
+#  endif
   }
   else {
     /* no op */
@@ -378,4 +378,47 @@ MINLINE void premul_float_to_straight_uchar(unsigned char *result, const float c
   }
 }
 
+#  ifdef BLI_HAVE_SSE2
+
+/**
+ * SIMD version of #straight_uchar_to_premul_float, giving the exact same result.
+ */
+MALWAYS_INLINE __m128 straight_uchar_to_premul_float_simd(const unsigned char color[4])
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i color_u8 = _mm_cvtsi32_si128(*(const int *)color);
+  const __m128i color_u32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(color_u8, zero), zero);
+  const __m128 c = _mm_cvtepi32_ps(color_u32);
+
+  const __m128 alpha = _mm_mul_ps(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3)),
+                                  _mm_set1_ps(1.0f / 255.0f));
+  const __m128 fac = _mm_mul_ps(alpha, _mm_set1_ps(1.0f / 255.0f));
+  const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  return _bli_math_blend_sse(mask, _mm_mul_ps(c, fac), alpha);
+}
+
+/**
+ * SIMD version of #premul_float_to_straight_uchar, giving the exact same result.
+ */
+MALWAYS_INLINE void premul_float_to_straight_uchar_simd(unsigned char result[4], __m128 color)
+{
+  const float alpha = _mm_cvtss_f32(_mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3)));
+  if (!(alpha == 0.0f || alpha == 1.0f)) {
+    const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    color = _bli_math_blend_sse(mask, _mm_mul_ps(color, _mm_set1_ps(1.0f / alpha)), color);
+  }
+
+  /* Same as #unit_float_to_uchar_clamp for each channel. */
+  __m128 value = _mm_add_ps(_mm_mul_ps(color, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+  value = _bli_math_blend_sse(
+      _mm_cmpgt_ps(color, _mm_set1_ps(1.0f - 0.5f / 255.0f)), _mm_set1_ps(255.0f), value);
+  value = _mm_andnot_ps(_mm_cmple_ps(color, _mm_setzero_ps()), value);
+
+  const __m128i value_u32 = _mm_cvttps_epi32(value);
+  const __m128i value_u16 = _mm_packs_epi32(value_u32, value_u32);
+  *(int *)result = _mm_cvtsi128_si32(_mm_packus_epi16(value_u16, value_u16));
+}
+
+#  endif /* BLI_HAVE_SSE2 */
+
 #endif /* __MATH_COLOR_INLINE_C__ */
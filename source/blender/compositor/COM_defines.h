@@ -109,6 +109,25 @@ constexpr float COM_PREVIEW_SIZE = 140.f;
 constexpr float COM_RULE_OF_THIRDS_DIVIDER = 100.0f;
 constexpr float COM_BLUR_BOKEH_PIXELS = 512;
 
+/**
+ * Kernel width or height from which blur operations convolve using the Fast Hartley Transform
+ * (see #convolve_fft) instead of reading all kernel pixels for each output pixel.
+ */
+constexpr int COM_FFT_CONVOLUTION_MIN_KERNEL_SIZE = 33;
+
+/**
+ * Memory that operations buffers may use before the full frame execution model stops starting
+ * operations concurrently. An operation is always started when no other is running, so trees
+ * needing more memory are still rendered, one operation at a time.
+ */
+constexpr size_t COM_FULL_FRAME_MEMORY_BUDGET = size_t(4) << 30;
+
+/**
+ * Memory that results of expensive operations kept across executions may use (see
+ * #ResultCache). Least recently used results are discarded first.
+ */
+constexpr size_t COM_RESULT_CACHE_MEMORY_BUDGET = size_t(2) << 30;
+
 constexpr rcti COM_AREA_NONE = {0, 0, 0, 0};
 constexpr rcti COM_CONSTANT_INPUT_AREA_OF_INTEREST = COM_AREA_NONE;
 
@@ -224,6 +224,10 @@ class CompositorContext {
   {
     return (this->get_bnodetree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
   }
+  bool is_half_storage_enabled() const
+  {
+    return (this->get_bnodetree()->flag & NTREE_COM_HALF_STORAGE) != 0;
+  }
 
   /**
    * \brief Get the render percentage as a factor.
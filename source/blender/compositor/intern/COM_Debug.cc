@@ -10,9 +10,12 @@ extern "C" {
 #include "BKE_appdir.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
 }
 
 #include "COM_ExecutionGroup.h"
+#include "COM_FusedPixelOperation.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_ViewerOperation.h"
@@ -26,6 +29,9 @@ DebugInfo::OpNameMap DebugInfo::op_names_;
 std::string DebugInfo::current_node_name_;
 std::string DebugInfo::current_op_name_;
 DebugInfo::GroupStateMap DebugInfo::group_states_;
+std::atomic<bool> DebugInfo::timings_enabled_ = false;
+std::mutex DebugInfo::timings_mutex_;
+Vector<DebugInfo::OperationTiming> DebugInfo::timings_;
 
 static std::string operation_class_name(const NodeOperation *op)
 {
@@ -484,4 +490,63 @@ void DebugInfo::delete_operation_exports()
   }
 }
 
+void DebugInfo::start_timings()
+{
+  std::lock_guard lock(timings_mutex_);
+  timings_.clear();
+  timings_enabled_ = true;
+}
+
+Vector<DebugInfo::OperationTiming> DebugInfo::stop_timings()
+{
+  std::lock_guard lock(timings_mutex_);
+  timings_enabled_ = false;
+  return std::move(timings_);
+}
+
+void DebugInfo::add_timing(const NodeOperation *op, const double seconds, const size_t buffer_bytes)
+{
+  std::string name = operation_class_name(op);
+  if (!op->get_name().empty()) {
+    name += " \"" + op->get_name() + "\"";
+  }
+
+  std::lock_guard lock(timings_mutex_);
+  timings_.append({std::move(name), seconds, buffer_bytes});
+}
+
+void DebugInfo::add_group_timing(const ExecutionGroup *group)
+{
+  const double seconds = PIL_check_seconds_timer() - group->execution_start_time_;
+
+  /* Name groups after the operation whose result they write. */
+  NodeOperation *output_op = group->get_output_operation();
+  size_t buffer_bytes = 0;
+  if (output_op->get_flags().is_write_buffer_operation) {
+    const DataType data_type = output_op->get_input_socket(0)->get_data_type();
+    buffer_bytes = size_t(group->width_) * group->height_ * COM_data_type_bytes_len(data_type);
+    output_op = output_op->get_input_operation(0);
+  }
+  add_timing(output_op, seconds, buffer_bytes);
+}
+
+void DebugInfo::report_operations_fused(const FusedPixelOperation *fused_op)
+{
+  printf("Compositor: fused %d pixel operations into \"%s\", saving %.2f MB of buffers\n",
+         fused_op->get_num_stages(),
+         fused_op->get_name().c_str(),
+         fused_op->get_saved_buffers_bytes() / (1024.0 * 1024.0));
+}
+
+void DebugInfo::report_fused_operation_rendered(const FusedPixelOperation *fused_op,
+                                                const double fused_time,
+                                                const double unfused_time)
+{
+  printf("Compositor: \"%s\" rendered in %.3f ms fused, %.3f ms unfused (%.3f ms saved)\n",
+         fused_op->get_name().c_str(),
+         fused_time * 1000.0,
+         unfused_time * 1000.0,
+         (unfused_time - fused_time) * 1000.0);
+}
+
 }  // namespace blender::compositor
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "BLI_vector.hh"
@@ -20,6 +22,11 @@ static constexpr bool COM_GRAPHVIZ_SHOW_NODE_NAME = false;
 /* Saves operations results to image files. */
 static constexpr bool COM_EXPORT_OPERATION_BUFFERS = false;
 
+/* Prints memory and time saved by fused pixel operations. To measure the time, fused operations
+ * are rendered a second time without fusing the stages, which makes compositing slower. */
+static constexpr bool COM_REPORT_FUSED_OPERATIONS = false;
+
+class FusedPixelOperation;
 class Node;
 class NodeOperation;
 class ExecutionSystem;
@@ -33,6 +40,13 @@ class DebugInfo {
   typedef std::map<const NodeOperation *, std::string> OpNameMap;
   typedef std::map<const ExecutionGroup *, GroupState> GroupStateMap;
 
+  /** Wall time and output buffer memory an operation took to render, see #start_timings. */
+  struct OperationTiming {
+    std::string name;
+    double seconds;
+    size_t buffer_bytes;
+  };
+
   static std::string node_name(const Node *node);
   static std::string operation_name(const NodeOperation *op);
 
@@ -48,6 +62,10 @@ class DebugInfo {
   static std::string current_op_name_;
   /** For visualizing group states. */
   static GroupStateMap group_states_;
+  /** Timings are recorded from the threads rendering the operations. */
+  static std::atomic<bool> timings_enabled_;
+  static std::mutex timings_mutex_;
+  static Vector<OperationTiming> timings_;
 
  public:
   static void convert_started()
@@ -110,6 +128,9 @@ class DebugInfo {
     if (COM_EXPORT_GRAPHVIZ) {
       group_states_[group] = EG_FINISHED;
     }
+    if (timings_enabled_) {
+      add_group_timing(group);
+    }
   };
 
   static void operation_rendered(const NodeOperation *op, MemoryBuffer *render)
@@ -120,6 +141,42 @@ class DebugInfo {
     }
   }
 
+  /**
+   * Full frame execution model only, tiled execution model times execution groups.
+   */
+  static void operation_timed(const NodeOperation *op, double seconds, size_t buffer_bytes)
+  {
+    if (timings_enabled_) {
+      add_timing(op, seconds, buffer_bytes);
+    }
+  }
+
+  /**
+   * Starts recording the wall time and output buffer memory of each rendered operation, or of
+   * each execution group in tiled execution model. Used by benchmarks.
+   */
+  static void start_timings();
+  /**
+   * Stops recording and returns the timings recorded since #start_timings, in render order.
+   */
+  static Vector<OperationTiming> stop_timings();
+
+  static void operations_fused(const FusedPixelOperation *fused_op)
+  {
+    if (COM_REPORT_FUSED_OPERATIONS) {
+      report_operations_fused(fused_op);
+    }
+  }
+
+  static void fused_operation_rendered(const FusedPixelOperation *fused_op,
+                                       double fused_time,
+                                       double unfused_time)
+  {
+    if (COM_REPORT_FUSED_OPERATIONS) {
+      report_fused_operation_rendered(fused_op, fused_time, unfused_time);
+    }
+  }
+
   static void graphviz(const ExecutionSystem *system, StringRefNull name = "");
 
  protected:
@@ -138,6 +195,14 @@ class DebugInfo {
 
   static void export_operation(const NodeOperation *op, MemoryBuffer *render);
   static void delete_operation_exports();
+
+  static void add_timing(const NodeOperation *op, double seconds, size_t buffer_bytes);
+  static void add_group_timing(const ExecutionGroup *group);
+
+  static void report_operations_fused(const FusedPixelOperation *fused_op);
+  static void report_fused_operation_rendered(const FusedPixelOperation *fused_op,
+                                              double fused_time,
+                                              double unfused_time);
 };
 
 }  // namespace blender::compositor
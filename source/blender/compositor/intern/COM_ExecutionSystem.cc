@@ -23,7 +23,8 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
                                  bNodeTree *editingtree,
                                  bool rendering,
                                  bool fastcalculation,
-                                 const char *view_name)
+                                 const char *view_name,
+                                 std::function<void(NodeOperationBuilder &builder)> build_operations)
 {
   num_work_threads_ = WorkScheduler::get_num_cpu_threads();
   context_.set_view_name(view_name);
@@ -49,6 +50,9 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
 
   {
     NodeOperationBuilder builder(&context_, editingtree, this);
+    if (build_operations) {
+      build_operations(builder);
+    }
     builder.convert_to_operations(this);
   }
 
@@ -139,7 +143,8 @@ void ExecutionSystem::execute_work(const rcti &work_rect,
       BLI_mutex_lock(&work_mutex_);
       num_sub_works_finished++;
       if (num_sub_works_finished == num_sub_works) {
-        BLI_condition_notify_one(&work_finished_cond_);
+        /* Other operations may be waiting for their own work. */
+        BLI_condition_notify_all(&work_finished_cond_);
       }
       BLI_mutex_unlock(&work_mutex_);
     };
@@ -148,13 +153,10 @@ void ExecutionSystem::execute_work(const rcti &work_rect,
   }
   BLI_assert(sub_work_y == work_rect.ymax);
 
-  WorkScheduler::finish();
-
-  /* Ensure all sub-works finished.
-   * TODO: This a workaround for WorkScheduler::finish() not waiting all works on queue threading
-   * model. Sync code should be removed once it's fixed. */
+  /* Wait for this call's sub-works only. #WorkScheduler::finish() waits for every scheduled work,
+   * including the work of operations rendered concurrently. */
   BLI_mutex_lock(&work_mutex_);
-  if (num_sub_works_finished < num_sub_works) {
+  while (num_sub_works_finished < num_sub_works) {
     BLI_condition_wait(&work_finished_cond_, &work_mutex_);
   }
   BLI_mutex_unlock(&work_mutex_);
@@ -107,6 +107,7 @@ namespace blender::compositor {
 class ExecutionGroup;
 class ExecutionModel;
 class NodeOperation;
+class NodeOperationBuilder;
 
 /**
  * \brief the ExecutionSystem contains the whole compositor tree.
@@ -154,13 +155,16 @@ class ExecutionSystem {
    *
    * \param editingtree: [bNodeTree *]
    * \param rendering: [true false]
+   * \param build_operations: Optionally adds operations and links to the builder before nodes
+   * are converted, allowing to execute operation graphs without nodes (used by benchmarks).
    */
   ExecutionSystem(RenderData *rd,
                   Scene *scene,
                   bNodeTree *editingtree,
                   bool rendering,
                   bool fastcalculation,
-                  const char *view_name);
+                  const char *view_name,
+                  std::function<void(NodeOperationBuilder &builder)> build_operations = nullptr);
 
   /**
    * Destructor
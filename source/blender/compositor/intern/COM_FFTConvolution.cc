@@ -0,0 +1,421 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "BLI_array.hh"
+#include "BLI_task.hh"
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor {
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+using fREAL = float;
+
+/* Returns next highest power of 2 of x, as well its log2 in L2. */
+static unsigned int next_pow2(unsigned int x, unsigned int *L2)
+{
+  unsigned int pw, x_notpow2 = x & (x - 1);
+  *L2 = 0;
+  while (x >>= 1) {
+    ++(*L2);
+  }
+  pw = 1 << (*L2);
+  if (x_notpow2) {
+    (*L2)++;
+    pw <<= 1;
+  }
+  return pw;
+}
+
+//------------------------------------------------------------------------------
+
+/* From FXT library by Joerg Arndt, faster in order bit-reversal
+ * use: `r = revbin_upd(r, h)` where `h = N>>1`. */
+static unsigned int revbin_upd(unsigned int r, unsigned int h)
+{
+  while (!((r ^= h) & h)) {
+    h >>= 1;
+  }
+  return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
+{
+  double tt, fc, dc, fs, ds, a = M_PI;
+  fREAL t1, t2;
+  int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+  int i, j = 0;
+  unsigned int Nh = len >> 1;
+  for (i = 1; i < (len - 1); i++) {
+    j = revbin_upd(j, Nh);
+    if (j > i) {
+      t1 = data[i];
+      data[i] = data[j];
+      data[j] = t1;
+    }
+  }
+
+  do {
+    fREAL *data_n = &data[n];
+
+    istep = n << 1;
+    for (k = 0; k < len; k += istep) {
+      t1 = data_n[k];
+      data_n[k] = data[k] - t1;
+      data[k] += t1;
+    }
+
+    n2 = n >> 1;
+    if (n > 2) {
+      fc = dc = cos(a);
+      fs = ds = sqrt(1.0 - fc * fc);  // sin(a);
+      bd = n - 2;
+      for (bl = 1; bl < n2; bl++) {
+        fREAL *data_nbd = &data_n[bd];
+        fREAL *data_bd = &data[bd];
+        for (k = bl; k < len; k += istep) {
+          t1 = fc * (double)data_n[k] + fs * (double)data_nbd[k];
+          t2 = fs * (double)data_n[k] - fc * (double)data_nbd[k];
+          data_n[k] = data[k] - t1;
+          data_nbd[k] = data_bd[k] - t2;
+          data[k] += t1;
+          data_bd[k] += t2;
+        }
+        tt = fc * dc - fs * ds;
+        fs = fs * dc + fc * ds;
+        fc = tt;
+        bd -= 2;
+      }
+    }
+
+    if (n > 1) {
+      for (k = n2; k < len; k += istep) {
+        t1 = data_n[k];
+        data_n[k] = data[k] - t1;
+        data[k] += t1;
+      }
+    }
+
+    n = istep;
+    a *= 0.5;
+  } while (n < len);
+
+  if (inverse) {
+    fREAL sc = (fREAL)1 / (fREAL)len;
+    for (k = 0; k < len; k++) {
+      data[k] *= sc;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above. */
+static void FHT2D(
+    fREAL *data, unsigned int Mx, unsigned int My, unsigned int nzp, unsigned int inverse)
+{
+  unsigned int i, j, Nx, Ny, maxy;
+
+  Nx = 1 << Mx;
+  Ny = 1 << My;
+
+  /* Rows (forward transform skips 0 pad data). */
+  maxy = inverse ? Ny : nzp;
+  for (j = 0; j < maxy; j++) {
+    FHT(&data[Nx * j], Mx, inverse);
+  }
+
+  /* Transpose data. */
+  if (Nx == Ny) { /* Square. */
+    for (j = 0; j < Ny; j++) {
+      for (i = j + 1; i < Nx; i++) {
+        unsigned int op = i + (j << Mx), np = j + (i << My);
+        SWAP(fREAL, data[op], data[np]);
+      }
+    }
+  }
+  else { /* Rectangular. */
+    unsigned int k, Nym = Ny - 1, stm = 1 << (Mx + My);
+    for (i = 0; stm > 0; i++) {
+#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+      for (j = PRED(i); j > i; j = PRED(j)) {
+        /* Pass. */
+      }
+      if (j < i) {
+        continue;
+      }
+      for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+        SWAP(fREAL, data[j], data[k]);
+      }
+#undef PRED
+      stm--;
+    }
+  }
+
+  SWAP(unsigned int, Nx, Ny);
+  SWAP(unsigned int, Mx, My);
+
+  /* Now columns == transposed rows. */
+  for (j = 0; j < Ny; j++) {
+    FHT(&data[Nx * j], Mx, inverse);
+  }
+
+  /* Finalize. */
+  for (j = 0; j <= (Ny >> 1); j++) {
+    unsigned int jm = (Ny - j) & (Ny - 1);
+    unsigned int ji = j << Mx;
+    unsigned int jmi = jm << Mx;
+    for (i = 0; i <= (Nx >> 1); i++) {
+      unsigned int im = (Nx - i) & (Nx - 1);
+      fREAL A = data[ji + i];
+      fREAL B = data[jmi + i];
+      fREAL C = data[ji + im];
+      fREAL D = data[jmi + im];
+      fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+      data[ji + i] = A - E;
+      data[jmi + i] = B + E;
+      data[ji + im] = C + E;
+      data[jmi + im] = D - E;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height. */
+static void fht_convolve(fREAL *d1, const fREAL *d2, unsigned int M, unsigned int N)
+{
+  fREAL a, b;
+  unsigned int i, j, k, L, mj, mL;
+  unsigned int m = 1 << M, n = 1 << N;
+  unsigned int m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+  unsigned int mn2 = m << (N - 1);
+
+  d1[0] *= d2[0];
+  d1[mn2] *= d2[mn2];
+  d1[m2] *= d2[m2];
+  d1[m2 + mn2] *= d2[m2 + mn2];
+  for (i = 1; i < m2; i++) {
+    k = m - i;
+    a = d1[i] * d2[i] - d1[k] * d2[k];
+    b = d1[k] * d2[i] + d1[i] * d2[k];
+    d1[i] = (b + a) * (fREAL)0.5;
+    d1[k] = (b - a) * (fREAL)0.5;
+    a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+    b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+    d1[i + mn2] = (b + a) * (fREAL)0.5;
+    d1[k + mn2] = (b - a) * (fREAL)0.5;
+  }
+  for (j = 1; j < n2; j++) {
+    L = n - j;
+    mj = j << M;
+    mL = L << M;
+    a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+    b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+    d1[mj] = (b + a) * (fREAL)0.5;
+    d1[mL] = (b - a) * (fREAL)0.5;
+    a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+    b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+    d1[m2 + mj] = (b + a) * (fREAL)0.5;
+    d1[m2 + mL] = (b - a) * (fREAL)0.5;
+  }
+  for (i = 1; i < m2; i++) {
+    k = m - i;
+    for (j = 1; j < n2; j++) {
+      L = n - j;
+      mj = j << M;
+      mL = L << M;
+      a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+      b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+      d1[i + mj] = (b + a) * (fREAL)0.5;
+      d1[k + mL] = (b - a) * (fREAL)0.5;
+      a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+      b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+      d1[i + mL] = (b + a) * (fREAL)0.5;
+      d1[k + mj] = (b - a) * (fREAL)0.5;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+
+void convolve_fft(const MemoryBuffer &image,
+                  const MemoryBuffer &kernel,
+                  const int num_channels,
+                  MemoryBuffer &r_result)
+{
+  BLI_assert(kernel.get_num_channels() == 1 || kernel.get_num_channels() >= num_channels);
+  BLI_assert(image.get_num_channels() >= num_channels);
+  BLI_assert(r_result.get_num_channels() >= num_channels);
+
+  r_result.clear();
+
+  const rcti &image_rect = image.get_rect();
+  const rcti &kernel_rect = kernel.get_rect();
+  const rcti &result_rect = r_result.get_rect();
+  const int kernel_width = kernel.get_width();
+  const int kernel_height = kernel.get_height();
+  const int kernel_center_x = kernel_width / 2;
+  const int kernel_center_y = kernel_height / 2;
+
+  /* Convolution result of a kernel sized block, to FFT pow2 required size & log2. */
+  unsigned int log2_w, log2_h;
+  const int w2 = next_pow2(2 * kernel_width - 1, &log2_w);
+  const int h2 = next_pow2(2 * kernel_height - 1, &log2_h);
+  const int64_t fft_len = int64_t(w2) * h2;
+
+  /* Only need to calc fht data of the kernel once, re-used for every block. */
+  const int num_kernel_channels = kernel.get_num_channels() == 1 ? 1 : num_channels;
+  Array<fREAL> kernel_fht(fft_len * num_kernel_channels, 0.0f);
+  threading::parallel_for(IndexRange(num_kernel_channels), 1, [&](const IndexRange channels) {
+    for (const int ch : channels) {
+      fREAL *data = &kernel_fht[fft_len * ch];
+      for (int y = 0; y < kernel_height; y++) {
+        const float *elem = kernel.get_elem(kernel_rect.xmin, kernel_rect.ymin + y);
+        for (int x = 0; x < kernel_width; x++, elem += kernel.elem_stride) {
+          data[y * w2 + x] = elem[ch];
+        }
+      }
+      FHT2D(data, log2_w, log2_h, kernel_height, 0);
+    }
+  });
+
+  /* Block add-overlap, blocks are as large as possible with their convolution fitting the FFT
+   * size. As blocks are higher than the kernel, results of a row of blocks only overlap the ones
+   * of adjacent rows. Even and odd rows are added in two passes, so that no channel of a pixel is
+   * written concurrently. Blocks of a row are added one by one. */
+  const int block_width = (w2 + 1) - kernel_width;
+  const int block_height = (h2 + 1) - kernel_height;
+  const int num_blocks_x = divide_ceil_u(BLI_rcti_size_x(&image_rect), block_width);
+  const int num_blocks_y = divide_ceil_u(BLI_rcti_size_y(&image_rect), block_height);
+  for (const int parity : {0, 1}) {
+    const int num_rows = (num_blocks_y + 1 - parity) / 2;
+    threading::parallel_for(IndexRange(num_rows * num_channels), 1, [&](const IndexRange tasks) {
+      Array<fREAL> data(fft_len);
+      for (const int64_t task : tasks) {
+        const int ch = task % num_channels;
+        const int block_y = (task / num_channels) * 2 + parity;
+        const fREAL *kernel_data = &kernel_fht[fft_len * (num_kernel_channels == 1 ? 0 : ch)];
+        for (int block_x = 0; block_x < num_blocks_x; block_x++) {
+          rcti block;
+          block.xmin = image_rect.xmin + block_x * block_width;
+          block.xmax = MIN2(block.xmin + block_width, image_rect.xmax);
+          block.ymin = image_rect.ymin + block_y * block_height;
+          block.ymax = MIN2(block.ymin + block_height, image_rect.ymax);
+
+          /* Skip blocks whose convolution doesn't reach the result. */
+          rcti reach = block;
+          reach.xmin -= kernel_center_x;
+          reach.xmax += kernel_width - 1 - kernel_center_x;
+          reach.ymin -= kernel_center_y;
+          reach.ymax += kernel_height - 1 - kernel_center_y;
+          rcti update_rect;
+          if (!BLI_rcti_isect(&reach, &result_rect, &update_rect) ||
+              BLI_rcti_is_empty(&update_rect)) {
+            continue;
+          }
+
+          /* Image, channel ch -> data. */
+          data.fill(0.0f);
+          for (int y = block.ymin; y < block.ymax; y++) {
+            fREAL *fp = &data[(y - block.ymin) * w2];
+            const float *elem = image.get_elem(block.xmin, y);
+            for (int x = block.xmin; x < block.xmax; x++, elem += image.elem_stride) {
+              *fp++ = elem[ch];
+            }
+          }
+
+          /* Forward FHT, zero pad data starts after block rows. */
+          FHT2D(data.data(), log2_w, log2_h, BLI_rcti_size_y(&block), 0);
+
+          /* FHT2D transposed data, row/col now swapped
+           * convolve & inverse FHT. */
+          fht_convolve(data.data(), kernel_data, log2_h, log2_w);
+          FHT2D(data.data(), log2_h, log2_w, 0, 1);
+          /* Data again transposed, so in order again. */
+
+          /* Overlap-add result. */
+          for (int y = update_rect.ymin; y < update_rect.ymax; y++) {
+            const fREAL *fp = &data[(y - block.ymin + kernel_center_y) * w2 +
+                                    (update_rect.xmin - block.xmin + kernel_center_x)];
+            float *elem = r_result.get_elem(update_rect.xmin, y);
+            for (int x = update_rect.xmin; x < update_rect.xmax; x++, elem += r_result.elem_stride) {
+              elem[ch] += *fp++;
+            }
+          }
+        }
+      }
+    });
+  }
+}
+
+void convolve_fft_normalized(const MemoryBuffer &image,
+                             const MemoryBuffer &kernel,
+                             const int num_channels,
+                             MemoryBuffer &r_result)
+{
+  convolve_fft(image, kernel, num_channels, r_result);
+
+  /* Summed area table of the kernel weights, to get the weights sum of any rectangle of kernel
+   * elements at once. Doubles don't lose precision adding lots of small weights. */
+  const rcti &image_rect = image.get_rect();
+  const rcti &kernel_rect = kernel.get_rect();
+  const int kernel_width = kernel.get_width();
+  const int kernel_height = kernel.get_height();
+  const int kernel_center_x = kernel_width / 2;
+  const int kernel_center_y = kernel_height / 2;
+  const int num_kernel_channels = kernel.get_num_channels() == 1 ? 1 : num_channels;
+  const int sums_width = kernel_width + 1;
+  Array<double> sums(int64_t(sums_width) * (kernel_height + 1) * num_kernel_channels, 0.0);
+  auto sum_at = [&](const int x, const int y, const int ch) -> double & {
+    return sums[(int64_t(y) * sums_width + x) * num_kernel_channels + ch];
+  };
+  for (int y = 0; y < kernel_height; y++) {
+    const float *elem = kernel.get_elem(kernel_rect.xmin, kernel_rect.ymin + y);
+    for (int x = 0; x < kernel_width; x++, elem += kernel.elem_stride) {
+      for (int ch = 0; ch < num_kernel_channels; ch++) {
+        sum_at(x + 1, y + 1, ch) = elem[ch] + sum_at(x, y + 1, ch) + sum_at(x + 1, y, ch) -
+                                   sum_at(x, y, ch);
+      }
+    }
+  }
+
+  /* Weights sums close to zero only come from rounding errors, dividing by them would amplify the
+   * convolution noise. */
+  Array<double> min_weights(num_kernel_channels);
+  for (int ch = 0; ch < num_kernel_channels; ch++) {
+    min_weights[ch] = fabs(sum_at(kernel_width, kernel_height, ch)) * 1e-6;
+  }
+
+  const rcti &result_rect = r_result.get_rect();
+  threading::parallel_for(
+      IndexRange(result_rect.ymin, BLI_rcti_size_y(&result_rect)), 8, [&](const IndexRange rows) {
+        for (const int y : rows) {
+          /* Kernel rows the image is convolved with, inclusive. */
+          const int kernel_ymin = MAX2(kernel_center_y + y - (image_rect.ymax - 1), 0);
+          const int kernel_ymax = MIN2(kernel_center_y + y - image_rect.ymin, kernel_height - 1);
+          float *elem = r_result.get_elem(result_rect.xmin, y);
+          for (int x = result_rect.xmin; x < result_rect.xmax; x++, elem += r_result.elem_stride) {
+            const int kernel_xmin = MAX2(kernel_center_x + x - (image_rect.xmax - 1), 0);
+            const int kernel_xmax = MIN2(kernel_center_x + x - image_rect.xmin, kernel_width - 1);
+            for (int ch = 0; ch < num_channels; ch++) {
+              double weight = 0.0;
+              const int kernel_ch = num_kernel_channels == 1 ? 0 : ch;
+              if (kernel_xmin <= kernel_xmax && kernel_ymin <= kernel_ymax) {
+                weight = sum_at(kernel_xmax + 1, kernel_ymax + 1, kernel_ch) -
+                         sum_at(kernel_xmin, kernel_ymax + 1, kernel_ch) -
+                         sum_at(kernel_xmax + 1, kernel_ymin, kernel_ch) +
+                         sum_at(kernel_xmin, kernel_ymin, kernel_ch);
+              }
+              elem[ch] = fabs(weight) > min_weights[kernel_ch] ? elem[ch] / weight : 0.0f;
+            }
+          }
+        }
+      });
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+
+/**
+ * Convolution with large kernels using the 2D Fast Hartley Transform. The image is split in
+ * blocks that are transformed, multiplied by the transformed kernel and overlap-added to the
+ * result in parallel. Cost per pixel grows with the logarithm of the kernel size instead of its
+ * area, it's faster than direct convolution for kernels of
+ * #COM_FFT_CONVOLUTION_MIN_KERNEL_SIZE and larger.
+ *
+ * The kernel center is its element at `(width / 2, height / 2)` relative to its rect, and:
+ * `result(p) = sum(image(n) * kernel(center + p - n))` for all pixels `n` of the image rect.
+ *
+ * Kernel must have a single channel, used for all image channels, or at least `num_channels`.
+ * Only the first `num_channels` of `r_result` are written, other channels are cleared. Result
+ * may have any rect, pixels the kernel doesn't reach from the image are cleared.
+ */
+void convolve_fft(const MemoryBuffer &image,
+                  const MemoryBuffer &kernel,
+                  int num_channels,
+                  MemoryBuffer &r_result);
+
+/**
+ * Same as #convolve_fft but divides each result pixel by the sum of the kernel weights of the
+ * image pixels it's convolved with. Matches direct convolutions skipping pixels outside the image
+ * and normalizing by the accumulated weights, so that image borders don't get darker.
+ */
+void convolve_fft_normalized(const MemoryBuffer &image,
+                             const MemoryBuffer &kernel,
+                             int num_channels,
+                             MemoryBuffer &r_result);
+
+}  // namespace blender::compositor
@@ -3,9 +3,14 @@
 
 #include "COM_FullFrameExecutionModel.h"
 
+#include "BLI_vector_set.hh"
+
 #include "BLT_translation.h"
 
+#include "PIL_time.h"
+
 #include "COM_Debug.h"
+#include "COM_ResultCache.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -20,13 +25,22 @@ FullFrameExecutionModel::FullFrameExecutionModel(CompositorContext &context,
                                                  Span<NodeOperation *> operations)
     : ExecutionModel(context, operations),
       active_buffers_(shared_buffers),
-      num_operations_finished_(0)
+      num_operations_finished_(0),
+      num_running_ops_(0),
+      used_memory_(0),
+      task_pool_(nullptr)
 {
   priorities_.append(eCompositorPriority::High);
   if (!context.is_fast_calculation()) {
     priorities_.append(eCompositorPriority::Medium);
     priorities_.append(eCompositorPriority::Low);
   }
+  BLI_mutex_init(&scheduler_mutex_);
+}
+
+FullFrameExecutionModel::~FullFrameExecutionModel()
+{
+  BLI_mutex_end(&scheduler_mutex_);
 }
 
 void FullFrameExecutionModel::execute(ExecutionSystem &exec_system)
@@ -72,8 +86,14 @@ Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation
 
     rcti rect = buf->get_rect();
     BLI_rcti_translate(&rect, offset_x, offset_y);
-    inputs_buffers[i] = new MemoryBuffer(
-        buf->get_buffer(), buf->get_num_channels(), rect, buf->is_a_single_elem());
+    if (buf->is_half_storage()) {
+      /* Each reader expands its own copy, half storage buffers are never modified. */
+      inputs_buffers[i] = buf->expand_half_storage(rect);
+    }
+    else {
+      inputs_buffers[i] = new MemoryBuffer(
+          buf->get_buffer(), buf->get_num_channels(), rect, buf->is_a_single_elem());
+    }
   }
   return inputs_buffers;
 }
@@ -91,6 +111,18 @@ MemoryBuffer *FullFrameExecutionModel::create_operation_buffer(NodeOperation *op
   return new MemoryBuffer(data_type, rect, is_a_single_elem);
 }
 
+static size_t get_operation_buffer_bytes(NodeOperation *op)
+{
+  if (op->get_number_of_output_sockets() == 0) {
+    return 0;
+  }
+  const size_t num_elems = op->get_flags().is_constant_operation ?
+                               1 :
+                               size_t(op->get_width()) * size_t(op->get_height());
+  const DataType data_type = op->get_output_socket(0)->get_data_type();
+  return num_elems * COM_data_type_bytes_len(data_type);
+}
+
 void FullFrameExecutionModel::render_operation(NodeOperation *op)
 {
   /* Output has no offset for easier image algorithms implementation on operations. */
@@ -104,8 +136,17 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
     const int op_offset_x = output_x - op->get_canvas().xmin;
     const int op_offset_y = output_y - op->get_canvas().ymin;
     Vector<rcti> areas = active_buffers_.get_areas_to_render(op, op_offset_x, op_offset_y);
+    const double start_time = PIL_check_seconds_timer();
     op->render(op_buf, areas, input_bufs);
     DebugInfo::operation_rendered(op, op_buf);
+    DebugInfo::operation_timed(
+        op, PIL_check_seconds_timer() - start_time, get_operation_buffer_bytes(op));
+    if (op->get_flags().use_result_cache) {
+      cache_operation_result(op, op_buf, areas);
+    }
+    if (op->get_flags().use_half_storage) {
+      op_buf->convert_to_half_storage();
+    }
 
     for (MemoryBuffer *buf : input_bufs) {
       delete buf;
@@ -118,25 +159,54 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
   operation_finished(op);
 }
 
+void FullFrameExecutionModel::cache_operation_result(NodeOperation *op,
+                                                     const MemoryBuffer *op_buf,
+                                                     Span<rcti> areas)
+{
+  const std::optional<size_t> key = op->get_result_key();
+  if (!key || op_buf == nullptr) {
+    return;
+  }
+
+  /* Results of cancelled executions may be incomplete. */
+  const bNodeTree *btree = context_.get_bnodetree();
+  if (btree->test_break(btree->tbh)) {
+    return;
+  }
+
+  /* Areas to render depend on the readers, only whole results may be reused. */
+  for (const rcti &area : areas) {
+    if (BLI_rcti_size_x(&area) == op->get_width() && BLI_rcti_size_y(&area) == op->get_height()) {
+      ResultCache::get().add(*key, *op_buf);
+      return;
+    }
+  }
+}
+
 void FullFrameExecutionModel::render_operations()
 {
   const bool is_rendering = context_.is_rendering();
 
   WorkScheduler::start(this->context_);
+  task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
   for (eCompositorPriority priority : priorities_) {
+    Vector<NodeOperation *> output_ops;
     for (NodeOperation *op : operations_) {
       const bool has_size = op->get_width() > 0 && op->get_height() > 0;
       const bool is_priority_output = op->is_output_operation(is_rendering) &&
                                       op->get_render_priority() == priority;
       if (is_priority_output && has_size) {
-        render_output_dependencies(op);
-        render_operation(op);
+        output_ops.append(op);
       }
       else if (is_priority_output && !has_size && op->is_active_viewer_output()) {
         static_cast<ViewerOperation *>(op)->clear_display_buffer();
       }
     }
+    render_outputs(output_ops);
   }
+  BLI_task_pool_free(task_pool_);
+  task_pool_ = nullptr;
+  scheduled_ops_.clear();
   WorkScheduler::stop();
 }
 
@@ -167,17 +237,86 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
   return dependencies;
 }
 
-void FullFrameExecutionModel::render_output_dependencies(NodeOperation *output_op)
+void FullFrameExecutionModel::render_outputs(Span<NodeOperation *> output_ops)
 {
-  BLI_assert(output_op->is_output_operation(context_.is_rendering()));
-  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op);
-  for (NodeOperation *op : dependencies) {
-    if (!active_buffers_.is_operation_rendered(op)) {
-      render_operation(op);
+  /* Gather operations not rendered yet. Registering them in #scheduled_ops_ and
+   * #active_buffers_ now ensures both maps are only read while operations run concurrently. */
+  VectorSet<NodeOperation *> ops_to_render;
+  for (NodeOperation *output_op : output_ops) {
+    BLI_assert(output_op->is_output_operation(context_.is_rendering()));
+    Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op);
+    dependencies.append(output_op);
+    for (NodeOperation *op : dependencies) {
+      if (!active_buffers_.is_operation_rendered(op)) {
+        ops_to_render.add(op);
+        scheduled_ops_.add_overwrite(op, ScheduledOperation());
+      }
+    }
+  }
+
+  for (NodeOperation *op : ops_to_render) {
+    schedule_operation(op);
+  }
+
+  BLI_mutex_lock(&scheduler_mutex_);
+  for (NodeOperation *op : ops_to_render) {
+    if (scheduled_ops_.lookup(op).num_pending_inputs == 0) {
+      ready_ops_.append(op);
+    }
+  }
+  start_ready_operations();
+  BLI_mutex_unlock(&scheduler_mutex_);
+
+  BLI_task_pool_work_and_wait(task_pool_);
+  BLI_assert(ready_ops_.is_empty() && num_running_ops_ == 0);
+}
+
+void FullFrameExecutionModel::schedule_operation(NodeOperation *op)
+{
+  ScheduledOperation &scheduled = scheduled_ops_.lookup(op);
+  scheduled.buffer_bytes = get_operation_buffer_bytes(op);
+  for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+    NodeOperation *input_op = op->get_input_operation(i);
+    if (!active_buffers_.is_operation_rendered(input_op)) {
+      scheduled.num_pending_inputs++;
+      scheduled_ops_.lookup(input_op).readers.append(op);
     }
   }
 }
 
+void FullFrameExecutionModel::start_ready_operations()
+{
+  while (!ready_ops_.is_empty()) {
+    NodeOperation *op = ready_ops_.first();
+    ScheduledOperation &scheduled = scheduled_ops_.lookup(op);
+    /* Each reader of half storage buffers expands its own float copy, see #get_input_buffers. */
+    scheduled.expanded_inputs_bytes = 0;
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      MemoryBuffer *input_buf = active_buffers_.get_rendered_buffer(input_op);
+      if (input_buf && input_buf->is_half_storage()) {
+        scheduled.expanded_inputs_bytes += get_operation_buffer_bytes(input_op);
+      }
+    }
+    const size_t buffer_bytes = scheduled.buffer_bytes + scheduled.expanded_inputs_bytes;
+    /* Wait for running operations to free buffers when over budget. */
+    if (num_running_ops_ > 0 && used_memory_ + buffer_bytes > COM_FULL_FRAME_MEMORY_BUDGET) {
+      break;
+    }
+    ready_ops_.remove(0);
+    used_memory_ += buffer_bytes;
+    num_running_ops_++;
+    BLI_task_pool_push(task_pool_, render_operation_task, op, false, nullptr);
+  }
+}
+
+void FullFrameExecutionModel::render_operation_task(TaskPool *__restrict pool, void *taskdata)
+{
+  FullFrameExecutionModel *model = static_cast<FullFrameExecutionModel *>(
+      BLI_task_pool_user_data(pool));
+  model->render_operation(static_cast<NodeOperation *>(taskdata));
+}
+
 void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op,
                                                         const rcti &output_area)
 {
@@ -257,14 +396,44 @@ void FullFrameExecutionModel::get_output_render_area(NodeOperation *output_op, r
 
 void FullFrameExecutionModel::operation_finished(NodeOperation *operation)
 {
+  BLI_mutex_lock(&scheduler_mutex_);
+
   /* Report inputs reads so that buffers may be freed/reused. */
   const int num_inputs = operation->get_number_of_input_sockets();
   for (int i = 0; i < num_inputs; i++) {
-    active_buffers_.read_finished(operation->get_input_operation(i));
+    NodeOperation *input_op = operation->get_input_operation(i);
+    if (active_buffers_.read_finished(input_op)) {
+      used_memory_ -= scheduled_ops_.lookup(input_op).buffer_bytes;
+    }
   }
 
   num_operations_finished_++;
   update_progress_bar();
+
+  ScheduledOperation &scheduled = scheduled_ops_.lookup(operation);
+  /* Expanded inputs were freed once the operation rendered. */
+  used_memory_ -= scheduled.expanded_inputs_bytes;
+  scheduled.expanded_inputs_bytes = 0;
+
+  MemoryBuffer *buffer = active_buffers_.get_rendered_buffer(operation);
+  if (buffer && buffer->is_half_storage()) {
+    const size_t saved_bytes = scheduled.buffer_bytes / 2;
+    scheduled.buffer_bytes -= saved_bytes;
+    used_memory_ -= saved_bytes;
+  }
+
+  /* Start the readers that were only waiting for this operation. */
+  for (NodeOperation *reader : scheduled.readers) {
+    ScheduledOperation &scheduled_reader = scheduled_ops_.lookup(reader);
+    scheduled_reader.num_pending_inputs--;
+    if (scheduled_reader.num_pending_inputs == 0) {
+      ready_ops_.append(reader);
+    }
+  }
+  num_running_ops_--;
+  start_ready_operations();
+
+  BLI_mutex_unlock(&scheduler_mutex_);
 }
 
 void FullFrameExecutionModel::update_progress_bar()
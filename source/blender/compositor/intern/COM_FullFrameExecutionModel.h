@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include "BLI_map.hh"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_vector.hh"
 
 #include "COM_Enums.h"
@@ -22,10 +25,25 @@ class NodeOperation;
 class SharedOperationBuffers;
 
 /**
- * Fully renders operations in order from inputs to outputs.
+ * Fully renders operations in order from inputs to outputs. Operations that don't depend on each
+ * other are rendered concurrently.
  */
 class FullFrameExecutionModel : public ExecutionModel {
  private:
+  /**
+   * Scheduling data of an operation in the dependency graph of the outputs being rendered.
+   */
+  struct ScheduledOperation {
+    /** Number of input sockets linked to operations that are not rendered yet. */
+    int num_pending_inputs = 0;
+    /** Operations reading this operation buffer, once per linked input socket. */
+    Vector<NodeOperation *> readers;
+    /** Estimated size of the operation output buffer. */
+    size_t buffer_bytes = 0;
+    /** Size of the float copies of half storage inputs, allocated while the operation renders. */
+    size_t expanded_inputs_bytes = 0;
+  };
+
   /**
    * Contains operations active buffers data.
    * Buffers will be disposed once reader operations are finished.
@@ -42,10 +60,36 @@ class FullFrameExecutionModel : public ExecutionModel {
    */
   Vector<eCompositorPriority> priorities_;
 
+  /**
+   * Dependency graph of the operations to render. Only modified while no operation is running.
+   */
+  Map<NodeOperation *, ScheduledOperation> scheduled_ops_;
+
+  /**
+   * Operations with all their inputs rendered, waiting for memory to be started.
+   */
+  Vector<NodeOperation *> ready_ops_;
+
+  int num_running_ops_;
+
+  /**
+   * Memory of the buffers alive or being rendered, checked against
+   * #COM_FULL_FRAME_MEMORY_BUDGET before starting operations.
+   */
+  size_t used_memory_;
+
+  /**
+   * Protects scheduling and progress data from concurrent operations.
+   */
+  ThreadMutex scheduler_mutex_;
+
+  TaskPool *task_pool_;
+
  public:
   FullFrameExecutionModel(CompositorContext &context,
                           SharedOperationBuffers &shared_buffers,
                           Span<NodeOperation *> operations);
+  ~FullFrameExecutionModel();
 
   void execute(ExecutionSystem &exec_system) override;
 
@@ -55,7 +99,18 @@ class FullFrameExecutionModel : public ExecutionModel {
    * Render output operations in order of priority.
    */
   void render_operations();
-  void render_output_dependencies(NodeOperation *output_op);
+  /**
+   * Render given output operations and all their dependencies, running operations concurrently
+   * as soon as their inputs are rendered.
+   */
+  void render_outputs(Span<NodeOperation *> output_ops);
+  void schedule_operation(NodeOperation *op);
+  /**
+   * Starts ready operations while they fit in the memory budget. Must be called with
+   * #scheduler_mutex_ locked.
+   */
+  void start_ready_operations();
+  static void render_operation_task(TaskPool *__restrict pool, void *taskdata);
   /**
    * Returns input buffers with an offset relative to given output coordinates.
    * Returned memory buffers must be deleted.
@@ -63,6 +118,10 @@ class FullFrameExecutionModel : public ExecutionModel {
   Vector<MemoryBuffer *> get_input_buffers(NodeOperation *op, int output_x, int output_y);
   MemoryBuffer *create_operation_buffer(NodeOperation *op, int output_x, int output_y);
   void render_operation(NodeOperation *op);
+  /**
+   * Stores given operation result in the #ResultCache when it's complete.
+   */
+  void cache_operation_result(NodeOperation *op, const MemoryBuffer *op_buf, Span<rcti> areas);
 
   void operation_finished(NodeOperation *operation);
 
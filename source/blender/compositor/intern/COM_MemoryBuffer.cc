@@ -5,6 +5,11 @@
 
 #include "COM_MemoryProxy.h"
 
+#include <atomic>
+
+#include "BLI_math_bits.h"
+#include "BLI_task.hh"
+
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf_types.h"
 
@@ -37,6 +42,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memory_proxy, const rcti &rect, MemoryBu
   num_channels_ = COM_data_type_num_channels(memory_proxy->get_data_type());
   buffer_ = (float *)MEM_mallocN_aligned(
       sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  half_buffer_ = nullptr;
   owns_data_ = true;
   state_ = state;
   datatype_ = memory_proxy->get_data_type();
@@ -52,6 +58,7 @@ MemoryBuffer::MemoryBuffer(DataType data_type, const rcti &rect, bool is_a_singl
   num_channels_ = COM_data_type_num_channels(data_type);
   buffer_ = (float *)MEM_mallocN_aligned(
       sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  half_buffer_ = nullptr;
   owns_data_ = true;
   state_ = MemoryBufferState::Temporary;
   datatype_ = data_type;
@@ -76,6 +83,7 @@ MemoryBuffer::MemoryBuffer(float *buffer,
   num_channels_ = num_channels;
   datatype_ = COM_num_channels_data_type(num_channels);
   buffer_ = buffer;
+  half_buffer_ = nullptr;
   owns_data_ = false;
   state_ = MemoryBufferState::Temporary;
 
@@ -84,6 +92,7 @@ MemoryBuffer::MemoryBuffer(float *buffer,
 
 MemoryBuffer::MemoryBuffer(const MemoryBuffer &src) : MemoryBuffer(src.datatype_, src.rect_, false)
 {
+  BLI_assert(!src.is_half_storage());
   memory_proxy_ = src.memory_proxy_;
   /* src may be single elem buffer */
   fill_from(src);
@@ -171,6 +180,103 @@ MemoryBuffer::~MemoryBuffer()
     MEM_freeN(buffer_);
     buffer_ = nullptr;
   }
+  MEM_SAFE_FREE(half_buffer_);
+}
+
+/* Conversions are written without branches so that they can be vectorized. */
+
+static inline uint16_t float_to_half(const float value)
+{
+  constexpr uint32_t f32_infinity = 255u << 23;
+  constexpr uint32_t f16_overflow = (127u + 16u) << 23;
+  constexpr uint32_t f16_min_normal = 113u << 23;
+  constexpr uint32_t denormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t bits = float_as_uint(value);
+  const uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+
+  /* Overflow to infinity, NaN stays NaN. */
+  const uint32_t inf_nan = bits > f32_infinity ? 0x7e00u : 0x7c00u;
+  /* Denormals, rounded by the float addition. */
+  const uint32_t denormal = float_as_uint(uint_as_float(bits) + uint_as_float(denormal_magic)) -
+                            denormal_magic;
+  /* Normals, re-bias exponent and round to nearest even. */
+  const uint32_t normal = (bits + ((15u - 127u) << 23) + 0xfffu + ((bits >> 13) & 1u)) >> 13;
+
+  const uint32_t half = bits >= f16_overflow ? inf_nan :
+                                               (bits < f16_min_normal ? denormal : normal);
+  return uint16_t(half | (sign >> 16));
+}
+
+static inline float half_to_float(const uint16_t value)
+{
+  constexpr uint32_t shifted_exponent = 0x7c00u << 13;
+
+  uint32_t bits = uint32_t(value & 0x7fffu) << 13;
+  const uint32_t exponent = bits & shifted_exponent;
+  bits += (127u - 15u) << 23;
+
+  /* Infinity and NaN. */
+  const uint32_t inf_nan = bits + ((128u - 16u) << 23);
+  /* Denormals, renormalized by the float subtraction. */
+  const uint32_t denormal = float_as_uint(uint_as_float(bits + (1u << 23)) -
+                                          uint_as_float(113u << 23));
+
+  bits = exponent == shifted_exponent ? inf_nan : (exponent == 0 ? denormal : bits);
+  return uint_as_float(bits | (uint32_t(value & 0x8000u) << 16));
+}
+
+bool MemoryBuffer::convert_to_half_storage()
+{
+  BLI_assert(owns_data_ && !is_a_single_elem_ && !is_half_storage());
+  /* Largest finite half float. */
+  constexpr uint32_t half_max = 0x477fe000u;
+  constexpr uint32_t f32_infinity = 255u << 23;
+
+  const int64_t len = int64_t(buffer_len()) * num_channels_;
+  uint16_t *half_buffer = (uint16_t *)MEM_mallocN_aligned(
+      sizeof(uint16_t) * len, 16, "COM_MemoryBuffer_half");
+  const float *src = buffer_;
+  std::atomic<bool> out_of_range = false;
+  threading::parallel_for(IndexRange(len), 64 * 1024, [&](const IndexRange range) {
+    uint32_t range_out_of_range = 0;
+    for (const int64_t i : range) {
+      const uint32_t abs_bits = float_as_uint(src[i]) & 0x7fffffffu;
+      range_out_of_range |= uint32_t(abs_bits > half_max) & uint32_t(abs_bits < f32_infinity);
+      half_buffer[i] = float_to_half(src[i]);
+    }
+    if (range_out_of_range) {
+      out_of_range = true;
+    }
+  });
+
+  /* Finite values that half float can't represent would become infinite, keep floats. */
+  if (out_of_range) {
+    MEM_freeN(half_buffer);
+    return false;
+  }
+
+  half_buffer_ = half_buffer;
+  MEM_freeN(buffer_);
+  buffer_ = nullptr;
+  return true;
+}
+
+MemoryBuffer *MemoryBuffer::expand_half_storage(const rcti &rect) const
+{
+  BLI_assert(is_half_storage());
+  BLI_assert(BLI_rcti_size_x(&rect) == get_width() && BLI_rcti_size_y(&rect) == get_height());
+  MemoryBuffer *expanded = new MemoryBuffer(datatype_, rect);
+  const int64_t len = int64_t(buffer_len()) * num_channels_;
+  const uint16_t *src = half_buffer_;
+  float *dst = expanded->buffer_;
+  threading::parallel_for(IndexRange(len), 64 * 1024, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      dst[i] = half_to_float(src[i]);
+    }
+  });
+  return expanded;
 }
 
 void MemoryBuffer::copy_from(const MemoryBuffer *src, const rcti &area)
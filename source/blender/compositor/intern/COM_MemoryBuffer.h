@@ -86,6 +86,12 @@ class MemoryBuffer {
    */
   float *buffer_;
 
+  /**
+   * Elements in half float storage, used instead of #buffer_ when set. See
+   * #convert_to_half_storage.
+   */
+  uint16_t *half_buffer_;
+
   /**
    * \brief the number of channels of a single value in the buffer.
    * For value buffers this is 1, vector 3 and color 4
@@ -377,6 +383,27 @@ class MemoryBuffer {
    */
   MemoryBuffer *inflate() const;
 
+  /**
+   * Converts the elements to half float storage, halving the buffer memory. Elements can't be
+   * accessed anymore, only read by expanding the buffer with #expand_half_storage. Only for full
+   * size buffers owning their data.
+   *
+   * \return false when finite elements are outside of half float range, the buffer is kept in
+   * float then.
+   */
+  bool convert_to_half_storage();
+
+  bool is_half_storage() const
+  {
+    return half_buffer_ != nullptr;
+  }
+
+  /**
+   * Creates a float buffer with the elements of this half float storage buffer, placed at given
+   * rect of the same size. This buffer is not modified so that it may be expanded concurrently.
+   */
+  MemoryBuffer *expand_half_storage(const rcti &rect) const;
+
   inline void wrap_pixel(int &x, int &y, MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
   {
     const int w = get_width();
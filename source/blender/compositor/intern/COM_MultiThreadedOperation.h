@@ -21,6 +21,9 @@ class MultiThreadedOperation : public NodeOperation {
  protected:
   MultiThreadedOperation();
 
+  /* Renders the partial updates of the operations it fuses. */
+  friend class FusedPixelOperation;
+
   /**
    * Called before an update memory buffer pass is executed. Single-threaded calls.
    */
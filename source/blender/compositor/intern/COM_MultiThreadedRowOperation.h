@@ -14,6 +14,9 @@ namespace blender::compositor {
  * between inputs and output.
  */
 class MultiThreadedRowOperation : public MultiThreadedOperation {
+ public:
+  MultiThreadedRowOperation();
+
  protected:
   struct PixelCursor {
     float *out;
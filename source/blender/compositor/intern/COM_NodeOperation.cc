@@ -84,6 +84,50 @@ std::optional<NodeOperationHash> NodeOperation::generate_hash()
   return hash;
 }
 
+std::optional<size_t> NodeOperation::generate_result_key(const size_t seed)
+{
+  result_key_ = std::nullopt;
+  std::optional<NodeOperationHash> hash = generate_hash();
+  if (!hash) {
+    return std::nullopt;
+  }
+
+  /* Hash data that may change without any change in parameters. */
+  params_hash_ = 0;
+  if (!hash_external_data()) {
+    return std::nullopt;
+  }
+
+  size_t key = seed;
+  combine_hashes(key, hash->type_hash_);
+  combine_hashes(key, hash->params_hash_);
+  combine_hashes(key, params_hash_);
+  for (NodeOperationInput &socket : inputs_) {
+    if (!socket.is_connected()) {
+      combine_hashes(key, 0);
+      continue;
+    }
+
+    NodeOperation &input = socket.get_link()->get_operation();
+    if (input.get_flags().is_constant_operation) {
+      const float *elem = ((ConstantOperation *)&input)->get_constant_elem();
+      const int num_channels = COM_data_type_num_channels(socket.get_data_type());
+      for (const int i : IndexRange(num_channels)) {
+        combine_hashes(key, get_default_hash(elem[i]));
+      }
+    }
+    else if (input.result_key_) {
+      combine_hashes(key, *input.result_key_);
+    }
+    else {
+      return std::nullopt;
+    }
+  }
+
+  result_key_ = key;
+  return key;
+}
+
 NodeOperationOutput *NodeOperation::get_output_socket(unsigned int index)
 {
   return &outputs_[index];
@@ -490,6 +534,18 @@ std::ostream &operator<<(std::ostream &os, const NodeOperationFlags &node_operat
   if (node_operation_flags.can_be_constant) {
     os << "can_be_constant,";
   }
+  if (node_operation_flags.is_pixel_operation) {
+    os << "pixel_operation,";
+  }
+  if (node_operation_flags.use_result_cache) {
+    os << "use_result_cache,";
+  }
+  if (node_operation_flags.needs_full_precision_inputs) {
+    os << "needs_full_precision_inputs,";
+  }
+  if (node_operation_flags.use_half_storage) {
+    os << "use_half_storage,";
+  }
 
   return os;
 }
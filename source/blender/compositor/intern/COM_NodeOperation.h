@@ -237,6 +237,32 @@ struct NodeOperationFlags {
    */
   bool can_be_constant : 1;
 
+  /**
+   * Whether each output pixel only depends on the input pixels at the same coordinates and all
+   * the work is done in #MultiThreadedOperation::update_memory_buffer_partial. Connected pixel
+   * operations are fused into a #FusedPixelOperation in full frame execution model.
+   */
+  bool is_pixel_operation : 1;
+
+  /**
+   * Whether operation is expensive enough for its result to be kept across executions in the
+   * #ResultCache. Requires `hash_output_params` to be implemented by the operation and all its
+   * upstream operations. Only used in full frame execution model.
+   */
+  bool use_result_cache : 1;
+
+  /**
+   * Whether operation inputs are data that can't lose precision, such as cryptomatte hashes or
+   * motion vectors. Upstream operations output is then never stored in half float.
+   */
+  bool needs_full_precision_inputs : 1;
+
+  /**
+   * Whether operation output buffer is stored in half float while waiting for its readers, set
+   * by #NodeOperationBuilder. Only used in full frame execution model.
+   */
+  bool use_half_storage : 1;
+
   NodeOperationFlags()
   {
     complex = false;
@@ -255,6 +281,10 @@ struct NodeOperationFlags {
     is_fullframe_operation = false;
     is_constant_operation = false;
     can_be_constant = false;
+    is_pixel_operation = false;
+    use_result_cache = false;
+    needs_full_precision_inputs = false;
+    use_half_storage = false;
   }
 };
 
@@ -310,6 +340,9 @@ class NodeOperation {
   size_t params_hash_;
   bool is_hash_output_params_implemented_;
 
+  /** Identifies the operation result across executions, see #generate_result_key. */
+  std::optional<size_t> result_key_;
+
   /**
    * \brief the index of the input socket that will be used to determine the canvas
    */
@@ -390,6 +423,22 @@ class NodeOperation {
    */
   std::optional<NodeOperationHash> generate_hash();
 
+  /**
+   * Generate a key that identifies the operation result across executions, for the
+   * #ResultCache. Unlike #generate_hash, input data that may change between executions such as
+   * images and render passes are hashed too (see #hash_external_data) and linked inputs are
+   * identified by their own result key instead of their id. Keys of all linked non-constant
+   * inputs must have been generated first, otherwise `std::nullopt` is returned. Keys are 64-bit
+   * hashes, pointers are never hashed as they may be reused by other data.
+   * \param seed: Hash of execution settings that affect all operations results.
+   */
+  std::optional<size_t> generate_result_key(size_t seed);
+
+  std::optional<size_t> get_result_key() const
+  {
+    return result_key_;
+  }
+
   unsigned int get_number_of_input_sockets() const
   {
     return inputs_.size();
@@ -430,6 +479,11 @@ class NodeOperation {
     execution_model_ = model;
   }
 
+  void set_use_half_storage(const bool use_half_storage)
+  {
+    flags_.use_half_storage = use_half_storage;
+  }
+
   void set_bnodetree(const bNodeTree *tree)
   {
     btree_ = tree;
@@ -661,9 +715,20 @@ class NodeOperation {
     is_hash_output_params_implemented_ = false;
   }
 
+  /* Overridden by operations reading data that may change between executions without any
+   * change in their parameters, such as images and render passes. Implementations must hash a
+   * version of such data using `hash_params` methods, or return false when it has none. Only
+   * called when generating result keys. */
+  virtual bool hash_external_data()
+  {
+    return true;
+  }
+
   static void combine_hashes(size_t &combined, size_t other)
   {
-    combined = BLI_ghashutil_combine_hash(combined, other);
+    /* Same as #BLI_ghashutil_combine_hash without truncating to 32 bits, the #ResultCache
+     * identifies results by these hashes only. */
+    combined ^= other + size_t(0x9e3779b97f4a7c15) + (combined << 6) + (combined >> 2);
   }
 
   template<typename T> void hash_param(T param)
@@ -4,13 +4,17 @@
 #include <set>
 
 #include "BLI_multi_value_map.hh"
+#include "BLI_set.hh"
 
 #include "COM_Converter.h"
+#include "COM_CachedResultOperation.h"
 #include "COM_Debug.h"
 
 #include "COM_ExecutionGroup.h"
+#include "COM_FusedPixelOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
@@ -92,6 +96,15 @@ void NodeOperationBuilder::convert_to_operations(ExecutionSystem *system)
   save_graphviz("compositor_prior_merging");
   merge_equal_operations();
 
+  if (context_->get_execution_model() == eExecutionModel::FullFrame) {
+    apply_result_cache();
+
+    save_graphviz("compositor_prior_fusing");
+    fuse_pixel_operations();
+
+    determine_half_storage();
+  }
+
   if (context_->get_execution_model() == eExecutionModel::Tiled) {
     /* surround complex ops with read/write buffer */
     add_complex_operation_buffers();
@@ -498,6 +511,210 @@ void NodeOperationBuilder::merge_equal_operations(NodeOperation *from, NodeOpera
   delete from;
 }
 
+void NodeOperationBuilder::determine_half_storage()
+{
+  if (!context_->is_half_storage_enabled()) {
+    return;
+  }
+
+  /* Outputs upstream of operations needing full precision may be data rather than colors. */
+  Set<NodeOperation *> full_precision_ops;
+  Vector<NodeOperation *> stack;
+  for (NodeOperation *op : operations_) {
+    if (op->get_flags().needs_full_precision_inputs) {
+      stack.append(op);
+    }
+  }
+  while (!stack.is_empty()) {
+    NodeOperation *op = stack.pop_last();
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      if (input_op && full_precision_ops.add(input_op)) {
+        stack.append(input_op);
+      }
+    }
+  }
+
+  /* Half float keeps enough precision for colors, not for depth, vectors or values in general. */
+  for (NodeOperation *op : operations_) {
+    const bool is_color = op->get_number_of_output_sockets() > 0 &&
+                          op->get_output_socket()->get_data_type() == DataType::Color;
+    op->set_use_half_storage(is_color && !op->get_flags().is_constant_operation &&
+                             !op->is_output_operation(context_->is_rendering()) &&
+                             !full_precision_ops.contains(op));
+  }
+}
+
+void NodeOperationBuilder::apply_result_cache()
+{
+  const size_t seed = get_default_hash_2(context_->get_quality(),
+                                         context_->is_fast_calculation());
+
+  /* Generate keys of cached operations, after the keys of all their inputs. */
+  Vector<NodeOperation *> cached_ops;
+  Set<NodeOperation *> visited;
+  Vector<std::pair<NodeOperation *, bool>> stack;
+  for (NodeOperation *op : operations_) {
+    if (!op->get_flags().use_result_cache) {
+      continue;
+    }
+    cached_ops.append(op);
+
+    stack.append({op, false});
+    while (!stack.is_empty()) {
+      auto [current, inputs_added] = stack.pop_last();
+      if (inputs_added) {
+        current->generate_result_key(seed);
+        continue;
+      }
+      if (!visited.add(current)) {
+        continue;
+      }
+      stack.append({current, true});
+      for (int i = 0; i < current->get_number_of_input_sockets(); i++) {
+        NodeOperation *input_op = current->get_input_operation(i);
+        if (input_op && !visited.contains(input_op)) {
+          stack.append({input_op, false});
+        }
+      }
+    }
+  }
+
+  for (NodeOperation *op : cached_ops) {
+    const std::optional<size_t> key = op->get_result_key();
+    if (!key) {
+      continue;
+    }
+    std::shared_ptr<const MemoryBuffer> result = ResultCache::get().lookup(*key);
+    const DataType data_type = op->get_output_socket()->get_data_type();
+    if (!result || result->get_width() != op->get_width() ||
+        result->get_height() != op->get_height() ||
+        result->get_num_channels() != COM_data_type_num_channels(data_type)) {
+      continue;
+    }
+
+    /* Upstream operations no longer needed are removed when pruning. */
+    CachedResultOperation *cached_op = new CachedResultOperation(
+        data_type, op->get_canvas(), std::move(result));
+    add_operation(cached_op);
+    cached_op->set_name(op->get_name());
+    unlink_inputs_and_relink_outputs(op, cached_op);
+    operations_.remove_first_occurrence_and_reorder(op);
+    delete op;
+  }
+}
+
+void NodeOperationBuilder::fuse_pixel_operations()
+{
+  /* Operations whose output is only read by one input socket, mapped to its operation. */
+  Map<NodeOperation *, NodeOperation *> single_readers;
+  Set<NodeOperation *> multiple_readers;
+  for (const Link &link : links_) {
+    NodeOperation *from_op = &link.from()->get_operation();
+    if (multiple_readers.contains(from_op)) {
+      continue;
+    }
+    if (!single_readers.add(from_op, &link.to()->get_operation())) {
+      single_readers.remove(from_op);
+      multiple_readers.add(from_op);
+    }
+  }
+
+  /* Whether the result of given operation is only needed by given pixel operation, so that it can
+   * be computed in the same pass. */
+  auto is_fusable_into = [&](NodeOperation *op, NodeOperation *reader) {
+    return op->get_flags().is_pixel_operation &&
+           !op->is_output_operation(context_->is_rendering()) &&
+           single_readers.lookup_default(op, nullptr) == reader &&
+           BLI_rcti_compare(&op->get_canvas(), &reader->get_canvas());
+  };
+
+  /* Gather groups from the last operation of each one, adding stages after their inputs. */
+  Vector<Vector<NodeOperation *>> groups;
+  for (NodeOperation *op : operations_) {
+    if (!op->get_flags().is_pixel_operation) {
+      continue;
+    }
+    NodeOperation *reader = single_readers.lookup_default(op, nullptr);
+    if (reader && reader->get_flags().is_pixel_operation && is_fusable_into(op, reader)) {
+      continue;
+    }
+
+    Vector<NodeOperation *> stages;
+    Vector<std::pair<NodeOperation *, bool>> stack;
+    stack.append({op, false});
+    while (!stack.is_empty()) {
+      auto [stage, inputs_added] = stack.pop_last();
+      if (inputs_added) {
+        stages.append(stage);
+        continue;
+      }
+      stack.append({stage, true});
+      for (int i = stage->get_number_of_input_sockets() - 1; i >= 0; i--) {
+        NodeOperation *input_op = stage->get_input_operation(i);
+        if (is_fusable_into(input_op, stage)) {
+          stack.append({input_op, false});
+        }
+      }
+    }
+    if (stages.size() > 1) {
+      groups.append(std::move(stages));
+    }
+  }
+
+  for (Span<NodeOperation *> stages : groups) {
+    fuse_pixel_operations(stages);
+  }
+}
+
+void NodeOperationBuilder::fuse_pixel_operations(Span<NodeOperation *> stages)
+{
+  NodeOperation *last_stage = stages.last();
+  FusedPixelOperation *fused_op = new FusedPixelOperation(
+      last_stage->get_output_socket()->get_data_type());
+
+  /* Inputs not computed by the group become inputs of the fused operation. Stages keep their
+   * input links, so that they still get their socket readers. */
+  Vector<NodeOperationOutput *> fused_inputs_links;
+  for (NodeOperation *stage : stages) {
+    Vector<int> input_stages;
+    for (int i = 0; i < stage->get_number_of_input_sockets(); i++) {
+      const int input_stage = int(stages.first_index_try(stage->get_input_operation(i)));
+      if (input_stage == -1) {
+        fused_inputs_links.append(stage->get_input_socket(i)->get_link());
+      }
+      input_stages.append(input_stage);
+    }
+    fused_op->add_stage(static_cast<MultiThreadedOperation *>(stage), input_stages);
+  }
+
+  int i = 0;
+  while (i < links_.size()) {
+    Link &link = links_[i];
+    if (stages.contains(&link.to()->get_operation())) {
+      links_.remove(i);
+      continue;
+    }
+    if (&link.from()->get_operation() == last_stage) {
+      link.to()->set_link(fused_op->get_output_socket());
+      links_[i] = Link(fused_op->get_output_socket(), link.to());
+    }
+    i++;
+  }
+
+  for (NodeOperation *stage : stages) {
+    operations_.remove_first_occurrence_and_reorder(stage);
+  }
+  add_operation(fused_op);
+  fused_op->set_name(last_stage->get_name());
+  fused_op->set_canvas(last_stage->get_canvas());
+  for (const int input_index : fused_inputs_links.index_range()) {
+    add_link(fused_inputs_links[input_index], fused_op->get_input_socket(input_index));
+  }
+
+  DebugInfo::operations_fused(fused_op);
+}
+
 Vector<NodeOperationInput *> NodeOperationBuilder::cache_output_links(
     NodeOperationOutput *output) const
 {
@@ -157,6 +157,17 @@ class NodeOperationBuilder {
   /** Merge operations with same type, inputs and parameters that produce the same result. */
   void merge_equal_operations();
   void merge_equal_operations(NodeOperation *from, NodeOperation *into);
+  /** Replace operations whose result is stored in the #ResultCache by a previous execution. */
+  void apply_result_cache();
+  /** Fuse connected pixel operations so that they are rendered together without full buffers for
+   * intermediate results. */
+  void fuse_pixel_operations();
+  void fuse_pixel_operations(Span<NodeOperation *> stages);
+  /**
+   * Choose the operations whose output buffers can be stored in half float, when enabled in the
+   * node tree.
+   */
+  void determine_half_storage();
   void save_graphviz(StringRefNull name = "");
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:NodeCompilerImpl")
@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "COM_ResultCache.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_defines.h"
+
+namespace blender::compositor {
+
+ResultCache &ResultCache::get()
+{
+  static ResultCache cache;
+  return cache;
+}
+
+std::shared_ptr<const MemoryBuffer> ResultCache::lookup(const size_t key)
+{
+  std::lock_guard lock(mutex_);
+  Entry *entry = entries_.lookup_ptr(key);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  entry->last_use = ++use_counter_;
+  return entry->buffer;
+}
+
+void ResultCache::add(const size_t key, const MemoryBuffer &result)
+{
+  const size_t bytes = size_t(result.get_width()) * result.get_height() *
+                       result.get_num_channels() * sizeof(float);
+  if (bytes > COM_RESULT_CACHE_MEMORY_BUDGET) {
+    return;
+  }
+
+  /* Copy outside the lock, results are large. */
+  std::shared_ptr<const MemoryBuffer> buffer = std::make_shared<MemoryBuffer>(result);
+
+  std::lock_guard lock(mutex_);
+  if (entries_.contains(key)) {
+    return;
+  }
+  free_least_recently_used(bytes);
+  entries_.add_new(key, {std::move(buffer), bytes, ++use_counter_});
+  used_bytes_ += bytes;
+}
+
+void ResultCache::clear()
+{
+  std::lock_guard lock(mutex_);
+  entries_.clear();
+  used_bytes_ = 0;
+}
+
+void ResultCache::free_least_recently_used(const size_t bytes_needed)
+{
+  while (used_bytes_ + bytes_needed > COM_RESULT_CACHE_MEMORY_BUDGET && !entries_.is_empty()) {
+    const size_t *oldest_key = nullptr;
+    uint64_t oldest_use = UINT64_MAX;
+    for (const auto item : entries_.items()) {
+      if (item.value.last_use < oldest_use) {
+        oldest_use = item.value.last_use;
+        oldest_key = &item.key;
+      }
+    }
+    /* Buffers still in use by a running execution are freed when it releases them. */
+    used_bytes_ -= entries_.pop(*oldest_key).bytes;
+  }
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "BLI_map.hh"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+
+/**
+ * Keeps results of expensive operations (see #NodeOperationFlags::use_result_cache) across
+ * compositor executions, so that editing nodes downstream of them doesn't render them again.
+ *
+ * Results are identified by a key generated from the operation and all its upstream operations
+ * parameters and input data versions (see #NodeOperation::generate_result_key). The least
+ * recently used results are discarded when exceeding #COM_RESULT_CACHE_MEMORY_BUDGET.
+ *
+ * Only used in full frame execution model. Thread-safe.
+ */
+class ResultCache {
+ private:
+  struct Entry {
+    std::shared_ptr<const MemoryBuffer> buffer;
+    size_t bytes;
+    uint64_t last_use;
+  };
+
+  Map<size_t, Entry> entries_;
+  size_t used_bytes_ = 0;
+  uint64_t use_counter_ = 0;
+  std::mutex mutex_;
+
+ public:
+  static ResultCache &get();
+
+  /**
+   * Get the result stored for given key, if any.
+   */
+  std::shared_ptr<const MemoryBuffer> lookup(size_t key);
+
+  /**
+   * Stores a copy of given result. Results larger than the whole budget are not stored.
+   */
+  void add(size_t key, const MemoryBuffer &result);
+
+  /**
+   * Discards all stored results.
+   */
+  void clear();
+
+ private:
+  void free_least_recently_used(size_t bytes_needed);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:ResultCache")
+#endif
+};
+
+}  // namespace blender::compositor
@@ -79,7 +79,7 @@ MemoryBuffer *SharedOperationBuffers::get_rendered_buffer(NodeOperation *op)
   return get_buffer_data(op).buffer.get();
 }
 
-void SharedOperationBuffers::read_finished(NodeOperation *read_op)
+bool SharedOperationBuffers::read_finished(NodeOperation *read_op)
 {
   BufferData &buf_data = get_buffer_data(read_op);
   buf_data.received_reads++;
@@ -87,7 +87,9 @@ void SharedOperationBuffers::read_finished(NodeOperation *read_op)
   if (buf_data.received_reads == buf_data.registered_reads) {
     /* Dispose buffer. */
     buf_data.buffer = nullptr;
+    return true;
   }
+  return false;
 }
 
 }  // namespace blender::compositor
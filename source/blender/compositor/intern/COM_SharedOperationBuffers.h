@@ -20,6 +20,9 @@ class NodeOperation;
 /**
  * Stores and shares operations rendered buffers including render data. Buffers are
  * disposed once all dependent operations have finished reading them.
+ *
+ * Operations may be rendered concurrently once all of them are registered, as long as calls to
+ * #read_finished are serialized by the caller.
  */
 class SharedOperationBuffers {
  private:
@@ -74,8 +77,10 @@ class SharedOperationBuffers {
   /**
    * Reports an operation has finished reading given operation. If all given operation dependencies
    * have finished its buffer will be disposed.
+   *
+   * \return Whether the buffer has been disposed.
    */
-  void read_finished(NodeOperation *read_op);
+  bool read_finished(NodeOperation *read_op);
 
  private:
   BufferData &get_buffer_data(NodeOperation *op);
@@ -9,6 +9,7 @@
 #include "BKE_scene.h"
 
 #include "COM_ExecutionSystem.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.h"
 
@@ -100,8 +101,15 @@ void COM_deinitialize()
   if (g_compositor.is_initialized) {
     BLI_mutex_lock(&g_compositor.mutex);
     blender::compositor::WorkScheduler::deinitialize();
+    COM_clear_caches();
     g_compositor.is_initialized = false;
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
   }
 }
+
+void COM_clear_caches()
+{
+  /* Results still used by a running execution are freed when it releases them. */
+  blender::compositor::ResultCache::get().clear();
+}
@@ -3,6 +3,7 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "COM_ConstantOperation.h"
+#include "COM_FFTConvolution.h"
 
 #include "COM_OpenCLDevice.h"
 
@@ -23,6 +24,7 @@ BokehBlurOperation::BokehBlurOperation()
 
   flags_.complex = true;
   flags_.open_cl = true;
+  flags_.use_result_cache = true;
 
   size_ = 1.0f;
   sizeavailable_ = false;
@@ -248,6 +250,12 @@ void BokehBlurOperation::update_size()
   sizeavailable_ = true;
 }
 
+void BokehBlurOperation::hash_output_params()
+{
+  hash_params(size_, sizeavailable_, extend_bounds_);
+  hash_param(get_quality());
+}
+
 void BokehBlurOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
 {
   if (!extend_bounds_) {
@@ -306,12 +314,50 @@ void BokehBlurOperation::get_area_of_interest(const int input_idx,
   }
 }
 
+int BokehBlurOperation::get_pixel_size() const
+{
+  const float max_dim = MAX2(this->get_width(), this->get_height());
+  return size_ * max_dim / 100.0f;
+}
+
+void BokehBlurOperation::update_memory_buffer_started(MemoryBuffer *UNUSED(output),
+                                                      const rcti &area,
+                                                      Span<MemoryBuffer *> inputs)
+{
+  const int pixel_size = get_pixel_size();
+  const int kernel_size = 2 * pixel_size + 1;
+  if (kernel_size < COM_FFT_CONVOLUTION_MIN_KERNEL_SIZE) {
+    return;
+  }
+
+  /* Bokeh sampled at the kernel pixels, reversed as #update_memory_buffer_partial reads it from
+   * the blurred pixel. Kernel element `pixel_size - d` weights the pixel at offset `d`. The direct
+   * loop reads offsets `[-pixel_size, pixel_size)`, so the first row and column (offset
+   * `pixel_size`) are left cleared to cover exactly the same pixels. */
+  const MemoryBuffer *bokeh_input = inputs[BOKEH_INPUT_INDEX];
+  const float m = bokehDimension_ / pixel_size;
+  rcti kernel_rect;
+  BLI_rcti_init(&kernel_rect, 0, kernel_size, 0, kernel_size);
+  MemoryBuffer kernel(DataType::Color, kernel_rect);
+  kernel.clear();
+  for (int y = 1; y < kernel_size; y++) {
+    const float v = bokeh_mid_y_ + (y - pixel_size) * m;
+    for (int x = 1; x < kernel_size; x++) {
+      const float u = bokeh_mid_x_ + (x - pixel_size) * m;
+      bokeh_input->read_elem_checked(u, v, kernel.get_elem(x, y));
+    }
+  }
+
+  fft_result_ = std::make_unique<MemoryBuffer>(DataType::Color, area);
+  convolve_fft_normalized(
+      *inputs[IMAGE_INPUT_INDEX], kernel, COM_DATA_TYPE_COLOR_CHANNELS, *fft_result_);
+}
+
 void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                       const rcti &area,
                                                       Span<MemoryBuffer *> inputs)
 {
-  const float max_dim = MAX2(this->get_width(), this->get_height());
-  const int pixel_size = size_ * max_dim / 100.0f;
+  const int pixel_size = get_pixel_size();
   const float m = bokehDimension_ / pixel_size;
 
   const MemoryBuffer *image_input = inputs[IMAGE_INPUT_INDEX];
@@ -328,6 +374,11 @@ void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
       continue;
     }
 
+    if (fft_result_) {
+      fft_result_->read_elem(x, y, it.out);
+      continue;
+    }
+
     float color_accum[4] = {0};
     float multiplier_accum[4] = {0};
     if (pixel_size < 2) {
@@ -363,4 +414,11 @@ void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
   }
 }
 
+void BokehBlurOperation::update_memory_buffer_finished(MemoryBuffer *UNUSED(output),
+                                                       const rcti &UNUSED(area),
+                                                       Span<MemoryBuffer *> UNUSED(inputs))
+{
+  fft_result_.reset();
+}
+
 }  // namespace blender::compositor
@@ -130,6 +130,12 @@ void BokehImageOperation::deinit_execution()
   }
 }
 
+void BokehImageOperation::hash_output_params()
+{
+  hash_params(data_->angle, data_->flaps, data_->rounding);
+  hash_params(data_->catadioptric, data_->lensshift);
+}
+
 void BokehImageOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
 {
   BLI_rcti_init(&r_area,
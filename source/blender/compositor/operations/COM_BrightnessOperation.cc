@@ -14,6 +14,7 @@ BrightnessOperation::BrightnessOperation()
   input_program_ = nullptr;
   use_premultiply_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 void BrightnessOperation::set_use_premultiply(bool use_premultiply)
@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "COM_CachedResultOperation.h"
+
+namespace blender::compositor {
+
+CachedResultOperation::CachedResultOperation(const DataType data_type,
+                                             const rcti &canvas,
+                                             std::shared_ptr<const MemoryBuffer> result)
+    : result_(std::move(result))
+{
+  BLI_assert(BLI_rcti_size_x(&canvas) == result_->get_width() &&
+             BLI_rcti_size_y(&canvas) == result_->get_height());
+  this->add_output_socket(data_type);
+  this->set_canvas(canvas);
+}
+
+void CachedResultOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         Span<MemoryBuffer *> UNUSED(inputs))
+{
+  /* Both buffers have the output offsets of their executions, which may differ. */
+  const rcti &output_rect = output->get_rect();
+  const rcti &result_rect = result_->get_rect();
+  rcti result_area = area;
+  BLI_rcti_translate(
+      &result_area, result_rect.xmin - output_rect.xmin, result_rect.ymin - output_rect.ymin);
+  output->copy_from(result_.get(), result_area, area.xmin, area.ymin);
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+#include "COM_MultiThreadedOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Outputs a result stored in the #ResultCache by a previous execution, replacing the operation
+ * that rendered it and all its upstream operations.
+ *
+ * Created by #NodeOperationBuilder, only in full frame execution model.
+ */
+class CachedResultOperation : public MultiThreadedOperation {
+ private:
+  std::shared_ptr<const MemoryBuffer> result_;
+
+ public:
+  /**
+   * \param canvas: Canvas of the replaced operation, the result must have its size.
+   */
+  CachedResultOperation(DataType data_type,
+                        const rcti &canvas,
+                        std::shared_ptr<const MemoryBuffer> result);
+
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+};
+
+}  // namespace blender::compositor
@@ -29,7 +29,7 @@ float ConvertDepthToRadiusOperation::determine_focal_distance()
   return 10.0f;
 }
 
-void ConvertDepthToRadiusOperation::init_execution()
+void ConvertDepthToRadiusOperation::update_lens_data(const int width, const int height)
 {
   float cam_sensor = DEFAULT_SENSOR_WIDTH;
   Camera *camera = nullptr;
@@ -39,17 +39,14 @@ void ConvertDepthToRadiusOperation::init_execution()
     cam_sensor = BKE_camera_sensor_size(camera->sensor_fit, camera->sensor_x, camera->sensor_y);
   }
 
-  input_operation_ = this->get_input_socket_reader(0);
   float focal_distance = determine_focal_distance();
   if (focal_distance == 0.0f) {
     focal_distance = 1e10f; /* If the DOF is 0.0 then set it to be far away. */
   }
   inverse_focal_distance_ = 1.0f / focal_distance;
-  aspect_ = (this->get_width() > this->get_height()) ?
-                (this->get_height() / (float)this->get_width()) :
-                (this->get_width() / (float)this->get_height());
+  aspect_ = (width > height) ? (height / (float)width) : (width / (float)height);
   aperture_ = 0.5f * (cam_lens_ / (aspect_ * cam_sensor)) / f_stop_;
-  const float minsz = MIN2(get_width(), get_height());
+  const float minsz = MIN2(width, height);
   dof_sp_ = minsz / ((cam_sensor / 2.0f) /
                      cam_lens_); /* <- == `aspect * MIN2(img->x, img->y) / tan(0.5f * fov)` */
 
@@ -58,6 +55,31 @@ void ConvertDepthToRadiusOperation::init_execution()
   }
 }
 
+void ConvertDepthToRadiusOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
+{
+  NodeOperation::determine_canvas(preferred_area, r_area);
+  if (execution_model_ == eExecutionModel::FullFrame && !BLI_rcti_is_empty(&r_area)) {
+    /* Lens data must be known when hashing, post blur operation is hashed with its size too. Equal
+     * post blur operations may be merged afterwards, so they are not accessed in execution. */
+    update_lens_data(BLI_rcti_size_x(&r_area), BLI_rcti_size_y(&r_area));
+    blur_post_operation_ = nullptr;
+  }
+}
+
+void ConvertDepthToRadiusOperation::init_execution()
+{
+  input_operation_ = this->get_input_socket_reader(0);
+  if (execution_model_ == eExecutionModel::Tiled) {
+    update_lens_data(get_width(), get_height());
+  }
+}
+
+void ConvertDepthToRadiusOperation::hash_output_params()
+{
+  hash_params(max_radius_, inverse_focal_distance_, aperture_);
+  hash_param(dof_sp_);
+}
+
 void ConvertDepthToRadiusOperation::execute_pixel_sampled(float output[4],
                                                           float x,
                                                           float y,
@@ -69,9 +69,21 @@ class ConvertDepthToRadiusOperation : public MultiThreadedOperation {
     blur_post_operation_ = operation;
   }
 
+  void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
+
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
+
+ protected:
+  void hash_output_params() override;
+
+ private:
+  /**
+   * Computes the data needed to convert depth to radius for given canvas size, also setting the
+   * size of the post blur operation.
+   */
+  void update_lens_data(int width, int height);
 };
 
 }  // namespace blender::compositor
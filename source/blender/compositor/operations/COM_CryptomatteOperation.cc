@@ -13,6 +13,7 @@ CryptomatteOperation::CryptomatteOperation(size_t num_inputs)
   }
   this->add_output_socket(DataType::Color);
   flags_.complex = true;
+  flags_.needs_full_precision_inputs = true;
 }
 
 void CryptomatteOperation::init_execution()
@@ -114,6 +114,7 @@ class DenoiseFilter {
 DenoiseBaseOperation::DenoiseBaseOperation()
 {
   flags_.is_fullframe_operation = true;
+  flags_.use_result_cache = true;
   output_rendered_ = false;
 }
 
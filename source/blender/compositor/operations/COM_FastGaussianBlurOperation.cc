@@ -387,6 +387,11 @@ void *FastGaussianBlurValueOperation::initialize_tile_data(rcti *rect)
   return iirgaus_;
 }
 
+void FastGaussianBlurValueOperation::hash_output_params()
+{
+  hash_params(sigma_, overlay_);
+}
+
 void FastGaussianBlurValueOperation::get_area_of_interest(const int UNUSED(input_idx),
                                                           const rcti &UNUSED(output_area),
                                                           rcti &r_input_area)
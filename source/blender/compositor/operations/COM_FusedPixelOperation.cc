@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "PIL_time.h"
+
+#include "COM_Debug.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_FusedPixelOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Number of pixels rendered by all stages before moving to the next strip. Small enough for the
+ * intermediate results to stay in cache, strips are at least a row high.
+ */
+constexpr int STRIP_PIXELS = 4096;
+
+FusedPixelOperation::FusedPixelOperation(const DataType output_data_type)
+{
+  this->add_output_socket(output_data_type);
+  update_start_time_ = 0.0;
+}
+
+FusedPixelOperation::~FusedPixelOperation()
+{
+  for (Stage &stage : stages_) {
+    delete stage.operation;
+  }
+}
+
+void FusedPixelOperation::add_stage(MultiThreadedOperation *operation, Span<int> input_stages)
+{
+  BLI_assert(operation->get_flags().is_pixel_operation);
+  BLI_assert(input_stages.size() == operation->get_number_of_input_sockets());
+
+  Stage stage;
+  stage.operation = operation;
+  for (const int i : input_stages.index_range()) {
+    StageInput input;
+    if (input_stages[i] == -1) {
+      this->add_input_socket(operation->get_input_socket(i)->get_data_type(), ResizeMode::None);
+      input.is_stage_result = false;
+      input.index = this->get_number_of_input_sockets() - 1;
+    }
+    else {
+      BLI_assert(input_stages[i] < stages_.size());
+      input.is_stage_result = true;
+      input.index = input_stages[i];
+    }
+    stage.inputs.append(input);
+  }
+  stages_.append(std::move(stage));
+}
+
+size_t FusedPixelOperation::get_saved_buffers_bytes() const
+{
+  size_t bytes = 0;
+  for (const Stage &stage : stages_.as_span().drop_back(1)) {
+    const DataType data_type = stage.operation->get_output_socket()->get_data_type();
+    bytes += size_t(stage.operation->get_width()) * stage.operation->get_height() *
+             COM_data_type_bytes_len(data_type);
+  }
+  return bytes;
+}
+
+void FusedPixelOperation::init_data()
+{
+  for (Stage &stage : stages_) {
+    stage.operation->init_data();
+  }
+}
+
+void FusedPixelOperation::init_execution()
+{
+  for (Stage &stage : stages_) {
+    stage.operation->init_execution();
+  }
+}
+
+void FusedPixelOperation::deinit_execution()
+{
+  for (Stage &stage : stages_) {
+    stage.operation->deinit_execution();
+  }
+}
+
+Vector<MemoryBuffer *> FusedPixelOperation::get_stage_inputs(
+    const Stage &stage,
+    Span<MemoryBuffer *> inputs,
+    Span<std::unique_ptr<MemoryBuffer>> stage_results)
+{
+  Vector<MemoryBuffer *> stage_inputs;
+  for (const StageInput &input : stage.inputs) {
+    stage_inputs.append(input.is_stage_result ? stage_results[input.index].get() :
+                                                inputs[input.index]);
+  }
+  return stage_inputs;
+}
+
+void FusedPixelOperation::update_memory_buffer_started(MemoryBuffer *UNUSED(output),
+                                                       const rcti &UNUSED(area),
+                                                       Span<MemoryBuffer *> UNUSED(inputs))
+{
+  if (COM_REPORT_FUSED_OPERATIONS) {
+    update_start_time_ = PIL_check_seconds_timer();
+  }
+}
+
+void FusedPixelOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                       const rcti &area,
+                                                       Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  const int strip_height = std::max(STRIP_PIXELS / std::max(width, 1), 1);
+
+  /* Intermediate results memory, reused for all strips. */
+  Array<Array<float>> strips_data(stages_.size() - 1);
+  for (const int i : strips_data.index_range()) {
+    const DataType data_type = stages_[i].operation->get_output_socket()->get_data_type();
+    strips_data[i].reinitialize(width * strip_height * COM_data_type_num_channels(data_type));
+  }
+
+  Array<std::unique_ptr<MemoryBuffer>> stage_results(stages_.size());
+  for (int y = area.ymin; y < area.ymax; y += strip_height) {
+    rcti strip;
+    BLI_rcti_init(&strip, area.xmin, area.xmax, y, std::min(y + strip_height, area.ymax));
+    for (const int i : stages_.index_range()) {
+      const Stage &stage = stages_[i];
+      MemoryBuffer *stage_output = output;
+      if (i < stages_.size() - 1) {
+        const DataType data_type = stage.operation->get_output_socket()->get_data_type();
+        stage_results[i] = std::make_unique<MemoryBuffer>(
+            strips_data[i].data(), COM_data_type_num_channels(data_type), strip);
+        stage_output = stage_results[i].get();
+      }
+      Vector<MemoryBuffer *> stage_inputs = get_stage_inputs(stage, inputs, stage_results);
+      stage.operation->update_memory_buffer_partial(stage_output, strip, stage_inputs);
+    }
+  }
+}
+
+void FusedPixelOperation::update_memory_buffer_finished(MemoryBuffer *UNUSED(output),
+                                                        const rcti &area,
+                                                        Span<MemoryBuffer *> inputs)
+{
+  if (COM_REPORT_FUSED_OPERATIONS) {
+    const double fused_time = PIL_check_seconds_timer() - update_start_time_;
+    const double unfused_time = render_unfused(area, inputs);
+    DebugInfo::fused_operation_rendered(this, fused_time, unfused_time);
+  }
+}
+
+double FusedPixelOperation::render_unfused(const rcti &area, Span<MemoryBuffer *> inputs)
+{
+  const double start_time = PIL_check_seconds_timer();
+  Array<std::unique_ptr<MemoryBuffer>> stage_results(stages_.size());
+  for (const int i : stages_.index_range()) {
+    const Stage &stage = stages_[i];
+    const DataType data_type = stage.operation->get_output_socket()->get_data_type();
+    stage_results[i] = std::make_unique<MemoryBuffer>(data_type, area);
+    Vector<MemoryBuffer *> stage_inputs = get_stage_inputs(stage, inputs, stage_results);
+    MemoryBuffer *stage_output = stage_results[i].get();
+    exec_system_->execute_work(area, [&](const rcti &split_rect) {
+      stage.operation->update_memory_buffer_partial(stage_output, split_rect, stage_inputs);
+    });
+  }
+  return PIL_check_seconds_timer() - start_time;
+}
+
+}  // namespace blender::compositor
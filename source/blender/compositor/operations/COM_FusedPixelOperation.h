@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+#include "COM_MultiThreadedOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Renders a group of pixel operations (see #NodeOperationFlags::is_pixel_operation) together, a
+ * strip of rows at a time. Results of intermediate stages are kept in strip sized buffers instead
+ * of full canvas buffers, saving their memory and the bandwidth of writing and reading them back.
+ *
+ * Created by #NodeOperationBuilder, only in full frame execution model.
+ */
+class FusedPixelOperation : public MultiThreadedOperation {
+ private:
+  /** Where a stage input is read from. */
+  struct StageInput {
+    /** Whether the input is the result of a previous stage or an input of this operation. */
+    bool is_stage_result;
+    int index;
+  };
+
+  struct Stage {
+    MultiThreadedOperation *operation;
+    Vector<StageInput> inputs;
+  };
+
+  /** Stages in execution order, the last one writes the output. */
+  Vector<Stage> stages_;
+
+  /** Start time of the current update, only used for debug reports. */
+  double update_start_time_;
+
+ public:
+  FusedPixelOperation(DataType output_data_type);
+  ~FusedPixelOperation();
+
+  /**
+   * Adds given operation as the next stage, taking ownership of it. Each of its inputs is read
+   * from the result of the previous stage in `input_stages` or from a new input socket of this
+   * operation when the stage index is -1. New input sockets are added in order.
+   */
+  void add_stage(MultiThreadedOperation *operation, Span<int> input_stages);
+
+  int get_num_stages() const
+  {
+    return stages_.size();
+  }
+
+  /**
+   * Memory of the intermediate stages results that would have been full canvas buffers.
+   */
+  size_t get_saved_buffers_bytes() const;
+
+  void init_data() override;
+  void init_execution() override;
+  void deinit_execution() override;
+
+ protected:
+  void update_memory_buffer_started(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+  void update_memory_buffer_finished(MemoryBuffer *output,
+                                     const rcti &area,
+                                     Span<MemoryBuffer *> inputs) override;
+
+ private:
+  Vector<MemoryBuffer *> get_stage_inputs(const Stage &stage,
+                                          Span<MemoryBuffer *> inputs,
+                                          Span<std::unique_ptr<MemoryBuffer>> stage_results);
+  /**
+   * Renders the stages one after the other with full buffers, as if they weren't fused.
+   * Returns the time it took, only used for debug reports.
+   */
+  double render_unfused(const rcti &area, Span<MemoryBuffer *> inputs);
+};
+
+}  // namespace blender::compositor
@@ -76,6 +76,10 @@ void GammaCorrectOperation::deinit_execution()
   input_program_ = nullptr;
 }
 
+void GammaCorrectOperation::hash_output_params()
+{
+}
+
 GammaUncorrectOperation::GammaUncorrectOperation()
 {
   this->add_input_socket(DataType::Color);
@@ -146,4 +150,8 @@ void GammaUncorrectOperation::deinit_execution()
   input_program_ = nullptr;
 }
 
+void GammaUncorrectOperation::hash_output_params()
+{
+}
+
 }  // namespace blender::compositor
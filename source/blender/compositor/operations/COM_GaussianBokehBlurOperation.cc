@@ -2,6 +2,7 @@
  * Copyright 2011 Blender Foundation. */
 
 #include "COM_GaussianBokehBlurOperation.h"
+#include "COM_FFTConvolution.h"
 
 #include "RE_pipeline.h"
 
@@ -212,10 +213,32 @@ void GaussianBokehBlurOperation::get_area_of_interest(const int input_idx,
   r_input_area.ymin = output_area.ymin - rady_;
 }
 
+void GaussianBokehBlurOperation::update_memory_buffer_started(MemoryBuffer *UNUSED(output),
+                                                              const rcti &area,
+                                                              Span<MemoryBuffer *> inputs)
+{
+  const int kernel_width = 2 * radx_ + 1;
+  const int kernel_height = 2 * rady_ + 1;
+  if (MAX2(kernel_width, kernel_height) < COM_FFT_CONVOLUTION_MIN_KERNEL_SIZE) {
+    return;
+  }
+
+  /* Filter is symmetric, no need to reverse it. */
+  MemoryBuffer kernel(gausstab_, COM_DATA_TYPE_VALUE_CHANNELS, kernel_width, kernel_height);
+  fft_result_ = std::make_unique<MemoryBuffer>(DataType::Color, area);
+  convolve_fft_normalized(
+      *inputs[IMAGE_INPUT_INDEX], kernel, COM_DATA_TYPE_COLOR_CHANNELS, *fft_result_);
+}
+
 void GaussianBokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                               const rcti &area,
                                                               Span<MemoryBuffer *> inputs)
 {
+  if (fft_result_) {
+    output->copy_from(fft_result_.get(), area);
+    return;
+  }
+
   const MemoryBuffer *input = inputs[IMAGE_INPUT_INDEX];
   BuffersIterator<float> it = output->iterate_with({}, area);
   const rcti &input_rect = input->get_rect();
@@ -249,6 +272,13 @@ void GaussianBokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *outp
   }
 }
 
+void GaussianBokehBlurOperation::update_memory_buffer_finished(MemoryBuffer *UNUSED(output),
+                                                               const rcti &UNUSED(area),
+                                                               Span<MemoryBuffer *> UNUSED(inputs))
+{
+  fft_result_.reset();
+}
+
 // reference image
 GaussianBlurReferenceOperation::GaussianBlurReferenceOperation()
     : BlurBaseOperation(DataType::Color)
@@ -17,6 +17,9 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
   float radyf_;
   void update_gauss();
 
+  /** Image convolved with the filter in the update area, when using FFT convolution. */
+  std::unique_ptr<MemoryBuffer> fft_result_;
+
  public:
   GaussianBokehBlurOperation();
   void init_data() override;
@@ -37,9 +40,15 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
                                             rcti *output) override;
 
   void get_area_of_interest(int input_idx, const rcti &output_area, rcti &r_input_area) override;
+  void update_memory_buffer_started(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
+  void update_memory_buffer_finished(MemoryBuffer *output,
+                                     const rcti &area,
+                                     Span<MemoryBuffer *> inputs) override;
 };
 
 class GaussianBlurReferenceOperation : public BlurBaseOperation {
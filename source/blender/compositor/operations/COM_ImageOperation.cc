@@ -103,6 +103,22 @@ void BaseImageOperation::determine_canvas(const rcti &UNUSED(preferred_area), rc
   BKE_image_release_ibuf(image_, stackbuf, nullptr);
 }
 
+void BaseImageOperation::hash_output_params()
+{
+  hash_params(image_ ? image_->id.session_uuid : 0, image_user_->framenr, image_user_->layer);
+  hash_params(image_user_->view, StringRef(view_name_));
+}
+
+bool BaseImageOperation::hash_external_data()
+{
+  /* Render results and viewers are written without marking image updates. */
+  if (image_ == nullptr || ELEM(image_->type, IMA_TYPE_R_RESULT, IMA_TYPE_COMPOSITE)) {
+    return false;
+  }
+  hash_param(BKE_image_partial_update_id(image_));
+  return true;
+}
+
 static void sample_image_at_location(
     ImBuf *ibuf, float x, float y, PixelSampler sampler, bool make_linear_rgb, float color[4])
 {
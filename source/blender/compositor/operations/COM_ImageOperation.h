@@ -41,6 +41,13 @@ class BaseImageOperation : public MultiThreadedOperation {
    */
   void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
 
+  void hash_output_params() override;
+  /**
+   * Image buffers change without any change in parameters when painted or reloaded, identify
+   * them by the image update id.
+   */
+  bool hash_external_data() override;
+
   virtual ImBuf *get_im_buf();
 
  public:
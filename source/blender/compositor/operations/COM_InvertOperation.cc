@@ -16,6 +16,7 @@ InvertOperation::InvertOperation()
   alpha_ = false;
   set_canvas_input_index(1);
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 void InvertOperation::init_execution()
 {
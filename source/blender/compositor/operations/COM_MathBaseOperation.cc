@@ -18,6 +18,7 @@ MathBaseOperation::MathBaseOperation()
   input_value3_operation_ = nullptr;
   use_clamp_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 void MathBaseOperation::init_execution()
@@ -49,6 +50,11 @@ void MathBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_are
   NodeOperation::determine_canvas(preferred_area, r_area);
 }
 
+void MathBaseOperation::hash_output_params()
+{
+  hash_param(use_clamp_);
+}
+
 void MathBaseOperation::clamp_if_needed(float *color)
 {
   if (use_clamp_) {
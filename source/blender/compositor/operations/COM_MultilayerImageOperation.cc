@@ -35,6 +35,13 @@ ImBuf *MultilayerBaseOperation::get_im_buf()
   return nullptr;
 }
 
+void MultilayerBaseOperation::hash_output_params()
+{
+  BaseImageOperation::hash_output_params();
+  hash_params(render_layer_, render_pass_);
+  hash_params(pass_id_, view_);
+}
+
 void MultilayerBaseOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                            const rcti &area,
                                                            Span<MemoryBuffer *> UNUSED(inputs))
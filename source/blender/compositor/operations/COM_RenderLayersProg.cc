@@ -196,6 +196,32 @@ void RenderLayersProg::determine_canvas(const rcti &UNUSED(preferred_area), rcti
   }
 }
 
+void RenderLayersProg::hash_output_params()
+{
+  hash_params(scene_ ? scene_->id.session_uuid : 0, layer_id_, StringRef(view_name_));
+  hash_params(pass_name_, elementsize_);
+}
+
+bool RenderLayersProg::hash_external_data()
+{
+  Scene *scene = this->get_scene();
+  Render *re = (scene) ? RE_GetSceneRender(scene) : nullptr;
+  RenderResult *rr = nullptr;
+
+  if (re) {
+    rr = RE_AcquireResultRead(re);
+  }
+
+  /* Results never tagged aren't rendered yet, their passes may still change. */
+  const bool is_identified = rr == nullptr || rr->update_id != 0;
+  hash_param(rr ? rr->update_id : 0);
+
+  if (re) {
+    RE_ReleaseResult(re);
+  }
+  return is_identified;
+}
+
 std::unique_ptr<MetaData> RenderLayersProg::get_meta_data()
 {
   Scene *scene = this->get_scene();
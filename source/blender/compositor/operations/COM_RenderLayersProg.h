@@ -60,6 +60,13 @@ class RenderLayersProg : public MultiThreadedOperation {
    */
   void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
 
+  void hash_output_params() override;
+  /**
+   * Render passes change without any change in parameters when rendering again, identify them by
+   * the render result update id.
+   */
+  bool hash_external_data() override;
+
   /**
    * retrieve the reference to the float buffer of the renderer.
    */
@@ -18,6 +18,7 @@ VariableSizeBokehBlurOperation::VariableSizeBokehBlurOperation()
   this->add_output_socket(DataType::Color);
   flags_.complex = true;
   flags_.open_cl = true;
+  flags_.use_result_cache = true;
 
   input_program_ = nullptr;
   input_bokeh_program_ = nullptr;
@@ -261,6 +262,12 @@ bool VariableSizeBokehBlurOperation::determine_depending_area_of_interest(
   return false;
 }
 
+void VariableSizeBokehBlurOperation::hash_output_params()
+{
+  hash_params(max_blur_, threshold_, do_size_scale_);
+  hash_param(get_quality());
+}
+
 void VariableSizeBokehBlurOperation::get_area_of_interest(const int input_idx,
                                                           const rcti &output_area,
                                                           rcti &r_input_area)
@@ -39,6 +39,7 @@ VectorBlurOperation::VectorBlurOperation()
   input_zprogram_ = nullptr;
   flags_.complex = true;
   flags_.is_fullframe_operation = true;
+  flags_.needs_full_precision_inputs = true;
 }
 void VectorBlurOperation::init_execution()
 {
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+
+#include "COM_BokehBlurOperation.h"
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor::tests {
+
+static int64_t buffer_size(const MemoryBuffer &buf)
+{
+  return int64_t(buf.get_width()) * buf.get_height() * buf.get_num_channels();
+}
+
+static void fill_random(MemoryBuffer &buf, RandomNumberGenerator &rng)
+{
+  for (float &value : MutableSpan<float>(buf.get_buffer(), buffer_size(buf))) {
+    value = rng.get_float();
+  }
+}
+
+/**
+ * Convolves reading all kernel elements for each result pixel, as the blur operations do when not
+ * using FFT convolution.
+ */
+static void convolve_direct(const MemoryBuffer &image,
+                            const MemoryBuffer &kernel,
+                            const int num_channels,
+                            const bool normalize,
+                            MemoryBuffer &r_result)
+{
+  const rcti &image_rect = image.get_rect();
+  const int center_x = kernel.get_width() / 2;
+  const int center_y = kernel.get_height() / 2;
+  r_result.clear();
+  for (BuffersIterator<float> it = r_result.iterate_with({}); !it.is_end(); ++it) {
+    for (int ch = 0; ch < num_channels; ch++) {
+      const int kernel_ch = kernel.get_num_channels() == 1 ? 0 : ch;
+      double sum = 0.0;
+      double weight = 0.0;
+      for (int y = image_rect.ymin; y < image_rect.ymax; y++) {
+        for (int x = image_rect.xmin; x < image_rect.xmax; x++) {
+          const int kernel_x = center_x + it.x - x;
+          const int kernel_y = center_y + it.y - y;
+          if (kernel_x < 0 || kernel_y < 0 || kernel_x >= kernel.get_width() ||
+              kernel_y >= kernel.get_height()) {
+            continue;
+          }
+          const float kernel_value = kernel.get_elem(kernel_x, kernel_y)[kernel_ch];
+          sum += image.get_elem(x, y)[ch] * kernel_value;
+          weight += kernel_value;
+        }
+      }
+      it.out[ch] = normalize ? (weight > 0.0 ? sum / weight : 0.0) : sum;
+    }
+  }
+}
+
+static void expect_buffers_near(MemoryBuffer &a, MemoryBuffer &b, const float error)
+{
+  ASSERT_TRUE(BLI_rcti_compare(&a.get_rect(), &b.get_rect()));
+  for (const int64_t i : IndexRange(buffer_size(a))) {
+    EXPECT_NEAR(a.get_buffer()[i], b.get_buffer()[i], error);
+  }
+}
+
+TEST(FFTConvolution, MatchesDirectConvolution)
+{
+  RandomNumberGenerator rng(0);
+  rcti image_rect, kernel_rect, result_rect;
+  BLI_rcti_init(&image_rect, 5, 105, -3, 74);
+  /* Not a power of 2 and not square. */
+  BLI_rcti_init(&kernel_rect, 0, 35, 0, 17);
+  /* Larger than the image, some pixels are out of reach of the kernel. */
+  BLI_rcti_init(&result_rect, -20, 130, -30, 90);
+
+  MemoryBuffer image(DataType::Color, image_rect);
+  MemoryBuffer kernel(DataType::Color, kernel_rect);
+  fill_random(image, rng);
+  fill_random(kernel, rng);
+
+  MemoryBuffer result(DataType::Color, result_rect);
+  MemoryBuffer expected(DataType::Color, result_rect);
+  convolve_fft(image, kernel, 3, result);
+  convolve_direct(image, kernel, 3, false, expected);
+  expect_buffers_near(result, expected, 1e-3f);
+}
+
+TEST(FFTConvolution, NormalizedSingleChannelKernel)
+{
+  RandomNumberGenerator rng(1);
+  rcti image_rect, kernel_rect;
+  BLI_rcti_init(&image_rect, 0, 90, 0, 60);
+  BLI_rcti_init(&kernel_rect, 0, 33, 0, 33);
+
+  MemoryBuffer image(DataType::Color, image_rect);
+  MemoryBuffer kernel(DataType::Value, kernel_rect);
+  fill_random(image, rng);
+  fill_random(kernel, rng);
+
+  MemoryBuffer result(DataType::Color, image_rect);
+  MemoryBuffer expected(DataType::Color, image_rect);
+  convolve_fft_normalized(image, kernel, COM_DATA_TYPE_COLOR_CHANNELS, result);
+  convolve_direct(image, kernel, COM_DATA_TYPE_COLOR_CHANNELS, true, expected);
+  expect_buffers_near(result, expected, 1e-4f);
+}
+
+/** Input operation only providing a canvas, its buffer is passed directly to the tested one. */
+class CanvasOperation : public NodeOperation {
+ public:
+  CanvasOperation(const DataType data_type, const rcti &canvas)
+  {
+    add_output_socket(data_type);
+    set_canvas(canvas);
+  }
+};
+
+/**
+ * Blurs a random image with a random bokeh through the FFT path when the kernel is large enough
+ * and compares it with the direct loop, which is used when #update_memory_buffer_started isn't
+ * called.
+ */
+static void test_bokeh_blur_fft_matches_direct(const float size, const bool expect_fft)
+{
+  RandomNumberGenerator rng(2);
+  rcti image_rect, bokeh_rect, size_rect;
+  BLI_rcti_init(&image_rect, 0, 100, 0, 60);
+  BLI_rcti_init(&bokeh_rect, 0, 64, 0, 64);
+  BLI_rcti_init(&size_rect, 0, 1, 0, 1);
+
+  MemoryBuffer image(DataType::Color, image_rect);
+  MemoryBuffer bokeh(DataType::Color, bokeh_rect);
+  MemoryBuffer bounding_box(DataType::Value, image_rect);
+  MemoryBuffer size_buffer(DataType::Value, size_rect, true);
+  fill_random(image, rng);
+  fill_random(bokeh, rng);
+  for (float &value : MutableSpan<float>(bounding_box.get_buffer(), buffer_size(bounding_box))) {
+    value = 1.0f;
+  }
+  *size_buffer.get_buffer() = size;
+
+  CanvasOperation image_operation(DataType::Color, image_rect);
+  CanvasOperation bokeh_operation(DataType::Color, bokeh_rect);
+  CanvasOperation bounding_box_operation(DataType::Value, image_rect);
+  CanvasOperation size_operation(DataType::Value, size_rect);
+  BokehBlurOperation operation;
+  operation.set_execution_model(eExecutionModel::FullFrame);
+  operation.get_input_socket(0)->set_link(image_operation.get_output_socket());
+  operation.get_input_socket(1)->set_link(bokeh_operation.get_output_socket());
+  operation.get_input_socket(2)->set_link(bounding_box_operation.get_output_socket());
+  operation.get_input_socket(3)->set_link(size_operation.get_output_socket());
+  operation.set_canvas(image_rect);
+  operation.set_size(size);
+  operation.init_data();
+
+  Vector<MemoryBuffer *> inputs = {&image, &bokeh, &bounding_box, &size_buffer};
+  MemoryBuffer result(DataType::Color, image_rect);
+  MemoryBuffer expected(DataType::Color, image_rect);
+  operation.update_memory_buffer_partial(&expected, image_rect, inputs);
+
+  operation.update_memory_buffer_started(&result, image_rect, inputs);
+  operation.update_memory_buffer_partial(&result, image_rect, inputs);
+  operation.update_memory_buffer_finished(&result, image_rect, inputs);
+
+  /* The direct loop is only this close to the FFT result if the kernels cover the same pixels. */
+  expect_buffers_near(result, expected, 1e-4f);
+  if (!expect_fft) {
+    EXPECT_EQ(memcmp(result.get_buffer(),
+                     expected.get_buffer(),
+                     sizeof(float) * buffer_size(result)),
+              0);
+  }
+}
+
+TEST(FFTConvolution, BokehBlurMatchesDirect)
+{
+  /* A pixel size of 16 gives the smallest kernel using FFT convolution. */
+  static_assert(2 * 16 + 1 == COM_FFT_CONVOLUTION_MIN_KERNEL_SIZE);
+  test_bokeh_blur_fft_matches_direct(16.0f, true);
+  test_bokeh_blur_fft_matches_direct(15.0f, false);
+}
+
+}  // namespace blender::compositor::tests
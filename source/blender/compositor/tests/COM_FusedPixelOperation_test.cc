@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include "BLI_hash.h"
+
+#include "DNA_userdef_types.h"
+
+#include "COM_FusedPixelOperation.h"
+#include "COM_GammaOperation.h"
+#include "COM_InvertOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_WorkScheduler.h"
+
+#include "COM_test_common.hh"
+
+namespace blender::compositor::tests {
+
+/* Not a multiple of the fused strips size, so that the last strip of each area is partial. */
+constexpr int IMAGE_WIDTH = 301;
+constexpr int IMAGE_HEIGHT = 97;
+
+/** Noise image, not a pixel operation so it's never fused. */
+class NoiseImageOperation : public MultiThreadedOperation {
+ public:
+  NoiseImageOperation()
+  {
+    this->add_output_socket(DataType::Color);
+  }
+
+  void determine_canvas(const rcti &UNUSED(preferred_area), rcti &r_area) override
+  {
+    BLI_rcti_init(&r_area, 0, IMAGE_WIDTH, 0, IMAGE_HEIGHT);
+  }
+
+  void execute_pixel_sampled(float output[4],
+                             float x,
+                             float y,
+                             PixelSampler UNUSED(sampler)) override
+  {
+    pixel_color(int(x), int(y), output);
+  }
+
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> UNUSED(inputs)) override
+  {
+    for (BuffersIterator<float> it = output->iterate_with({}, area); !it.is_end(); ++it) {
+      pixel_color(it.x, it.y, it.out);
+    }
+  }
+
+ private:
+  static void pixel_color(const int x, const int y, float r_color[4])
+  {
+    for (int ch = 0; ch < 4; ch++) {
+      r_color[ch] = BLI_hash_int_3d_to_float(x, y, ch);
+    }
+  }
+};
+
+/**
+ * Copies its input into the given buffer and records how many stages the operation rendering its
+ * input fuses, 0 when it isn't a #FusedPixelOperation.
+ */
+class ResultOperation : public MultiThreadedOperation {
+ private:
+  MemoryBuffer &result_;
+  int &r_num_fused_stages_;
+  SocketReader *image_input_;
+
+ public:
+  ResultOperation(MemoryBuffer &result, int &r_num_fused_stages)
+      : result_(result), r_num_fused_stages_(r_num_fused_stages)
+  {
+    this->add_input_socket(DataType::Color);
+    image_input_ = nullptr;
+  }
+
+  bool is_output_operation(bool UNUSED(rendering)) const override
+  {
+    return true;
+  }
+
+  eCompositorPriority get_render_priority() const override
+  {
+    return eCompositorPriority::High;
+  }
+
+  void determine_canvas(const rcti &UNUSED(preferred_area), rcti &r_area) override
+  {
+    rcti local_preferred;
+    BLI_rcti_init(&local_preferred, 0, IMAGE_WIDTH, 0, IMAGE_HEIGHT);
+    switch (execution_model_) {
+      case eExecutionModel::Tiled:
+        NodeOperation::determine_canvas(local_preferred, r_area);
+        r_area = local_preferred;
+        break;
+      case eExecutionModel::FullFrame:
+        set_determined_canvas_modifier([&](rcti &canvas) { canvas = local_preferred; });
+        NodeOperation::determine_canvas(local_preferred, r_area);
+        break;
+    }
+  }
+
+  void init_execution() override
+  {
+    image_input_ = get_input_socket_reader(0);
+    const FusedPixelOperation *fused_op = dynamic_cast<const FusedPixelOperation *>(
+        get_input_operation(0));
+    r_num_fused_stages_ = fused_op ? fused_op->get_num_stages() : 0;
+  }
+
+  void deinit_execution() override
+  {
+    image_input_ = nullptr;
+  }
+
+  void execute_region(rcti *rect, unsigned int UNUSED(tile_number)) override
+  {
+    for (int y = rect->ymin; y < rect->ymax; y++) {
+      for (int x = rect->xmin; x < rect->xmax; x++) {
+        image_input_->read_sampled(result_.get_elem(x, y), x, y, PixelSampler::Nearest);
+      }
+    }
+  }
+
+  void update_memory_buffer_partial(MemoryBuffer *UNUSED(output),
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override
+  {
+    result_.copy_from(inputs[0], area);
+  }
+};
+
+/**
+ * Adds `Multiply(Invert(Gamma(Add(image, image))), Add(image, image))`. The add result is read
+ * twice, so it stays out of the fused group and its buffer is linked to two inputs of the fused
+ * operation.
+ */
+static void build_graph(NodeOperationBuilder &builder, MemoryBuffer &result, int &r_num_stages)
+{
+  NoiseImageOperation *image = new NoiseImageOperation();
+  builder.add_operation(image);
+
+  MixAddOperation *add = new MixAddOperation();
+  builder.add_operation(add);
+  builder.add_link(add_value(builder, 0.5f)->get_output_socket(), add->get_input_socket(0));
+  builder.add_link(image->get_output_socket(), add->get_input_socket(1));
+  builder.add_link(image->get_output_socket(), add->get_input_socket(2));
+
+  GammaOperation *gamma = new GammaOperation();
+  builder.add_operation(gamma);
+  builder.add_link(add->get_output_socket(), gamma->get_input_socket(0));
+  builder.add_link(add_value(builder, 2.2f)->get_output_socket(), gamma->get_input_socket(1));
+
+  InvertOperation *invert = new InvertOperation();
+  invert->set_color(true);
+  invert->set_alpha(false);
+  builder.add_operation(invert);
+  builder.add_link(add_value(builder, 0.3f)->get_output_socket(), invert->get_input_socket(0));
+  builder.add_link(gamma->get_output_socket(), invert->get_input_socket(1));
+
+  MixMultiplyOperation *multiply = new MixMultiplyOperation();
+  builder.add_operation(multiply);
+  builder.add_link(add_value(builder, 0.8f)->get_output_socket(),
+                   multiply->get_input_socket(0));
+  builder.add_link(invert->get_output_socket(), multiply->get_input_socket(1));
+  builder.add_link(add->get_output_socket(), multiply->get_input_socket(2));
+
+  ResultOperation *output = new ResultOperation(result, r_num_stages);
+  builder.add_operation(output);
+  builder.add_link(multiply->get_output_socket(), output->get_input_socket(0));
+}
+
+/**
+ * Renders the graph in full frame, where gamma, invert and multiply get fused, and compares it
+ * with tiled, which renders each operation on its own.
+ */
+TEST(FusedPixelOperation, MatchesUnfused)
+{
+  const bool use_full_frame_compositor = U.experimental.use_full_frame_compositor;
+  U.experimental.use_full_frame_compositor = true;
+  WorkScheduler::initialize(false, 4);
+
+  rcti rect;
+  BLI_rcti_init(&rect, 0, IMAGE_WIDTH, 0, IMAGE_HEIGHT);
+  MemoryBuffer fused(DataType::Color, rect);
+  MemoryBuffer unfused(DataType::Color, rect);
+  int fused_num_stages = -1;
+  int unfused_num_stages = -1;
+  execute_operations(eExecutionModel::FullFrame, 64, [&](NodeOperationBuilder &builder) {
+    build_graph(builder, fused, fused_num_stages);
+  });
+  execute_operations(eExecutionModel::Tiled, 64, [&](NodeOperationBuilder &builder) {
+    build_graph(builder, unfused, unfused_num_stages);
+  });
+
+  WorkScheduler::deinitialize();
+  U.experimental.use_full_frame_compositor = use_full_frame_compositor;
+
+  EXPECT_EQ(fused_num_stages, 3);
+  EXPECT_EQ(unfused_num_stages, 0);
+  const int64_t num_elems = int64_t(IMAGE_WIDTH) * IMAGE_HEIGHT * COM_DATA_TYPE_COLOR_CHANNELS;
+  float max_diff = 0.0f;
+  for (const int64_t i : IndexRange(num_elems)) {
+    max_diff = std::max(max_diff, std::abs(fused.get_buffer()[i] - unfused.get_buffer()[i]));
+  }
+  EXPECT_LE(max_diff, 1e-5f);
+}
+
+}  // namespace blender::compositor::tests
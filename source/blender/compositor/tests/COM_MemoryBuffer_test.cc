@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <limits>
+
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor::tests {
+
+static rcti create_rect(int width, int height, int offset = 0)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, offset, offset + width, offset, offset + height);
+  return rect;
+}
+
+TEST(MemoryBuffer, HalfStorageRoundTrip)
+{
+  const rcti rect = create_rect(3, 2);
+  MemoryBuffer buf(DataType::Color, rect);
+  const float values[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 0.1f, 0.18f, 3.14159f,
+                          100.25f, 1000.0f, 65504.0f, -2.5f, 1e-5f, 1e-7f, 6e-8f, -0.001f,
+                          0.333f, 0.999f, 2.0f, 4096.5f, 0.75f, 12.0f, 0.2f, -65504.0f};
+  float *data = buf.get_buffer();
+  for (const int i : IndexRange(ARRAY_SIZE(values))) {
+    data[i] = values[i];
+  }
+
+  EXPECT_TRUE(buf.convert_to_half_storage());
+  EXPECT_TRUE(buf.is_half_storage());
+  EXPECT_EQ(buf.get_buffer(), nullptr);
+
+  const rcti expanded_rect = create_rect(3, 2, 4);
+  MemoryBuffer *expanded = buf.expand_half_storage(expanded_rect);
+  EXPECT_FALSE(expanded->is_half_storage());
+  EXPECT_TRUE(BLI_rcti_compare(&expanded->get_rect(), &expanded_rect));
+  const float *expanded_data = expanded->get_buffer();
+  for (const int i : IndexRange(ARRAY_SIZE(values))) {
+    /* Half float has 11 bits of precision, denormals are absolute. */
+    const float tolerance = std::max(std::abs(values[i]) / 2048.0f, 6e-8f);
+    EXPECT_NEAR(expanded_data[i], values[i], tolerance);
+  }
+  EXPECT_EQ(std::signbit(expanded_data[1]), true);
+  delete expanded;
+}
+
+TEST(MemoryBuffer, HalfStorageSpecialValues)
+{
+  const rcti rect = create_rect(1, 1);
+  MemoryBuffer buf(DataType::Color, rect);
+  float *data = buf.get_buffer();
+  data[0] = std::numeric_limits<float>::infinity();
+  data[1] = -std::numeric_limits<float>::infinity();
+  data[2] = std::numeric_limits<float>::quiet_NaN();
+  data[3] = 65504.0f;
+
+  EXPECT_TRUE(buf.convert_to_half_storage());
+  MemoryBuffer *expanded = buf.expand_half_storage(rect);
+  const float *expanded_data = expanded->get_buffer();
+  EXPECT_EQ(expanded_data[0], std::numeric_limits<float>::infinity());
+  EXPECT_EQ(expanded_data[1], -std::numeric_limits<float>::infinity());
+  EXPECT_TRUE(std::isnan(expanded_data[2]));
+  EXPECT_EQ(expanded_data[3], 65504.0f);
+  delete expanded;
+}
+
+TEST(MemoryBuffer, HalfStorageOutOfRange)
+{
+  /* Finite values above the largest half float keep the buffer in float. */
+  for (const float value : {65505.0f, -70000.0f, 1e10f}) {
+    const rcti rect = create_rect(64, 64);
+    MemoryBuffer buf(DataType::Color, rect);
+    const float color[4] = {0.5f, 0.5f, 0.5f, 1.0f};
+    buf.fill(rect, color);
+    buf.get_elem(63, 63)[2] = value;
+
+    EXPECT_FALSE(buf.convert_to_half_storage());
+    EXPECT_FALSE(buf.is_half_storage());
+    EXPECT_EQ(buf.get_elem(63, 63)[2], value);
+    EXPECT_EQ(buf.get_elem(0, 0)[0], 0.5f);
+  }
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,355 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * Benchmarks of the execution models rendering synthetic operation graphs at 2K, 4K and 8K.
+ * Graphs are built directly from operations, no node tree or UI is needed. Wall time and buffer
+ * memory of each operation (each execution group in tiled) are recorded through #DebugInfo.
+ *
+ * Disabled by default as they take a while, run with:
+ * `blender_test --gtest_also_run_disabled_tests --gtest_filter=CompositorPerformance.*`
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_hash.h"
+#include "BLI_threads.h"
+
+#include "DNA_userdef_types.h"
+
+#include "PIL_time.h"
+
+#include "COM_BokehBlurOperation.h"
+#include "COM_BokehImageOperation.h"
+#include "COM_Debug.h"
+#include "COM_GammaOperation.h"
+#include "COM_GaussianXBlurOperation.h"
+#include "COM_GaussianYBlurOperation.h"
+#include "COM_GlareFogGlowOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_WorkScheduler.h"
+
+#include "COM_test_common.hh"
+
+namespace blender::compositor::tests {
+
+/**
+ * Procedural image with noise, gradients and sparse highlights, so that blurs and glares have
+ * representative content to work on.
+ */
+class SyntheticImageOperation : public MultiThreadedOperation {
+ private:
+  int width_;
+  int height_;
+
+ public:
+  SyntheticImageOperation(int width, int height) : width_(width), height_(height)
+  {
+    this->add_output_socket(DataType::Color);
+  }
+
+  void determine_canvas(const rcti &UNUSED(preferred_area), rcti &r_area) override
+  {
+    BLI_rcti_init(&r_area, 0, width_, 0, height_);
+  }
+
+  void execute_pixel_sampled(float output[4],
+                             float x,
+                             float y,
+                             PixelSampler UNUSED(sampler)) override
+  {
+    pixel_color(int(x), int(y), output);
+  }
+
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> UNUSED(inputs)) override
+  {
+    for (BuffersIterator<float> it = output->iterate_with({}, area); !it.is_end(); ++it) {
+      pixel_color(it.x, it.y, it.out);
+    }
+  }
+
+ private:
+  void pixel_color(const int x, const int y, float r_color[4]) const
+  {
+    const uint hash = BLI_hash_int_2d(x, y);
+    const float noise = (hash & 0xFFFF) / float(0xFFFF);
+    const float highlight = (hash % 4099) == 0 ? 20.0f : 0.0f;
+    r_color[0] = float(x) / width_ * 0.8f + noise * 0.2f + highlight;
+    r_color[1] = float(y) / height_ * 0.8f + noise * 0.2f + highlight;
+    r_color[2] = noise + highlight;
+    r_color[3] = 1.0f;
+  }
+};
+
+/**
+ * Output of the benchmark graphs, keeps the rendered image like the compositor output does.
+ */
+class BenchmarkOutputOperation : public MultiThreadedOperation {
+ private:
+  int width_;
+  int height_;
+  SocketReader *image_input_;
+  std::unique_ptr<MemoryBuffer> result_;
+
+ public:
+  BenchmarkOutputOperation(int width, int height) : width_(width), height_(height)
+  {
+    this->add_input_socket(DataType::Color);
+    image_input_ = nullptr;
+  }
+
+  bool is_output_operation(bool UNUSED(rendering)) const override
+  {
+    return true;
+  }
+
+  eCompositorPriority get_render_priority() const override
+  {
+    return eCompositorPriority::High;
+  }
+
+  void determine_canvas(const rcti &UNUSED(preferred_area), rcti &r_area) override
+  {
+    rcti local_preferred;
+    BLI_rcti_init(&local_preferred, 0, width_, 0, height_);
+    switch (execution_model_) {
+      case eExecutionModel::Tiled:
+        NodeOperation::determine_canvas(local_preferred, r_area);
+        r_area = local_preferred;
+        break;
+      case eExecutionModel::FullFrame:
+        set_determined_canvas_modifier([&](rcti &canvas) { canvas = local_preferred; });
+        NodeOperation::determine_canvas(local_preferred, r_area);
+        break;
+    }
+  }
+
+  void init_execution() override
+  {
+    image_input_ = get_input_socket_reader(0);
+    result_ = std::make_unique<MemoryBuffer>(DataType::Color, get_canvas());
+  }
+
+  void deinit_execution() override
+  {
+    image_input_ = nullptr;
+  }
+
+  void execute_region(rcti *rect, unsigned int UNUSED(tile_number)) override
+  {
+    for (int y = rect->ymin; y < rect->ymax; y++) {
+      for (int x = rect->xmin; x < rect->xmax; x++) {
+        image_input_->read_sampled(result_->get_elem(x, y), x, y, PixelSampler::Nearest);
+      }
+    }
+  }
+
+  void update_memory_buffer_partial(MemoryBuffer *UNUSED(output),
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override
+  {
+    result_->copy_from(inputs[0], area);
+  }
+};
+
+enum class BenchmarkGraph {
+  /** Chain of per pixel operations, bandwidth bound. */
+  PixelOperations,
+  /** Separable gaussian blur. */
+  GaussianBlur,
+  /** Bokeh blur, large kernel. */
+  BokehBlur,
+  /** Fog glow glare, FFT convolution. */
+  FogGlow,
+};
+
+static const char *graph_name(const BenchmarkGraph graph)
+{
+  switch (graph) {
+    case BenchmarkGraph::PixelOperations:
+      return "Pixel operations";
+    case BenchmarkGraph::GaussianBlur:
+      return "Gaussian blur";
+    case BenchmarkGraph::BokehBlur:
+      return "Bokeh blur";
+    case BenchmarkGraph::FogGlow:
+      return "Fog glow";
+  }
+  return "";
+}
+
+static void add_operation_with_name(NodeOperationBuilder &builder,
+                                    NodeOperation *operation,
+                                    const char *name)
+{
+  builder.add_operation(operation);
+  operation->set_name(name);
+}
+
+static void build_graph(NodeOperationBuilder &builder,
+                        const BenchmarkGraph graph,
+                        const int width,
+                        const int height)
+{
+  SyntheticImageOperation *image = new SyntheticImageOperation(width, height);
+  add_operation_with_name(builder, image, "Image");
+  NodeOperation *result = image;
+
+  switch (graph) {
+    case BenchmarkGraph::PixelOperations: {
+      MixAddOperation *mix = new MixAddOperation();
+      add_operation_with_name(builder, mix, "Add");
+      builder.add_link(add_value(builder, 0.5f)->get_output_socket(), mix->get_input_socket(0));
+      builder.add_link(image->get_output_socket(), mix->get_input_socket(1));
+      builder.add_link(image->get_output_socket(), mix->get_input_socket(2));
+
+      GammaOperation *gamma = new GammaOperation();
+      add_operation_with_name(builder, gamma, "Gamma");
+      builder.add_link(mix->get_output_socket(), gamma->get_input_socket(0));
+      builder.add_link(add_value(builder, 2.2f)->get_output_socket(), gamma->get_input_socket(1));
+
+      MixMultiplyOperation *multiply = new MixMultiplyOperation();
+      add_operation_with_name(builder, multiply, "Multiply");
+      builder.add_link(add_value(builder, 1.0f)->get_output_socket(),
+                       multiply->get_input_socket(0));
+      builder.add_link(gamma->get_output_socket(), multiply->get_input_socket(1));
+      builder.add_link(image->get_output_socket(), multiply->get_input_socket(2));
+      result = multiply;
+      break;
+    }
+    case BenchmarkGraph::GaussianBlur: {
+      NodeBlurData data = {0};
+      data.sizex = data.sizey = short(width / 100);
+      data.filtertype = R_FILTER_GAUSS;
+
+      GaussianXBlurOperation *blur_x = new GaussianXBlurOperation();
+      blur_x->set_data(&data);
+      blur_x->set_size(1.0f);
+      blur_x->set_quality(eCompositorQuality::High);
+      add_operation_with_name(builder, blur_x, "Blur X");
+      builder.add_link(image->get_output_socket(), blur_x->get_input_socket(0));
+
+      GaussianYBlurOperation *blur_y = new GaussianYBlurOperation();
+      blur_y->set_data(&data);
+      blur_y->set_size(1.0f);
+      blur_y->set_quality(eCompositorQuality::High);
+      add_operation_with_name(builder, blur_y, "Blur Y");
+      builder.add_link(blur_x->get_output_socket(), blur_y->get_input_socket(0));
+      result = blur_y;
+      break;
+    }
+    case BenchmarkGraph::BokehBlur: {
+      static NodeBokehImage bokeh_data = {0.0f, 6, 0.0f, 0.0f, 0.0f};
+      BokehImageOperation *bokeh = new BokehImageOperation();
+      bokeh->set_data(&bokeh_data);
+      add_operation_with_name(builder, bokeh, "Bokeh");
+
+      BokehBlurOperation *blur = new BokehBlurOperation();
+      blur->set_quality(eCompositorQuality::High);
+      /* Percentage of the image size. */
+      blur->set_size(1.0f);
+      add_operation_with_name(builder, blur, "Bokeh Blur");
+      builder.add_link(image->get_output_socket(), blur->get_input_socket(0));
+      builder.add_link(bokeh->get_output_socket(), blur->get_input_socket(1));
+      builder.add_link(add_value(builder, 1.0f)->get_output_socket(), blur->get_input_socket(2));
+      result = blur;
+      break;
+    }
+    case BenchmarkGraph::FogGlow: {
+      static NodeGlare glare_data = {0};
+      glare_data.size = 8;
+      GlareFogGlowOperation *glare = new GlareFogGlowOperation();
+      glare->set_glare_settings(&glare_data);
+      add_operation_with_name(builder, glare, "Fog Glow");
+      builder.add_link(image->get_output_socket(), glare->get_input_socket(0));
+      result = glare;
+      break;
+    }
+  }
+
+  BenchmarkOutputOperation *output = new BenchmarkOutputOperation(width, height);
+  add_operation_with_name(builder, output, "Output");
+  builder.add_link(result->get_output_socket(), output->get_input_socket(0));
+}
+
+static void run_benchmark(const eExecutionModel execution_model,
+                          const BenchmarkGraph graph,
+                          const int width,
+                          const int height)
+{
+  DebugInfo::start_timings();
+  const double start_time = PIL_check_seconds_timer();
+  execute_operations(execution_model, 256, [&](NodeOperationBuilder &builder) {
+    build_graph(builder, graph, width, height);
+  });
+  const double total_time = PIL_check_seconds_timer() - start_time;
+  const Vector<DebugInfo::OperationTiming> timings = DebugInfo::stop_timings();
+
+  printf("%s, %s, %dx%d: %.2f ms\n",
+         execution_model == eExecutionModel::FullFrame ? "Full frame" : "Tiled",
+         graph_name(graph),
+         width,
+         height,
+         total_time * 1000.0);
+  size_t total_bytes = 0;
+  for (const DebugInfo::OperationTiming &timing : timings) {
+    printf("  %-56s %10.2f ms %10.2f MB\n",
+           timing.name.c_str(),
+           timing.seconds * 1000.0,
+           timing.buffer_bytes / (1024.0 * 1024.0));
+    total_bytes += timing.buffer_bytes;
+  }
+  printf("  %-56s %13s %10.2f MB\n", "Total buffers", "", total_bytes / (1024.0 * 1024.0));
+  EXPECT_FALSE(timings.is_empty());
+}
+
+static void run_benchmarks(const eExecutionModel execution_model, const int width, const int height)
+{
+  const bool use_full_frame_compositor = U.experimental.use_full_frame_compositor;
+  U.experimental.use_full_frame_compositor = true;
+  WorkScheduler::initialize(false, BLI_system_thread_count());
+
+  for (const BenchmarkGraph graph : {BenchmarkGraph::PixelOperations,
+                                     BenchmarkGraph::GaussianBlur,
+                                     BenchmarkGraph::BokehBlur,
+                                     BenchmarkGraph::FogGlow}) {
+    run_benchmark(execution_model, graph, width, height);
+  }
+
+  WorkScheduler::deinitialize();
+  U.experimental.use_full_frame_compositor = use_full_frame_compositor;
+}
+
+TEST(CompositorPerformance, DISABLED_full_frame_2k)
+{
+  run_benchmarks(eExecutionModel::FullFrame, 2048, 1080);
+}
+
+TEST(CompositorPerformance, DISABLED_full_frame_4k)
+{
+  run_benchmarks(eExecutionModel::FullFrame, 4096, 2160);
+}
+
+TEST(CompositorPerformance, DISABLED_full_frame_8k)
+{
+  run_benchmarks(eExecutionModel::FullFrame, 8192, 4320);
+}
+
+TEST(CompositorPerformance, DISABLED_tiled_2k)
+{
+  run_benchmarks(eExecutionModel::Tiled, 2048, 1080);
+}
+
+TEST(CompositorPerformance, DISABLED_tiled_4k)
+{
+  run_benchmarks(eExecutionModel::Tiled, 4096, 2160);
+}
+
+TEST(CompositorPerformance, DISABLED_tiled_8k)
+{
+  run_benchmarks(eExecutionModel::Tiled, 8192, 4320);
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+/** \file
+ * Utilities for tests executing operation graphs built directly from operations, without a
+ * node tree.
+ */
+
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "COM_ExecutionSystem.h"
+#include "COM_NodeOperationBuilder.h"
+#include "COM_SetValueOperation.h"
+
+namespace blender::compositor::tests {
+
+inline SetValueOperation *add_value(NodeOperationBuilder &builder, const float value)
+{
+  SetValueOperation *operation = new SetValueOperation();
+  operation->set_value(value);
+  builder.add_operation(operation);
+  return operation;
+}
+
+inline void tree_stats_draw(void *UNUSED(handle), const char *UNUSED(str))
+{
+}
+
+inline void tree_progress(void *UNUSED(handle), float UNUSED(progress))
+{
+}
+
+inline int tree_test_break(void *UNUSED(handle))
+{
+  return false;
+}
+
+inline void tree_update_draw(void *UNUSED(handle))
+{
+}
+
+/**
+ * Renders the operations added by \a build_operations with the given execution model. The node
+ * tree is only used for its execution settings and callbacks.
+ */
+inline void execute_operations(
+    const eExecutionModel execution_model,
+    const int chunk_size,
+    const std::function<void(NodeOperationBuilder &builder)> &build_operations)
+{
+  bNodeTree *node_tree = MEM_cnew<bNodeTree>(__func__);
+  node_tree->execution_mode = execution_model == eExecutionModel::FullFrame ? 1 : 0;
+  node_tree->render_quality = NTREE_QUALITY_HIGH;
+  node_tree->chunksize = chunk_size;
+  node_tree->stats_draw = tree_stats_draw;
+  node_tree->progress = tree_progress;
+  node_tree->test_break = tree_test_break;
+  node_tree->update_draw = tree_update_draw;
+  RenderData *render_data = MEM_cnew<RenderData>(__func__);
+  {
+    ExecutionSystem system(render_data, nullptr, node_tree, true, false, "", build_operations);
+    system.execute();
+  }
+  MEM_freeN(render_data);
+  MEM_freeN(node_tree);
+}
+
+}  // namespace blender::compositor::tests
@@ -226,6 +226,7 @@ static bool eyedropper_cryptomatte_sample_image_fl(const bNode *node,
     ImBuf *ibuf = BKE_image_acquire_ibuf(image, iuser, NULL);
     if (image->rr) {
       LISTBASE_FOREACH (RenderLayer *, render_layer, &image->rr->layers) {
+        BKE_image_multilayer_ensure_loaded(image, render_layer);
         success = eyedropper_cryptomatte_sample_renderlayer_fl(render_layer, prefix, fpos, r_col);
         if (success) {
           break;
@@ -242,18 +242,18 @@ static void image_buffer_rect_update(RenderJob *rj,
   view_settings = &scene->view_settings;
   display_settings = &scene->display_settings;
 
-  IMB_partial_display_buffer_update(ibuf,
-                                    rectf,
-                                    nullptr,
-                                    linear_stride,
-                                    linear_offset_x,
-                                    linear_offset_y,
-                                    view_settings,
-                                    display_settings,
-                                    offset_x,
-                                    offset_y,
-                                    offset_x + BLI_rcti_size_x(tile_rect),
-                                    offset_y + BLI_rcti_size_y(tile_rect));
+  IMB_partial_display_buffer_update_threaded(ibuf,
+                                             rectf,
+                                             nullptr,
+                                             linear_stride,
+                                             linear_offset_x,
+                                             linear_offset_y,
+                                             view_settings,
+                                             display_settings,
+                                             offset_x,
+                                             offset_y,
+                                             offset_x + BLI_rcti_size_x(tile_rect),
+                                             offset_y + BLI_rcti_size_y(tile_rect));
 }
 
 /* ****************************** render invoking ***************** */
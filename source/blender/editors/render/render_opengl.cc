@@ -913,7 +913,9 @@ static void screen_opengl_render_end(bContext *C, OGLRender *oglrender)
   if (oglrender->mh) {
     if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
       for (i = 0; i < oglrender->totvideos; i++) {
-        oglrender->mh->end_movie(oglrender->movie_ctx_arr[i]);
+        if (!oglrender->mh->end_movie(oglrender->movie_ctx_arr[i])) {
+          BKE_report(oglrender->reports, RPT_ERROR, "Error writing movie file");
+        }
         oglrender->mh->context_free(oglrender->movie_ctx_arr[i]);
       }
     }
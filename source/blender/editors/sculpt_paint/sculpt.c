@@ -440,7 +440,7 @@ bool SCULPT_vertex_any_face_set_visible_get(SculptSession *ss, int index)
 {
   switch (BKE_pbvh_type(ss->pbvh)) {
     case PBVH_FACES: {
-      MeshElemMap *vert_map = &ss->pmap[index];
+      const MeshElemMap *vert_map = &ss->pmap[index];
       for (int j = 0; j < ss->pmap[index].count; j++) {
         if (ss->face_sets[vert_map->indices[j]] > 0) {
           return true;
@@ -460,7 +460,7 @@ bool SCULPT_vertex_all_face_sets_visible_get(const SculptSession *ss, int index)
 {
   switch (BKE_pbvh_type(ss->pbvh)) {
     case PBVH_FACES: {
-      MeshElemMap *vert_map = &ss->pmap[index];
+      const MeshElemMap *vert_map = &ss->pmap[index];
       for (int j = 0; j < ss->pmap[index].count; j++) {
         if (ss->face_sets[vert_map->indices[j]] < 0) {
           return false;
@@ -484,7 +484,7 @@ void SCULPT_vertex_face_set_set(SculptSession *ss, int index, int face_set)
 {
   switch (BKE_pbvh_type(ss->pbvh)) {
     case PBVH_FACES: {
-      MeshElemMap *vert_map = &ss->pmap[index];
+      const MeshElemMap *vert_map = &ss->pmap[index];
       for (int j = 0; j < ss->pmap[index].count; j++) {
         if (ss->face_sets[vert_map->indices[j]] > 0) {
           ss->face_sets[vert_map->indices[j]] = abs(face_set);
@@ -509,7 +509,7 @@ int SCULPT_vertex_face_set_get(SculptSession *ss, int index)
 {
   switch (BKE_pbvh_type(ss->pbvh)) {
     case PBVH_FACES: {
-      MeshElemMap *vert_map = &ss->pmap[index];
+      const MeshElemMap *vert_map = &ss->pmap[index];
       int face_set = 0;
       for (int i = 0; i < ss->pmap[index].count; i++) {
         if (ss->face_sets[vert_map->indices[i]] > face_set) {
@@ -534,7 +534,7 @@ bool SCULPT_vertex_has_face_set(SculptSession *ss, int index, int face_set)
 {
   switch (BKE_pbvh_type(ss->pbvh)) {
     case PBVH_FACES: {
-      MeshElemMap *vert_map = &ss->pmap[index];
+      const MeshElemMap *vert_map = &ss->pmap[index];
       for (int i = 0; i < ss->pmap[index].count; i++) {
         if (ss->face_sets[vert_map->indices[i]] == face_set) {
           return true;
@@ -576,7 +576,7 @@ void SCULPT_visibility_sync_all_face_sets_to_vertices(Object *ob)
 static void UNUSED_FUNCTION(sculpt_visibility_sync_vertex_to_face_sets)(SculptSession *ss,
                                                                         int index)
 {
-  MeshElemMap *vert_map = &ss->pmap[index];
+  const MeshElemMap *vert_map = &ss->pmap[index];
   const bool visible = SCULPT_vertex_visible_get(ss, index);
   for (int i = 0; i < ss->pmap[index].count; i++) {
     if (visible) {
@@ -613,7 +613,7 @@ void SCULPT_visibility_sync_all_vertex_to_face_sets(SculptSession *ss)
 
 static bool sculpt_check_unique_face_set_in_base_mesh(SculptSession *ss, int index)
 {
-  MeshElemMap *vert_map = &ss->pmap[index];
+  const MeshElemMap *vert_map = &ss->pmap[index];
   int face_set = -1;
   for (int i = 0; i < ss->pmap[index].count; i++) {
     if (face_set == -1) {
@@ -634,7 +634,7 @@ static bool sculpt_check_unique_face_set_in_base_mesh(SculptSession *ss, int ind
  */
 static bool sculpt_check_unique_face_set_for_edge_in_base_mesh(SculptSession *ss, int v1, int v2)
 {
-  MeshElemMap *vert_map = &ss->pmap[v1];
+  const MeshElemMap *vert_map = &ss->pmap[v1];
   int p1 = -1, p2 = -1;
   for (int i = 0; i < ss->pmap[v1].count; i++) {
     MPoly *p = &ss->mpoly[vert_map->indices[i]];
@@ -767,7 +767,7 @@ static void sculpt_vertex_neighbors_get_faces(SculptSession *ss,
                                               int index,
                                               SculptVertexNeighborIter *iter)
 {
-  MeshElemMap *vert_map = &ss->pmap[index];
+  const MeshElemMap *vert_map = &ss->pmap[index];
   iter->size = 0;
   iter->num_duplicates = 0;
   iter->capacity = SCULPT_VERTEX_NEIGHBOR_FIXED_CAPACITY;
@@ -78,9 +78,7 @@ void SCULPT_pbvh_clear(Object *ob)
     ss->pbvh = NULL;
   }
 
-  MEM_SAFE_FREE(ss->pmap);
-
-  MEM_SAFE_FREE(ss->pmap_mem);
+  BKE_sculptsession_topology_map_release(&ss->pmap, &ss->pmap_ref);
 
   BKE_object_free_derived_caches(ob);
 
@@ -26,6 +26,7 @@
 #include "BKE_image.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_multires.h"
 #include "BKE_node.h"
 #include "BKE_object.h"
@@ -115,18 +116,12 @@ static float *SCULPT_geodesic_mesh_create(Object *ob,
   BLI_bitmap *edge_tag = BLI_BITMAP_NEW(totedge, "edge tag");
 
   if (!ss->epmap) {
-    BKE_mesh_edge_poly_map_create(&ss->epmap,
-                                  &ss->epmap_mem,
-                                  mesh->medge,
-                                  mesh->totedge,
-                                  mesh->mpoly,
-                                  mesh->totpoly,
-                                  mesh->mloop,
-                                  mesh->totloop);
+    ss->epmap_ref = BKE_mesh_runtime_edge_poly_map_acquire(mesh);
+    ss->epmap = ss->epmap_ref->elem_map;
   }
   if (!ss->vemap) {
-    BKE_mesh_vert_edge_map_create(
-        &ss->vemap, &ss->vemap_mem, mesh->medge, mesh->totvert, mesh->totedge);
+    ss->vemap_ref = BKE_mesh_runtime_vert_edge_map_acquire(mesh);
+    ss->vemap = ss->vemap_ref->elem_map;
   }
 
   /* Both contain edge indices encoded as *void. */
@@ -132,6 +132,8 @@ typedef struct SculptUndoNodeGeometry {
   int totpoly;
 } SculptUndoNodeGeometry;
 
+#define SCULPT_UNDO_COMPRESSED_ARRAYS_NUM 5
+
 typedef struct SculptUndoNode {
   struct SculptUndoNode *next, *prev;
 
@@ -193,6 +195,12 @@ typedef struct SculptUndoNode {
   /* Sculpt Face Sets */
   int *face_sets;
 
+  /* Compressed copy of the float arrays (co, orig_co, mask, col and loop_col) once the undo step
+   * has been pushed. While compressed those arrays are NULL, #compressed_len stores their sizes
+   * in bytes. */
+  void *compressed;
+  size_t compressed_len[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM];
+
   size_t undo_size;
 } SculptUndoNode;
 
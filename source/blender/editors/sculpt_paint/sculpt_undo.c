@@ -7,6 +7,7 @@
  */
 
 #include <stddef.h>
+#include <zstd.h>
 
 #include "MEM_guardedalloc.h"
 
@@ -56,6 +57,9 @@
 #include "ED_undo.h"
 
 #include "bmesh.h"
+
+#include "atomic_ops.h"
+
 #include "sculpt_intern.h"
 
 /* Implementation of undo system for objects in sculpt mode.
@@ -99,6 +103,9 @@
 
 #define NO_ACTIVE_LAYER ATTR_DOMAIN_AUTO
 
+/* Compression runs after the stroke, favor speed over ratio. */
+#define SCULPT_UNDO_ZSTD_LEVEL 1
+
 typedef struct UndoSculpt {
   ListBase nodes;
 
@@ -123,6 +130,9 @@ typedef struct SculptUndoStep {
   /* Active color attribute at the end of this undo step. */
   SculptAttrRef active_color_end;
 
+  /* Background compression of the nodes, see #sculpt_undo_compress_begin. */
+  TaskPool *compress_pool;
+
   bContext *C;
 } SculptUndoStep;
 
@@ -660,6 +670,255 @@ static void sculpt_undo_refine_subdiv(Depsgraph *depsgraph,
   MEM_freeN(deformed_verts);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compressed Node Storage
+ *
+ * Once a step is pushed its per-vertex float arrays are only needed again on undo/redo, so they
+ * are compressed on a background thread and decompressed when the step is decoded.
+ *
+ * Before compression each array is delta encoded by XOR-ing every float with the same component
+ * of the previous element, and split into byte planes. Vertices of a PBVH node are close to each
+ * other, so this leaves long runs of zero bytes in the sign, exponent and high mantissa planes.
+ * The encoding is lossless.
+ * \{ */
+
+static void sculpt_undo_node_float_arrays(SculptUndoNode *unode,
+                                          float **r_arrays[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM],
+                                          int r_components[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM])
+{
+  r_arrays[0] = (float **)&unode->co;
+  r_arrays[1] = (float **)&unode->orig_co;
+  r_arrays[2] = &unode->mask;
+  r_arrays[3] = (float **)&unode->col;
+  r_arrays[4] = (float **)&unode->loop_col;
+  r_components[0] = 3;
+  r_components[1] = 3;
+  r_components[2] = 1;
+  r_components[3] = 4;
+  r_components[4] = 4;
+}
+
+static void sculpt_undo_delta_encode(const uint32_t *src, uint32_t *dst, int len, int components)
+{
+  for (int i = 0; i < min_ii(len, components); i++) {
+    dst[i] = src[i];
+  }
+  for (int i = components; i < len; i++) {
+    dst[i] = src[i] ^ src[i - components];
+  }
+}
+
+static void sculpt_undo_delta_decode(uint32_t *data, int len, int components)
+{
+  for (int i = components; i < len; i++) {
+    data[i] ^= data[i - components];
+  }
+}
+
+static void sculpt_undo_byte_planes_split(const uint32_t *src, uchar *dst, int len)
+{
+  const uchar *src_bytes = (const uchar *)src;
+  for (int b = 0; b < 4; b++) {
+    for (int i = 0; i < len; i++) {
+      dst[b * len + i] = src_bytes[i * 4 + b];
+    }
+  }
+}
+
+static void sculpt_undo_byte_planes_join(const uchar *src, uint32_t *dst, int len)
+{
+  uchar *dst_bytes = (uchar *)dst;
+  for (int b = 0; b < 4; b++) {
+    for (int i = 0; i < len; i++) {
+      dst_bytes[i * 4 + b] = src[b * len + i];
+    }
+  }
+}
+
+static bool sculpt_undo_node_can_compress(const SculptUndoNode *unode)
+{
+  return ELEM(unode->type, SCULPT_UNDO_COORDS, SCULPT_UNDO_MASK, SCULPT_UNDO_COLOR) &&
+         unode->bm_entry == NULL && unode->compressed == NULL;
+}
+
+static void sculpt_undo_node_compress(UndoSculpt *usculpt, SculptUndoNode *unode)
+{
+  float **arrays[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM];
+  int components[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM];
+  sculpt_undo_node_float_arrays(unode, arrays, components);
+
+  size_t raw_size = 0;
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    unode->compressed_len[i] = *arrays[i] ? MEM_allocN_len(*arrays[i]) : 0;
+    raw_size += unode->compressed_len[i];
+  }
+  if (raw_size == 0) {
+    return;
+  }
+
+  uint32_t *delta = MEM_mallocN(raw_size, __func__);
+  uchar *planes = MEM_mallocN(raw_size, __func__);
+  size_t offset = 0;
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    const int len = (int)(unode->compressed_len[i] / sizeof(float));
+    if (len == 0) {
+      continue;
+    }
+    sculpt_undo_delta_encode((const uint32_t *)*arrays[i], delta, len, components[i]);
+    sculpt_undo_byte_planes_split(delta, planes + offset, len);
+    offset += unode->compressed_len[i];
+  }
+  MEM_freeN(delta);
+
+  const size_t bound = ZSTD_compressBound(raw_size);
+  void *compressed = MEM_mallocN(bound, "SculptUndoNode.compressed");
+  const size_t compressed_size = ZSTD_compress(
+      compressed, bound, planes, raw_size, SCULPT_UNDO_ZSTD_LEVEL);
+  MEM_freeN(planes);
+
+  if (ZSTD_isError(compressed_size) || compressed_size >= raw_size) {
+    MEM_freeN(compressed);
+    return;
+  }
+
+  unode->compressed = MEM_reallocN(compressed, compressed_size);
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    MEM_SAFE_FREE(*arrays[i]);
+  }
+
+  atomic_sub_and_fetch_z(&usculpt->undo_size, raw_size - MEM_allocN_len(unode->compressed));
+}
+
+static void sculpt_undo_node_decompress(UndoSculpt *usculpt, SculptUndoNode *unode)
+{
+  float **arrays[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM];
+  int components[SCULPT_UNDO_COMPRESSED_ARRAYS_NUM];
+  sculpt_undo_node_float_arrays(unode, arrays, components);
+
+  size_t raw_size = 0;
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    raw_size += unode->compressed_len[i];
+  }
+
+  const size_t compressed_size = MEM_allocN_len(unode->compressed);
+  uchar *planes = MEM_mallocN(raw_size, __func__);
+  const size_t decompressed_size = ZSTD_decompress(
+      planes, raw_size, unode->compressed, compressed_size);
+  BLI_assert(decompressed_size == raw_size);
+  UNUSED_VARS_NDEBUG(decompressed_size);
+
+  size_t offset = 0;
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    const int len = (int)(unode->compressed_len[i] / sizeof(float));
+    if (len == 0) {
+      continue;
+    }
+    uint32_t *data = MEM_mallocN(unode->compressed_len[i], "SculptUndoNode array");
+    sculpt_undo_byte_planes_join(planes + offset, data, len);
+    sculpt_undo_delta_decode(data, len, components[i]);
+    *arrays[i] = (float *)data;
+    offset += unode->compressed_len[i];
+  }
+  MEM_freeN(planes);
+
+  MEM_freeN(unode->compressed);
+  unode->compressed = NULL;
+
+  atomic_add_and_fetch_z(&usculpt->undo_size, raw_size - compressed_size);
+}
+
+static void sculpt_undo_compress_task(TaskPool *__restrict pool, void *taskdata)
+{
+  SculptUndoStep *us = BLI_task_pool_user_data(pool);
+  sculpt_undo_node_compress(&us->data, taskdata);
+
+  /* Let the undo stack memory limit see the reduced size without waiting for all nodes. */
+  atomic_store_z(&us->step.data_size, atomic_load_z(&us->data.undo_size));
+}
+
+/* Start compressing the nodes of a step that was pushed, in the background. */
+static void sculpt_undo_compress_begin(SculptUndoStep *us)
+{
+  if (us->compress_pool != NULL) {
+    return;
+  }
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &us->data.nodes) {
+    if (!sculpt_undo_node_can_compress(unode)) {
+      continue;
+    }
+    if (us->compress_pool == NULL) {
+      us->compress_pool = BLI_task_pool_create_background(us, TASK_PRIORITY_LOW);
+    }
+    BLI_task_pool_push(us->compress_pool, sculpt_undo_compress_task, unode, false, NULL);
+  }
+}
+
+/* Wait for the background compression of the step to finish. */
+static void sculpt_undo_compress_end(SculptUndoStep *us)
+{
+  if (us->compress_pool == NULL) {
+    return;
+  }
+  BLI_task_pool_work_and_wait(us->compress_pool);
+  BLI_task_pool_free(us->compress_pool);
+  us->compress_pool = NULL;
+
+  us->step.data_size = us->data.undo_size;
+}
+
+typedef struct SculptUndoDecompressData {
+  UndoSculpt *usculpt;
+  SculptUndoNode **nodes;
+} SculptUndoDecompressData;
+
+static void sculpt_undo_decompress_task_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptUndoDecompressData *data = userdata;
+  sculpt_undo_node_decompress(data->usculpt, data->nodes[i]);
+}
+
+/* Make the arrays of all nodes of the step accessible again. */
+static void sculpt_undo_decompress(SculptUndoStep *us)
+{
+  sculpt_undo_compress_end(us);
+
+  int totnode = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &us->data.nodes) {
+    if (unode->compressed) {
+      totnode++;
+    }
+  }
+  if (totnode == 0) {
+    return;
+  }
+
+  SculptUndoNode **nodes = MEM_mallocN(sizeof(*nodes) * totnode, __func__);
+  totnode = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &us->data.nodes) {
+    if (unode->compressed) {
+      nodes[totnode++] = unode;
+    }
+  }
+
+  SculptUndoDecompressData data = {
+      .usculpt = &us->data,
+      .nodes = nodes,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, totnode, &data, sculpt_undo_decompress_task_cb, &settings);
+
+  MEM_freeN(nodes);
+
+  us->step.data_size = us->data.undo_size;
+}
+
+/** \} */
+
 static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase *lb)
 {
   Scene *scene = CTX_data_scene(C);
@@ -932,6 +1191,10 @@ static void sculpt_undo_free_list(ListBase *lb)
       MEM_freeN(unode->face_sets);
     }
 
+    if (unode->compressed) {
+      MEM_freeN(unode->compressed);
+    }
+
     MEM_freeN(unode);
 
     unode = unode_next;
@@ -1632,6 +1895,10 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
     bmain->is_memfile_undo_flush_needed = true;
   }
 
+  /* The step is complete once encoded, also when it was pushed by an operator with
+   * `OPTYPE_UNDO` after #SCULPT_undo_push_end. */
+  sculpt_undo_compress_begin(us);
+
   return true;
 }
 
@@ -1641,7 +1908,9 @@ static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
 {
   BLI_assert(us->step.is_applied == true);
 
+  sculpt_undo_decompress(us);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_compress_begin(us);
   us->step.is_applied = false;
 }
 
@@ -1651,7 +1920,9 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
 {
   BLI_assert(us->step.is_applied == false);
 
+  sculpt_undo_decompress(us);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_compress_begin(us);
   us->step.is_applied = true;
 }
 
@@ -1765,6 +2036,7 @@ static void sculpt_undosys_step_decode(
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  sculpt_undo_compress_end(us);
   sculpt_undo_free_list(&us->data.nodes);
 }
 
@@ -1810,6 +2082,10 @@ static UndoSculpt *sculpt_undo_get_nodes(void)
 {
   UndoStack *ustack = ED_undo_stack_get();
   UndoStep *us = BKE_undosys_stack_init_or_active_with_type(ustack, BKE_UNDOSYS_TYPE_SCULPT);
+  if (us && us != ustack->step_init) {
+    /* Accessing the nodes of a pushed step, which may have been compressed. */
+    sculpt_undo_decompress((SculptUndoStep *)us);
+  }
   return sculpt_undosys_step_get_nodes(us);
 }
 
@@ -2940,6 +2940,11 @@ void IMAGE_OT_invert(wmOperatorType *ot)
 /** \name Scale Operator
  * \{ */
 
+enum {
+  IMAGE_SCALE_BOX = 0,
+  IMAGE_SCALE_LANCZOS = 1,
+};
+
 static int image_scale_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
 {
   Image *ima = image_from_context(C);
@@ -2985,7 +2990,12 @@ static int image_scale_exec(bContext *C, wmOperator *op)
   ED_image_undo_push_begin_with_image(op->type->name, ima, ibuf, &sima->iuser);
 
   ibuf->userflags |= IB_DISPLAY_BUFFER_INVALID;
-  IMB_scaleImBuf(ibuf, size[0], size[1]);
+  if (RNA_enum_get(op->ptr, "method") == IMAGE_SCALE_LANCZOS) {
+    IMB_scaleImBuf_lanczos(ibuf, size[0], size[1]);
+  }
+  else {
+    IMB_scaleImBuf(ibuf, size[0], size[1]);
+  }
   BKE_image_release_ibuf(ima, ibuf, NULL);
 
   ED_image_undo_push_end();
@@ -3000,6 +3010,16 @@ static int image_scale_exec(bContext *C, wmOperator *op)
 
 void IMAGE_OT_resize(wmOperatorType *ot)
 {
+  static const EnumPropertyItem method_items[] = {
+      {IMAGE_SCALE_BOX, "BOX", 0, "Box", "Average the pixels covered by each new pixel"},
+      {IMAGE_SCALE_LANCZOS,
+       "LANCZOS",
+       0,
+       "Lanczos",
+       "Sharper result without aliasing, slower to compute"},
+      {0, NULL, 0, NULL, NULL},
+  };
+
   /* identifiers */
   ot->name = "Resize Image";
   ot->idname = "IMAGE_OT_resize";
@@ -3012,6 +3032,12 @@ void IMAGE_OT_resize(wmOperatorType *ot)
 
   /* properties */
   RNA_def_int_vector(ot->srna, "size", 2, NULL, 1, INT_MAX, "Size", "", 1, SHRT_MAX);
+  RNA_def_enum(ot->srna,
+               "method",
+               method_items,
+               IMAGE_SCALE_BOX,
+               "Method",
+               "Filter used to compute the pixels of the resized image");
 
   /* flags */
   ot->flag = OPTYPE_REGISTER;
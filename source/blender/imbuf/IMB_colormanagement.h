@@ -298,6 +298,12 @@ void IMB_display_buffer_transform_apply(unsigned char *display_buffer,
 
 void IMB_display_buffer_release(void *cache_handle);
 
+/**
+ * Whether display buffers of large images drawn on screen are transformed through a baked LUT
+ * approximating the display transform, set from the user preferences.
+ */
+void IMB_colormanagement_display_lut_set_enabled(bool enabled);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -394,6 +400,10 @@ void IMB_partial_display_buffer_update_threaded(
     int xmax,
     int ymax);
 
+/**
+ * Mark the region as changed, display buffer tiles it overlaps are updated once the display
+ * buffer is acquired. Regions marked several times are only transformed once.
+ */
 void IMB_partial_display_buffer_update_delayed(
     struct ImBuf *ibuf, int xmin, int ymin, int xmax, int ymax);
 
@@ -449,6 +449,31 @@ struct ImBuf *IMB_anim_previewframe(struct anim *anim);
  */
 void IMB_free_anim(struct anim *anim);
 
+/**
+ * Same as #IMB_open_anim, but gives a movie of the same file and settings released with
+ * #IMB_anim_pool_release when there is one, with its decoder still open and positioned at the
+ * last fetched frame.
+ *
+ * \attention Defined in anim_movie.c
+ */
+struct anim *IMB_anim_pool_acquire(const char *name,
+                                   int ib_flags,
+                                   int streamindex,
+                                   char colorspace[IM_MAX_SPACE]);
+/**
+ * Same as #IMB_free_anim, but keeps movies with an open FFmpeg decoder for reuse by
+ * #IMB_anim_pool_acquire. Only a few of the most recently released movies are kept.
+ *
+ * \attention Defined in anim_movie.c
+ */
+void IMB_anim_pool_release(struct anim *anim);
+/**
+ * Free all movies kept for reuse.
+ *
+ * \attention Defined in anim_movie.c
+ */
+void IMB_anim_pool_clear(void);
+
 /**
  *
  * \attention Defined in filter.c
@@ -525,6 +550,16 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/**
+ * High quality scaling with a separable Lanczos filter, slower than #IMB_scaleImBuf but keeps
+ * more detail without aliasing. Byte buffers are filtered with premultiplied alpha.
+ *
+ * \attention Defined in scaling.c
+ *
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_lanczos(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -269,6 +269,8 @@ typedef struct ImBuf {
   struct ColormanageCache *colormanage_cache;
   int colormanage_flag;
   rcti invalid_rect;
+  /** tiles of invalid_rect to update, see #IMB_partial_display_buffer_update_delayed */
+  struct ImBufInvalidTiles *invalid_tiles;
 
   /* information for compressed textures */
   struct DDSData dds_data;
@@ -36,6 +36,12 @@ struct MovieCache *IMB_moviecache_create(const char *name,
                                          GHashCmpFP cmpfp);
 void IMB_moviecache_set_getdata_callback(struct MovieCache *cache,
                                          MovieCacheGetKeyDataFP getdatafp);
+/**
+ * Keep frames evicted by the cache limiter compressed in memory instead of freeing them, within a
+ * share of the cache limit. Worth it for frames which are slow to get again, like decoded movie
+ * frames. Getting a compressed frame decompresses it.
+ */
+void IMB_moviecache_set_compression(struct MovieCache *cache, bool use_compression);
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
                                           MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
@@ -21,6 +21,7 @@
 extern "C" {
 #endif
 
+struct ImBuf;
 struct StampData;
 
 void *IMB_exr_get_handle(void);
@@ -45,6 +46,35 @@ void IMB_exr_add_channel(void *handle,
  */
 bool IMB_exr_begin_read(
     void *handle, const char *filepath, int *width, int *height, bool parse_channels);
+/**
+ * Open a multi-layer file for reading single passes with #IMB_exr_read_pass. Views, layers and
+ * passes are parsed from the header but no pixels are read. The file is closed again, and only
+ * opened while a pass is read.
+ *
+ * \param metadata_ibuf: Optional image buffer to add the string attributes of the header to, since
+ * no image buffer is created for the file.
+ * \return false when the file can't be read or is not a multi-layer file.
+ */
+bool IMB_exr_begin_read_lazy(
+    void *handle, const char *filepath, int *width, int *height, struct ImBuf *metadata_ibuf);
+/**
+ * Decode the channels of a single pass of a file opened with #IMB_exr_begin_read_lazy.
+ *
+ * When the file was overwritten since it was opened, it is parsed again and the pass is read
+ * from the new file, as long as its size and layers still allow it.
+ *
+ * The whole data window of the pass is decoded. Passes are stored in the render result of the
+ * image and shared by all of its users, which would have to track which regions are loaded to
+ * read less, so there's no region argument.
+ *
+ * \param passname: Pass name without layer and view, as passed to #IMB_exr_multilayer_convert.
+ * \return Buffer of data window size with the pass channels interleaved, owned by the caller.
+ * Null when the pass doesn't exist or can't be read.
+ */
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname);
 /**
  * Used for output files (from #RenderResult) (single and multi-layer, single and multi-view).
  */
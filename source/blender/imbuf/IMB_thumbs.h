@@ -81,6 +81,13 @@ void IMB_thumb_makedirs(void);
 struct ImBuf *IMB_thumb_load_blend(const char *blen_path,
                                    const char *blen_group,
                                    const char *blen_id);
+/**
+ * Keep `.blend` files opened by #IMB_thumb_load_blend between these calls, so previews of many
+ * IDs of the same file don't reopen it for each ID. Calls can be nested, files are closed by the
+ * last end call. Done by #IMB_thumb_locks_acquire and #IMB_thumb_locks_release.
+ */
+void IMB_thumb_load_blend_cache_begin(void);
+void IMB_thumb_load_blend_cache_end(void);
 
 /**
  * Special function for previewing fonts.
@@ -92,6 +99,13 @@ void IMB_thumb_ensure_translations(void);
 
 /* Threading */
 
+/**
+ * Start managing thumbnails from multiple threads, with #IMB_thumb_path_lock.
+ *
+ * Until the matching #IMB_thumb_locks_release, thumbnails created by #IMB_thumb_manage and
+ * #IMB_thumb_create are written to the cache in the background instead of before returning.
+ * Release waits for all of them to be written.
+ */
 void IMB_thumb_locks_acquire(void);
 void IMB_thumb_locks_release(void);
 void IMB_thumb_path_lock(const char *path);
@@ -64,6 +64,9 @@
 
 #define MAXNUMSTREAMS 50
 
+/* Maximum number of decoded frames of the current GOP kept by FFmpeg movies. */
+#define FFMPEG_GOP_CACHE_MAX_FRAMES 64
+
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
@@ -120,6 +123,18 @@ struct anim {
   int64_t cur_pts;
   int64_t cur_key_frame_pts;
   AVPacket *cur_packet;
+
+  /* Timestamp and duration of the frame in `cur_frame_final`, which is not always the last
+   * decoded frame when it comes from the GOP cache. */
+  int64_t cur_frame_final_pts;
+  int64_t cur_frame_final_duration;
+
+  /* Decoded frames of the current GOP in presentation order, up to the last decoded frame. */
+  AVFrame *gop_frames[FFMPEG_GOP_CACHE_MAX_FRAMES];
+  int gop_frames_len;
+  int gop_frames_max;
+  /* Memory of one decoded frame, counted against the budget shared by all movies. */
+  size_t gop_frame_size;
 #endif
 
   char index_dir[768];
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+#pragma once
+
+/** \file
+ * \ingroup imbuf
+ *
+ * Baked 3D LUT approximation of display transforms, used as a fast path when converting scene
+ * linear float buffers to 8 bit display buffers.
+ *
+ * The LUT is sampled in a logarithmic shaper space covering `[0, COLORMANAGE_LUT_DOMAIN_MAX]`,
+ * with a grid node at exactly 1.0 so clipping to the display range stays exact. Pixels outside
+ * of that domain are passed to the exact transform the LUT was baked from.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of grid nodes along each axis of the LUT. */
+#define COLORMANAGE_LUT_SIZE 65
+/** Largest scene linear value covered by the LUT, larger values use the exact transform. */
+#define COLORMANAGE_LUT_DOMAIN_MAX 502.0f
+/**
+ * Largest allowed difference between the LUT and the exact transform, measured on bake on
+ * values clamped to the `[0, 1]` range of 8 bit display buffers.
+ */
+#define COLORMANAGE_LUT_MAX_ERROR (1.5f / 255.0f)
+
+typedef struct ColormanageLUT ColormanageLUT;
+
+/**
+ * Exact transform a LUT is baked from, transforms `num_pixels` RGB triplets in place.
+ * Must be thread-safe, it's called from multiple threads on bake and apply.
+ */
+typedef void (*ColormanageLUTTransformFn)(void *user_data, float *rgb, int num_pixels);
+
+/**
+ * Bake a LUT sampling given transform, which must stay valid until the LUT is freed.
+ *
+ * \return NULL when the LUT differs from the transform by more than
+ * #COLORMANAGE_LUT_MAX_ERROR, which happens for transforms with discontinuities or clipping
+ * the LUT grid can't follow. The exact transform should be used instead then.
+ */
+ColormanageLUT *colormanage_lut_bake(ColormanageLUTTransformFn transform, void *user_data);
+void colormanage_lut_free(ColormanageLUT *lut);
+
+/**
+ * Largest difference between the LUT and its exact transform found on bake.
+ */
+float colormanage_lut_max_error(const ColormanageLUT *lut);
+
+/**
+ * Transform `num_pixels` pixels of `channels` (3 or 4) floats in place, as the exact transform
+ * preceded by multiplying RGB by `scale` and followed by raising clamped RGB to `exponent`. This
+ * matches exposure and gamma of display processors, so they don't need a LUT of their own.
+ *
+ * With `predivide` RGB of 4 channel pixels is transformed unpremultiplied, alpha is unchanged.
+ */
+void colormanage_lut_apply(const ColormanageLUT *lut,
+                           float *buffer,
+                           size_t num_pixels,
+                           int channels,
+                           float scale,
+                           float exponent,
+                           bool predivide);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,10 @@
 
 #include "IMB_imbuf.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Generic File Type
  * \{ */
@@ -96,6 +100,11 @@ struct ImBuf *imb_loadpng(const unsigned char *mem,
                           int flags,
                           char colorspace[IM_MAX_SPACE]);
 bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags);
+/**
+ * \param use_threads: Filter and deflate bands of rows on multiple threads. This is decided based
+ * on the image size by #imb_savepng, both give valid PNG files but not the exact same bytes.
+ */
+bool imb_savepng_ex(struct ImBuf *ibuf, const char *filepath, int flags, bool use_threads);
 
 /** \} */
 
@@ -267,3 +276,7 @@ struct ImBuf *imb_loadwebp(const unsigned char *mem,
 bool imb_savewebp(struct ImBuf *ibuf, const char *name, int flags);
 
 /** \} */
+
+#ifdef __cplusplus
+}
+#endif
@@ -37,6 +37,8 @@
 #  include <io.h>
 #endif
 
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -488,6 +490,14 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+/* Memory used by the decoded frames kept in the GOP caches of all movies, see
+ * #ffmpeg_gop_cache_add. A budget per movie would multiply with the movies opened for every
+ * strip, and again for the copies used by sequencer prefetching. */
+#  define FFMPEG_GOP_CACHE_MEMORY (256 * 1024 * 1024)
+
+static ThreadMutex ffmpeg_gop_cache_mutex = BLI_MUTEX_INITIALIZER;
+static size_t ffmpeg_gop_cache_memory_used = 0;
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -682,6 +692,18 @@ static int startffmpeg(struct anim *anim)
   anim->cur_packet = av_packet_alloc();
   anim->cur_packet->stream_index = -1;
 
+  anim->cur_frame_final_pts = -1;
+  anim->cur_frame_final_duration = 0;
+  anim->gop_frames_len = 0;
+  anim->gop_frames_max = 0;
+  const int decoded_frame_size = av_image_get_buffer_size(
+      pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height, 1);
+  if (decoded_frame_size > 0) {
+    anim->gop_frame_size = (size_t)decoded_frame_size;
+    anim->gop_frames_max = MIN2(FFMPEG_GOP_CACHE_MEMORY / decoded_frame_size,
+                                FFMPEG_GOP_CACHE_MAX_FRAMES);
+  }
+
   anim->pFrame = av_frame_alloc();
   anim->pFrameComplete = false;
   anim->pFrameDeinterlaced = av_frame_alloc();
@@ -781,19 +803,18 @@ static int startffmpeg(struct anim *anim)
   return 0;
 }
 
-/* postprocess the image in anim->pFrame and do color conversion
+/* postprocess the decoded image in input and do color conversion
  * and deinterlacing stuff.
  *
  * Output is anim->cur_frame_final
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, AVFrame *input)
 {
-  AVFrame *input = anim->pFrame;
   ImBuf *ibuf = anim->cur_frame_final;
   int filter_y = 0;
 
-  if (!anim->pFrameComplete) {
+  if (input == NULL) {
     return;
   }
 
@@ -816,7 +837,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 
   if (anim->ib_flags & IB_animdeinterlace) {
     if (av_image_deinterlace(anim->pFrameDeinterlaced,
-                             anim->pFrame,
+                             input,
                              anim->pCodecCtx->pix_fmt,
                              anim->pCodecCtx->width,
                              anim->pCodecCtx->height) < 0) {
@@ -852,6 +873,85 @@ static void ffmpeg_postprocess(struct anim *anim)
   }
 }
 
+static void ffmpeg_gop_cache_clear(struct anim *anim)
+{
+  if (anim->gop_frames_len == 0) {
+    return;
+  }
+
+  for (int i = 0; i < anim->gop_frames_len; i++) {
+    av_frame_free(&anim->gop_frames[i]);
+  }
+
+  BLI_mutex_lock(&ffmpeg_gop_cache_mutex);
+  ffmpeg_gop_cache_memory_used -= anim->gop_frames_len * anim->gop_frame_size;
+  BLI_mutex_unlock(&ffmpeg_gop_cache_mutex);
+
+  anim->gop_frames_len = 0;
+}
+
+/* Keep a reference to the frame just decoded in anim->pFrame, so frames of the current GOP can be
+ * fetched again without seeking back to its key frame and decoding all frames up to them. */
+static void ffmpeg_gop_cache_add(struct anim *anim)
+{
+  if (anim->pFrame->key_frame) {
+    ffmpeg_gop_cache_clear(anim);
+  }
+
+  if (anim->gop_frames_max == 0) {
+    return;
+  }
+
+  bool drop_oldest = anim->gop_frames_len == anim->gop_frames_max;
+  if (!drop_oldest) {
+    BLI_mutex_lock(&ffmpeg_gop_cache_mutex);
+    if (ffmpeg_gop_cache_memory_used + anim->gop_frame_size <= FFMPEG_GOP_CACHE_MEMORY) {
+      ffmpeg_gop_cache_memory_used += anim->gop_frame_size;
+    }
+    else if (anim->gop_frames_len > 0) {
+      /* Budget is used up, reuse the memory of the oldest frame of this movie. */
+      drop_oldest = true;
+    }
+    else {
+      BLI_mutex_unlock(&ffmpeg_gop_cache_mutex);
+      return;
+    }
+    BLI_mutex_unlock(&ffmpeg_gop_cache_mutex);
+  }
+
+  if (drop_oldest) {
+    /* Drop the oldest frame, the cache must stay contiguous up to the last decoded frame. */
+    av_frame_free(&anim->gop_frames[0]);
+    memmove(anim->gop_frames,
+            anim->gop_frames + 1,
+            sizeof(*anim->gop_frames) * (anim->gop_frames_len - 1));
+    anim->gop_frames_len--;
+  }
+
+  /* Only references the decoder buffers, no copy is made. */
+  AVFrame *frame = av_frame_clone(anim->pFrame);
+  if (frame == NULL) {
+    BLI_mutex_lock(&ffmpeg_gop_cache_mutex);
+    ffmpeg_gop_cache_memory_used -= anim->gop_frame_size;
+    BLI_mutex_unlock(&ffmpeg_gop_cache_mutex);
+    return;
+  }
+  anim->gop_frames[anim->gop_frames_len++] = frame;
+}
+
+/* Find the frame that the pts belongs to among the decoded frames of the current GOP. */
+static AVFrame *ffmpeg_gop_cache_lookup(struct anim *anim, int64_t pts_to_search)
+{
+  for (int i = 0; i < anim->gop_frames_len; i++) {
+    AVFrame *frame = anim->gop_frames[i];
+    int64_t diff = pts_to_search - av_get_pts_from_frame(frame);
+    if (diff >= 0 && diff < frame->pkt_duration) {
+      return frame;
+    }
+  }
+  return NULL;
+}
+
 static void ffmpeg_decode_store_frame_pts(struct anim *anim)
 {
   anim->cur_pts = av_get_pts_from_frame(anim->pFrame);
@@ -860,6 +960,8 @@ static void ffmpeg_decode_store_frame_pts(struct anim *anim)
     anim->cur_key_frame_pts = anim->cur_pts;
   }
 
+  ffmpeg_gop_cache_add(anim);
+
   av_log(anim->pFormatCtx,
          AV_LOG_DEBUG,
          "  FRAME DONE: cur_pts=%" PRId64 ", guessed_pts=%" PRId64 "\n",
@@ -1035,12 +1137,12 @@ static int64_t ffmpeg_get_pts_to_search(struct anim *anim,
   return pts_to_search;
 }
 
-/* Check if the pts will get us the same frame that we already have in memory from last decode. */
+/* Check if the pts will get us the same frame that we already have in memory from last fetch. */
 static bool ffmpeg_pts_matches_last_frame(struct anim *anim, int64_t pts_to_search)
 {
-  if (anim->pFrame && anim->cur_frame_final) {
-    int64_t diff = pts_to_search - anim->cur_pts;
-    return diff >= 0 && diff < anim->pFrame->pkt_duration;
+  if (anim->cur_frame_final) {
+    int64_t diff = pts_to_search - anim->cur_frame_final_pts;
+    return diff >= 0 && diff < anim->cur_frame_final_duration;
   }
 
   return false;
@@ -1299,6 +1401,7 @@ static int ffmpeg_seek_to_key_frame(struct anim *anim,
   /* Flush the internal buffers of ffmpeg. This needs to be done after seeking to avoid decoding
    * errors. */
   avcodec_flush_buffers(anim->pCodecCtx);
+  ffmpeg_gop_cache_clear(anim);
 
   anim->cur_pts = -1;
 
@@ -1338,18 +1441,34 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     av_log(anim->pFormatCtx,
            AV_LOG_DEBUG,
            "FETCH: frame repeat: pts: %" PRId64 "\n",
-           (int64_t)anim->cur_pts);
+           (int64_t)anim->cur_frame_final_pts);
     IMB_refImBuf(anim->cur_frame_final);
     anim->cur_position = position;
     return anim->cur_frame_final;
   }
 
-  if (position == anim->cur_position + 1 || ffmpeg_is_first_frame_decode(anim, position)) {
-    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: no seek necessary, just continue...\n");
-    ffmpeg_decode_video_frame(anim);
+  /* Frames of the GOP cache are contiguous up to the last decoded frame. When the requested frame
+   * isn't one of them, the previously fetched frame is the last decoded one or the requested frame
+   * is before the cached ones, so decoding can continue or seek as if there was no cache. */
+  AVFrame *frame = ffmpeg_gop_cache_lookup(anim, pts_to_search);
+  if (frame != NULL) {
+    av_log(anim->pFormatCtx,
+           AV_LOG_DEBUG,
+           "FETCH: frame from GOP cache: pts: %" PRId64 "\n",
+           av_get_pts_from_frame(frame));
   }
-  else if (ffmpeg_seek_to_key_frame(anim, position, tc_index, pts_to_search) >= 0) {
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+  else {
+    if (position == anim->cur_position + 1 || ffmpeg_is_first_frame_decode(anim, position)) {
+      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: no seek necessary, just continue...\n");
+      ffmpeg_decode_video_frame(anim);
+    }
+    else if (ffmpeg_seek_to_key_frame(anim, position, tc_index, pts_to_search) >= 0) {
+      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    }
+
+    if (anim->pFrameComplete) {
+      frame = anim->pFrame;
+    }
   }
 
   IMB_freeImBuf(anim->cur_frame_final);
@@ -1387,7 +1506,15 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   anim->cur_frame_final->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-  ffmpeg_postprocess(anim);
+  ffmpeg_postprocess(anim, frame);
+
+  if (frame != NULL) {
+    anim->cur_frame_final_pts = av_get_pts_from_frame(frame);
+    anim->cur_frame_final_duration = frame->pkt_duration;
+  }
+  else {
+    anim->cur_frame_final_duration = 0;
+  }
 
   anim->cur_position = position;
 
@@ -1410,6 +1537,7 @@ static void free_anim_ffmpeg(struct anim *anim)
     av_frame_free(&anim->pFrame);
     av_frame_free(&anim->pFrameRGB);
     av_frame_free(&anim->pFrameDeinterlaced);
+    ffmpeg_gop_cache_clear(anim);
 
     sws_freeContext(anim->img_convert_ctx);
     IMB_freeImBuf(anim->cur_frame_final);
@@ -1643,3 +1771,139 @@ int IMB_anim_get_image_height(struct anim *anim)
 {
   return anim->y;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Decoder Pool
+ *
+ * Opening a movie file and its decoder is slow, and the decoder state is lost with it: the next
+ * fetch has to seek back to a key frame and decode up to the requested frame again. Released
+ * movies with an open FFmpeg decoder are kept here, to be given again to the next user of the
+ * same file with the same settings. Strips of the same file, strips going in and out of view and
+ * the copies of strips used by prefetching reuse decoders this way.
+ * \{ */
+
+/* Maximum number of released movies kept with an open decoder. */
+#define ANIM_POOL_MAX_IDLE 8
+
+typedef struct AnimPoolEntry {
+  struct AnimPoolEntry *next, *prev;
+  struct anim *anim;
+  /* File state when the movie was released, it's not reused when the file changed. */
+  int64_t file_mtime;
+  int64_t file_size;
+} AnimPoolEntry;
+
+static ListBase anim_pool = {NULL, NULL};
+static ThreadMutex anim_pool_mutex = BLI_MUTEX_INITIALIZER;
+
+static void anim_pool_entry_free(AnimPoolEntry *entry)
+{
+  IMB_free_anim(entry->anim);
+  MEM_freeN(entry);
+}
+
+struct anim *IMB_anim_pool_acquire(const char *name,
+                                   int ib_flags,
+                                   int streamindex,
+                                   char colorspace[IM_MAX_SPACE])
+{
+  /* Only allocates, the file is opened on first fetch. Also gives the colorspace to match. */
+  struct anim *anim = IMB_open_anim(name, ib_flags, streamindex, colorspace);
+  if (anim == NULL) {
+    return NULL;
+  }
+
+  BLI_stat_t st;
+  if (BLI_stat(anim->name, &st) != 0) {
+    return anim;
+  }
+
+  ListBase stale_entries = {NULL, NULL};
+  AnimPoolEntry *found = NULL;
+
+  BLI_mutex_lock(&anim_pool_mutex);
+  LISTBASE_FOREACH_MUTABLE (AnimPoolEntry *, entry, &anim_pool) {
+    struct anim *pooled = entry->anim;
+    if (!STREQ(pooled->name, anim->name) || pooled->ib_flags != anim->ib_flags ||
+        pooled->streamindex != anim->streamindex || !STREQ(pooled->colorspace, anim->colorspace)) {
+      continue;
+    }
+    BLI_remlink(&anim_pool, entry);
+    if (entry->file_mtime != (int64_t)st.st_mtime || entry->file_size != (int64_t)st.st_size) {
+      BLI_addtail(&stale_entries, entry);
+      continue;
+    }
+    found = entry;
+    break;
+  }
+  BLI_mutex_unlock(&anim_pool_mutex);
+
+  LISTBASE_FOREACH_MUTABLE (AnimPoolEntry *, entry, &stale_entries) {
+    anim_pool_entry_free(entry);
+  }
+
+  if (found) {
+    IMB_free_anim(anim);
+    anim = found->anim;
+    MEM_freeN(found);
+  }
+  return anim;
+}
+
+void IMB_anim_pool_release(struct anim *anim)
+{
+  if (anim == NULL) {
+    return;
+  }
+
+#ifdef WITH_FFMPEG
+  BLI_stat_t st;
+  if (anim->curtype != ANIM_FFMPEG || anim->pCodecCtx == NULL || BLI_stat(anim->name, &st) != 0) {
+    IMB_free_anim(anim);
+    return;
+  }
+
+  /* Only the decoder is kept. Indices and proxies are fast to open again, their files may be
+   * rebuilt meanwhile, and the next user sets its own proxy directory and suffix. */
+  IMB_free_indices(anim);
+  anim->index_dir[0] = '\0';
+  anim->suffix[0] = '\0';
+  ffmpeg_gop_cache_clear(anim);
+  IMB_freeImBuf(anim->cur_frame_final);
+  anim->cur_frame_final = NULL;
+
+  AnimPoolEntry *entry = MEM_mallocN(sizeof(AnimPoolEntry), __func__);
+  entry->anim = anim;
+  entry->file_mtime = (int64_t)st.st_mtime;
+  entry->file_size = (int64_t)st.st_size;
+
+  AnimPoolEntry *oldest = NULL;
+  BLI_mutex_lock(&anim_pool_mutex);
+  BLI_addhead(&anim_pool, entry);
+  if (BLI_listbase_count_at_most(&anim_pool, ANIM_POOL_MAX_IDLE + 1) > ANIM_POOL_MAX_IDLE) {
+    oldest = anim_pool.last;
+    BLI_remlink(&anim_pool, oldest);
+  }
+  BLI_mutex_unlock(&anim_pool_mutex);
+
+  if (oldest) {
+    anim_pool_entry_free(oldest);
+  }
+#else
+  IMB_free_anim(anim);
+#endif
+}
+
+void IMB_anim_pool_clear(void)
+{
+  BLI_mutex_lock(&anim_pool_mutex);
+  ListBase entries = anim_pool;
+  BLI_listbase_clear(&anim_pool);
+  BLI_mutex_unlock(&anim_pool_mutex);
+
+  LISTBASE_FOREACH_MUTABLE (AnimPoolEntry *, entry, &entries) {
+    anim_pool_entry_free(entry);
+  }
+}
+
+/** \} */
@@ -7,6 +7,7 @@
 
 #include "IMB_colormanagement.h"
 #include "IMB_colormanagement_intern.h"
+#include "IMB_colormanagement_lut.h"
 
 #include <math.h>
 #include <string.h>
@@ -26,11 +27,13 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_appdir.h"
@@ -91,6 +94,12 @@ typedef struct ColormanageProcessor {
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
   CurveMapping *curve_mapping;
   bool is_data_result;
+
+  /* Baked approximation of the display transform used instead of `cpu_processor`, see
+   * #display_processor_use_lut. Exposure and gamma are applied on top of it. */
+  struct DisplayLUTCacheEntry *display_lut;
+  float display_lut_scale;
+  float display_lut_exponent;
 } ColormanageProcessor;
 
 static struct global_gpu_state {
@@ -714,6 +723,8 @@ void colormanagement_init(void)
   BLI_init_srgb_conversion();
 }
 
+static void display_lut_cache_free(void);
+
 void colormanagement_exit(void)
 {
   OCIO_gpuCacheFree();
@@ -737,6 +748,8 @@ void colormanagement_exit(void)
   memset(&global_gpu_state, 0, sizeof(global_gpu_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  display_lut_cache_free();
+
   colormanage_free_config();
 }
 
@@ -762,9 +775,12 @@ static bool colormanage_use_look(const char *look, const char *view_name)
   return (look_descr->is_noop == false && colormanage_compatible_look(look_descr, view_name));
 }
 
+static void invalid_tiles_free(ImBuf *ibuf);
+
 void colormanage_cache_free(ImBuf *ibuf)
 {
   MEM_SAFE_FREE(ibuf->display_buffer_flags);
+  invalid_tiles_free(ibuf);
 
   if (ibuf->colormanage_cache) {
     ColormanageCacheData *cache_data = colormanage_cachedata_get(ibuf);
@@ -1433,6 +1449,225 @@ const float *IMB_colormanagement_get_xyz_to_scene_linear()
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Display Transform LUTs
+ *
+ * Display transforms of large buffers converted to 8 bit display buffers go through a 3D LUT
+ * baked from the OCIO processor, see #ColormanageLUT. LUTs are baked without exposure and gamma,
+ * so they're shared by all view settings using the same look, view and display.
+ * \{ */
+
+/* Least number of pixels to transform for a LUT to be baked, smaller buffers use a LUT only when
+ * it already exists. Baking costs about as much as transforming twice this number of pixels. */
+#define DISPLAY_LUT_BAKE_MIN_PIXELS (COLORMANAGE_LUT_SIZE * COLORMANAGE_LUT_SIZE * \
+                                     COLORMANAGE_LUT_SIZE)
+/* Number of unused LUTs kept around. */
+#define DISPLAY_LUT_CACHE_MAX_UNUSED 4
+
+typedef struct DisplayLUTCacheEntry {
+  struct DisplayLUTCacheEntry *next, *prev;
+
+  char look[MAX_COLORSPACE_NAME];
+  char view_transform[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+
+  /* Display processor without exposure and gamma the LUT is baked from. */
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor;
+  /* NULL when the LUT isn't accurate enough, the exact processor is used then. */
+  ColormanageLUT *lut;
+
+  /* Protects baking, which happens outside of #display_lut_cache_lock so that display buffers
+   * of other views don't wait for it. */
+  ThreadMutex bake_lock;
+  bool is_baked;
+
+  /* Protected by #display_lut_cache_lock. */
+  int users;
+} DisplayLUTCacheEntry;
+
+/* Most recently used first. */
+static ListBase display_lut_cache = {NULL, NULL};
+static ThreadMutex display_lut_cache_lock = BLI_MUTEX_INITIALIZER;
+/* Set from the user preferences, see #IMB_colormanagement_display_lut_set_enabled. */
+static bool display_lut_enabled = true;
+
+static void display_lut_transform(void *user_data, float *rgb, int num_pixels)
+{
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor = user_data;
+
+  if (num_pixels == 1) {
+    OCIO_cpuProcessorApplyRGB(cpu_processor, rgb);
+    return;
+  }
+
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(rgb,
+                                                              num_pixels,
+                                                              1,
+                                                              3,
+                                                              sizeof(float),
+                                                              3 * sizeof(float),
+                                                              3 * sizeof(float) * num_pixels);
+  OCIO_cpuProcessorApply(cpu_processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+static void display_lut_cache_entry_free(DisplayLUTCacheEntry *entry)
+{
+  if (entry->lut) {
+    colormanage_lut_free(entry->lut);
+  }
+  if (entry->cpu_processor) {
+    OCIO_cpuProcessorRelease(entry->cpu_processor);
+  }
+  BLI_mutex_end(&entry->bake_lock);
+  MEM_freeN(entry);
+}
+
+static void display_lut_cache_free_unused(int max_unused)
+{
+  int num_unused = 0;
+  LISTBASE_FOREACH_MUTABLE (DisplayLUTCacheEntry *, entry, &display_lut_cache) {
+    if (entry->users == 0 && ++num_unused > max_unused) {
+      BLI_remlink(&display_lut_cache, entry);
+      display_lut_cache_entry_free(entry);
+    }
+  }
+}
+
+static void display_lut_cache_free(void)
+{
+  BLI_mutex_lock(&display_lut_cache_lock);
+  LISTBASE_FOREACH_MUTABLE (DisplayLUTCacheEntry *, entry, &display_lut_cache) {
+    BLI_assert_msg(entry->users == 0, "Display LUT is still in use");
+    display_lut_cache_entry_free(entry);
+  }
+  BLI_listbase_clear(&display_lut_cache);
+  BLI_mutex_unlock(&display_lut_cache_lock);
+}
+
+static void display_lut_release(DisplayLUTCacheEntry *entry);
+
+/**
+ * Get the LUT of the display transform, baking it when `allow_bake` is true and it wasn't baked
+ * yet. Baking happens with the lock of the entry only, so concurrent display buffer updates of
+ * the same view wait for a single bake, while other views aren't blocked.
+ */
+static DisplayLUTCacheEntry *display_lut_acquire(const char *look,
+                                                 const char *view_transform,
+                                                 const char *display,
+                                                 const bool allow_bake)
+{
+  BLI_mutex_lock(&display_lut_cache_lock);
+
+  DisplayLUTCacheEntry *entry;
+  for (entry = display_lut_cache.first; entry; entry = entry->next) {
+    if (STREQ(entry->look, look) && STREQ(entry->view_transform, view_transform) &&
+        STREQ(entry->display, display)) {
+      break;
+    }
+  }
+
+  if (entry == NULL && allow_bake) {
+    entry = MEM_callocN(sizeof(DisplayLUTCacheEntry), "display LUT cache entry");
+    STRNCPY(entry->look, look);
+    STRNCPY(entry->view_transform, view_transform);
+    STRNCPY(entry->display, display);
+    BLI_mutex_init(&entry->bake_lock);
+    BLI_addhead(&display_lut_cache, entry);
+  }
+  else if (entry) {
+    /* Keep most recently used LUTs first. */
+    BLI_remlink(&display_lut_cache, entry);
+    BLI_addhead(&display_lut_cache, entry);
+  }
+
+  if (entry) {
+    entry->users++;
+  }
+
+  display_lut_cache_free_unused(DISPLAY_LUT_CACHE_MAX_UNUSED);
+
+  BLI_mutex_unlock(&display_lut_cache_lock);
+
+  if (entry == NULL) {
+    return NULL;
+  }
+
+  /* Small buffers don't wait for a LUT being baked, the exact processor is as fast for them. */
+  if (allow_bake) {
+    BLI_mutex_lock(&entry->bake_lock);
+  }
+  else if (!BLI_mutex_trylock(&entry->bake_lock)) {
+    display_lut_release(entry);
+    return NULL;
+  }
+
+  if (!entry->is_baked && allow_bake) {
+    entry->cpu_processor = create_display_buffer_processor(
+        look, view_transform, display, 0.0f, 1.0f, global_role_scene_linear);
+    if (entry->cpu_processor) {
+      entry->lut = colormanage_lut_bake(display_lut_transform, entry->cpu_processor);
+    }
+    entry->is_baked = true;
+  }
+  const bool has_lut = entry->lut != NULL;
+
+  BLI_mutex_unlock(&entry->bake_lock);
+
+  if (!has_lut) {
+    /* Not baked yet, or known to be too inaccurate for this transform. The entry is kept so it
+     * isn't baked again. */
+    display_lut_release(entry);
+    return NULL;
+  }
+
+  return entry;
+}
+
+void IMB_colormanagement_display_lut_set_enabled(const bool enabled)
+{
+  display_lut_enabled = enabled;
+}
+
+static void display_lut_release(DisplayLUTCacheEntry *entry)
+{
+  BLI_mutex_lock(&display_lut_cache_lock);
+  BLI_assert(entry->users > 0);
+  entry->users--;
+  display_lut_cache_free_unused(DISPLAY_LUT_CACHE_MAX_UNUSED);
+  BLI_mutex_unlock(&display_lut_cache_lock);
+}
+
+/**
+ * Let the display processor transform `num_pixels` pixels through a LUT instead of its OCIO
+ * processor. Only meant for processors creating 8 bit display buffers drawn on screen, the LUT
+ * is accurate enough for those but not for float buffers or images written to files.
+ */
+static void display_processor_use_lut(ColormanageProcessor *cm_processor,
+                                      const ColorManagedViewSettings *view_settings,
+                                      const ColorManagedDisplaySettings *display_settings,
+                                      const size_t num_pixels)
+{
+  if (!display_lut_enabled || view_settings == NULL || cm_processor->cpu_processor == NULL ||
+      cm_processor->is_data_result) {
+    return;
+  }
+
+  cm_processor->display_lut = display_lut_acquire(view_settings->look,
+                                                  view_settings->view_transform,
+                                                  display_settings->display_device,
+                                                  num_pixels >= DISPLAY_LUT_BAKE_MIN_PIXELS);
+  if (cm_processor->display_lut) {
+    const float exposure = view_settings->exposure;
+    const float gamma = view_settings->gamma;
+    cm_processor->display_lut_scale = (exposure == 0.0f) ? 1.0f : powf(2.0f, exposure);
+    cm_processor->display_lut_exponent = (gamma == 1.0f) ? 1.0f :
+                                                           1.0f / max_ff(FLT_EPSILON, gamma);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Threaded Display Buffer Transform Routines
  * \{ */
@@ -1763,7 +1998,8 @@ static void colormanage_display_buffer_process_ex(
     float *display_buffer,
     unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    const bool use_display_lut)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1779,6 +2015,11 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    if (use_display_lut) {
+      BLI_assert(display_buffer == NULL);
+      display_processor_use_lut(
+          cm_processor, view_settings, display_settings, ((size_t)ibuf->x) * ibuf->y);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1798,8 +2039,9 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedViewSettings *view_settings,
                                                const ColorManagedDisplaySettings *display_settings)
 {
+  /* Display buffers are only drawn, a LUT is accurate enough for them. */
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /** \} */
@@ -2456,8 +2698,13 @@ static void colormanagement_imbuf_make_display_space(
     imb_addrectImBuf(ibuf);
   }
 
-  colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect, view_settings, display_settings);
+  /* Used for writing images, always with the exact transform. */
+  colormanage_display_buffer_process_ex(ibuf,
+                                        ibuf->rect_float,
+                                        (unsigned char *)ibuf->rect,
+                                        view_settings,
+                                        display_settings,
+                                        false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -2650,6 +2897,11 @@ ImBuf *IMB_colormanagement_imbuf_for_write(ImBuf *ibuf,
 /** \name Public Display Buffers Interfaces
  * \{ */
 
+static void display_buffer_update_invalid_tiles(
+    ImBuf *ibuf,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings);
+
 unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf,
                                           const ColorManagedViewSettings *view_settings,
                                           const ColorManagedDisplaySettings *display_settings,
@@ -2692,21 +2944,12 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf,
 
   if (ibuf->invalid_rect.xmin != ibuf->invalid_rect.xmax) {
     if ((ibuf->userflags & IB_DISPLAY_BUFFER_INVALID) == 0) {
-      IMB_partial_display_buffer_update_threaded(ibuf,
-                                                 ibuf->rect_float,
-                                                 (unsigned char *)ibuf->rect,
-                                                 ibuf->x,
-                                                 0,
-                                                 0,
-                                                 applied_view_settings,
-                                                 display_settings,
-                                                 ibuf->invalid_rect.xmin,
-                                                 ibuf->invalid_rect.ymin,
-                                                 ibuf->invalid_rect.xmax,
-                                                 ibuf->invalid_rect.ymax);
+      display_buffer_update_invalid_tiles(ibuf, applied_view_settings, display_settings);
+    }
+    else {
+      BLI_rcti_init(&ibuf->invalid_rect, 0, 0, 0, 0);
+      invalid_tiles_free(ibuf);
     }
-
-    BLI_rcti_init(&ibuf->invalid_rect, 0, 0, 0, 0);
   }
 
   BLI_thread_lock(LOCK_COLORMANAGE);
@@ -3388,7 +3631,116 @@ void IMB_colormanagement_colorspace_items_add(EnumPropertyItem **items, int *tot
  *
  * Updating happens for active display transformation only, all
  * the rest buffers would be marked as dirty
+ *
+ * Updated rectangles are split along a grid of #DISPLAY_BUFFER_TILE_SIZE tiles. Each tile is
+ * gathered into a float buffer and transformed at once, tiles are processed in parallel.
+ * Delayed updates only mark tiles as invalid, so overlapping updates of paint strokes are
+ * coalesced and each tile is transformed once when the display buffer is acquired.
+ */
+
+/** Size of the tiles partial updates are split in, matches paint undo and GPU update tiles. */
+#define DISPLAY_BUFFER_TILE_SIZE 64
+
+/**
+ * Tiles of the display buffer invalidated by #IMB_partial_display_buffer_update_delayed,
+ * a subset of `ImBuf.invalid_rect`. When missing all of the invalid rect is updated.
+ */
+typedef struct ImBufInvalidTiles {
+  int tiles_x, tiles_y;
+  BLI_bitmap *bitmap;
+} ImBufInvalidTiles;
+
+static int display_buffer_tiles_num(const int size)
+{
+  return (size + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE;
+}
+
+static void invalid_tiles_free(ImBuf *ibuf)
+{
+  if (ibuf->invalid_tiles) {
+    MEM_freeN(ibuf->invalid_tiles->bitmap);
+    MEM_freeN(ibuf->invalid_tiles);
+    ibuf->invalid_tiles = NULL;
+  }
+}
+
+static bool invalid_tiles_match_size(const ImBufInvalidTiles *tiles, const ImBuf *ibuf)
+{
+  return tiles->tiles_x == display_buffer_tiles_num(ibuf->x) &&
+         tiles->tiles_y == display_buffer_tiles_num(ibuf->y);
+}
+
+static void invalid_tiles_mark(ImBufInvalidTiles *tiles, const rcti *rect)
+{
+  const int tile_xmin = rect->xmin / DISPLAY_BUFFER_TILE_SIZE;
+  const int tile_ymin = rect->ymin / DISPLAY_BUFFER_TILE_SIZE;
+  const int tile_xmax = display_buffer_tiles_num(rect->xmax);
+  const int tile_ymax = display_buffer_tiles_num(rect->ymax);
+
+  for (int tile_y = tile_ymin; tile_y < tile_ymax; tile_y++) {
+    for (int tile_x = tile_xmin; tile_x < tile_xmax; tile_x++) {
+      BLI_BITMAP_ENABLE(tiles->bitmap, tile_y * tiles->tiles_x + tile_x);
+    }
+  }
+}
+
+/**
+ * Split \a rect along the tile grid, tiles are clipped to the rect.
+ * \return Number of tiles, the array is to be freed by the caller.
  */
+static int display_buffer_rect_split_tiles(const rcti *rect, rcti **r_tiles)
+{
+  const int tile_xmin = rect->xmin / DISPLAY_BUFFER_TILE_SIZE;
+  const int tile_ymin = rect->ymin / DISPLAY_BUFFER_TILE_SIZE;
+  const int tile_xmax = display_buffer_tiles_num(rect->xmax);
+  const int tile_ymax = display_buffer_tiles_num(rect->ymax);
+  const int tiles_num = (tile_xmax - tile_xmin) * (tile_ymax - tile_ymin);
+  rcti *tiles = MEM_mallocN(sizeof(rcti) * tiles_num, "display buffer tiles");
+  int i = 0;
+
+  for (int tile_y = tile_ymin; tile_y < tile_ymax; tile_y++) {
+    for (int tile_x = tile_xmin; tile_x < tile_xmax; tile_x++, i++) {
+      BLI_rcti_init(&tiles[i],
+                    max_ii(tile_x * DISPLAY_BUFFER_TILE_SIZE, rect->xmin),
+                    min_ii((tile_x + 1) * DISPLAY_BUFFER_TILE_SIZE, rect->xmax),
+                    max_ii(tile_y * DISPLAY_BUFFER_TILE_SIZE, rect->ymin),
+                    min_ii((tile_y + 1) * DISPLAY_BUFFER_TILE_SIZE, rect->ymax));
+    }
+  }
+
+  *r_tiles = tiles;
+  return tiles_num;
+}
+
+/**
+ * Tiles of the invalid rect marked by delayed updates, clipped to the invalid rect.
+ * \return Number of tiles, the array is to be freed by the caller.
+ */
+static int display_buffer_invalid_tiles_get(const ImBuf *ibuf,
+                                            const rcti *invalid_rect,
+                                            rcti **r_tiles)
+{
+  const ImBufInvalidTiles *invalid_tiles = ibuf->invalid_tiles;
+  rcti *tiles;
+  const int tiles_num = display_buffer_rect_split_tiles(invalid_rect, &tiles);
+
+  if (invalid_tiles == NULL || !invalid_tiles_match_size(invalid_tiles, ibuf)) {
+    *r_tiles = tiles;
+    return tiles_num;
+  }
+
+  int invalid_tiles_num = 0;
+  for (int i = 0; i < tiles_num; i++) {
+    const int tile_x = tiles[i].xmin / DISPLAY_BUFFER_TILE_SIZE;
+    const int tile_y = tiles[i].ymin / DISPLAY_BUFFER_TILE_SIZE;
+    if (BLI_BITMAP_TEST(invalid_tiles->bitmap, tile_y * invalid_tiles->tiles_x + tile_x)) {
+      tiles[invalid_tiles_num++] = tiles[i];
+    }
+  }
+
+  *r_tiles = tiles;
+  return invalid_tiles_num;
+}
 
 static void partial_buffer_update_rect(ImBuf *ibuf,
                                        unsigned char *display_buffer,
@@ -3408,96 +3760,100 @@ static void partial_buffer_update_rect(ImBuf *ibuf,
   int channels = ibuf->channels;
   float dither = ibuf->dither;
   ColorSpace *rect_colorspace = ibuf->rect_colorspace;
-  float *display_buffer_float = NULL;
   const int width = xmax - xmin;
   const int height = ymax - ymin;
   bool is_data = (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA) != 0;
 
-  if (dither != 0.0f) {
-    /* cm_processor is NULL in cases byte_buffer's space matches display
-     * buffer's space
-     * in this case we could skip extra transform and only apply dither
-     * use 4 channels for easier byte->float->byte conversion here so
-     * (this is only needed to apply dither, in other cases we'll convert
-     * byte buffer to display directly)
-     */
-    if (!cm_processor) {
-      channels = 4;
+  if (cm_processor) {
+    /* Gather pixels of the rect, so they are transformed at once rather than one by one. */
+    float *buffer = MEM_mallocN((size_t)channels * width * height * sizeof(float),
+                                "partial display buffer update");
+    float *fp = buffer;
+
+    if (!ELEM(channels, 1, 3, 4)) {
+      BLI_assert_msg(0, "Unsupported number of channels in partial buffer update");
+      MEM_freeN(buffer);
+      return;
     }
 
-    display_buffer_float = MEM_callocN((size_t)channels * width * height * sizeof(float),
-                                       "display buffer for dither");
-  }
-
-  if (cm_processor) {
     for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        size_t display_index = ((size_t)y * display_stride + x) * 4;
-        size_t linear_index = ((size_t)(y - linear_offset_y) * linear_stride +
-                               (x - linear_offset_x)) *
-                              channels;
-        float pixel[4];
+      size_t linear_index = ((size_t)(y - linear_offset_y) * linear_stride +
+                             (xmin - linear_offset_x)) *
+                            channels;
 
-        if (linear_buffer) {
-          if (channels == 4) {
-            copy_v4_v4(pixel, (float *)linear_buffer + linear_index);
-          }
-          else if (channels == 3) {
-            copy_v3_v3(pixel, (float *)linear_buffer + linear_index);
-            pixel[3] = 1.0f;
-          }
-          else if (channels == 1) {
-            pixel[0] = linear_buffer[linear_index];
-          }
-          else {
-            BLI_assert_msg(0, "Unsupported number of channels in partial buffer update");
-          }
-        }
-        else if (byte_buffer) {
+      if (linear_buffer) {
+        memcpy(fp, linear_buffer + linear_index, sizeof(float) * channels * width);
+        fp += channels * width;
+      }
+      else if (byte_buffer) {
+        for (x = xmin; x < xmax; x++, fp += channels, linear_index += channels) {
+          float pixel[4];
           rgba_uchar_to_float(pixel, byte_buffer + linear_index);
-          IMB_colormanagement_colorspace_to_scene_linear_v3(pixel, rect_colorspace);
-          straight_to_premul_v4(pixel);
+          memcpy(fp, pixel, sizeof(float) * channels);
         }
+      }
+    }
 
-        if (!is_data) {
-          IMB_colormanagement_processor_apply_pixel(cm_processor, pixel, channels);
-        }
+    if (linear_buffer == NULL && byte_buffer != NULL && channels != 1) {
+      IMB_colormanagement_colorspace_to_scene_linear(
+          buffer, width, height, channels, rect_colorspace, false);
+      IMB_premultiply_rect_float(buffer, channels, width, height);
+    }
 
-        if (display_buffer_float) {
-          size_t index = ((size_t)(y - ymin) * width + (x - xmin)) * channels;
+    if (!is_data) {
+      IMB_colormanagement_processor_apply(cm_processor, buffer, width, height, channels, true);
+    }
+
+    if (dither != 0.0f) {
+      size_t display_index = ((size_t)ymin * display_stride + xmin) * 4;
+
+      IMB_buffer_byte_from_float(display_buffer + display_index,
+                                 buffer,
+                                 channels,
+                                 dither,
+                                 IB_PROFILE_SRGB,
+                                 IB_PROFILE_SRGB,
+                                 true,
+                                 width,
+                                 height,
+                                 display_stride,
+                                 width);
+    }
+    else {
+      fp = buffer;
+      for (y = ymin; y < ymax; y++) {
+        for (x = xmin; x < xmax; x++, fp += channels) {
+          size_t display_index = ((size_t)y * display_stride + x) * 4;
 
-          if (channels == 4) {
-            copy_v4_v4(display_buffer_float + index, pixel);
-          }
-          else if (channels == 3) {
-            copy_v3_v3(display_buffer_float + index, pixel);
-          }
-          else /* if (channels == 1) */ {
-            display_buffer_float[index] = pixel[0];
-          }
-        }
-        else {
           if (channels == 4) {
             float pixel_straight[4];
-            premul_to_straight_v4_v4(pixel_straight, pixel);
+            premul_to_straight_v4_v4(pixel_straight, fp);
             rgba_float_to_uchar(display_buffer + display_index, pixel_straight);
           }
           else if (channels == 3) {
-            rgb_float_to_uchar(display_buffer + display_index, pixel);
+            rgb_float_to_uchar(display_buffer + display_index, fp);
             display_buffer[display_index + 3] = 255;
           }
           else /* if (channels == 1) */ {
             display_buffer[display_index] = display_buffer[display_index + 1] =
                 display_buffer[display_index + 2] = display_buffer[display_index + 3] =
-                    unit_float_to_uchar_clamp(pixel[0]);
+                    unit_float_to_uchar_clamp(fp[0]);
           }
         }
       }
     }
+
+    MEM_freeN(buffer);
   }
   else {
-    if (display_buffer_float) {
-      /* huh, for dither we need float buffer first, no cheaper way. currently */
+    if (dither != 0.0f) {
+      /* cm_processor is NULL in cases byte_buffer's space matches display
+       * buffer's space, in this case we could skip extra transform and only apply dither.
+       * Huh, for dither we need float buffer first, no cheaper way. currently */
+      float *display_buffer_float = MEM_callocN((size_t)4 * width * height * sizeof(float),
+                                                "display buffer for dither");
+      size_t display_index = ((size_t)ymin * display_stride + xmin) * 4;
+
       IMB_buffer_float_from_byte(display_buffer_float,
                                  byte_buffer,
                                  IB_PROFILE_SRGB,
@@ -3507,6 +3863,20 @@ static void partial_buffer_update_rect(ImBuf *ibuf,
                                  height,
                                  width,
                                  display_stride);
+
+      IMB_buffer_byte_from_float(display_buffer + display_index,
+                                 display_buffer_float,
+                                 4,
+                                 dither,
+                                 IB_PROFILE_SRGB,
+                                 IB_PROFILE_SRGB,
+                                 true,
+                                 width,
+                                 height,
+                                 display_stride,
+                                 width);
+
+      MEM_freeN(display_buffer_float);
     }
     else {
       int i;
@@ -3520,24 +3890,6 @@ static void partial_buffer_update_rect(ImBuf *ibuf,
       }
     }
   }
-
-  if (display_buffer_float) {
-    size_t display_index = ((size_t)ymin * display_stride + xmin) * channels;
-
-    IMB_buffer_byte_from_float(display_buffer + display_index,
-                               display_buffer_float,
-                               channels,
-                               dither,
-                               IB_PROFILE_SRGB,
-                               IB_PROFILE_SRGB,
-                               true,
-                               width,
-                               height,
-                               display_stride,
-                               width);
-
-    MEM_freeN(display_buffer_float);
-  }
 }
 
 typedef struct PartialThreadData {
@@ -3549,14 +3901,15 @@ typedef struct PartialThreadData {
   int linear_stride;
   int linear_offset_x, linear_offset_y;
   ColormanageProcessor *cm_processor;
-  int xmin, ymin, xmax;
+  const rcti *tiles;
 } PartialThreadData;
 
-static void partial_buffer_update_rect_thread_do(void *data_v, int scanline)
+static void partial_buffer_update_tile_thread_do(void *__restrict data_v,
+                                                 const int tile_index,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
 {
   PartialThreadData *data = (PartialThreadData *)data_v;
-  int ymin = data->ymin + scanline;
-  const int num_scanlines = 1;
+  const rcti *tile = &data->tiles[tile_index];
   partial_buffer_update_rect(data->ibuf,
                              data->display_buffer,
                              data->linear_buffer,
@@ -3566,10 +3919,10 @@ static void partial_buffer_update_rect_thread_do(void *data_v, int scanline)
                              data->linear_offset_x,
                              data->linear_offset_y,
                              data->cm_processor,
-                             data->xmin,
-                             ymin,
-                             data->xmax,
-                             ymin + num_scanlines);
+                             tile->xmin,
+                             tile->ymin,
+                             tile->xmax,
+                             tile->ymax);
 }
 
 static void imb_partial_display_buffer_update_ex(
@@ -3581,10 +3934,8 @@ static void imb_partial_display_buffer_update_ex(
     int offset_y,
     const ColorManagedViewSettings *view_settings,
     const ColorManagedDisplaySettings *display_settings,
-    int xmin,
-    int ymin,
-    int xmax,
-    int ymax,
+    const rcti *tiles,
+    const int tiles_num,
     bool do_threads)
 {
   ColormanageCacheViewSettings cache_view_settings;
@@ -3638,41 +3989,31 @@ static void imb_partial_display_buffer_update_ex(
     }
 
     if (!skip_transform) {
+      size_t num_pixels = 0;
+      for (int i = 0; i < tiles_num; i++) {
+        num_pixels += (size_t)BLI_rcti_size_x(&tiles[i]) * BLI_rcti_size_y(&tiles[i]);
+      }
+
       cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+      display_processor_use_lut(cm_processor, view_settings, display_settings, num_pixels);
     }
 
-    if (do_threads) {
-      PartialThreadData data;
-      data.ibuf = ibuf;
-      data.display_buffer = display_buffer;
-      data.linear_buffer = linear_buffer;
-      data.byte_buffer = byte_buffer;
-      data.display_stride = buffer_width;
-      data.linear_stride = stride;
-      data.linear_offset_x = offset_x;
-      data.linear_offset_y = offset_y;
-      data.cm_processor = cm_processor;
-      data.xmin = xmin;
-      data.ymin = ymin;
-      data.xmax = xmax;
-      IMB_processor_apply_threaded_scanlines(
-          ymax - ymin, partial_buffer_update_rect_thread_do, &data);
-    }
-    else {
-      partial_buffer_update_rect(ibuf,
-                                 display_buffer,
-                                 linear_buffer,
-                                 byte_buffer,
-                                 buffer_width,
-                                 stride,
-                                 offset_x,
-                                 offset_y,
-                                 cm_processor,
-                                 xmin,
-                                 ymin,
-                                 xmax,
-                                 ymax);
-    }
+    PartialThreadData data;
+    data.ibuf = ibuf;
+    data.display_buffer = display_buffer;
+    data.linear_buffer = linear_buffer;
+    data.byte_buffer = byte_buffer;
+    data.display_stride = buffer_width;
+    data.linear_stride = stride;
+    data.linear_offset_x = offset_x;
+    data.linear_offset_y = offset_y;
+    data.cm_processor = cm_processor;
+    data.tiles = tiles;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = do_threads && tiles_num > 1;
+    BLI_task_parallel_range(0, tiles_num, &data, partial_buffer_update_tile_thread_do, &settings);
 
     if (cm_processor) {
       IMB_colormanagement_processor_free(cm_processor);
@@ -3682,6 +4023,45 @@ static void imb_partial_display_buffer_update_ex(
   }
 }
 
+static void imb_partial_display_buffer_update_rect(
+    ImBuf *ibuf,
+    const float *linear_buffer,
+    const unsigned char *byte_buffer,
+    int stride,
+    int offset_x,
+    int offset_y,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    int xmin,
+    int ymin,
+    int xmax,
+    int ymax,
+    bool do_threads)
+{
+  rcti rect, *tiles;
+
+  if (xmin >= xmax || ymin >= ymax) {
+    return;
+  }
+
+  BLI_rcti_init(&rect, xmin, xmax, ymin, ymax);
+  const int tiles_num = display_buffer_rect_split_tiles(&rect, &tiles);
+
+  imb_partial_display_buffer_update_ex(ibuf,
+                                       linear_buffer,
+                                       byte_buffer,
+                                       stride,
+                                       offset_x,
+                                       offset_y,
+                                       view_settings,
+                                       display_settings,
+                                       tiles,
+                                       tiles_num,
+                                       do_threads);
+
+  MEM_freeN(tiles);
+}
+
 void IMB_partial_display_buffer_update(ImBuf *ibuf,
                                        const float *linear_buffer,
                                        const unsigned char *byte_buffer,
@@ -3695,19 +4075,19 @@ void IMB_partial_display_buffer_update(ImBuf *ibuf,
                                        int xmax,
                                        int ymax)
 {
-  imb_partial_display_buffer_update_ex(ibuf,
-                                       linear_buffer,
-                                       byte_buffer,
-                                       stride,
-                                       offset_x,
-                                       offset_y,
-                                       view_settings,
-                                       display_settings,
-                                       xmin,
-                                       ymin,
-                                       xmax,
-                                       ymax,
-                                       false);
+  imb_partial_display_buffer_update_rect(ibuf,
+                                         linear_buffer,
+                                         byte_buffer,
+                                         stride,
+                                         offset_x,
+                                         offset_y,
+                                         view_settings,
+                                         display_settings,
+                                         xmin,
+                                         ymin,
+                                         xmax,
+                                         ymax,
+                                         false);
 }
 
 void IMB_partial_display_buffer_update_threaded(
@@ -3724,34 +4104,95 @@ void IMB_partial_display_buffer_update_threaded(
     int xmax,
     int ymax)
 {
-  int width = xmax - xmin;
-  int height = ymax - ymin;
-  bool do_threads = (((size_t)width) * height >= 64 * 64);
-  imb_partial_display_buffer_update_ex(ibuf,
-                                       linear_buffer,
-                                       byte_buffer,
-                                       stride,
-                                       offset_x,
-                                       offset_y,
-                                       view_settings,
-                                       display_settings,
-                                       xmin,
-                                       ymin,
-                                       xmax,
-                                       ymax,
-                                       do_threads);
+  imb_partial_display_buffer_update_rect(ibuf,
+                                         linear_buffer,
+                                         byte_buffer,
+                                         stride,
+                                         offset_x,
+                                         offset_y,
+                                         view_settings,
+                                         display_settings,
+                                         xmin,
+                                         ymin,
+                                         xmax,
+                                         ymax,
+                                         true);
+}
+
+static void display_buffer_update_invalid_tiles(
+    ImBuf *ibuf,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  rcti invalid_rect, *tiles;
+
+  /* Delayed updates may be outside of the buffer. */
+  BLI_rcti_init(&invalid_rect, 0, ibuf->x, 0, ibuf->y);
+  if (BLI_rcti_isect(&invalid_rect, &ibuf->invalid_rect, &invalid_rect) &&
+      !BLI_rcti_is_empty(&invalid_rect)) {
+    const int tiles_num = display_buffer_invalid_tiles_get(ibuf, &invalid_rect, &tiles);
+
+    if (tiles_num) {
+      imb_partial_display_buffer_update_ex(ibuf,
+                                           ibuf->rect_float,
+                                           (unsigned char *)ibuf->rect,
+                                           ibuf->x,
+                                           0,
+                                           0,
+                                           view_settings,
+                                           display_settings,
+                                           tiles,
+                                           tiles_num,
+                                           true);
+    }
+
+    MEM_freeN(tiles);
+  }
+
+  BLI_rcti_init(&ibuf->invalid_rect, 0, 0, 0, 0);
+  invalid_tiles_free(ibuf);
 }
 
 void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin, int xmax, int ymax)
 {
+  ImBufInvalidTiles *invalid_tiles = ibuf->invalid_tiles;
+  rcti rect;
+
+  BLI_rcti_init(
+      &rect, max_ii(xmin, 0), min_ii(xmax, ibuf->x), max_ii(ymin, 0), min_ii(ymax, ibuf->y));
+  if (BLI_rcti_is_empty(&rect)) {
+    return;
+  }
+
+  if (invalid_tiles && !invalid_tiles_match_size(invalid_tiles, ibuf)) {
+    /* Buffer was resized, fall back to updating all of the invalid rect. */
+    invalid_tiles_free(ibuf);
+    invalid_tiles = NULL;
+  }
+
   if (ibuf->invalid_rect.xmin == ibuf->invalid_rect.xmax) {
-    BLI_rcti_init(&ibuf->invalid_rect, xmin, xmax, ymin, ymax);
+    ibuf->invalid_rect = rect;
+
+    if (invalid_tiles == NULL) {
+      invalid_tiles = MEM_mallocN(sizeof(ImBufInvalidTiles), "ImBufInvalidTiles");
+      invalid_tiles->tiles_x = display_buffer_tiles_num(ibuf->x);
+      invalid_tiles->tiles_y = display_buffer_tiles_num(ibuf->y);
+      invalid_tiles->bitmap = BLI_BITMAP_NEW(invalid_tiles->tiles_x * invalid_tiles->tiles_y,
+                                             "ImBufInvalidTiles bitmap");
+      ibuf->invalid_tiles = invalid_tiles;
+    }
+    else {
+      BLI_bitmap_set_all(
+          invalid_tiles->bitmap, false, invalid_tiles->tiles_x * invalid_tiles->tiles_y);
+    }
   }
   else {
-    rcti rect;
-    BLI_rcti_init(&rect, xmin, xmax, ymin, ymax);
     BLI_rcti_union(&ibuf->invalid_rect, &rect);
   }
+
+  if (invalid_tiles) {
+    invalid_tiles_mark(invalid_tiles, &rect);
+  }
 }
 
 /** \} */
@@ -3827,7 +4268,16 @@ void IMB_colormanagement_processor_apply_v4(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->cpu_processor) {
+  if (cm_processor->display_lut) {
+    colormanage_lut_apply(cm_processor->display_lut->lut,
+                          pixel,
+                          1,
+                          4,
+                          cm_processor->display_lut_scale,
+                          cm_processor->display_lut_exponent,
+                          false);
+  }
+  else if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorApplyRGBA(cm_processor->cpu_processor, pixel);
   }
 }
@@ -3839,7 +4289,16 @@ void IMB_colormanagement_processor_apply_v4_predivide(ColormanageProcessor *cm_p
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->cpu_processor) {
+  if (cm_processor->display_lut) {
+    colormanage_lut_apply(cm_processor->display_lut->lut,
+                          pixel,
+                          1,
+                          4,
+                          cm_processor->display_lut_scale,
+                          cm_processor->display_lut_exponent,
+                          true);
+  }
+  else if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorApplyRGBA_predivide(cm_processor->cpu_processor, pixel);
   }
 }
@@ -3850,7 +4309,16 @@ void IMB_colormanagement_processor_apply_v3(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->cpu_processor) {
+  if (cm_processor->display_lut) {
+    colormanage_lut_apply(cm_processor->display_lut->lut,
+                          pixel,
+                          1,
+                          3,
+                          cm_processor->display_lut_scale,
+                          cm_processor->display_lut_exponent,
+                          false);
+  }
+  else if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorApplyRGB(cm_processor->cpu_processor, pixel);
   }
 }
@@ -3896,7 +4364,16 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->cpu_processor && channels >= 3) {
+  if (cm_processor->display_lut && ELEM(channels, 3, 4)) {
+    colormanage_lut_apply(cm_processor->display_lut->lut,
+                          buffer,
+                          ((size_t)width) * height,
+                          channels,
+                          cm_processor->display_lut_scale,
+                          cm_processor->display_lut_exponent,
+                          predivide);
+  }
+  else if (cm_processor->cpu_processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3945,6 +4422,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorRelease(cm_processor->cpu_processor);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
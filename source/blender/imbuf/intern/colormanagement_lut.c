@@ -0,0 +1,402 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup imbuf
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_simd.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement_lut.h"
+
+#define LUT_SIZE COLORMANAGE_LUT_SIZE
+#define LUT_STRIDE_G LUT_SIZE
+#define LUT_STRIDE_B (LUT_SIZE * LUT_SIZE)
+
+/**
+ * Shaper mapping scene linear values to LUT grid coordinates:
+ * `log2(1 + x * SCALE) / log2(1 + MAX * SCALE) * (LUT_SIZE - 1)`.
+ *
+ * Nearly logarithmic, so that grid nodes are spread evenly in stops, and linear close to 0
+ * where the logarithm would waste nodes on values indistinguishable on displays.
+ * #COLORMANAGE_LUT_DOMAIN_MAX is `1 / SCALE + 2`, which puts 1.0 on the middle grid node.
+ */
+#define LUT_SHAPER_SCALE 500.0f
+
+struct ColormanageLUT {
+  ColormanageLUTTransformFn transform;
+  void *transform_data;
+
+  /** Multiplier of the shaper logarithm giving grid coordinates. */
+  float shaper_factor;
+  float max_error;
+
+  /** Transformed RGB of grid nodes, padded to 4 floats, red index varying fastest. */
+  float (*table)[4];
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Lookup
+ * \{ */
+
+#ifdef BLI_HAVE_SSE2
+
+/**
+ * `log2(x)` for `x >= 1`. The mantissa is normalized to `[sqrt(0.5), sqrt(2))`, where the
+ * series `log2(m) = 2 / ln(2) * (t + t^3 / 3 + t^5 / 5 + ...)` with `t = (m - 1) / (m + 1)`
+ * converges quickly, four terms give an error below 1e-7.
+ */
+MALWAYS_INLINE __m128 lut_log2_simd(const __m128 x)
+{
+  const __m128i sqrt_half_bits = _mm_set1_epi32(0x3f3504f3);
+  const __m128i offset_bits = _mm_sub_epi32(_mm_castps_si128(x), sqrt_half_bits);
+  const __m128 exponent = _mm_cvtepi32_ps(_mm_srai_epi32(offset_bits, 23));
+  const __m128 mantissa = _mm_castsi128_ps(
+      _mm_add_epi32(_mm_and_si128(offset_bits, _mm_set1_epi32(0x007fffff)), sqrt_half_bits));
+
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+  const __m128 t2 = _mm_mul_ps(t, t);
+  __m128 series = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f / 7.0f)));
+  series = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(t2, series));
+  series = _mm_add_ps(one, _mm_mul_ps(t2, series));
+  series = _mm_mul_ps(_mm_mul_ps(t, series), _mm_set1_ps((float)(2.0 / M_LN2)));
+
+  return _mm_add_ps(exponent, series);
+}
+
+#endif
+
+/**
+ * Tetrahedral interpolation of the LUT at given scene linear RGB, which must be inside of
+ * `[0, COLORMANAGE_LUT_DOMAIN_MAX]`.
+ *
+ * The grid cell is split in 6 tetrahedra sharing its diagonal, the one containing the sample is
+ * chosen by ordering the fractional coordinates. Unlike trilinear interpolation it only blends 4
+ * nodes, and keeps neutral colors exactly on the grey axis of the LUT.
+ */
+static void lut_interpolate(const ColormanageLUT *lut, const float rgb[3], float r_rgb[3])
+{
+  int index[3];
+  float fac[3];
+#ifdef BLI_HAVE_SSE2
+  {
+    const __m128 scaled = _mm_mul_ps(_mm_set_ps(0.0f, rgb[2], rgb[1], rgb[0]),
+                                     _mm_set1_ps(LUT_SHAPER_SCALE));
+    const __m128 position = _mm_mul_ps(lut_log2_simd(_mm_add_ps(_mm_set1_ps(1.0f), scaled)),
+                                       _mm_set1_ps(lut->shaper_factor));
+    const __m128i index_v = _mm_cvttps_epi32(
+        _mm_min_ps(position, _mm_set1_ps((float)(LUT_SIZE - 2))));
+    float fac_v4[4];
+    int index_v4[4];
+    _mm_storeu_ps(fac_v4, _mm_sub_ps(position, _mm_cvtepi32_ps(index_v)));
+    _mm_storeu_si128((__m128i *)index_v4, index_v);
+    for (int i = 0; i < 3; i++) {
+      index[i] = index_v4[i];
+      fac[i] = fac_v4[i];
+    }
+  }
+#else
+  for (int i = 0; i < 3; i++) {
+    const float position = log2f(1.0f + rgb[i] * LUT_SHAPER_SCALE) * lut->shaper_factor;
+    index[i] = min_ii((int)position, LUT_SIZE - 2);
+    fac[i] = position - (float)index[i];
+  }
+#endif
+
+  /* Walk from the cell origin to its opposite corner along axes ordered by decreasing fractional
+   * coordinate, which gives the nodes of the tetrahedron. Written without branches, which would
+   * mispredict a lot on noisy images. Ties only need to be broken consistently. */
+  const bool x_ge_y = fac[0] >= fac[1], x_ge_z = fac[0] >= fac[2], y_ge_z = fac[1] >= fac[2];
+  const int max_stride = (x_ge_y && x_ge_z) ? 1 : (y_ge_z ? LUT_STRIDE_G : LUT_STRIDE_B);
+  const int min_stride = (x_ge_z && y_ge_z) ? LUT_STRIDE_B : (x_ge_y ? LUT_STRIDE_G : 1);
+  const float max_fac = max_fff(fac[0], fac[1], fac[2]);
+  const float min_fac = min_fff(fac[0], fac[1], fac[2]);
+  const float mid_fac = fac[0] + fac[1] + fac[2] - max_fac - min_fac;
+
+  const int base = index[0] + index[1] * LUT_STRIDE_G + index[2] * LUT_STRIDE_B;
+  const int last = base + 1 + LUT_STRIDE_G + LUT_STRIDE_B;
+  const int first = base + max_stride;
+  const int second = last - min_stride;
+  const float w0 = 1.0f - max_fac;
+  const float w1 = max_fac - mid_fac;
+  const float w2 = mid_fac - min_fac;
+  const float w3 = min_fac;
+
+#ifdef BLI_HAVE_SSE2
+  __m128 result = _mm_mul_ps(_mm_load_ps(lut->table[base]), _mm_set1_ps(w0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(lut->table[first]), _mm_set1_ps(w1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(lut->table[second]), _mm_set1_ps(w2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(lut->table[last]), _mm_set1_ps(w3)));
+
+  float result_v4[4];
+  _mm_storeu_ps(result_v4, result);
+  r_rgb[0] = result_v4[0];
+  r_rgb[1] = result_v4[1];
+  r_rgb[2] = result_v4[2];
+#else
+  const float *c0 = lut->table[base], *c1 = lut->table[first];
+  const float *c2 = lut->table[second], *c3 = lut->table[last];
+  for (int i = 0; i < 3; i++) {
+    r_rgb[i] = w0 * c0[i] + w1 * c1[i] + w2 * c2[i] + w3 * c3[i];
+  }
+#endif
+}
+
+BLI_INLINE bool lut_domain_contains(const float rgb[3])
+{
+  /* Written so that NaN is outside of the domain. */
+  return (rgb[0] >= 0.0f && rgb[0] <= COLORMANAGE_LUT_DOMAIN_MAX) &&
+         (rgb[1] >= 0.0f && rgb[1] <= COLORMANAGE_LUT_DOMAIN_MAX) &&
+         (rgb[2] >= 0.0f && rgb[2] <= COLORMANAGE_LUT_DOMAIN_MAX);
+}
+
+/** Number of pixels outside of the LUT domain passed to the exact transform at once. */
+#define LUT_APPLY_BATCH_SIZE 256
+
+/**
+ * Store transformed RGB of a pixel, raised to `exponent` and premultiplied by `alpha` again when
+ * it was transformed unpremultiplied.
+ */
+BLI_INLINE void lut_store_pixel(float *pixel,
+                                const float rgb[3],
+                                const float exponent,
+                                const float alpha)
+{
+  for (int i = 0; i < 3; i++) {
+    const float value = (exponent != 1.0f) ? powf(max_ff(rgb[i], 0.0f), exponent) : rgb[i];
+    pixel[i] = value * alpha;
+  }
+}
+
+/**
+ * Alpha to unpremultiply RGB of a pixel with before the transform, 1 when the pixel is
+ * transformed as is.
+ */
+BLI_INLINE float lut_pixel_alpha(const float *pixel, const int channels, const bool predivide)
+{
+  return (predivide && channels == 4 && !ELEM(pixel[3], 0.0f, 1.0f)) ? pixel[3] : 1.0f;
+}
+
+/** Transform gathered pixels outside of the LUT domain with the exact transform. */
+static void lut_apply_outside(const ColormanageLUT *lut,
+                              float *buffer,
+                              const int channels,
+                              const float exponent,
+                              const bool predivide,
+                              float (*outside_rgb)[3],
+                              const size_t *outside_index,
+                              const int num_outside)
+{
+  lut->transform(lut->transform_data, outside_rgb[0], num_outside);
+  for (int i = 0; i < num_outside; i++) {
+    float *pixel = buffer + outside_index[i] * channels;
+    lut_store_pixel(pixel, outside_rgb[i], exponent, lut_pixel_alpha(pixel, channels, predivide));
+  }
+}
+
+void colormanage_lut_apply(const ColormanageLUT *lut,
+                           float *buffer,
+                           const size_t num_pixels,
+                           const int channels,
+                           const float scale,
+                           const float exponent,
+                           const bool predivide)
+{
+  BLI_assert(ELEM(channels, 3, 4));
+
+  /* Pixels outside of the domain are gathered, so the exact transform is called for many pixels
+   * at once instead of once per pixel. */
+  float outside_rgb[LUT_APPLY_BATCH_SIZE][3];
+  size_t outside_index[LUT_APPLY_BATCH_SIZE];
+  int num_outside = 0;
+
+  for (size_t i = 0; i < num_pixels; i++) {
+    float *pixel = buffer + i * channels;
+    const float alpha = lut_pixel_alpha(pixel, channels, predivide);
+    const float input_scale = scale / alpha;
+    float rgb[3] = {pixel[0] * input_scale, pixel[1] * input_scale, pixel[2] * input_scale};
+
+    if (lut_domain_contains(rgb)) {
+      lut_interpolate(lut, rgb, rgb);
+      lut_store_pixel(pixel, rgb, exponent, alpha);
+      continue;
+    }
+
+    copy_v3_v3(outside_rgb[num_outside], rgb);
+    outside_index[num_outside] = i;
+    num_outside++;
+
+    if (num_outside == LUT_APPLY_BATCH_SIZE) {
+      lut_apply_outside(
+          lut, buffer, channels, exponent, predivide, outside_rgb, outside_index, num_outside);
+      num_outside = 0;
+    }
+  }
+
+  if (num_outside > 0) {
+    lut_apply_outside(
+        lut, buffer, channels, exponent, predivide, outside_rgb, outside_index, num_outside);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Bake
+ * \{ */
+
+typedef struct LUTBakeData {
+  ColormanageLUT *lut;
+  /** Scene linear values of grid nodes along each axis. */
+  float nodes[LUT_SIZE];
+  /** Largest error found by the validation of each slice of cells. */
+  float slice_error[LUT_SIZE - 1];
+} LUTBakeData;
+
+static void lut_bake_slice(void *__restrict userdata,
+                           const int b,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LUTBakeData *data = userdata;
+  ColormanageLUT *lut = data->lut;
+  float(*rgb)[3] = MEM_mallocN(sizeof(*rgb) * LUT_STRIDE_B, __func__);
+
+  for (int g = 0; g < LUT_SIZE; g++) {
+    for (int r = 0; r < LUT_SIZE; r++) {
+      float *node = rgb[r + g * LUT_STRIDE_G];
+      node[0] = data->nodes[r];
+      node[1] = data->nodes[g];
+      node[2] = data->nodes[b];
+    }
+  }
+
+  lut->transform(lut->transform_data, rgb[0], LUT_STRIDE_B);
+
+  float(*table)[4] = lut->table + b * LUT_STRIDE_B;
+  for (int i = 0; i < LUT_STRIDE_B; i++) {
+    copy_v3_v3(table[i], rgb[i]);
+    table[i][3] = 0.0f;
+  }
+
+  MEM_freeN(rgb);
+}
+
+/**
+ * Compare the LUT against the exact transform at a point inside of each cell. Points vary from
+ * cell to cell, to catch errors on the faces and diagonals the tetrahedra split cells along.
+ */
+static void lut_validate_slice(void *__restrict userdata,
+                               const int b,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  static const float offsets[8][3] = {
+      {0.5f, 0.5f, 0.5f},
+      {0.1f, 0.5f, 0.9f},
+      {0.9f, 0.1f, 0.5f},
+      {0.5f, 0.9f, 0.1f},
+      {0.3f, 0.7f, 0.2f},
+      {0.7f, 0.2f, 0.3f},
+      {0.2f, 0.3f, 0.7f},
+      {0.9f, 0.9f, 0.1f},
+  };
+  const int num_cells = (LUT_SIZE - 1) * (LUT_SIZE - 1);
+
+  LUTBakeData *data = userdata;
+  ColormanageLUT *lut = data->lut;
+  float(*rgb)[3] = MEM_mallocN(sizeof(*rgb) * num_cells, __func__);
+  float(*exact)[3] = MEM_mallocN(sizeof(*exact) * num_cells, __func__);
+
+  for (int g = 0; g < LUT_SIZE - 1; g++) {
+    for (int r = 0; r < LUT_SIZE - 1; r++) {
+      const float *offset = offsets[(r + 3 * g + 5 * b) % ARRAY_SIZE(offsets)];
+      const int index[3] = {r, g, b};
+      float *point = rgb[r + g * (LUT_SIZE - 1)];
+      for (int i = 0; i < 3; i++) {
+        point[i] = interpf(data->nodes[index[i] + 1], data->nodes[index[i]], offset[i]);
+      }
+    }
+  }
+
+  memcpy(exact, rgb, sizeof(*rgb) * num_cells);
+  lut->transform(lut->transform_data, exact[0], num_cells);
+
+  float max_error = 0.0f;
+  for (int i = 0; i < num_cells; i++) {
+    float result[3];
+    lut_interpolate(lut, rgb[i], result);
+    for (int j = 0; j < 3; j++) {
+      if (isnan(result[j]) || isnan(exact[i][j])) {
+        max_error = FLT_MAX;
+        continue;
+      }
+      /* The LUT is used for 8 bit display buffers, where values are clamped to this range. */
+      max_error = max_ff(max_error,
+                         fabsf(clamp_f(result[j], 0.0f, 1.0f) - clamp_f(exact[i][j], 0.0f, 1.0f)));
+    }
+  }
+  data->slice_error[b] = max_error;
+
+  MEM_freeN(rgb);
+  MEM_freeN(exact);
+}
+
+ColormanageLUT *colormanage_lut_bake(ColormanageLUTTransformFn transform, void *user_data)
+{
+  ColormanageLUT *lut = MEM_callocN(sizeof(ColormanageLUT), "colormanage LUT");
+  lut->transform = transform;
+  lut->transform_data = user_data;
+  lut->table = MEM_mallocN_aligned(
+      sizeof(*lut->table) * LUT_SIZE * LUT_STRIDE_B, 16, "colormanage LUT table");
+
+  const double shaper_range = log2(1.0 + (double)COLORMANAGE_LUT_DOMAIN_MAX * LUT_SHAPER_SCALE);
+  lut->shaper_factor = (float)((LUT_SIZE - 1) / shaper_range);
+
+  LUTBakeData data;
+  data.lut = lut;
+  for (int i = 0; i < LUT_SIZE; i++) {
+    /* Inverse of the shaper, written to get 1.0 exactly on the middle node. */
+    const double value = pow(1.0 + (double)COLORMANAGE_LUT_DOMAIN_MAX * LUT_SHAPER_SCALE,
+                             (double)i / (LUT_SIZE - 1));
+    data.nodes[i] = (float)((value - 1.0) / LUT_SHAPER_SCALE);
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, LUT_SIZE, &data, lut_bake_slice, &settings);
+  BLI_task_parallel_range(0, LUT_SIZE - 1, &data, lut_validate_slice, &settings);
+
+  for (int b = 0; b < LUT_SIZE - 1; b++) {
+    lut->max_error = max_ff(lut->max_error, data.slice_error[b]);
+  }
+
+  if (lut->max_error > COLORMANAGE_LUT_MAX_ERROR) {
+    colormanage_lut_free(lut);
+    return NULL;
+  }
+
+  return lut;
+}
+
+void colormanage_lut_free(ColormanageLUT *lut)
+{
+  MEM_freeN(lut->table);
+  MEM_freeN(lut);
+}
+
+float colormanage_lut_max_error(const ColormanageLUT *lut)
+{
+  return lut->max_error;
+}
+
+/** \} */
@@ -0,0 +1,269 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.hh"
+
+#include "IMB_colormanagement_lut.h"
+
+namespace blender::imbuf::tests {
+
+/* Stand-ins for OCIO display processors, the LUT only sees the transform function. */
+
+static float srgb_encode(const float value)
+{
+  const float clamped = clamp_f(value, 0.0f, 1.0f);
+  return (clamped < 0.0031308f) ? clamped * 12.92f : 1.055f * powf(clamped, 1.0f / 2.4f) - 0.055f;
+}
+
+/** Like the Standard view: sRGB encoding of each channel. */
+static void standard_transform(void * /*user_data*/, float *rgb, int num_pixels)
+{
+  for (int i = 0; i < num_pixels * 3; i++) {
+    rgb[i] = srgb_encode(rgb[i]);
+  }
+}
+
+/** Like the Filmic view: logarithmic encoding of a wide range of stops, contrast curve, and
+ * desaturation. */
+static void filmic_transform(void * /*user_data*/, float *rgb, int num_pixels)
+{
+  for (int i = 0; i < num_pixels; i++, rgb += 3) {
+    float encoded[3];
+    for (int j = 0; j < 3; j++) {
+      const float log_value = log2f(max_ff(rgb[j], 1e-10f) / 0.18f);
+      const float t = clamp_f((log_value + 12.47393f) / (12.47393f + 12.526069f), 0.0f, 1.0f);
+      encoded[j] = t * t * (3.0f - 2.0f * t);
+    }
+    const float average = (encoded[0] + encoded[1] + encoded[2]) / 3.0f;
+    for (int j = 0; j < 3; j++) {
+      rgb[j] = interpf(encoded[j], average, 0.8f);
+    }
+  }
+}
+
+/** Hard threshold, which no LUT can follow. */
+static void threshold_transform(void * /*user_data*/, float *rgb, int num_pixels)
+{
+  for (int i = 0; i < num_pixels * 3; i++) {
+    rgb[i] = (rgb[i] > 0.3f) ? 1.0f : 0.0f;
+  }
+}
+
+/** Random scene linear color, spread evenly in stops from 2^-16 to `max_value`. */
+static void random_color(RandomNumberGenerator &rng, const float max_value, float r_rgb[3])
+{
+  for (int i = 0; i < 3; i++) {
+    r_rgb[i] = exp2f(interpf(log2f(max_value), -16.0f, rng.get_float()));
+  }
+}
+
+static float display_error(const float *result, const float *expected)
+{
+  float error = 0.0f;
+  for (int i = 0; i < 3; i++) {
+    error = max_ff(error,
+                   fabsf(clamp_f(result[i], 0.0f, 1.0f) - clamp_f(expected[i], 0.0f, 1.0f)));
+  }
+  return error;
+}
+
+static void test_accuracy(ColormanageLUTTransformFn transform)
+{
+  ColormanageLUT *lut = colormanage_lut_bake(transform, nullptr);
+  ASSERT_NE(lut, nullptr);
+  EXPECT_LE(colormanage_lut_max_error(lut), COLORMANAGE_LUT_MAX_ERROR);
+
+  RandomNumberGenerator rng(1);
+  float max_error = 0.0f;
+  for (int i = 0; i < 100000; i++) {
+    float result[3], expected[3];
+    random_color(rng, COLORMANAGE_LUT_DOMAIN_MAX, result);
+    copy_v3_v3(expected, result);
+
+    colormanage_lut_apply(lut, result, 1, 3, 1.0f, 1.0f, false);
+    transform(nullptr, expected, 1);
+    max_error = max_ff(max_error, display_error(result, expected));
+  }
+  /* Validation on bake only samples a few points per cell, allow some margin. */
+  EXPECT_LE(max_error, 2.0f * COLORMANAGE_LUT_MAX_ERROR);
+
+  colormanage_lut_free(lut);
+}
+
+TEST(colormanage_lut, accuracy_standard)
+{
+  test_accuracy(standard_transform);
+}
+
+TEST(colormanage_lut, accuracy_filmic)
+{
+  test_accuracy(filmic_transform);
+}
+
+TEST(colormanage_lut, exact_on_grid)
+{
+  ColormanageLUT *lut = colormanage_lut_bake(standard_transform, nullptr);
+  ASSERT_NE(lut, nullptr);
+
+  /* 1.0 is on a grid node, so the clipping of displays is kept sharp. */
+  const float values[] = {0.0f, 1.0f, COLORMANAGE_LUT_DOMAIN_MAX};
+  for (const float value : values) {
+    float result[3] = {value, value, value};
+    colormanage_lut_apply(lut, result, 1, 3, 1.0f, 1.0f, false);
+    EXPECT_NEAR(result[0], srgb_encode(value), 1e-5f);
+    EXPECT_NEAR(result[1], srgb_encode(value), 1e-5f);
+    EXPECT_NEAR(result[2], srgb_encode(value), 1e-5f);
+  }
+
+  colormanage_lut_free(lut);
+}
+
+TEST(colormanage_lut, outside_of_domain)
+{
+  ColormanageLUT *lut = colormanage_lut_bake(filmic_transform, nullptr);
+  ASSERT_NE(lut, nullptr);
+
+  /* Pixels with any channel outside of the domain use the exact transform. */
+  const float colors[][3] = {
+      {-0.5f, 0.2f, 0.3f},
+      {0.1f, COLORMANAGE_LUT_DOMAIN_MAX * 2.0f, 0.3f},
+      {0.1f, 0.2f, 1e30f},
+  };
+  for (const float *color : colors) {
+    float result[3], expected[3];
+    copy_v3_v3(result, color);
+    copy_v3_v3(expected, color);
+    colormanage_lut_apply(lut, result, 1, 3, 1.0f, 1.0f, false);
+    filmic_transform(nullptr, expected, 1);
+    EXPECT_EQ(result[0], expected[0]);
+    EXPECT_EQ(result[1], expected[1]);
+    EXPECT_EQ(result[2], expected[2]);
+  }
+
+  colormanage_lut_free(lut);
+}
+
+/** Filmic transform counting the number of calls in `user_data`. */
+static void filmic_transform_counted(void *user_data, float *rgb, int num_pixels)
+{
+  (*static_cast<int *>(user_data))++;
+  filmic_transform(nullptr, rgb, num_pixels);
+}
+
+TEST(colormanage_lut, outside_of_domain_batched)
+{
+  int num_calls = 0;
+  ColormanageLUT *lut = colormanage_lut_bake(filmic_transform_counted, &num_calls);
+  ASSERT_NE(lut, nullptr);
+
+  /* Every third pixel outside of the domain, with partially transparent pixels. */
+  const int num_pixels = 1000;
+  const float scale = 2.0f;
+  const float exponent = 1.0f / 2.2f;
+  Array<float> pixels(num_pixels * 4);
+  RandomNumberGenerator rng(3);
+  for (int i = 0; i < num_pixels; i++) {
+    float *pixel = &pixels[i * 4];
+    random_color(rng, 1.0f, pixel);
+    if (i % 3 == 0) {
+      pixel[i % 2] = (i % 4 == 0) ? -0.25f : COLORMANAGE_LUT_DOMAIN_MAX * 2.0f;
+    }
+    pixel[3] = (i % 5 == 0) ? 0.5f : 1.0f;
+  }
+  Array<float> result = pixels;
+
+  num_calls = 0;
+  colormanage_lut_apply(lut, result.data(), num_pixels, 4, scale, exponent, true);
+  /* Pixels outside of the domain are transformed together. */
+  EXPECT_LE(num_calls, 2);
+
+  for (int i = 0; i < num_pixels; i += 3) {
+    const float *pixel = &pixels[i * 4];
+    const float alpha = pixel[3];
+    float expected[3];
+    for (int j = 0; j < 3; j++) {
+      expected[j] = pixel[j] / alpha * scale;
+    }
+    filmic_transform(nullptr, expected, 1);
+    for (int j = 0; j < 3; j++) {
+      EXPECT_NEAR(result[i * 4 + j], powf(max_ff(expected[j], 0.0f), exponent) * alpha, 1e-6f);
+    }
+    EXPECT_EQ(result[i * 4 + 3], alpha);
+  }
+
+  colormanage_lut_free(lut);
+}
+
+TEST(colormanage_lut, exposure_gamma)
+{
+  ColormanageLUT *lut = colormanage_lut_bake(filmic_transform, nullptr);
+  ASSERT_NE(lut, nullptr);
+
+  const float scale = 4.0f;
+  const float exponent = 1.0f / 2.2f;
+
+  RandomNumberGenerator rng(2);
+  for (int i = 0; i < 1000; i++) {
+    float result[3], expected[3];
+    random_color(rng, 1.0f, result);
+    for (int j = 0; j < 3; j++) {
+      expected[j] = result[j] * scale;
+    }
+
+    /* Same as applying exposure before the LUT and gamma after it. */
+    colormanage_lut_apply(lut, result, 1, 3, scale, exponent, false);
+    colormanage_lut_apply(lut, expected, 1, 3, 1.0f, 1.0f, false);
+    for (int j = 0; j < 3; j++) {
+      EXPECT_NEAR(result[j], powf(max_ff(expected[j], 0.0f), exponent), 1e-6f);
+    }
+  }
+
+  colormanage_lut_free(lut);
+}
+
+TEST(colormanage_lut, predivide)
+{
+  ColormanageLUT *lut = colormanage_lut_bake(standard_transform, nullptr);
+  ASSERT_NE(lut, nullptr);
+
+  float pixels[3][4] = {
+      {0.1f, 0.2f, 0.3f, 0.5f},
+      {0.1f, 0.2f, 0.3f, 1.0f},
+      {0.1f, 0.2f, 0.3f, 0.0f},
+  };
+  float straight[3] = {0.2f, 0.4f, 0.6f};
+  float premultiplied[3] = {0.1f, 0.2f, 0.3f};
+  colormanage_lut_apply(lut, pixels[0], 3, 4, 1.0f, 1.0f, true);
+  colormanage_lut_apply(lut, straight, 1, 3, 1.0f, 1.0f, false);
+  colormanage_lut_apply(lut, premultiplied, 1, 3, 1.0f, 1.0f, false);
+
+  /* Partially transparent pixels are transformed unpremultiplied. */
+  EXPECT_NEAR(pixels[0][0], straight[0] * 0.5f, 1e-6f);
+  EXPECT_NEAR(pixels[0][1], straight[1] * 0.5f, 1e-6f);
+  EXPECT_NEAR(pixels[0][2], straight[2] * 0.5f, 1e-6f);
+  /* Opaque and fully transparent pixels as they are. */
+  for (int i = 1; i < 3; i++) {
+    EXPECT_NEAR(pixels[i][0], premultiplied[0], 1e-6f);
+    EXPECT_NEAR(pixels[i][1], premultiplied[1], 1e-6f);
+    EXPECT_NEAR(pixels[i][2], premultiplied[2], 1e-6f);
+  }
+  /* Alpha is left untouched. */
+  EXPECT_EQ(pixels[0][3], 0.5f);
+  EXPECT_EQ(pixels[1][3], 1.0f);
+  EXPECT_EQ(pixels[2][3], 0.0f);
+
+  colormanage_lut_free(lut);
+}
+
+TEST(colormanage_lut, reject_inaccurate)
+{
+  EXPECT_EQ(colormanage_lut_bake(threshold_transform, nullptr), nullptr);
+}
+
+}  // namespace blender::imbuf::tests
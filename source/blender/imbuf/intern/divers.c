@@ -7,6 +7,8 @@
 
 #include "BLI_math.h"
 #include "BLI_rect.h"
+#include "BLI_simd.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "IMB_filter.h"
@@ -62,7 +64,7 @@ MINLINE unsigned char ftochar(float value)
 }
 
 MINLINE void ushort_to_byte_dither_v4(
-    uchar b[4], const unsigned short us[4], DitherContext *di, float s, float t)
+    uchar b[4], const unsigned short us[4], const DitherContext *di, float s, float t)
 {
 #define USHORTTOFLOAT(val) ((float)val / 65535.0f)
   float dither_value = dither_random_value(s, t) * 0.0033f * di->dither;
@@ -76,7 +78,7 @@ MINLINE void ushort_to_byte_dither_v4(
 }
 
 MINLINE void float_to_byte_dither_v4(
-    uchar b[4], const float f[4], DitherContext *di, float s, float t)
+    uchar b[4], const float f[4], const DitherContext *di, float s, float t)
 {
   float dither_value = dither_random_value(s, t) * 0.0033f * di->dither;
 
@@ -86,171 +88,379 @@ MINLINE void float_to_byte_dither_v4(
   b[3] = unit_float_to_uchar_clamp(f[3]);
 }
 
-bool IMB_alpha_affects_rgb(const ImBuf *ibuf)
+#ifdef BLI_HAVE_SSE2
+/* Same rounding and clamping as #unit_float_to_uchar_clamp, the result is in the 32 bit lanes. */
+MALWAYS_INLINE __m128i float_to_uchar_clamp_simd(const __m128 value)
 {
-  return ibuf && (ibuf->flags & IB_alphamode_channel_packed) == 0;
+  const __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+  return _mm_cvttps_epi32(
+      _mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
 }
 
-void IMB_buffer_byte_from_float(uchar *rect_to,
-                                const float *rect_from,
-                                int channels_from,
-                                float dither,
-                                int profile_to,
-                                int profile_from,
-                                bool predivide,
-                                int width,
-                                int height,
-                                int stride_to,
-                                int stride_from)
+MALWAYS_INLINE __m128 alpha_lane_mask_simd(void)
 {
-  float tmp[4];
-  int x, y;
-  DitherContext *di = NULL;
-  float inv_width = 1.0f / width;
-  float inv_height = 1.0f / height;
+  return _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+}
 
-  /* we need valid profiles */
-  BLI_assert(profile_to != IB_PROFILE_NONE);
-  BLI_assert(profile_from != IB_PROFILE_NONE);
+/* Same as #premul_to_straight_v4_v4, pixels with zero or one alpha are kept as is. */
+MALWAYS_INLINE __m128 premul_to_straight_simd(const __m128 premul)
+{
+  const __m128 alpha = _mm_shuffle_ps(premul, premul, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 keep = _mm_or_ps(
+      _mm_or_ps(_mm_cmpeq_ps(alpha, _mm_setzero_ps()), _mm_cmpeq_ps(alpha, _mm_set1_ps(1.0f))),
+      alpha_lane_mask_simd());
+  const __m128 straight = _mm_mul_ps(premul, _mm_div_ps(_mm_set1_ps(1.0f), alpha));
+  return _mm_or_ps(_mm_and_ps(keep, premul), _mm_andnot_ps(keep, straight));
+}
 
-  if (dither) {
-    di = create_dither_context(dither);
+/* Same as #straight_to_premul_v4_v4. */
+MALWAYS_INLINE __m128 straight_to_premul_simd(const __m128 straight)
+{
+  const __m128 alpha = _mm_shuffle_ps(straight, straight, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 mask = alpha_lane_mask_simd();
+  return _mm_or_ps(_mm_and_ps(mask, straight),
+                   _mm_andnot_ps(mask, _mm_mul_ps(straight, alpha)));
+}
+
+MALWAYS_INLINE __m128i float_to_byte_pixel_simd(
+    const float *from, const bool predivide, const DitherContext *di, float s, float t)
+{
+  __m128 pixel = _mm_loadu_ps(from);
+  if (predivide) {
+    pixel = premul_to_straight_simd(pixel);
   }
+  if (di) {
+    /* Alpha is not dithered. */
+    const float dither_value = dither_random_value(s, t) * 0.0033f * di->dither;
+    pixel = _mm_add_ps(pixel, _mm_set_ps(0.0f, dither_value, dither_value, dither_value));
+  }
+  return float_to_uchar_clamp_simd(pixel);
+}
 
-  for (y = 0; y < height; y++) {
-    float t = y * inv_height;
+MALWAYS_INLINE void byte_to_float_pixel_simd(float *to,
+                                             const __m128i value,
+                                             const bool premultiply)
+{
+  __m128 pixel = _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(1.0f / 255.0f));
+  if (premultiply) {
+    pixel = straight_to_premul_simd(pixel);
+  }
+  _mm_storeu_ps(to, pixel);
+}
+#endif
 
-    if (channels_from == 1) {
-      /* single channel input */
-      const float *from = rect_from + ((size_t)stride_from) * y;
-      uchar *to = rect_to + ((size_t)stride_to) * y * 4;
+/**
+ * Convert a row of RGBA float pixels to bytes without color space conversion, the same as
+ * #rgba_float_to_uchar with optional un-premultiplying and dithering.
+ */
+static void float_to_byte_row_v4(uchar *to,
+                                 const float *from,
+                                 const int width,
+                                 const bool predivide,
+                                 const DitherContext *di,
+                                 const float inv_width,
+                                 const float t)
+{
+  int x = 0;
+#ifdef BLI_HAVE_SSE2
+  for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+    __m128i values[4];
+    for (int i = 0; i < 4; i++) {
+      values[i] = float_to_byte_pixel_simd(
+          from + i * 4, predivide, di, (float)(x + i) * inv_width, t);
+    }
+    _mm_storeu_si128((__m128i *)to,
+                     _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]),
+                                      _mm_packs_epi32(values[2], values[3])));
+  }
+  for (; x < width; x++, from += 4, to += 4) {
+    const __m128i value = float_to_byte_pixel_simd(from, predivide, di, (float)x * inv_width, t);
+    const __m128i words = _mm_packs_epi32(value, value);
+    const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    memcpy(to, &packed, sizeof(packed));
+  }
+#else
+  for (; x < width; x++, from += 4, to += 4) {
+    float straight[4];
+    const float *pixel = from;
+    if (predivide) {
+      premul_to_straight_v4_v4(straight, from);
+      pixel = straight;
+    }
+    if (di) {
+      float_to_byte_dither_v4(to, pixel, di, (float)x * inv_width, t);
+    }
+    else {
+      rgba_float_to_uchar(to, pixel);
+    }
+  }
+#endif
+}
 
-      for (x = 0; x < width; x++, from++, to += 4) {
-        to[0] = to[1] = to[2] = to[3] = unit_float_to_uchar_clamp(from[0]);
-      }
+/**
+ * Convert a row of RGBA byte pixels to float without color space conversion, the same as
+ * #rgba_uchar_to_float with optional premultiplying.
+ */
+static void byte_to_float_row_v4(float *to,
+                                 const uchar *from,
+                                 const int width,
+                                 const bool premultiply)
+{
+  int x = 0;
+#ifdef BLI_HAVE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+    const __m128i bytes = _mm_loadu_si128((const __m128i *)from);
+    const __m128i words_lo = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i words_hi = _mm_unpackhi_epi8(bytes, zero);
+    byte_to_float_pixel_simd(to, _mm_unpacklo_epi16(words_lo, zero), premultiply);
+    byte_to_float_pixel_simd(to + 4, _mm_unpackhi_epi16(words_lo, zero), premultiply);
+    byte_to_float_pixel_simd(to + 8, _mm_unpacklo_epi16(words_hi, zero), premultiply);
+    byte_to_float_pixel_simd(to + 12, _mm_unpackhi_epi16(words_hi, zero), premultiply);
+  }
+  for (; x < width; x++, from += 4, to += 4) {
+    int packed;
+    memcpy(&packed, from, sizeof(packed));
+    const __m128i bytes = _mm_cvtsi32_si128(packed);
+    byte_to_float_pixel_simd(
+        to, _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero), premultiply);
+  }
+#else
+  for (; x < width; x++, from += 4, to += 4) {
+    rgba_uchar_to_float(to, from);
+    if (premultiply) {
+      straight_to_premul_v4(to);
     }
-    else if (channels_from == 3) {
-      /* RGB input */
-      const float *from = rect_from + ((size_t)stride_from) * y * 3;
-      uchar *to = rect_to + ((size_t)stride_to) * y * 4;
+  }
+#endif
+}
 
-      if (profile_to == profile_from) {
-        /* no color space conversion */
-        for (x = 0; x < width; x++, from += 3, to += 4) {
-          rgb_float_to_uchar(to, from);
-          to[3] = 255;
-        }
+/**
+ * Convert a row of sRGB byte pixels to linear float using the lookup table of
+ * #srgb_to_linearrgb_uchar4, with optional premultiplying.
+ */
+static void srgb_byte_to_linear_float_row_v4(float *to,
+                                             const uchar *from,
+                                             const int width,
+                                             const bool premultiply)
+{
+  for (int x = 0; x < width; x++, from += 4, to += 4) {
+    srgb_to_linearrgb_uchar4(to, from);
+    if (premultiply) {
+#ifdef BLI_HAVE_SSE2
+      _mm_storeu_ps(to, straight_to_premul_simd(_mm_loadu_ps(to)));
+#else
+      straight_to_premul_v4(to);
+#endif
+    }
+  }
+}
+
+static void premultiply_row_v4(float *rect, const int width)
+{
+  for (int x = 0; x < width; x++, rect += 4) {
+#ifdef BLI_HAVE_SSE2
+    _mm_storeu_ps(rect, straight_to_premul_simd(_mm_loadu_ps(rect)));
+#else
+    straight_to_premul_v4(rect);
+#endif
+  }
+}
+
+/* Minimum number of pixels converted by a thread. */
+#define CONVERSION_GRAIN_SIZE (64 * 64)
+
+/**
+ * Run \a func for all rows of a buffer, threaded when the buffer is large enough for it to pay
+ * off.
+ */
+static void buffer_rows_parallel(const int width,
+                                 const int height,
+                                 void *userdata,
+                                 TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)width) * height >= 2 * CONVERSION_GRAIN_SIZE;
+  settings.min_iter_per_thread = max_ii(1, CONVERSION_GRAIN_SIZE / max_ii(width, 1));
+  BLI_task_parallel_range(0, height, userdata, func, &settings);
+}
+
+bool IMB_alpha_affects_rgb(const ImBuf *ibuf)
+{
+  return ibuf && (ibuf->flags & IB_alphamode_channel_packed) == 0;
+}
+
+typedef struct ByteFromFloatData {
+  uchar *rect_to;
+  const float *rect_from;
+  int channels_from;
+  const DitherContext *di;
+  int profile_to;
+  int profile_from;
+  bool predivide;
+  int width;
+  int stride_to;
+  int stride_from;
+  float inv_width;
+  float inv_height;
+} ByteFromFloatData;
+
+/**
+ * Convert row \a y of the buffer, \a from and \a to point to the first pixel of the row.
+ * The row index only affects dithering.
+ */
+static void buffer_byte_from_float_row(const ByteFromFloatData *data,
+                                       const float *from,
+                                       uchar *to,
+                                       const int y)
+{
+  const DitherContext *di = data->di;
+  const bool predivide = data->predivide;
+  const int width = data->width;
+  const float inv_width = data->inv_width;
+  const float t = y * data->inv_height;
+  float tmp[4];
+  int x;
+
+  if (data->channels_from == 1) {
+    /* single channel input */
+    for (x = 0; x < width; x++, from++, to += 4) {
+      to[0] = to[1] = to[2] = to[3] = unit_float_to_uchar_clamp(from[0]);
+    }
+  }
+  else if (data->channels_from == 3) {
+    /* RGB input */
+    if (data->profile_to == data->profile_from) {
+      /* no color space conversion */
+      for (x = 0; x < width; x++, from += 3, to += 4) {
+        rgb_float_to_uchar(to, from);
+        to[3] = 255;
       }
-      else if (profile_to == IB_PROFILE_SRGB) {
-        /* convert from linear to sRGB */
-        for (x = 0; x < width; x++, from += 3, to += 4) {
-          linearrgb_to_srgb_v3_v3(tmp, from);
-          rgb_float_to_uchar(to, tmp);
-          to[3] = 255;
-        }
+    }
+    else if (data->profile_to == IB_PROFILE_SRGB) {
+      /* convert from linear to sRGB */
+      for (x = 0; x < width; x++, from += 3, to += 4) {
+        linearrgb_to_srgb_v3_v3(tmp, from);
+        rgb_float_to_uchar(to, tmp);
+        to[3] = 255;
       }
-      else if (profile_to == IB_PROFILE_LINEAR_RGB) {
-        /* convert from sRGB to linear */
-        for (x = 0; x < width; x++, from += 3, to += 4) {
-          srgb_to_linearrgb_v3_v3(tmp, from);
-          rgb_float_to_uchar(to, tmp);
-          to[3] = 255;
-        }
+    }
+    else if (data->profile_to == IB_PROFILE_LINEAR_RGB) {
+      /* convert from sRGB to linear */
+      for (x = 0; x < width; x++, from += 3, to += 4) {
+        srgb_to_linearrgb_v3_v3(tmp, from);
+        rgb_float_to_uchar(to, tmp);
+        to[3] = 255;
       }
     }
-    else if (channels_from == 4) {
-      /* RGBA input */
-      const float *from = rect_from + ((size_t)stride_from) * y * 4;
-      uchar *to = rect_to + ((size_t)stride_to) * y * 4;
-
-      if (profile_to == profile_from) {
-        float straight[4];
+  }
+  else if (data->channels_from == 4) {
+    /* RGBA input */
+    if (data->profile_to == data->profile_from) {
+      /* no color space conversion */
+      float_to_byte_row_v4(to, from, width, predivide, di, inv_width, t);
+    }
+    else if (data->profile_to == IB_PROFILE_SRGB) {
+      /* convert from linear to sRGB */
+      unsigned short us[4];
+      float straight[4];
 
-        /* no color space conversion */
-        if (dither && predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            premul_to_straight_v4_v4(straight, from);
-            float_to_byte_dither_v4(to, straight, di, (float)x * inv_width, t);
-          }
-        }
-        else if (dither) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            float_to_byte_dither_v4(to, from, di, (float)x * inv_width, t);
-          }
-        }
-        else if (predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            premul_to_straight_v4_v4(straight, from);
-            rgba_float_to_uchar(to, straight);
-          }
+      for (x = 0; x < width; x++, from += 4, to += 4) {
+        if (predivide) {
+          premul_to_straight_v4_v4(straight, from);
+          linearrgb_to_srgb_ushort4(us, straight);
         }
         else {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            rgba_float_to_uchar(to, from);
-          }
-        }
-      }
-      else if (profile_to == IB_PROFILE_SRGB) {
-        /* convert from linear to sRGB */
-        unsigned short us[4];
-        float straight[4];
-
-        if (dither && predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            premul_to_straight_v4_v4(straight, from);
-            linearrgb_to_srgb_ushort4(us, from);
-            ushort_to_byte_dither_v4(to, us, di, (float)x * inv_width, t);
-          }
+          linearrgb_to_srgb_ushort4(us, from);
         }
-        else if (dither) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            linearrgb_to_srgb_ushort4(us, from);
-            ushort_to_byte_dither_v4(to, us, di, (float)x * inv_width, t);
-          }
-        }
-        else if (predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            premul_to_straight_v4_v4(straight, from);
-            linearrgb_to_srgb_ushort4(us, from);
-            ushort_to_byte_v4(to, us);
-          }
+        if (di) {
+          ushort_to_byte_dither_v4(to, us, di, (float)x * inv_width, t);
         }
         else {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            linearrgb_to_srgb_ushort4(us, from);
-            ushort_to_byte_v4(to, us);
-          }
+          ushort_to_byte_v4(to, us);
         }
       }
-      else if (profile_to == IB_PROFILE_LINEAR_RGB) {
-        /* convert from sRGB to linear */
-        if (dither && predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            srgb_to_linearrgb_predivide_v4(tmp, from);
-            float_to_byte_dither_v4(to, tmp, di, (float)x * inv_width, t);
-          }
+    }
+    else if (data->profile_to == IB_PROFILE_LINEAR_RGB) {
+      /* convert from sRGB to linear */
+      for (x = 0; x < width; x++, from += 4, to += 4) {
+        if (predivide) {
+          srgb_to_linearrgb_predivide_v4(tmp, from);
         }
-        else if (dither) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            srgb_to_linearrgb_v4(tmp, from);
-            float_to_byte_dither_v4(to, tmp, di, (float)x * inv_width, t);
-          }
+        else {
+          srgb_to_linearrgb_v4(tmp, from);
         }
-        else if (predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            srgb_to_linearrgb_predivide_v4(tmp, from);
-            rgba_float_to_uchar(to, tmp);
-          }
+        if (di) {
+          float_to_byte_dither_v4(to, tmp, di, (float)x * inv_width, t);
         }
         else {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            srgb_to_linearrgb_v4(tmp, from);
-            rgba_float_to_uchar(to, tmp);
-          }
+          rgba_float_to_uchar(to, tmp);
         }
       }
     }
   }
+}
+
+static void buffer_byte_from_float_task(void *__restrict data_v,
+                                        const int y,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ByteFromFloatData *data = (const ByteFromFloatData *)data_v;
+  const float *from = data->rect_from + ((size_t)data->stride_from) * y * data->channels_from;
+  uchar *to = data->rect_to + ((size_t)data->stride_to) * y * 4;
+  buffer_byte_from_float_row(data, from, to, y);
+}
+
+static void byte_from_float_data_init(ByteFromFloatData *data,
+                                      int channels_from,
+                                      const DitherContext *di,
+                                      int profile_to,
+                                      int profile_from,
+                                      bool predivide,
+                                      int width,
+                                      int height)
+{
+  data->channels_from = channels_from;
+  data->di = di;
+  data->profile_to = profile_to;
+  data->profile_from = profile_from;
+  data->predivide = predivide;
+  data->width = width;
+  data->inv_width = 1.0f / width;
+  data->inv_height = 1.0f / height;
+}
+
+void IMB_buffer_byte_from_float(uchar *rect_to,
+                                const float *rect_from,
+                                int channels_from,
+                                float dither,
+                                int profile_to,
+                                int profile_from,
+                                bool predivide,
+                                int width,
+                                int height,
+                                int stride_to,
+                                int stride_from)
+{
+  DitherContext *di = NULL;
+
+  /* we need valid profiles */
+  BLI_assert(profile_to != IB_PROFILE_NONE);
+  BLI_assert(profile_from != IB_PROFILE_NONE);
+
+  if (dither) {
+    di = create_dither_context(dither);
+  }
+
+  ByteFromFloatData data;
+  byte_from_float_data_init(
+      &data, channels_from, di, profile_to, profile_from, predivide, width, height);
+  data.rect_to = rect_to;
+  data.rect_from = rect_from;
+  data.stride_to = stride_to;
+  data.stride_from = stride_from;
+  buffer_rows_parallel(width, height, &data, buffer_byte_from_float_task);
 
   if (dither) {
     clear_dither_context(di);
@@ -347,6 +557,61 @@ void IMB_buffer_byte_from_float_mask(uchar *rect_to,
   }
 }
 
+typedef struct FloatFromByteData {
+  float *rect_to;
+  const uchar *rect_from;
+  int profile_to;
+  int profile_from;
+  bool predivide;
+  int width;
+  int stride_to;
+  int stride_from;
+} FloatFromByteData;
+
+static void buffer_float_from_byte_task(void *__restrict data_v,
+                                        const int y,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FloatFromByteData *data = (const FloatFromByteData *)data_v;
+  const uchar *from = data->rect_from + ((size_t)data->stride_from) * y * 4;
+  float *to = data->rect_to + ((size_t)data->stride_to) * y * 4;
+  const int width = data->width;
+  float tmp[4];
+  int x;
+
+  /* RGBA input */
+  if (data->profile_to == data->profile_from) {
+    /* no color space conversion */
+    byte_to_float_row_v4(to, from, width, false);
+  }
+  else if (data->profile_to == IB_PROFILE_LINEAR_RGB) {
+    /* convert sRGB to linear */
+    if (data->predivide) {
+      for (x = 0; x < width; x++, from += 4, to += 4) {
+        srgb_to_linearrgb_uchar4_predivide(to, from);
+      }
+    }
+    else {
+      srgb_byte_to_linear_float_row_v4(to, from, width, false);
+    }
+  }
+  else if (data->profile_to == IB_PROFILE_SRGB) {
+    /* convert linear to sRGB */
+    if (data->predivide) {
+      for (x = 0; x < width; x++, from += 4, to += 4) {
+        rgba_uchar_to_float(tmp, from);
+        linearrgb_to_srgb_predivide_v4(to, tmp);
+      }
+    }
+    else {
+      for (x = 0; x < width; x++, from += 4, to += 4) {
+        rgba_uchar_to_float(tmp, from);
+        linearrgb_to_srgb_v4(to, tmp);
+      }
+    }
+  }
+}
+
 void IMB_buffer_float_from_byte(float *rect_to,
                                 const uchar *rect_from,
                                 int profile_to,
@@ -357,53 +622,20 @@ void IMB_buffer_float_from_byte(float *rect_to,
                                 int stride_to,
                                 int stride_from)
 {
-  float tmp[4];
-  int x, y;
-
   /* we need valid profiles */
   BLI_assert(profile_to != IB_PROFILE_NONE);
   BLI_assert(profile_from != IB_PROFILE_NONE);
 
-  /* RGBA input */
-  for (y = 0; y < height; y++) {
-    const uchar *from = rect_from + ((size_t)stride_from) * y * 4;
-    float *to = rect_to + ((size_t)stride_to) * y * 4;
-
-    if (profile_to == profile_from) {
-      /* no color space conversion */
-      for (x = 0; x < width; x++, from += 4, to += 4) {
-        rgba_uchar_to_float(to, from);
-      }
-    }
-    else if (profile_to == IB_PROFILE_LINEAR_RGB) {
-      /* convert sRGB to linear */
-      if (predivide) {
-        for (x = 0; x < width; x++, from += 4, to += 4) {
-          srgb_to_linearrgb_uchar4_predivide(to, from);
-        }
-      }
-      else {
-        for (x = 0; x < width; x++, from += 4, to += 4) {
-          srgb_to_linearrgb_uchar4(to, from);
-        }
-      }
-    }
-    else if (profile_to == IB_PROFILE_SRGB) {
-      /* convert linear to sRGB */
-      if (predivide) {
-        for (x = 0; x < width; x++, from += 4, to += 4) {
-          rgba_uchar_to_float(tmp, from);
-          linearrgb_to_srgb_predivide_v4(to, tmp);
-        }
-      }
-      else {
-        for (x = 0; x < width; x++, from += 4, to += 4) {
-          rgba_uchar_to_float(tmp, from);
-          linearrgb_to_srgb_v4(to, tmp);
-        }
-      }
-    }
-  }
+  FloatFromByteData data;
+  data.rect_to = rect_to;
+  data.rect_from = rect_from;
+  data.profile_to = profile_to;
+  data.profile_from = profile_from;
+  data.predivide = predivide;
+  data.width = width;
+  data.stride_to = stride_to;
+  data.stride_from = stride_from;
+  buffer_rows_parallel(width, height, &data, buffer_float_from_byte_task);
 }
 
 void IMB_buffer_float_from_float(float *rect_to,
@@ -693,9 +925,49 @@ void IMB_buffer_byte_from_byte(uchar *rect_to,
 /** \name ImBuf Conversion
  * \{ */
 
+typedef struct RectFromFloatData {
+  ImBuf *ibuf;
+  /* Transform from the float to the byte color space, NULL when they are the same. */
+  struct ColormanageProcessor *cm_processor;
+  ByteFromFloatData convert;
+  int band_rows;
+} RectFromFloatData;
+
+static void rect_from_float_band(void *__restrict data_v,
+                                 const int band,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RectFromFloatData *data = (const RectFromFloatData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const int channels = ibuf->channels;
+  const int ymin = band * data->band_rows;
+  const int rows = min_ii(data->band_rows, ibuf->y - ymin);
+  const float *rect_float = ibuf->rect_float + ((size_t)ymin) * ibuf->x * channels;
+  float *buffer = NULL;
+
+  if (data->cm_processor) {
+    /* Transform a copy of the band, small enough to stay in cache until it's converted. */
+    const size_t size = sizeof(float) * channels * ibuf->x * rows;
+    buffer = MEM_mallocN(size, __func__);
+    memcpy(buffer, rect_float, size);
+    IMB_colormanagement_processor_apply(
+        data->cm_processor, buffer, ibuf->x, rows, channels, data->convert.predivide);
+    rect_float = buffer;
+  }
+
+  /* Convert float to byte, from float's premultiplied alpha to byte's straight alpha. */
+  for (int i = 0; i < rows; i++) {
+    buffer_byte_from_float_row(&data->convert,
+                               rect_float + ((size_t)i) * ibuf->x * channels,
+                               (uchar *)ibuf->rect + ((size_t)(ymin + i)) * ibuf->x * 4,
+                               ymin + i);
+  }
+
+  MEM_SAFE_FREE(buffer);
+}
+
 void IMB_rect_from_float(ImBuf *ibuf)
 {
-  float *buffer;
   const char *from_colorspace;
 
   /* verify we have a float buffer */
@@ -717,42 +989,84 @@ void IMB_rect_from_float(ImBuf *ibuf)
     from_colorspace = ibuf->float_colorspace->name;
   }
 
-  buffer = MEM_dupallocN(ibuf->rect_float);
-
-  /* first make float buffer in byte space */
-  const bool predivide = IMB_alpha_affects_rgb(ibuf);
-  IMB_colormanagement_transform(buffer,
-                                ibuf->x,
-                                ibuf->y,
-                                ibuf->channels,
-                                from_colorspace,
-                                ibuf->rect_colorspace->name,
-                                predivide);
-
-  /* convert from float's premul alpha to byte's straight alpha */
-  if (IMB_alpha_affects_rgb(ibuf)) {
-    IMB_unpremultiply_rect_float(buffer, ibuf->channels, ibuf->x, ibuf->y);
+  DitherContext *di = NULL;
+  if (ibuf->dither) {
+    di = create_dither_context(ibuf->dither);
   }
 
-  /* convert float to byte */
-  IMB_buffer_byte_from_float((unsigned char *)ibuf->rect,
-                             buffer,
-                             ibuf->channels,
-                             ibuf->dither,
-                             IB_PROFILE_SRGB,
-                             IB_PROFILE_SRGB,
-                             false,
-                             ibuf->x,
-                             ibuf->y,
-                             ibuf->x,
-                             ibuf->x);
-
-  MEM_freeN(buffer);
+  /* Bands of rows are transformed to byte space and converted in one go, instead of
+   * transforming a copy of the whole float buffer first. */
+  RectFromFloatData data;
+  data.ibuf = ibuf;
+  data.cm_processor = NULL;
+  if (from_colorspace[0] != '\0' && !STREQ(from_colorspace, ibuf->rect_colorspace->name)) {
+    data.cm_processor = IMB_colormanagement_colorspace_processor_new(
+        from_colorspace, ibuf->rect_colorspace->name);
+  }
+  byte_from_float_data_init(&data.convert,
+                            ibuf->channels,
+                            di,
+                            IB_PROFILE_SRGB,
+                            IB_PROFILE_SRGB,
+                            IMB_alpha_affects_rgb(ibuf),
+                            ibuf->x,
+                            ibuf->y);
+  data.band_rows = max_ii(1, CONVERSION_GRAIN_SIZE / max_ii(ibuf->x, 1));
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = IMB_get_rect_len(ibuf) >= 2 * CONVERSION_GRAIN_SIZE;
+  BLI_task_parallel_range(
+      0, divide_ceil_u(ibuf->y, data.band_rows), &data, rect_from_float_band, &settings);
+
+  if (data.cm_processor) {
+    IMB_colormanagement_processor_free(data.cm_processor);
+  }
+  if (di) {
+    clear_dither_context(di);
+  }
 
   /* ensure user flag is reset */
   ibuf->userflags &= ~IB_RECT_INVALID;
 }
 
+typedef struct FloatFromRectData {
+  float *rect_float;
+  const uchar *rect;
+  int width;
+  int stride_float;
+  int stride_byte;
+  /* Color space to transform from with OpenColorIO, NULL when no transform is needed. */
+  struct ColorSpace *colorspace;
+  /* Decode with the sRGB lookup table instead. */
+  bool use_srgb_table;
+  bool premultiply;
+} FloatFromRectData;
+
+static void float_from_rect_row(void *__restrict data_v,
+                                const int y,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FloatFromRectData *data = (const FloatFromRectData *)data_v;
+  const uchar *rect = data->rect + ((size_t)y) * data->stride_byte * 4;
+  float *rect_float = data->rect_float + ((size_t)y) * data->stride_float * 4;
+
+  if (data->use_srgb_table) {
+    srgb_byte_to_linear_float_row_v4(rect_float, rect, data->width, data->premultiply);
+  }
+  else if (data->colorspace == NULL) {
+    byte_to_float_row_v4(rect_float, rect, data->width, data->premultiply);
+  }
+  else {
+    byte_to_float_row_v4(rect_float, rect, data->width, false);
+    IMB_colormanagement_colorspace_to_scene_linear(
+        rect_float, data->width, 1, 4, data->colorspace, false);
+    if (data->premultiply) {
+      premultiply_row_v4(rect_float, data->width);
+    }
+  }
+}
+
 void IMB_float_from_rect_ex(struct ImBuf *dst,
                             const struct ImBuf *src,
                             const rcti *region_to_update)
@@ -779,33 +1093,23 @@ void IMB_float_from_rect_ex(struct ImBuf *dst,
   const int region_width = BLI_rcti_size_x(region_to_update);
   const int region_height = BLI_rcti_size_y(region_to_update);
 
-  /* Convert byte buffer to float buffer without color or alpha conversion. */
-  IMB_buffer_float_from_byte(rect_float,
-                             rect,
-                             IB_PROFILE_SRGB,
-                             IB_PROFILE_SRGB,
-                             false,
-                             region_width,
-                             region_height,
-                             src->x,
-                             dst->x);
-
-  /* Perform color space conversion from rect color space to linear. */
-  float *float_ptr = rect_float;
-  for (int i = 0; i < region_height; i++) {
-    IMB_colormanagement_colorspace_to_scene_linear(
-        float_ptr, region_width, 1, dst->channels, src->rect_colorspace, false);
-    float_ptr += 4 * dst->x;
-  }
-
-  /* Perform alpha conversion. */
-  if (IMB_alpha_affects_rgb(src)) {
-    float_ptr = rect_float;
-    for (int i = 0; i < region_height; i++) {
-      IMB_premultiply_rect_float(float_ptr, dst->channels, region_width, 1);
-      float_ptr += 4 * dst->x;
-    }
+  /* Convert byte buffer to float buffer, perform color space conversion from rect color space
+   * to linear and alpha conversion row by row while the row is in cache. Color spaces that match
+   * the sRGB transfer function are decoded with a lookup table instead of OpenColorIO. */
+  FloatFromRectData data;
+  data.rect_float = rect_float;
+  data.rect = rect;
+  data.width = region_width;
+  data.stride_float = dst->x;
+  data.stride_byte = src->x;
+  data.colorspace = src->rect_colorspace;
+  data.use_srgb_table = IMB_colormanagement_space_is_srgb(src->rect_colorspace);
+  data.premultiply = IMB_alpha_affects_rgb(src);
+  if (data.use_srgb_table || IMB_colormanagement_space_is_scene_linear(src->rect_colorspace) ||
+      IMB_colormanagement_space_is_data(src->rect_colorspace)) {
+    data.colorspace = NULL;
   }
+  buffer_rows_parallel(region_width, region_height, &data, float_from_rect_row);
 }
 
 void IMB_float_from_rect(ImBuf *ibuf)
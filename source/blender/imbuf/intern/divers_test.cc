@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * Tests of byte and float buffer conversion against the per-pixel color functions, and
+ * benchmarks of converting 4K buffers.
+ *
+ * Benchmarks are disabled by default, run with:
+ * `blender_test --gtest_also_run_disabled_tests --gtest_filter=imbuf_conversion.DISABLED_*`
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_math_color.h"
+#include "BLI_rand.hh"
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+namespace blender::imbuf::tests {
+
+/* Odd sizes to convert the last pixels of rows separately, large enough to be threaded. */
+constexpr int width = 131;
+constexpr int height = 67;
+
+static Vector<float> random_float_pixels(const int num_pixels)
+{
+  RandomNumberGenerator rng(0);
+  Vector<float> pixels(num_pixels * 4);
+  for (const int i : IndexRange(num_pixels)) {
+    float *pixel = &pixels[i * 4];
+    for (int c = 0; c < 4; c++) {
+      /* Include values outside of the 0..1 range to test clamping. */
+      pixel[c] = rng.get_float() * 1.2f - 0.1f;
+    }
+    /* Alpha of zero and one are special cases for un-premultiplying. */
+    pixel[3] = (i % 5 == 0) ? 0.0f : (i % 7 == 0) ? 1.0f : clamp_f(pixel[3], 0.0f, 1.0f);
+  }
+  return pixels;
+}
+
+static Vector<uchar> random_byte_pixels(const int num_pixels)
+{
+  RandomNumberGenerator rng(0);
+  Vector<uchar> pixels(num_pixels * 4);
+  for (uchar &value : pixels) {
+    value = uchar(rng.get_int32(256));
+  }
+  return pixels;
+}
+
+static void test_byte_from_float(const bool predivide, const float dither)
+{
+  const Vector<float> src = random_float_pixels(width * height);
+  Vector<uchar> dst(width * height * 4);
+  IMB_buffer_byte_from_float(dst.data(),
+                             src.data(),
+                             4,
+                             dither,
+                             IB_PROFILE_SRGB,
+                             IB_PROFILE_SRGB,
+                             predivide,
+                             width,
+                             height,
+                             width,
+                             width);
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const int i = y * width + x;
+      float expected[4];
+      copy_v4_v4(expected, &src[i * 4]);
+      if (predivide) {
+        premul_to_straight_v4(expected);
+      }
+      const float dither_value = dither_random_value(float(x) * (1.0f / width),
+                                                     float(y) * (1.0f / height)) *
+                                 0.0033f * dither;
+      for (int c = 0; c < 4; c++) {
+        const float value = (c < 3) ? dither_value + expected[c] : expected[c];
+        EXPECT_EQ(dst[i * 4 + c], unit_float_to_uchar_clamp(value));
+      }
+    }
+  }
+}
+
+TEST(imbuf_conversion, byte_from_float)
+{
+  test_byte_from_float(false, 0.0f);
+}
+
+TEST(imbuf_conversion, byte_from_float_predivide)
+{
+  test_byte_from_float(true, 0.0f);
+}
+
+TEST(imbuf_conversion, byte_from_float_dither)
+{
+  test_byte_from_float(false, 1.0f);
+  test_byte_from_float(true, 1.0f);
+}
+
+TEST(imbuf_conversion, float_from_byte)
+{
+  BLI_init_srgb_conversion();
+
+  const Vector<uchar> src = random_byte_pixels(width * height);
+  Vector<float> dst(width * height * 4);
+  Vector<float> dst_linear(width * height * 4);
+  IMB_buffer_float_from_byte(dst.data(),
+                             src.data(),
+                             IB_PROFILE_SRGB,
+                             IB_PROFILE_SRGB,
+                             false,
+                             width,
+                             height,
+                             width,
+                             width);
+  IMB_buffer_float_from_byte(dst_linear.data(),
+                             src.data(),
+                             IB_PROFILE_LINEAR_RGB,
+                             IB_PROFILE_SRGB,
+                             false,
+                             width,
+                             height,
+                             width,
+                             width);
+
+  for (const int i : IndexRange(width * height)) {
+    float expected[4], expected_linear[4];
+    rgba_uchar_to_float(expected, &src[i * 4]);
+    srgb_to_linearrgb_uchar4(expected_linear, &src[i * 4]);
+    for (int c = 0; c < 4; c++) {
+      EXPECT_EQ(dst[i * 4 + c], expected[c]);
+      EXPECT_EQ(dst_linear[i * 4 + c], expected_linear[c]);
+    }
+  }
+}
+
+TEST(imbuf_conversion, stride)
+{
+  /* Convert a region in the middle of a larger buffer, pixels around it must stay untouched. */
+  const int stride = width + 10;
+  const Vector<float> src = random_float_pixels(stride * height);
+  Vector<uchar> dst(stride * height * 4, 0);
+  IMB_buffer_byte_from_float(dst.data() + 5 * 4,
+                             src.data() + 5 * 4,
+                             4,
+                             0.0f,
+                             IB_PROFILE_SRGB,
+                             IB_PROFILE_SRGB,
+                             false,
+                             width,
+                             height,
+                             stride,
+                             stride);
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < stride; x++) {
+      const int i = y * stride + x;
+      const bool inside = x >= 5 && x < 5 + width;
+      for (int c = 0; c < 4; c++) {
+        EXPECT_EQ(dst[i * 4 + c], inside ? unit_float_to_uchar_clamp(src[i * 4 + c]) : 0);
+      }
+    }
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Benchmarks
+ * \{ */
+
+TEST(imbuf_conversion, DISABLED_benchmark_4k)
+{
+  BLI_threadapi_init();
+  BLI_init_srgb_conversion();
+
+  const int x = 3840;
+  const int y = 2160;
+  const Vector<float> src_float = random_float_pixels(x * y);
+  const Vector<uchar> src_byte = random_byte_pixels(x * y);
+  Vector<float> dst_float(x * y * 4);
+  Vector<uchar> dst_byte(x * y * 4);
+  const int runs = 5;
+
+  for (const bool predivide : {false, true}) {
+    for (const float dither : {0.0f, 1.0f}) {
+      const double start_time = PIL_check_seconds_timer();
+      for (int i = 0; i < runs; i++) {
+        IMB_buffer_byte_from_float(dst_byte.data(),
+                                   src_float.data(),
+                                   4,
+                                   dither,
+                                   IB_PROFILE_SRGB,
+                                   IB_PROFILE_SRGB,
+                                   predivide,
+                                   x,
+                                   y,
+                                   x,
+                                   x);
+      }
+      const double total_time = PIL_check_seconds_timer() - start_time;
+      printf("byte from float %-10s %-9s 3840x2160: %8.2f ms\n",
+             predivide ? "predivide" : "",
+             (dither != 0.0f) ? "dither" : "",
+             total_time / runs * 1000.0);
+    }
+  }
+
+  for (const int profile_to : {IB_PROFILE_SRGB, IB_PROFILE_LINEAR_RGB}) {
+    const double start_time = PIL_check_seconds_timer();
+    for (int i = 0; i < runs; i++) {
+      IMB_buffer_float_from_byte(
+          dst_float.data(), src_byte.data(), profile_to, IB_PROFILE_SRGB, false, x, y, x, x);
+    }
+    const double total_time = PIL_check_seconds_timer() - start_time;
+    printf("float from byte %-20s 3840x2160: %8.2f ms\n",
+           (profile_to == IB_PROFILE_SRGB) ? "" : "sRGB to linear",
+           total_time / runs * 1000.0);
+  }
+
+  BLI_threadapi_exit();
+}
+
+/** \} */
+
+}  // namespace blender::imbuf::tests
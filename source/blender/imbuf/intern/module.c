@@ -24,6 +24,7 @@ void IMB_init(void)
 
 void IMB_exit(void)
 {
+  IMB_anim_pool_clear();
   imb_tile_cache_exit();
   imb_filetypes_exit();
   colormanagement_exit();
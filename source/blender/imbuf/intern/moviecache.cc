@@ -7,16 +7,22 @@
 
 #undef DEBUG_MESSAGES
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib> /* for qsort */
 #include <memory.h>
 #include <mutex>
 
+#include <zstd.h>
+
 #include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -25,6 +31,8 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+using blender::IndexRange;
+
 #ifdef DEBUG_MESSAGES
 #  if defined __GNUC__
 #    define PRINT(format, args...) printf(format, ##args)
@@ -43,6 +51,13 @@ static MEM_CacheLimiterC *limitor = nullptr;
  * so regular mutex will not work here, hence the recursive lock. */
 static std::recursive_mutex limitor_lock;
 
+/** Share of the cache limit which frames kept compressed may use. */
+#define MOVIECACHE_COMPRESSED_LIMIT_FACTOR 0.5
+/** Compression runs when the cache is full, favor speed over ratio. */
+#define MOVIECACHE_ZSTD_LEVEL 1
+/** Frames are compressed in bands of rows, which are compressed and restored in parallel. */
+#define MOVIECACHE_COMPRESSED_BAND_ROWS 64
+
 struct MovieCache {
   char name[64];
 
@@ -64,7 +79,9 @@ struct MovieCache {
   void *last_userkey;
 
   int totseg, *points, proxy, render_flags; /* for visual statistics optimization */
-  int pad;
+
+  /* Keep evicted frames compressed, see #IMB_moviecache_set_compression. */
+  bool use_compression;
 };
 
 struct MovieCacheKey {
@@ -72,15 +89,367 @@ struct MovieCacheKey {
   void *userkey;
 };
 
+struct MovieCacheCompressedBand {
+  void *data;
+  size_t size;
+};
+
+/** Pixels of a frame evicted from the cache limiter. */
+struct MovieCacheCompressedPixels {
+  /* Bands of the byte and float buffers, null when the frame doesn't have the buffer. */
+  MovieCacheCompressedBand *rect_bands;
+  MovieCacheCompressedBand *rect_float_bands;
+  int bands_num;
+  /* Memory used by the compressed frame, including the image buffer without pixels. */
+  size_t size;
+};
+
 struct MovieCacheItem {
+  /* Link in #compressed_items, for compressed items only. */
+  MovieCacheItem *next, *prev;
   MovieCache *cache_owner;
   ImBuf *ibuf;
   MEM_CacheLimiterHandleC *c_handle;
   void *priority_data;
+  /* Pixels of #ibuf when it was evicted compressed, #ibuf has no pixel buffers then. */
+  MovieCacheCompressedPixels *compressed;
   /* Indicates that #ibuf is null, because there was an error during load. */
   bool added_empty;
 };
 
+/* Compressed items of all caches, least recently compressed first. Guarded by #limitor_lock. */
+static ListBase compressed_items = {nullptr, nullptr};
+static size_t compressed_memory_in_use = 0;
+
+/* -------------------------------------------------------------------- */
+/** \name Compressed Frames
+ *
+ * Frames evicted by the cache limiter from caches with compression enabled are compressed
+ * losslessly and kept in memory, until compressed frames exceed their share of the cache limit.
+ * Getting a compressed frame restores its pixels and hands it back to the cache limiter.
+ * \{ */
+
+/**
+ * Delta to the same channel of the previous pixel, split in planes of bytes of equal
+ * significance. Smooth images compress much better this way.
+ */
+template<typename T>
+static void compressed_band_encode(const T *src, uchar *dst, const int64_t len, const int channels)
+{
+  for (int64_t i = 0; i < len; i++) {
+    const T delta = (i < channels) ? src[i] : T(src[i] - src[i - channels]);
+    for (int b = 0; b < int(sizeof(T)); b++) {
+      dst[b * len + i] = uchar(delta >> (b * 8));
+    }
+  }
+}
+
+template<typename T>
+static void compressed_band_decode(const uchar *src, T *dst, const int64_t len, const int channels)
+{
+  for (int64_t i = 0; i < len; i++) {
+    T delta = 0;
+    for (int b = 0; b < int(sizeof(T)); b++) {
+      delta |= T(T(src[b * len + i]) << (b * 8));
+    }
+    dst[i] = (i < channels) ? delta : T(dst[i - channels] + delta);
+  }
+}
+
+template<typename T>
+static bool compressed_band_compress(MovieCacheCompressedBand *band,
+                                     const T *src,
+                                     const int64_t len,
+                                     const int channels)
+{
+  const size_t raw_size = sizeof(T) * len;
+  uchar *planes = (uchar *)MEM_mallocN(raw_size, __func__);
+  compressed_band_encode(src, planes, len, channels);
+
+  const size_t bound = ZSTD_compressBound(raw_size);
+  void *data = MEM_mallocN(bound, "MovieCacheCompressedBand");
+  const size_t size = ZSTD_compress(data, bound, planes, raw_size, MOVIECACHE_ZSTD_LEVEL);
+  MEM_freeN(planes);
+
+  if (ZSTD_isError(size)) {
+    MEM_freeN(data);
+    return false;
+  }
+
+  band->data = MEM_reallocN(data, size);
+  band->size = size;
+  return true;
+}
+
+template<typename T>
+static bool compressed_band_decompress(const MovieCacheCompressedBand *band,
+                                       T *dst,
+                                       const int64_t len,
+                                       const int channels)
+{
+  const size_t raw_size = sizeof(T) * len;
+  uchar *planes = (uchar *)MEM_mallocN(raw_size, __func__);
+  const size_t size = ZSTD_decompress(planes, raw_size, band->data, band->size);
+
+  if (size == raw_size) {
+    compressed_band_decode(planes, dst, len, channels);
+  }
+  MEM_freeN(planes);
+
+  return size == raw_size;
+}
+
+static void compressed_pixels_free(MovieCacheCompressedPixels *compressed)
+{
+  MovieCacheCompressedBand *buffers[2] = {compressed->rect_bands, compressed->rect_float_bands};
+  for (MovieCacheCompressedBand *bands : buffers) {
+    if (bands) {
+      for (int i = 0; i < compressed->bands_num; i++) {
+        MEM_SAFE_FREE(bands[i].data);
+      }
+      MEM_freeN(bands);
+    }
+  }
+  MEM_freeN(compressed);
+}
+
+static MovieCacheCompressedPixels *compressed_pixels_new(const ImBuf *ibuf)
+{
+  MovieCacheCompressedPixels *compressed = (MovieCacheCompressedPixels *)MEM_callocN(
+      sizeof(MovieCacheCompressedPixels), "MovieCacheCompressedPixels");
+  const int bands_num = (ibuf->y + MOVIECACHE_COMPRESSED_BAND_ROWS - 1) /
+                        MOVIECACHE_COMPRESSED_BAND_ROWS;
+  const int64_t row_len = int64_t(ibuf->x) * ibuf->channels;
+  std::atomic<bool> success = true;
+
+  compressed->bands_num = bands_num;
+  if (ibuf->rect) {
+    compressed->rect_bands = (MovieCacheCompressedBand *)MEM_callocN(
+        sizeof(MovieCacheCompressedBand) * bands_num, "MovieCacheCompressedPixels rect");
+  }
+  if (ibuf->rect_float) {
+    compressed->rect_float_bands = (MovieCacheCompressedBand *)MEM_callocN(
+        sizeof(MovieCacheCompressedBand) * bands_num, "MovieCacheCompressedPixels rect_float");
+  }
+
+  /* Isolated since the cache lock is held, tasks running moviecache functions could otherwise be
+   * picked up by this thread while waiting, and enter the recursive lock. */
+  blender::threading::isolate_task([&]() {
+    blender::threading::parallel_for(IndexRange(bands_num), 1, [&](const IndexRange range) {
+      for (const int64_t band : range) {
+        const int ymin = int(band) * MOVIECACHE_COMPRESSED_BAND_ROWS;
+        const int rows = std::min(MOVIECACHE_COMPRESSED_BAND_ROWS, ibuf->y - ymin);
+
+        if (ibuf->rect &&
+            !compressed_band_compress(&compressed->rect_bands[band],
+                                      (const uchar *)ibuf->rect + int64_t(ymin) * ibuf->x * 4,
+                                      int64_t(rows) * ibuf->x * 4,
+                                      4)) {
+          success = false;
+        }
+        if (ibuf->rect_float &&
+            !compressed_band_compress(&compressed->rect_float_bands[band],
+                                      (const uint32_t *)ibuf->rect_float + ymin * row_len,
+                                      rows * row_len,
+                                      ibuf->channels)) {
+          success = false;
+        }
+      }
+    });
+  });
+
+  compressed->size = sizeof(MovieCacheCompressedPixels);
+  for (int i = 0; i < bands_num; i++) {
+    compressed->size += (compressed->rect_bands ? compressed->rect_bands[i].size : 0) +
+                        (compressed->rect_float_bands ? compressed->rect_float_bands[i].size : 0);
+  }
+
+  if (!success) {
+    compressed_pixels_free(compressed);
+    return nullptr;
+  }
+  return compressed;
+}
+
+static bool compressed_pixels_restore(const MovieCacheCompressedPixels *compressed, ImBuf *ibuf)
+{
+  const int64_t row_len = int64_t(ibuf->x) * ibuf->channels;
+  std::atomic<bool> success = true;
+
+  if (compressed->rect_bands) {
+    ibuf->rect = (uint *)imb_alloc_pixels(ibuf->x, ibuf->y, 4, sizeof(uchar), __func__);
+    if (ibuf->rect == nullptr) {
+      return false;
+    }
+    ibuf->mall |= IB_rect;
+  }
+  if (compressed->rect_float_bands) {
+    ibuf->rect_float = (float *)imb_alloc_pixels(
+        ibuf->x, ibuf->y, ibuf->channels, sizeof(float), __func__);
+    if (ibuf->rect_float == nullptr) {
+      return false;
+    }
+    ibuf->mall |= IB_rectfloat;
+  }
+
+  blender::threading::isolate_task([&]() {
+    blender::threading::parallel_for(IndexRange(compressed->bands_num), 1, [&](IndexRange range) {
+      for (const int64_t band : range) {
+        const int ymin = int(band) * MOVIECACHE_COMPRESSED_BAND_ROWS;
+        const int rows = std::min(MOVIECACHE_COMPRESSED_BAND_ROWS, ibuf->y - ymin);
+
+        if (ibuf->rect &&
+            !compressed_band_decompress(&compressed->rect_bands[band],
+                                        (uchar *)ibuf->rect + int64_t(ymin) * ibuf->x * 4,
+                                        int64_t(rows) * ibuf->x * 4,
+                                        4)) {
+          success = false;
+        }
+        if (ibuf->rect_float &&
+            !compressed_band_decompress(&compressed->rect_float_bands[band],
+                                        (uint32_t *)ibuf->rect_float + ymin * row_len,
+                                        rows * row_len,
+                                        ibuf->channels)) {
+          success = false;
+        }
+      }
+    });
+  });
+
+  return success;
+}
+
+static size_t compressed_memory_limit()
+{
+  return size_t(MEM_CacheLimiter_get_maximum() * MOVIECACHE_COMPRESSED_LIMIT_FACTOR);
+}
+
+static size_t get_compressed_memory_in_use()
+{
+  return compressed_memory_in_use;
+}
+
+static bool moviecache_item_can_compress(const MovieCacheItem *item)
+{
+  const ImBuf *ibuf = item->ibuf;
+
+  if (!item->cache_owner->use_compression) {
+    return false;
+  }
+  /* Pixels are freed, which is only possible when the cache is the only user of the buffer. */
+  if (ibuf->refcounter != 0) {
+    return false;
+  }
+  if (ibuf->rect == nullptr && ibuf->rect_float == nullptr) {
+    return false;
+  }
+  if ((ibuf->rect && (ibuf->mall & IB_rect) == 0) ||
+      (ibuf->rect_float && (ibuf->mall & IB_rectfloat) == 0)) {
+    return false;
+  }
+  if (ibuf->zbuf || ibuf->zbuf_float || ibuf->tiles) {
+    return false;
+  }
+  return true;
+}
+
+/** Free a compressed item, as if it was evicted by the cache limiter. */
+static void moviecache_compressed_item_drop(MovieCacheItem *item)
+{
+  BLI_remlink(&compressed_items, item);
+  compressed_memory_in_use -= item->compressed->size;
+
+  compressed_pixels_free(item->compressed);
+  item->compressed = nullptr;
+
+  IMB_freeImBuf(item->ibuf);
+  item->ibuf = nullptr;
+
+  /* force cached segments to be updated */
+  MEM_SAFE_FREE(item->cache_owner->points);
+}
+
+/**
+ * Compress pixels of an item evicted by the cache limiter, must be called with #limitor_lock.
+ * \return false when the item can't be compressed, its buffer is to be freed then.
+ */
+static bool moviecache_item_compress(MovieCacheItem *item)
+{
+  ImBuf *ibuf = item->ibuf;
+
+  if (!moviecache_item_can_compress(item)) {
+    return false;
+  }
+
+  MovieCacheCompressedPixels *compressed = compressed_pixels_new(ibuf);
+  if (compressed == nullptr) {
+    return false;
+  }
+  if (compressed->size >= IMB_get_size_in_memory(ibuf)) {
+    compressed_pixels_free(compressed);
+    return false;
+  }
+
+  imb_freerectImBuf(ibuf);
+  imb_freerectfloatImBuf(ibuf);
+  compressed->size += IMB_get_size_in_memory(ibuf);
+
+  PRINT("%s: cache '%s' compress item %p buffer %p to %d bytes\n",
+        __func__,
+        item->cache_owner->name,
+        item,
+        ibuf,
+        int(compressed->size));
+
+  item->compressed = compressed;
+  BLI_addtail(&compressed_items, item);
+  compressed_memory_in_use += compressed->size;
+
+  const size_t limit = compressed_memory_limit();
+  while (compressed_items.first && compressed_memory_in_use > limit) {
+    moviecache_compressed_item_drop((MovieCacheItem *)compressed_items.first);
+  }
+
+  return true;
+}
+
+/**
+ * Restore pixels of a compressed item and hand it back to the cache limiter, must be called with
+ * #limitor_lock. The item is freed if its pixels can't be restored.
+ */
+static void moviecache_item_decompress(MovieCacheItem *item)
+{
+  MovieCacheCompressedPixels *compressed = item->compressed;
+
+  BLI_remlink(&compressed_items, item);
+  compressed_memory_in_use -= compressed->size;
+  item->compressed = nullptr;
+
+  const bool success = compressed_pixels_restore(compressed, item->ibuf);
+  compressed_pixels_free(compressed);
+
+  if (!success) {
+    IMB_freeImBuf(item->ibuf);
+    item->ibuf = nullptr;
+    MEM_SAFE_FREE(item->cache_owner->points);
+    return;
+  }
+
+  PRINT("%s: cache '%s' decompress item %p buffer %p\n",
+        __func__,
+        item->cache_owner->name,
+        item,
+        item->ibuf);
+
+  item->c_handle = MEM_CacheLimiter_insert(limitor, item);
+
+  MEM_CacheLimiter_ref(item->c_handle);
+  MEM_CacheLimiter_enforce_limits(limitor);
+  MEM_CacheLimiter_unref(item->c_handle);
+}
+
+/** \} */
+
 static unsigned int moviecache_hashhash(const void *keyv)
 {
   const MovieCacheKey *key = (const MovieCacheKey *)keyv;
@@ -112,9 +481,16 @@ static void moviecache_valfree(void *val)
 
   PRINT("%s: cache '%s' free item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-  if (item->c_handle) {
+  if (item->c_handle || item->compressed) {
     limitor_lock.lock();
-    MEM_CacheLimiter_unmanage(item->c_handle);
+    if (item->c_handle) {
+      MEM_CacheLimiter_unmanage(item->c_handle);
+    }
+    if (item->compressed) {
+      BLI_remlink(&compressed_items, item);
+      compressed_memory_in_use -= item->compressed->size;
+      compressed_pixels_free(item->compressed);
+    }
     limitor_lock.unlock();
   }
 
@@ -175,10 +551,15 @@ static void moviecache_destructor(void *p)
 
     PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
+    item->c_handle = nullptr;
+
+    if (moviecache_item_compress(item)) {
+      return;
+    }
+
     IMB_freeImBuf(item->ibuf);
 
     item->ibuf = nullptr;
-    item->c_handle = nullptr;
 
     /* force cached segments to be updated */
     MEM_SAFE_FREE(cache->points);
@@ -252,6 +633,7 @@ void IMB_moviecache_init(void)
 
   MEM_CacheLimiter_ItemPriority_Func_set(limitor, get_item_priority);
   MEM_CacheLimiter_ItemDestroyable_Func_set(limitor, get_item_destroyable);
+  MEM_CacheLimiter_UnmanagedMemory_Func_set(limitor, get_compressed_memory_in_use);
 }
 
 void IMB_moviecache_destruct(void)
@@ -294,6 +676,11 @@ void IMB_moviecache_set_getdata_callback(MovieCache *cache, MovieCacheGetKeyData
   cache->getdatafp = getdatafp;
 }
 
+void IMB_moviecache_set_compression(MovieCache *cache, bool use_compression)
+{
+  cache->use_compression = use_compression;
+}
+
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
                                           MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
@@ -328,10 +715,12 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
   PRINT("%s: cache '%s' put %p, item %p\n", __func__, cache->name, ibuf, item);
 
+  item->next = item->prev = nullptr;
   item->ibuf = ibuf;
   item->cache_owner = cache;
   item->c_handle = nullptr;
   item->priority_data = nullptr;
+  item->compressed = nullptr;
   item->added_empty = ibuf == nullptr;
 
   if (cache->getprioritydatafp) {
@@ -414,9 +803,15 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey, bool *r_is_cached_em
   if (item) {
     if (item->ibuf) {
       limitor_lock.lock();
-      MEM_CacheLimiter_touch(item->c_handle);
+      if (item->compressed) {
+        moviecache_item_decompress(item);
+      }
+      else {
+        MEM_CacheLimiter_touch(item->c_handle);
+      }
       limitor_lock.unlock();
-
+    }
+    if (item->ibuf) {
       IMB_refImBuf(item->ibuf);
 
       return item->ibuf;
@@ -600,6 +995,11 @@ void IMB_moviecacheIter_step(struct MovieCacheIter *iter)
 ImBuf *IMB_moviecacheIter_getImBuf(struct MovieCacheIter *iter)
 {
   MovieCacheItem *item = (MovieCacheItem *)BLI_ghashIterator_getValue((GHashIterator *)iter);
+  if (item->compressed) {
+    limitor_lock.lock();
+    moviecache_item_decompress(item);
+    limitor_lock.unlock();
+  }
   return item->ibuf;
 }
 
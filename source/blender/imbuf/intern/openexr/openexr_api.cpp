@@ -48,6 +48,7 @@
 #include <OpenEXR/ImfRgbaFile.h>
 #include <OpenEXR/ImfStandardAttributes.h>
 #include <OpenEXR/ImfStringAttribute.h>
+#include <OpenEXR/ImfTiledRgbaFile.h>
 #include <OpenEXR/ImfVersion.h>
 
 /* multiview/multipart */
@@ -58,6 +59,7 @@
 #include <OpenEXR/ImfOutputPart.h>
 #include <OpenEXR/ImfPartHelper.h>
 #include <OpenEXR/ImfPartType.h>
+#include <OpenEXR/ImfTiledInputPart.h>
 #include <OpenEXR/ImfTiledOutputPart.h>
 
 #include "DNA_scene_types.h" /* For OpenEXR compression constants */
@@ -107,6 +109,7 @@ extern "C" {
 /* prototype */
 static struct ExrPass *imb_exr_get_pass(ListBase *lb, char *passname);
 static bool exr_has_multiview(MultiPartInputFile &file);
+static bool imb_exr_is_multi(MultiPartInputFile &file);
 static bool exr_has_multipart_file(MultiPartInputFile &file);
 static bool exr_has_alpha(MultiPartInputFile &file);
 static bool exr_has_zbuffer(MultiPartInputFile &file);
@@ -710,6 +713,12 @@ struct ExrHandle {
   ListBase layers;   /* hierarchical, pointing in end to ExrChannel */
 
   int num_half_channels; /* used during filr save, allows faster temporary buffers allocation */
+
+  /* File read from and its size and modification time when opened, to detect files that were
+   * overwritten while passes are read lazily. */
+  char filepath[FILE_MAX];
+  int64_t file_size;
+  int64_t file_mtime;
 };
 
 /* flattened out channel */
@@ -745,7 +754,9 @@ struct ExrLayer {
   ListBase passes;
 };
 
-static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data);
+static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data, bool alloc_passes);
+static void imb_exr_pass_assign_rect(ExrHandle *data, ExrPass *pass, float *rect);
+static void imb_exr_free_channels(ExrHandle *data);
 
 /* ********************** */
 
@@ -1021,16 +1032,16 @@ void IMB_exrtile_begin_write(
   }
 }
 
-bool IMB_exr_begin_read(
-    void *handle, const char *filepath, int *width, int *height, const bool parse_channels)
+static bool imb_exr_open_file(ExrHandle *data, const char *filepath, int *width, int *height)
 {
-  ExrHandle *data = (ExrHandle *)handle;
-  ExrChannel *echan;
-
   /* 32 is arbitrary, but zero length files crashes exr. */
-  if (!(BLI_exists(filepath) && BLI_file_size(filepath) > 32)) {
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) == -1 || st.st_size <= 32) {
     return false;
   }
+  BLI_strncpy(data->filepath, filepath, sizeof(data->filepath));
+  data->file_size = st.st_size;
+  data->file_mtime = st.st_mtime;
 
   /* avoid crash/abort when we don't have permission to write here */
   try {
@@ -1053,9 +1064,22 @@ bool IMB_exr_begin_read(
   data->width = *width = dw.max.x - dw.min.x + 1;
   data->height = *height = dw.max.y - dw.min.y + 1;
 
+  return true;
+}
+
+bool IMB_exr_begin_read(
+    void *handle, const char *filepath, int *width, int *height, const bool parse_channels)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  ExrChannel *echan;
+
+  if (!imb_exr_open_file(data, filepath, width, height)) {
+    return false;
+  }
+
   if (parse_channels) {
     /* Parse channels into view/layer/pass. */
-    if (!imb_exr_multilayer_parse_channels_from_file(data)) {
+    if (!imb_exr_multilayer_parse_channels_from_file(data, true)) {
       return false;
     }
   }
@@ -1081,6 +1105,44 @@ bool IMB_exr_begin_read(
   return true;
 }
 
+static void imb_exr_read_metadata(const Header &header, ImBuf *ibuf);
+
+/** Close the input file, parsed views, layers and passes are kept. */
+static void imb_exr_close_file(ExrHandle *data)
+{
+  delete data->ifile;
+  delete data->ifile_stream;
+  data->ifile = nullptr;
+  data->ifile_stream = nullptr;
+}
+
+bool IMB_exr_begin_read_lazy(
+    void *handle, const char *filepath, int *width, int *height, ImBuf *metadata_ibuf)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+
+  if (!imb_exr_open_file(data, filepath, width, height)) {
+    return false;
+  }
+  if (!imb_exr_is_multi(*data->ifile)) {
+    imb_exr_close_file(data);
+    return false;
+  }
+
+  /* Parse channels into view/layer/pass, pass buffers are allocated on read. */
+  if (!imb_exr_multilayer_parse_channels_from_file(data, false)) {
+    imb_exr_close_file(data);
+    return false;
+  }
+  if (metadata_ibuf) {
+    imb_exr_read_metadata(data->ifile->header(0), metadata_ibuf);
+  }
+
+  /* Opened again for each pass, so images don't keep files open while they aren't read. */
+  imb_exr_close_file(data);
+  return true;
+}
+
 void IMB_exr_set_channel(
     void *handle, const char *layname, const char *passname, int xstride, int ystride, float *rect)
 {
@@ -1273,17 +1335,46 @@ void IMB_exrtile_write_channels(
   }
 }
 
-void IMB_exr_read_channels(void *handle)
+/* Check if EXR was saved with previous versions of blender which flipped images. */
+static bool imb_exr_is_flipped(ExrHandle *data)
 {
-  ExrHandle *data = (ExrHandle *)handle;
-  int numparts = data->ifile->parts();
-
-  /* Check if EXR was saved with previous versions of blender which flipped images. */
   const StringAttribute *ta = data->ifile->header(0).findTypedAttribute<StringAttribute>(
       "BlenderMultiChannel");
 
   /* 'previous multilayer attribute, flipped. */
-  short flip = (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
+  return (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
+}
+
+/* Frame-buffer slice writing the channel into its rect, flipped to Blender convention. */
+static Slice imb_exr_channel_slice(ExrHandle *data,
+                                   ExrChannel *echan,
+                                   const Box2i &dw,
+                                   const bool flip)
+{
+  float *rect = echan->rect;
+  size_t xstride = echan->xstride * sizeof(float);
+  size_t ystride = echan->ystride * sizeof(float);
+
+  if (!flip) {
+    /* Inverse correct first pixel for data-window coordinates. */
+    rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
+    /* Move to last scan-line to flip to Blender convention. */
+    rect += echan->xstride * (data->height - 1) * data->width;
+    ystride = -ystride;
+  }
+  else {
+    /* Inverse correct first pixel for data-window coordinates. */
+    rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
+  }
+
+  return Slice(Imf::FLOAT, (char *)rect, xstride, ystride);
+}
+
+void IMB_exr_read_channels(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  int numparts = data->ifile->parts();
+  const bool flip = imb_exr_is_flipped(data);
 
   exr_printf(
       "\nIMB_exr_read_channels\n%s %-6s %-22s "
@@ -1315,24 +1406,7 @@ void IMB_exr_read_channels(void *handle)
                  echan->m->internal_name.c_str());
 
       if (echan->rect) {
-        float *rect = echan->rect;
-        size_t xstride = echan->xstride * sizeof(float);
-        size_t ystride = echan->ystride * sizeof(float);
-
-        if (!flip) {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
-          /* Move to last scan-line to flip to Blender convention. */
-          rect += echan->xstride * (data->height - 1) * data->width;
-          ystride = -ystride;
-        }
-        else {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
-        }
-
-        frameBuffer.insert(echan->m->internal_name,
-                           Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        frameBuffer.insert(echan->m->internal_name, imb_exr_channel_slice(data, echan, dw, flip));
       }
       else {
         printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
@@ -1352,6 +1426,133 @@ void IMB_exr_read_channels(void *handle)
   }
 }
 
+/** Read the pixels of \a part in \a frameBuffer, tiled files at the highest resolution level. */
+static bool imb_exr_read_part(ExrHandle *data, const int part, const FrameBuffer &frameBuffer)
+{
+  try {
+    if (data->ifile->header(part).hasTileDescription()) {
+      TiledInputPart in(*data->ifile, part);
+      in.setFrameBuffer(frameBuffer);
+      /* OpenEXR decodes the tiles in its thread pool. */
+      in.readTiles(0, in.numXTiles(0) - 1, 0, in.numYTiles(0) - 1, 0, 0);
+    }
+    else {
+      const Box2i dw = data->ifile->header(part).dataWindow();
+      InputPart in(*data->ifile, part);
+      in.setFrameBuffer(frameBuffer);
+      in.readPixels(dw.min.y, dw.max.y);
+    }
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Open the file of a lazily read handle to read a pass. When the file was overwritten since it was
+ * opened, the offsets of the old file would read stale or corrupt pixels, so layers and passes are
+ * parsed again, since only their names are known to the caller.
+ *
+ * \return false when the file can't be read anymore, or no longer matches the opened file.
+ */
+static bool imb_exr_lazy_file_open(ExrHandle *data)
+{
+  BLI_stat_t st;
+  if (BLI_stat(data->filepath, &st) == -1) {
+    return false;
+  }
+
+  const int width = data->width, height = data->height;
+  const bool is_changed = (st.st_size != data->file_size || st.st_mtime != data->file_mtime);
+  if (is_changed) {
+    imb_exr_free_channels(data);
+    data->multiView->clear();
+  }
+
+  int new_width, new_height;
+  if (!imb_exr_open_file(data, data->filepath, &new_width, &new_height)) {
+    return false;
+  }
+  if (is_changed &&
+      (new_width != width || new_height != height || !imb_exr_is_multi(*data->ifile) ||
+       !imb_exr_multilayer_parse_channels_from_file(data, false))) {
+    /* Passes of the new file can't be used in place of the old ones, reloading is needed. */
+    imb_exr_close_file(data);
+    data->width = width;
+    data->height = height;
+    return false;
+  }
+
+  return true;
+}
+
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+
+  if (data->ifile != nullptr || !imb_exr_lazy_file_open(data)) {
+    return nullptr;
+  }
+
+  ExrLayer *lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+  ExrPass *pass = nullptr;
+
+  if (lay != nullptr) {
+    LISTBASE_FOREACH (ExrPass *, pass_iter, &lay->passes) {
+      if (STREQ(pass_iter->internal_name, passname) && STREQ(pass_iter->view, viewname)) {
+        pass = pass_iter;
+        break;
+      }
+    }
+  }
+  if (pass == nullptr || pass->totchan == 0) {
+    imb_exr_close_file(data);
+    return nullptr;
+  }
+
+  float *rect = (float *)MEM_callocN(
+      sizeof(float) * data->width * data->height * pass->totchan, "pass rect");
+  imb_exr_pass_assign_rect(data, pass, rect);
+
+  const bool flip = imb_exr_is_flipped(data);
+  bool success = true;
+
+  /* Only the channels of this pass are decoded, parts without them are skipped. */
+  for (int part = 0; part < data->ifile->parts() && success; part++) {
+    const Box2i dw = data->ifile->header(part).dataWindow();
+    FrameBuffer frameBuffer;
+    bool has_channels = false;
+
+    for (int a = 0; a < pass->totchan; a++) {
+      ExrChannel *echan = pass->chan[a];
+      if (echan->m->part_number == part) {
+        frameBuffer.insert(echan->m->internal_name, imb_exr_channel_slice(data, echan, dw, flip));
+        has_channels = true;
+      }
+    }
+
+    if (has_channels) {
+      success = imb_exr_read_part(data, part, frameBuffer);
+    }
+  }
+
+  /* The caller owns the buffer. */
+  imb_exr_pass_assign_rect(data, pass, nullptr);
+  imb_exr_close_file(data);
+
+  if (!success) {
+    MEM_freeN(rect);
+    return nullptr;
+  }
+  return rect;
+}
+
 void IMB_exr_multilayer_convert(void *handle,
                                 void *base,
                                 void *(*addview)(void *base, const char *str),
@@ -1401,12 +1602,27 @@ void IMB_exr_multilayer_convert(void *handle,
   }
 }
 
+static void imb_exr_free_channels(ExrHandle *data)
+{
+  LISTBASE_FOREACH (ExrChannel *, chan, &data->channels) {
+    delete chan->m;
+  }
+  BLI_freelistN(&data->channels);
+
+  LISTBASE_FOREACH (ExrLayer *, lay, &data->layers) {
+    LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+      if (pass->rect) {
+        MEM_freeN(pass->rect);
+      }
+    }
+    BLI_freelistN(&lay->passes);
+  }
+  BLI_freelistN(&data->layers);
+}
+
 void IMB_exr_close(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
-  ExrLayer *lay;
-  ExrPass *pass;
-  ExrChannel *chan;
 
   delete data->ifile;
   delete data->ifile_stream;
@@ -1421,20 +1637,7 @@ void IMB_exr_close(void *handle)
   data->mpofile = nullptr;
   data->ofile_stream = nullptr;
 
-  for (chan = (ExrChannel *)data->channels.first; chan; chan = chan->next) {
-    delete chan->m;
-  }
-  BLI_freelistN(&data->channels);
-
-  for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
-    for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
-      if (pass->rect) {
-        MEM_freeN(pass->rect);
-      }
-    }
-    BLI_freelistN(&lay->passes);
-  }
-  BLI_freelistN(&data->layers);
+  imb_exr_free_channels(data);
 
   BLI_remlink(&exrhandles, data);
   MEM_freeN(data);
@@ -1593,7 +1796,66 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
-static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
+/**
+ * Point the channels of \a pass into \a rect, interleaved in the order Blender expects.
+ * \a rect can be null for passes that are not read yet, only channel ids are set then.
+ */
+static void imb_exr_pass_assign_rect(ExrHandle *data, ExrPass *pass, float *rect)
+{
+  if (pass->totchan == 1) {
+    ExrChannel *echan = pass->chan[0];
+    echan->rect = rect;
+    echan->xstride = 1;
+    echan->ystride = data->width;
+    pass->chan_id[0] = echan->chan_id;
+  }
+  else {
+    char lookup[256];
+
+    memset(lookup, 0, sizeof(lookup));
+
+    /* we can have RGB(A), XYZ(W), UVA */
+    if (ELEM(pass->totchan, 3, 4)) {
+      if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
+          pass->chan[2]->chan_id == 'B') {
+        lookup[(unsigned int)'R'] = 0;
+        lookup[(unsigned int)'G'] = 1;
+        lookup[(unsigned int)'B'] = 2;
+        lookup[(unsigned int)'A'] = 3;
+      }
+      else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
+               pass->chan[2]->chan_id == 'Y') {
+        lookup[(unsigned int)'X'] = 0;
+        lookup[(unsigned int)'Y'] = 1;
+        lookup[(unsigned int)'Z'] = 2;
+        lookup[(unsigned int)'W'] = 3;
+      }
+      else {
+        lookup[(unsigned int)'U'] = 0;
+        lookup[(unsigned int)'V'] = 1;
+        lookup[(unsigned int)'A'] = 2;
+      }
+      for (int a = 0; a < pass->totchan; a++) {
+        ExrChannel *echan = pass->chan[a];
+        echan->rect = rect ? rect + lookup[(unsigned int)echan->chan_id] : nullptr;
+        echan->xstride = pass->totchan;
+        echan->ystride = data->width * pass->totchan;
+        pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
+      }
+    }
+    else { /* unknown */
+      for (int a = 0; a < pass->totchan; a++) {
+        ExrChannel *echan = pass->chan[a];
+        echan->rect = rect ? rect + a : nullptr;
+        echan->xstride = pass->totchan;
+        echan->ystride = data->width * pass->totchan;
+        pass->chan_id[a] = echan->chan_id;
+      }
+    }
+  }
+}
+
+static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data, const bool alloc_passes)
 {
   std::vector<MultiViewChannelName> channels;
   GetChannelsInMultiPartFile(*data->ifile, channels);
@@ -1652,59 +1914,11 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
   for (ExrLayer *lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (ExrPass *pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
       if (pass->totchan) {
-        pass->rect = (float *)MEM_callocN(
-            data->width * data->height * pass->totchan * sizeof(float), "pass rect");
-        if (pass->totchan == 1) {
-          ExrChannel *echan = pass->chan[0];
-          echan->rect = pass->rect;
-          echan->xstride = 1;
-          echan->ystride = data->width;
-          pass->chan_id[0] = echan->chan_id;
-        }
-        else {
-          char lookup[256];
-
-          memset(lookup, 0, sizeof(lookup));
-
-          /* we can have RGB(A), XYZ(W), UVA */
-          if (ELEM(pass->totchan, 3, 4)) {
-            if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
-                pass->chan[2]->chan_id == 'B') {
-              lookup[(unsigned int)'R'] = 0;
-              lookup[(unsigned int)'G'] = 1;
-              lookup[(unsigned int)'B'] = 2;
-              lookup[(unsigned int)'A'] = 3;
-            }
-            else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
-                     pass->chan[2]->chan_id == 'Y') {
-              lookup[(unsigned int)'X'] = 0;
-              lookup[(unsigned int)'Y'] = 1;
-              lookup[(unsigned int)'Z'] = 2;
-              lookup[(unsigned int)'W'] = 3;
-            }
-            else {
-              lookup[(unsigned int)'U'] = 0;
-              lookup[(unsigned int)'V'] = 1;
-              lookup[(unsigned int)'A'] = 2;
-            }
-            for (int a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-              echan->xstride = pass->totchan;
-              echan->ystride = data->width * pass->totchan;
-              pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-            }
-          }
-          else { /* unknown */
-            for (int a = 0; a < pass->totchan; a++) {
-              ExrChannel *echan = pass->chan[a];
-              echan->rect = pass->rect + a;
-              echan->xstride = pass->totchan;
-              echan->ystride = data->width * pass->totchan;
-              pass->chan_id[a] = echan->chan_id;
-            }
-          }
+        if (alloc_passes) {
+          pass->rect = (float *)MEM_callocN(
+              data->width * data->height * pass->totchan * sizeof(float), "pass rect");
         }
+        imb_exr_pass_assign_rect(data, pass, pass->rect);
       }
     }
   }
@@ -1726,7 +1940,7 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
   data->width = width;
   data->height = height;
 
-  if (!imb_exr_multilayer_parse_channels_from_file(data)) {
+  if (!imb_exr_multilayer_parse_channels_from_file(data, true)) {
     IMB_exr_close(data);
     return nullptr;
   }
@@ -1963,6 +2177,20 @@ static bool imb_exr_is_multi(MultiPartInputFile &file)
   return false;
 }
 
+static void imb_exr_read_metadata(const Header &header, ImBuf *ibuf)
+{
+  IMB_metadata_ensure(&ibuf->metadata);
+  for (Header::ConstIterator iter = header.begin(); iter != header.end(); iter++) {
+    const StringAttribute *attr = header.findTypedAttribute<StringAttribute>(iter.name());
+
+    /* not all attributes are string attributes so we might get some NULLs here */
+    if (attr) {
+      IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
+      ibuf->flags |= IB_metadata;
+    }
+  }
+}
+
 bool IMB_exr_has_multilayer(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
@@ -2024,20 +2252,7 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
       if (!(flags & IB_test)) {
 
         if (flags & IB_metadata) {
-          const Header &header = file->header(0);
-          Header::ConstIterator iter;
-
-          IMB_metadata_ensure(&ibuf->metadata);
-          for (iter = header.begin(); iter != header.end(); iter++) {
-            const StringAttribute *attr = file->header(0).findTypedAttribute<StringAttribute>(
-                iter.name());
-
-            /* not all attributes are string attributes so we might get some NULLs here */
-            if (attr) {
-              IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
-              ibuf->flags |= IB_metadata;
-            }
-          }
+          imb_exr_read_metadata(file->header(0), ibuf);
         }
 
         /* Only enters with IB_multilayer flag set. */
@@ -2167,6 +2382,64 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
   }
 }
 
+/**
+ * Create a thumbnail from the smallest mip-map or rip-map level of a tiled file that is at least
+ * as large as the thumbnail, so only a fraction of the pixels of the full resolution image are
+ * decoded.
+ */
+static struct ImBuf *imb_exr_thumbnail_from_levels(IStream &stream,
+                                                   const int dest_w,
+                                                   const int dest_h)
+{
+  /* Single thread of the pool, like other thumbnails. */
+  TiledRgbaInputFile file(stream, 1);
+
+  int lx = 0, ly = 0;
+  if (file.levelMode() == RIPMAP_LEVELS) {
+    while (lx + 1 < file.numXLevels() && file.levelWidth(lx + 1) >= dest_w) {
+      lx++;
+    }
+    while (ly + 1 < file.numYLevels() && file.levelHeight(ly + 1) >= dest_h) {
+      ly++;
+    }
+  }
+  else {
+    while (lx + 1 < file.numLevels() && file.levelWidth(lx + 1) >= dest_w &&
+           file.levelHeight(lx + 1) >= dest_h) {
+      lx++;
+    }
+    ly = lx;
+  }
+
+  const Box2i dw = file.dataWindowForLevel(lx, ly);
+  const int level_w = dw.max.x - dw.min.x + 1;
+  const int level_h = dw.max.y - dw.min.y + 1;
+
+  Imf::Array2D<Imf::Rgba> pixels(level_h, level_w);
+  file.setFrameBuffer(&pixels[0][0] - dw.min.x - dw.min.y * level_w, 1, level_w);
+  file.readTiles(0, file.numXTiles(lx) - 1, 0, file.numYTiles(ly) - 1, lx, ly);
+
+  struct ImBuf *ibuf = IMB_allocImBuf(dest_w, dest_h, 32, IB_rectfloat);
+
+  for (int h = 0; h < dest_h; h++) {
+    const int source_y = std::min(h * level_h / dest_h, level_h - 1);
+    for (int w = 0; w < dest_w; w++) {
+      const int source_x = std::min(w * level_w / dest_w, level_w - 1);
+      const Imf::Rgba &pixel = pixels[source_y][source_x];
+      float *dest_px = &ibuf->rect_float[(h * dest_w + w) * 4];
+      dest_px[0] = pixel.r;
+      dest_px[1] = pixel.g;
+      dest_px[2] = pixel.b;
+      dest_px[3] = pixel.a;
+    }
+  }
+
+  /* Rows were filled from the top of the image down. */
+  IMB_flipy(ibuf);
+
+  return ibuf;
+}
+
 struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
                                                   const int UNUSED(flags),
                                                   const size_t max_thumb_size,
@@ -2227,6 +2500,17 @@ struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
     int dest_w = (int)(source_w * scale_factor);
     int dest_h = (int)(source_h * scale_factor);
 
+    /* Files with reduced resolution levels are read from the level closest to the thumbnail. */
+    if (file->header().hasTileDescription() &&
+        file->header().tileDescription().mode != ONE_LEVEL) {
+      delete file;
+      file = nullptr;
+      stream->seekg(0);
+      struct ImBuf *ibuf = imb_exr_thumbnail_from_levels(*stream, dest_w, dest_h);
+      delete stream;
+      return ibuf;
+    }
+
     struct ImBuf *ibuf = IMB_allocImBuf(dest_w, dest_h, 32, IB_rectfloat);
 
     /* A single row of source pixels. */
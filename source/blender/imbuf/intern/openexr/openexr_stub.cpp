@@ -36,6 +36,21 @@ bool IMB_exr_begin_read(void * /*handle*/,
 {
   return false;
 }
+bool IMB_exr_begin_read_lazy(void * /*handle*/,
+                             const char * /*filepath*/,
+                             int * /*width*/,
+                             int * /*height*/,
+                             struct ImBuf * /*metadata_ibuf*/)
+{
+  return false;
+}
+float *IMB_exr_read_pass(void * /*handle*/,
+                         const char * /*layname*/,
+                         const char * /*passname*/,
+                         const char * /*viewname*/)
+{
+  return nullptr;
+}
 bool IMB_exr_begin_write(void * /*handle*/,
                          const char * /*filepath*/,
                          int /*width*/,
@@ -8,9 +8,11 @@
  */
 
 #include <png.h>
+#include <zlib.h>
 
 #include "BLI_fileops.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -107,7 +109,295 @@ BLI_INLINE unsigned short ftoshort(float val)
   return unit_float_to_ushort_clamp(val);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Deflate
+ *
+ * Like pigz does for gzip files, the image data is split into bands of rows which are filtered
+ * and deflated on separate threads. Each band is deflated with the data before it as preset
+ * dictionary, so there is hardly any loss in compression, and all but the last band end with a
+ * sync flush on a byte boundary. Concatenated, the bands form a single deflate stream which only
+ * needs the zlib header and the checksum of all data around it, and is read like any other PNG.
+ * \{ */
+
+/* Minimum amount of filtered image data deflated by a thread. */
+#define PNG_BAND_MIN_SIZE (256 * 1024)
+/* Deflate window size, the maximum distance of back references in the stream. */
+#define PNG_DICTIONARY_SIZE 32768
+/* Maximum size of IDAT chunks written. */
+#define PNG_IDAT_CHUNK_SIZE (1 << 20)
+
+typedef struct PNGDeflateBand {
+  /* Compressed data, NULL on failure. */
+  unsigned char *data;
+  size_t size;
+  uLong adler;
+} PNGDeflateBand;
+
+typedef struct PNGDeflateData {
+  png_bytepp row_pointers;
+  int height;
+  /* Size of a row, without the filter type byte. */
+  size_t row_size;
+  /* Bytes per complete pixel, distance to the pixel on the left in filters. */
+  int bpp;
+  /* Swap 16 bit values to the big endian byte order of PNG. */
+  bool swap16;
+  int level;
+  int band_rows;
+  /* Filter type byte and filtered data of all rows. */
+  unsigned char *filtered;
+  PNGDeflateBand *bands;
+} PNGDeflateData;
+
+BLI_INLINE unsigned char png_paeth_predictor(const int a, const int b, const int c)
+{
+  const int p = a + b - c;
+  const int pa = abs(p - a);
+  const int pb = abs(p - b);
+  const int pc = abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return (unsigned char)a;
+  }
+  return (unsigned char)((pb <= pc) ? b : c);
+}
+
+/* Same heuristic as libpng for picking filters: the smallest sum of absolute signed values. */
+static size_t png_filter_cost(const unsigned char *filtered, const size_t size)
+{
+  size_t cost = 0;
+  for (size_t i = 0; i < size; i++) {
+    cost += (filtered[i] < 128) ? filtered[i] : 256 - filtered[i];
+  }
+  return cost;
+}
+
+/**
+ * Write the filter type and filtered bytes of row \a cur to \a r_filtered, trying all filters.
+ * \a prev is the row above it, NULL for the first row. \a scratch has room for four rows.
+ */
+static void png_filter_row(const unsigned char *cur,
+                           const unsigned char *prev,
+                           const size_t row_size,
+                           const size_t bpp,
+                           unsigned char *scratch,
+                           unsigned char *r_filtered)
+{
+  unsigned char *candidates[5] = {NULL,
+                                  scratch,
+                                  scratch + row_size,
+                                  scratch + row_size * 2,
+                                  scratch + row_size * 3};
+
+  for (size_t i = 0; i < row_size; i++) {
+    const int a = (i >= bpp) ? cur[i - bpp] : 0;
+    const int b = prev ? prev[i] : 0;
+    const int c = (prev && i >= bpp) ? prev[i - bpp] : 0;
+    candidates[PNG_FILTER_VALUE_SUB][i] = (unsigned char)(cur[i] - a);
+    candidates[PNG_FILTER_VALUE_UP][i] = (unsigned char)(cur[i] - b);
+    candidates[PNG_FILTER_VALUE_AVG][i] = (unsigned char)(cur[i] - ((a + b) >> 1));
+    candidates[PNG_FILTER_VALUE_PAETH][i] = (unsigned char)(cur[i] - png_paeth_predictor(a, b, c));
+  }
+
+  int best_filter = PNG_FILTER_VALUE_NONE;
+  size_t best_cost = png_filter_cost(cur, row_size);
+  for (int filter = PNG_FILTER_VALUE_SUB; filter <= PNG_FILTER_VALUE_PAETH; filter++) {
+    const size_t cost = png_filter_cost(candidates[filter], row_size);
+    if (cost < best_cost) {
+      best_filter = filter;
+      best_cost = cost;
+    }
+  }
+
+  r_filtered[0] = (unsigned char)best_filter;
+  memcpy(r_filtered + 1,
+         (best_filter == PNG_FILTER_VALUE_NONE) ? cur : candidates[best_filter],
+         row_size);
+}
+
+/* Copy row \a y in PNG byte order to \a r_row, or return it directly when it already is. */
+static const unsigned char *png_row_get(const PNGDeflateData *data,
+                                        const int y,
+                                        unsigned char *r_row)
+{
+  const unsigned char *row = data->row_pointers[y];
+  if (!data->swap16) {
+    return row;
+  }
+  for (size_t i = 0; i < data->row_size; i += 2) {
+    r_row[i] = row[i + 1];
+    r_row[i + 1] = row[i];
+  }
+  return r_row;
+}
+
+static void png_filter_band(void *__restrict data_v,
+                            const int band,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PNGDeflateData *data = (const PNGDeflateData *)data_v;
+  const size_t row_size = data->row_size;
+  const int ymin = band * data->band_rows;
+  const int ymax = min_ii(ymin + data->band_rows, data->height);
+
+  /* Room for four filtered candidates and two rows in PNG byte order. */
+  unsigned char *scratch = MEM_mallocN(row_size * 6, __func__);
+  unsigned char *row_buffers[2] = {scratch + row_size * 4, scratch + row_size * 5};
+
+  const unsigned char *prev = (ymin > 0) ? png_row_get(data, ymin - 1, row_buffers[1]) : NULL;
+  for (int y = ymin; y < ymax; y++) {
+    const unsigned char *cur = png_row_get(data, y, row_buffers[(y - ymin) & 1]);
+    png_filter_row(
+        cur, prev, row_size, data->bpp, scratch, data->filtered + (row_size + 1) * y);
+    prev = cur;
+  }
+
+  MEM_freeN(scratch);
+}
+
+static void png_deflate_band(void *__restrict data_v,
+                             const int band,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PNGDeflateData *data = (const PNGDeflateData *)data_v;
+  PNGDeflateBand *result = &data->bands[band];
+  const size_t stride = data->row_size + 1;
+  const int ymin = band * data->band_rows;
+  const int ymax = min_ii(ymin + data->band_rows, data->height);
+  const bool is_last = ymax == data->height;
+  unsigned char *input = data->filtered + stride * ymin;
+  const size_t input_size = stride * (ymax - ymin);
+
+  result->data = NULL;
+  result->adler = adler32(adler32(0L, Z_NULL, 0), input, (uInt)input_size);
+
+  z_stream stream = {NULL};
+  /* Raw deflate, the zlib header and checksum are written for all bands together. */
+  if (deflateInit2(&stream, data->level, Z_DEFLATED, -15, 8, Z_FILTERED) != Z_OK) {
+    return;
+  }
+  if (ymin > 0) {
+    const size_t dictionary_size = min_zz(stride * ymin, PNG_DICTIONARY_SIZE);
+    deflateSetDictionary(&stream, input - dictionary_size, (uInt)dictionary_size);
+  }
+
+  /* Sync flush adds an empty stored block. */
+  size_t buffer_size = deflateBound(&stream, (uLong)input_size) + 16;
+  unsigned char *buffer = MEM_mallocN(buffer_size, __func__);
+  stream.next_in = input;
+  stream.avail_in = (uInt)input_size;
+  stream.next_out = buffer;
+  stream.avail_out = (uInt)buffer_size;
+
+  const int flush = is_last ? Z_FINISH : Z_SYNC_FLUSH;
+  for (;;) {
+    const int ret = deflate(&stream, flush);
+    if (is_last ? (ret == Z_STREAM_END) : (stream.avail_in == 0 && stream.avail_out > 0)) {
+      break;
+    }
+    if (!ELEM(ret, Z_OK, Z_BUF_ERROR) || stream.avail_out > 0) {
+      deflateEnd(&stream);
+      MEM_freeN(buffer);
+      return;
+    }
+    /* Should not happen with the bound above, grow the buffer to be sure. */
+    const size_t used = buffer_size;
+    buffer_size *= 2;
+    buffer = MEM_reallocN(buffer, buffer_size);
+    stream.next_out = buffer + used;
+    stream.avail_out = (uInt)(buffer_size - used);
+  }
+
+  result->size = buffer_size - stream.avail_out;
+  result->data = buffer;
+  deflateEnd(&stream);
+}
+
+/**
+ * Filter and compress all rows into a zlib stream for the IDAT chunks, in parallel.
+ * \return The stream or NULL on failure.
+ */
+static unsigned char *png_deflate_rows_parallel(png_bytepp row_pointers,
+                                                const int height,
+                                                const size_t row_size,
+                                                const int bpp,
+                                                const bool swap16,
+                                                const int level,
+                                                size_t *r_size)
+{
+  PNGDeflateData data;
+  data.row_pointers = row_pointers;
+  data.height = height;
+  data.row_size = row_size;
+  data.bpp = bpp;
+  data.swap16 = swap16;
+  data.level = level;
+  data.band_rows = max_ii(1, (int)(PNG_BAND_MIN_SIZE / (row_size + 1)));
+  data.filtered = MEM_mallocN((row_size + 1) * height, "png filtered rows");
+
+  const int num_bands = (int)divide_ceil_u(height, data.band_rows);
+  data.bands = MEM_calloc_arrayN(num_bands, sizeof(PNGDeflateBand), "png deflate bands");
+
+  /* Filtering is done for all bands first, they need the end of the band before them for the
+   * preset dictionary. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, num_bands, &data, png_filter_band, &settings);
+  BLI_task_parallel_range(0, num_bands, &data, png_deflate_band, &settings);
+  MEM_freeN(data.filtered);
+
+  /* zlib header and trailer, see RFC 1950. */
+  const unsigned char cmf = 0x78;
+  unsigned char flg = (level < 2) ? 0 : (level < 6) ? 1 : (level == 6) ? 2 : 3;
+  flg <<= 6;
+  flg += 31 - ((cmf << 8) + flg) % 31;
+
+  size_t size = 2 + 4;
+  bool ok = true;
+  for (int i = 0; i < num_bands; i++) {
+    ok &= data.bands[i].data != NULL;
+    size += data.bands[i].size;
+  }
+
+  unsigned char *stream = ok ? MEM_mallocN(size, "png zlib stream") : NULL;
+  if (stream) {
+    unsigned char *dst = stream;
+    uLong adler = adler32(0L, Z_NULL, 0);
+    *dst++ = cmf;
+    *dst++ = flg;
+    for (int i = 0; i < num_bands; i++) {
+      const int ymin = i * data.band_rows;
+      const int rows = min_ii(data.band_rows, height - ymin);
+      memcpy(dst, data.bands[i].data, data.bands[i].size);
+      dst += data.bands[i].size;
+      adler = adler32_combine(adler, data.bands[i].adler, (z_off_t)((row_size + 1) * rows));
+    }
+    dst[0] = (unsigned char)(adler >> 24);
+    dst[1] = (unsigned char)(adler >> 16);
+    dst[2] = (unsigned char)(adler >> 8);
+    dst[3] = (unsigned char)adler;
+    *r_size = size;
+  }
+
+  for (int i = 0; i < num_bands; i++) {
+    MEM_SAFE_FREE(data.bands[i].data);
+  }
+  MEM_freeN(data.bands);
+
+  return stream;
+}
+
+/** \} */
+
 bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
+{
+  const size_t row_size = ((size_t)ibuf->x) * ((ibuf->planes + 7) >> 3) *
+                          ((ibuf->foptions.flag & PNG_16BIT) ? 2 : 1);
+  /* Not worth the overhead of threading for a single band. */
+  const bool use_threads = (row_size + 1) * ibuf->y >= 2 * PNG_BAND_MIN_SIZE;
+  return imb_savepng_ex(ibuf, filepath, flags, use_threads);
+}
+
+bool imb_savepng_ex(struct ImBuf *ibuf, const char *filepath, int flags, bool use_threads)
 {
   png_structp png_ptr;
   png_infop info_ptr;
@@ -117,6 +407,8 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
   unsigned short *pixels16 = NULL, *to16;
   float *from_float, from_straight[4];
   png_bytepp row_pointers = NULL;
+  unsigned char *idat = NULL;
+  size_t idat_size = 0;
   int i, bytesperpixel, color_type = PNG_COLOR_TYPE_GRAY;
   FILE *fp = NULL;
 
@@ -203,6 +495,9 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
     if (row_pointers) {
       MEM_freeN(row_pointers);
     }
+    if (idat) {
+      MEM_freeN(idat);
+    }
     if (fp) {
       fflush(fp);
       fclose(fp);
@@ -461,10 +756,6 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
   /* write the file header information */
   png_write_info(png_ptr, info_ptr);
 
-#ifdef __LITTLE_ENDIAN__
-  png_set_swap(png_ptr);
-#endif
-
   /* set the individual row-pointers to point at the correct offsets */
   if (is_16bit) {
     for (i = 0; i < ibuf->y; i++) {
@@ -480,11 +771,44 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
     }
   }
 
-  /* write out the entire image data in one call */
-  png_write_image(png_ptr, row_pointers);
+  if (use_threads) {
+#ifdef __LITTLE_ENDIAN__
+    const bool swap16 = is_16bit;
+#else
+    const bool swap16 = false;
+#endif
+    idat = png_deflate_rows_parallel(row_pointers,
+                                     ibuf->y,
+                                     ((size_t)ibuf->x) * bytesperpixel * (is_16bit ? 2 : 1),
+                                     bytesperpixel * (is_16bit ? 2 : 1),
+                                     swap16,
+                                     compression,
+                                     &idat_size);
+  }
+
+  if (idat) {
+    /* Write the compressed image data and end of the file directly, libpng only handles
+     * compressing the data itself. */
+    for (size_t offset = 0; offset < idat_size; offset += PNG_IDAT_CHUNK_SIZE) {
+      png_write_chunk(png_ptr,
+                      (png_bytep)"IDAT",
+                      idat + offset,
+                      min_zz(idat_size - offset, PNG_IDAT_CHUNK_SIZE));
+    }
+    png_write_chunk(png_ptr, (png_bytep)"IEND", NULL, 0);
+    MEM_freeN(idat);
+  }
+  else {
+#ifdef __LITTLE_ENDIAN__
+    png_set_swap(png_ptr);
+#endif
+
+    /* write out the entire image data in one call */
+    png_write_image(png_ptr, row_pointers);
 
-  /* write the additional chunks to the PNG file (not really needed) */
-  png_write_end(png_ptr, info_ptr);
+    /* write the additional chunks to the PNG file (not really needed) */
+    png_write_end(png_ptr, info_ptr);
+  }
 
   /* clean up */
   if (pixels) {
@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * Tests of writing PNG files with and without parallel deflate, and a benchmark comparing both
+ * for 4K images.
+ *
+ * Benchmarks are disabled by default, run with:
+ * `blender_test --gtest_also_run_disabled_tests --gtest_filter=imbuf_png.DISABLED_*`
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+#include "BLI_threads.h"
+
+#include "IMB_filetype.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+namespace blender::imbuf::tests {
+
+/** Gradients with some noise, compressible like rendered images are. */
+static ImBuf *create_test_buffer(const int x, const int y, const int planes, const bool is_16bit)
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, planes, IB_rect);
+  RandomNumberGenerator rng(0);
+  uchar *rect = (uchar *)ibuf->rect;
+  for (int j = 0; j < y; j++) {
+    for (int i = 0; i < x; i++, rect += 4) {
+      rect[0] = uchar((i + rng.get_int32(4)) % 256);
+      rect[1] = uchar((j + rng.get_int32(4)) % 256);
+      rect[2] = uchar(((i + j) / 2) % 256);
+      rect[3] = uchar(255 - rng.get_int32(8));
+    }
+  }
+  if (is_16bit) {
+    ibuf->foptions.flag |= PNG_16BIT;
+  }
+  ibuf->foptions.quality = 90;
+  return ibuf;
+}
+
+static void test_round_trip(const int planes, const bool is_16bit, const bool use_threads)
+{
+  /* Large enough for multiple bands to be deflated in parallel. */
+  ImBuf *ibuf = create_test_buffer(300, 400, planes, is_16bit);
+  ASSERT_TRUE(imb_savepng_ex(ibuf, "<memory>", IB_mem, use_threads));
+
+  char colorspace[IM_MAX_SPACE] = "";
+  ImBuf *result = imb_loadpng(ibuf->encodedbuffer, ibuf->encodedsize, IB_rect, colorspace);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->x, ibuf->x);
+  EXPECT_EQ(result->y, ibuf->y);
+  EXPECT_EQ(result->planes, planes);
+
+  const int channels = planes / 8;
+  for (size_t i = 0; i < size_t(ibuf->x) * ibuf->y; i++) {
+    const uchar *expected = (const uchar *)ibuf->rect + i * 4;
+    for (int c = 0; c < channels; c++) {
+      if (is_16bit) {
+        EXPECT_NEAR(result->rect_float[i * 4 + c], expected[c] / 255.0f, 1e-6f);
+      }
+      else {
+        EXPECT_EQ(((const uchar *)result->rect)[i * 4 + c], expected[c]);
+      }
+    }
+  }
+
+  IMB_freeImBuf(result);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_png, round_trip)
+{
+  for (const bool use_threads : {false, true}) {
+    test_round_trip(32, false, use_threads);
+    test_round_trip(24, false, use_threads);
+    test_round_trip(32, true, use_threads);
+    test_round_trip(24, true, use_threads);
+  }
+}
+
+TEST(imbuf_png, small_image)
+{
+  /* Less data than a single band, in a single row. */
+  ImBuf *ibuf = create_test_buffer(7, 1, 32, true);
+  ASSERT_TRUE(imb_savepng_ex(ibuf, "<memory>", IB_mem, true));
+  char colorspace[IM_MAX_SPACE] = "";
+  ImBuf *result = imb_loadpng(ibuf->encodedbuffer, ibuf->encodedsize, IB_rect, colorspace);
+  ASSERT_NE(result, nullptr);
+  EXPECT_NEAR(result->rect_float[4], ((const uchar *)ibuf->rect)[4] / 255.0f, 1e-6f);
+  IMB_freeImBuf(result);
+  IMB_freeImBuf(ibuf);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Benchmarks
+ * \{ */
+
+TEST(imbuf_png, DISABLED_benchmark_4k)
+{
+  BLI_threadapi_init();
+
+  for (const bool is_16bit : {false, true}) {
+    for (const int quality : {15, 90}) {
+      for (const bool use_threads : {false, true}) {
+        ImBuf *ibuf = create_test_buffer(3840, 2160, 32, is_16bit);
+        ibuf->foptions.quality = quality;
+
+        const int runs = 3;
+        const double start_time = PIL_check_seconds_timer();
+        for (int i = 0; i < runs; i++) {
+          imb_savepng_ex(ibuf, "<memory>", IB_mem, use_threads);
+        }
+        const double total_time = PIL_check_seconds_timer() - start_time;
+
+        printf("%-6s quality %2d %-8s 3840x2160: %8.2f ms, %6.2f MB\n",
+               is_16bit ? "16 bit" : "8 bit",
+               quality,
+               use_threads ? "threaded" : "",
+               total_time / runs * 1000.0,
+               ibuf->encodedsize / (1024.0 * 1024.0));
+        IMB_freeImBuf(ibuf);
+      }
+    }
+  }
+
+  BLI_threadapi_exit();
+}
+
+/** \} */
+
+}  // namespace blender::imbuf::tests
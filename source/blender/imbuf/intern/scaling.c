@@ -7,8 +7,12 @@
 
 #include <math.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_simd.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -888,694 +892,466 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+/* -------------------------------------------------------------------- */
+/** \name Box Filtered Scaling
+ *
+ * Scaling down averages the source pixels covered by each destination pixel, scaling up
+ * interpolates linearly between the two nearest source pixels. Weights only depend on the
+ * position along the scaled axis, they're computed once and rows are scaled in parallel.
+ *
+ * NOTE: float buffers are assumed to have 4 channels.
+ * \{ */
+
+/** Source pixels averaged into a destination pixel when scaling down. */
+typedef struct ScaleDownSpan {
+  /**
+   * First fully covered source pixel. The pixel before it is covered by `-prev_sample`, that is
+   * the part of it not averaged into the previous destination pixel.
+   */
+  int start;
+  /** Number of fully covered source pixels, the pixel after them is covered by `sample`. */
+  int len;
+  float prev_sample;
+  float sample;
+} ScaleDownSpan;
+
+/** Source pixels interpolated into a destination pixel when scaling up. */
+typedef struct ScaleUpSpan {
+  /** Source pixel interpolated with the one after it by `sample`. */
+  int start;
+  float sample;
+} ScaleUpSpan;
+
+static ScaleDownSpan *scaledown_spans_new(const int size, const int newsize, float *r_add)
 {
-  const bool do_rect = (ibuf->rect != NULL);
-  const bool do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+  ScaleDownSpan *spans = MEM_mallocN(sizeof(ScaleDownSpan) * newsize, __func__);
+  const float add = (size - 0.01) / newsize;
+  float sample = 0.0f;
+  int start = 0;
+
+  for (int i = 0; i < newsize; i++) {
+    spans[i].start = start;
+    spans[i].prev_sample = sample;
+    spans[i].len = 0;
+
+    sample += add;
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
+      spans[i].len++;
     }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
 
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
+    spans[i].sample = sample;
+    start += spans[i].len + 1;
+    sample -= 1.0f;
   }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
-  }
-
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
-      }
-      if (do_float) {
+  BLI_assert(start == size); /* see bug T26502. */
 
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+  *r_add = add;
+  return spans;
+}
 
-        newrectf += 4;
-      }
+static ScaleUpSpan *scaleup_spans_new(const int size, const int newsize)
+{
+  ScaleUpSpan *spans = MEM_mallocN(sizeof(ScaleUpSpan) * newsize, __func__);
+  const float add = (size - 1.001) / (newsize - 1.0);
+  float sample = 0.0f;
+  int start = 0;
 
+  for (int i = 0; i < newsize; i++) {
+    if (sample >= 1.0f) {
       sample -= 1.0f;
+      start++;
     }
+    spans[i].start = start;
+    spans[i].sample = sample;
+    sample += add;
   }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->x = newx;
-  return ibuf;
+  return spans;
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+#ifdef BLI_HAVE_SSE2
+MALWAYS_INLINE __m128 load_byte_pixel_simd(const uchar *pixel)
 {
-  const bool do_rect = (ibuf->rect != NULL);
-  const bool do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bytes = _mm_cvtsi32_si128(*(const int *)pixel);
+  return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+}
 
-  if (!do_rect && !do_float) {
-    return ibuf;
+MALWAYS_INLINE __m128 scaledown_pixel_simd(__m128 prev,
+                                           const __m128 *pixels,
+                                           const __m128 last,
+                                           const ScaleDownSpan *span,
+                                           const float add)
+{
+  /* Same operations as the scalar code, negation flips the sign bit like unary minus does. */
+  __m128 nval = _mm_mul_ps(_mm_xor_ps(prev, _mm_set1_ps(-0.0f)), _mm_set1_ps(span->prev_sample));
+  for (int i = 0; i < span->len; i++) {
+    nval = _mm_add_ps(nval, pixels[i]);
   }
+  return _mm_div_ps(_mm_add_ps(nval, _mm_mul_ps(_mm_set1_ps(span->sample), last)),
+                    _mm_set1_ps(add));
+}
+#endif
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny");
-    if (_newrect == NULL) {
-      return ibuf;
+/**
+ * Average the source pixels of \a span into \a dst. \a src points to the first fully covered
+ * pixel, \a stride is the distance between source pixels along the scaled axis.
+ */
+static void scaledown_pixel_byte(
+    const uchar *src, const size_t stride, const ScaleDownSpan *span, const float add, uchar *dst)
+{
+  float result[4];
+#ifdef BLI_HAVE_SSE2
+  const __m128 prev = (span->start > 0) ? load_byte_pixel_simd(src - stride) : _mm_setzero_ps();
+  __m128 nval = _mm_mul_ps(_mm_xor_ps(prev, _mm_set1_ps(-0.0f)), _mm_set1_ps(span->prev_sample));
+  for (int i = 0; i < span->len; i++, src += stride) {
+    nval = _mm_add_ps(nval, load_byte_pixel_simd(src));
+  }
+  _mm_storeu_ps(result,
+                _mm_div_ps(_mm_add_ps(nval,
+                                      _mm_mul_ps(_mm_set1_ps(span->sample),
+                                                 load_byte_pixel_simd(src))),
+                           _mm_set1_ps(add)));
+#else
+  float nval[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  if (span->start > 0) {
+    for (int c = 0; c < 4; c++) {
+      nval[c] = -(float)(src - stride)[c] * span->prev_sample;
     }
   }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+  for (int i = 0; i < span->len; i++, src += stride) {
+    for (int c = 0; c < 4; c++) {
+      nval[c] += src[c];
     }
   }
+  for (int c = 0; c < 4; c++) {
+    result[c] = (nval[c] + span->sample * src[c]) / add;
+  }
+#endif
+  for (int c = 0; c < 4; c++) {
+    dst[c] = roundf(result[c]);
+  }
+}
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
-      }
-
-      sample -= 1.0f;
+static void scaledown_pixel_float(
+    const float *src, const size_t stride, const ScaleDownSpan *span, const float add, float *dst)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128 prev = (span->start > 0) ? _mm_loadu_ps(src - stride) : _mm_setzero_ps();
+  __m128 nval = _mm_mul_ps(_mm_xor_ps(prev, _mm_set1_ps(-0.0f)), _mm_set1_ps(span->prev_sample));
+  for (int i = 0; i < span->len; i++, src += stride) {
+    nval = _mm_add_ps(nval, _mm_loadu_ps(src));
+  }
+  _mm_storeu_ps(
+      dst,
+      _mm_div_ps(_mm_add_ps(nval, _mm_mul_ps(_mm_set1_ps(span->sample), _mm_loadu_ps(src))),
+                 _mm_set1_ps(add)));
+#else
+  float nval[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  if (span->start > 0) {
+    for (int c = 0; c < 4; c++) {
+      nval[c] = -(src - stride)[c] * span->prev_sample;
     }
   }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+  for (int i = 0; i < span->len; i++, src += stride) {
+    for (int c = 0; c < 4; c++) {
+      nval[c] += src[c];
+    }
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  for (int c = 0; c < 4; c++) {
+    dst[c] = (nval[c] + span->sample * src[c]) / add;
   }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
+#endif
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+/**
+ * Interpolate between the source pixel \a src and the one \a stride after it.
+ */
+static void scaleup_pixel_byte(const uchar *src,
+                               const size_t stride,
+                               const float sample,
+                               uchar *dst)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  int x, y;
-  bool do_rect = false, do_float = false;
+#ifdef BLI_HAVE_SSE2
+  const __m128 val = load_byte_pixel_simd(src);
+  const __m128 diff = _mm_sub_ps(load_byte_pixel_simd(src + stride), val);
+  const __m128 result = _mm_add_ps(_mm_add_ps(val, _mm_set1_ps(0.5f)),
+                                   _mm_mul_ps(_mm_set1_ps(sample), diff));
+  const __m128i result_i = _mm_cvttps_epi32(result);
+  const __m128i result_s = _mm_packs_epi32(result_i, result_i);
+  *(int *)dst = _mm_cvtsi128_si32(_mm_packus_epi16(result_s, result_s));
+#else
+  for (int c = 0; c < 4; c++) {
+    const float val = src[c];
+    const float diff = src[stride + c] - val;
+    dst[c] = (val + 0.5f) + sample * diff;
+  }
+#endif
+}
 
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
-  }
+static void scaleup_pixel_float(const float *src,
+                                const size_t stride,
+                                const float sample,
+                                float *dst)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128 val = _mm_loadu_ps(src);
+  const __m128 diff = _mm_sub_ps(_mm_loadu_ps(src + stride), val);
+  _mm_storeu_ps(dst, _mm_add_ps(val, _mm_mul_ps(_mm_set1_ps(sample), diff)));
+#else
+  for (int c = 0; c < 4; c++) {
+    dst[c] = src[c] + sample * (src[stride + c] - src[c]);
+  }
+#endif
+}
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return ibuf;
+typedef struct ScaleAxisData {
+  const ImBuf *ibuf;
+  uchar *newrect;
+  float *newrectf;
+  /** Size of the scaled axis after scaling. */
+  int newsize;
+  const ScaleDownSpan *down_spans;
+  const ScaleUpSpan *up_spans;
+  float add;
+} ScaleAxisData;
+
+static void scaledownx_row(void *__restrict data_v,
+                           const int y,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleAxisData *data = (const ScaleAxisData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const size_t src_offset = (size_t)y * ibuf->x * 4;
+  const size_t dst_offset = (size_t)y * data->newsize * 4;
+
+  for (int i = 0; i < data->newsize; i++) {
+    const ScaleDownSpan *span = &data->down_spans[i];
+    if (data->newrect) {
+      scaledown_pixel_byte((const uchar *)ibuf->rect + src_offset + span->start * 4,
+                           4,
+                           span,
+                           data->add,
+                           data->newrect + dst_offset + i * 4);
     }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+    if (data->newrectf) {
+      scaledown_pixel_float(ibuf->rect_float + src_offset + span->start * 4,
+                            4,
+                            span,
+                            data->add,
+                            data->newrectf + dst_offset + i * 4);
     }
   }
+}
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  /* Special case, copy all columns, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see T70356. */
-  if (UNLIKELY(ibuf->x == 1)) {
-    if (do_rect) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrect, rect, sizeof(char[4]));
-          newrect += 4;
-        }
-        rect += 4;
-      }
+static void scaledowny_row(void *__restrict data_v,
+                           const int newy,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleAxisData *data = (const ScaleAxisData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const ScaleDownSpan *span = &data->down_spans[newy];
+  const size_t stride = (size_t)ibuf->x * 4;
+  const size_t src_offset = span->start * stride;
+  const size_t dst_offset = newy * stride;
+
+  for (int x = 0; x < ibuf->x; x++) {
+    if (data->newrect) {
+      scaledown_pixel_byte((const uchar *)ibuf->rect + src_offset + x * 4,
+                           stride,
+                           span,
+                           data->add,
+                           data->newrect + dst_offset + x * 4);
     }
-    if (do_float) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrectf, rectf, sizeof(float[4]));
-          newrectf += 4;
-        }
-        rectf += 4;
-      }
+    if (data->newrectf) {
+      scaledown_pixel_float(ibuf->rect_float + src_offset + x * 4,
+                            stride,
+                            span,
+                            data->add,
+                            data->newrectf + dst_offset + x * 4);
     }
   }
-  else {
-    const float add = (ibuf->x - 1.001) / (newx - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (y = ibuf->y; y > 0; y--) {
-
-      sample = 0;
+}
 
-      if (do_rect) {
-        val_a = rect[0];
-        nval_a = rect[4];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[5];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[6];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[7];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 8;
+static void scaleupx_row(void *__restrict data_v,
+                         const int y,
+                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleAxisData *data = (const ScaleAxisData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const size_t src_offset = (size_t)y * ibuf->x * 4;
+  const size_t dst_offset = (size_t)y * data->newsize * 4;
+
+  for (int i = 0; i < data->newsize; i++) {
+    const ScaleUpSpan *span = &data->up_spans[i];
+
+    /* Special case, copy all columns, needed since the scaling logic assumes there is at least
+     * two rows to interpolate between causing out of bounds read for 1px images, see T70356. */
+    if (UNLIKELY(ibuf->x == 1)) {
+      if (data->newrect) {
+        memcpy(data->newrect + dst_offset + i * 4,
+               (const uchar *)ibuf->rect + src_offset,
+               sizeof(char[4]));
       }
-      if (do_float) {
-        val_af = rectf[0];
-        nval_af = rectf[4];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[5];
-        diff_bf = nval_bf - val_bf;
+      if (data->newrectf) {
+        memcpy(data->newrectf + dst_offset + i * 4,
+               ibuf->rect_float + src_offset,
+               sizeof(float[4]));
+      }
+      continue;
+    }
 
-        val_gf = rectf[2];
-        nval_gf = rectf[6];
-        diff_gf = nval_gf - val_gf;
+    if (data->newrect) {
+      scaleup_pixel_byte((const uchar *)ibuf->rect + src_offset + span->start * 4,
+                         4,
+                         span->sample,
+                         data->newrect + dst_offset + i * 4);
+    }
+    if (data->newrectf) {
+      scaleup_pixel_float(ibuf->rect_float + src_offset + span->start * 4,
+                          4,
+                          span->sample,
+                          data->newrectf + dst_offset + i * 4);
+    }
+  }
+}
 
-        val_rf = rectf[3];
-        nval_rf = rectf[7];
-        diff_rf = nval_rf - val_rf;
+static void scaleupy_row(void *__restrict data_v,
+                         const int newy,
+                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleAxisData *data = (const ScaleAxisData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const ScaleUpSpan *span = &data->up_spans[newy];
+  const size_t stride = (size_t)ibuf->x * 4;
+  const size_t src_offset = span->start * stride;
+  const size_t dst_offset = newy * stride;
 
-        rectf += 8;
-      }
-      for (x = newx; x > 0; x--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += 4;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += 4;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += 4;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += 4;
-        }
-        sample += add;
-      }
+  /* Special case, copy all rows, needed since the scaling logic assumes there is at least
+   * two rows to interpolate between causing out of bounds read for 1px images, see T70356. */
+  if (UNLIKELY(ibuf->y == 1)) {
+    if (data->newrect) {
+      memcpy(data->newrect + dst_offset, ibuf->rect, sizeof(char) * stride);
     }
+    if (data->newrectf) {
+      memcpy(data->newrectf + dst_offset, ibuf->rect_float, sizeof(float) * stride);
+    }
+    return;
   }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  for (int x = 0; x < ibuf->x; x++) {
+    if (data->newrect) {
+      scaleup_pixel_byte((const uchar *)ibuf->rect + src_offset + x * 4,
+                         stride,
+                         span->sample,
+                         data->newrect + dst_offset + x * 4);
+    }
+    if (data->newrectf) {
+      scaleup_pixel_float(ibuf->rect_float + src_offset + x * 4,
+                          stride,
+                          span->sample,
+                          data->newrectf + dst_offset + x * 4);
+    }
   }
-
-  ibuf->x = newx;
-  return ibuf;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+/**
+ * Scale one axis of \a ibuf to \a newsize, calling \a row_func for each row of the result.
+ */
+static ImBuf *scale_axis(ImBuf *ibuf,
+                         const int newx,
+                         const int newy,
+                         const bool scale_x,
+                         TaskParallelRangeFunc row_func)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
+  const bool do_rect = (ibuf->rect != NULL);
+  const bool do_float = (ibuf->rect_float != NULL);
+  const int size = scale_x ? ibuf->x : ibuf->y;
+  const int newsize = scale_x ? newx : newy;
+  ScaleAxisData data = {NULL};
 
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+  if (!do_rect && !do_float) {
     return ibuf;
   }
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
+  if (do_rect) {
+    data.newrect = MEM_mallocN(sizeof(uchar[4]) * newx * newy, "scale_axis");
+    if (data.newrect == NULL) {
       return ibuf;
     }
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+  if (do_float) {
+    data.newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scale_axisf");
+    if (data.newrectf == NULL) {
+      if (data.newrect) {
+        MEM_freeN(data.newrect);
       }
       return ibuf;
     }
   }
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  skipx = 4 * ibuf->x;
-
-  /* Special case, copy all rows, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see T70356. */
-  if (UNLIKELY(ibuf->y == 1)) {
-    if (do_rect) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrect, rect, sizeof(char) * skipx);
-        newrect += skipx;
-      }
-    }
-    if (do_float) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrectf, rectf, sizeof(float) * skipx);
-        newrectf += skipx;
-      }
-    }
+  data.ibuf = ibuf;
+  data.newsize = newsize;
+  if (newsize < size) {
+    data.down_spans = scaledown_spans_new(size, newsize, &data.add);
   }
   else {
-    const float add = (ibuf->y - 1.001) / (newy - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (x = ibuf->x; x > 0; x--) {
-      sample = 0;
-      if (do_rect) {
-        rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-        newrect = _newrect + 4 * (x - 1);
-
-        val_a = rect[0];
-        nval_a = rect[skipx];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[skipx + 1];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[skipx + 2];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[skipx + 3];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 2 * skipx;
-      }
-      if (do_float) {
-        rectf = ibuf->rect_float + 4 * (x - 1);
-        newrectf = _newrectf + 4 * (x - 1);
-
-        val_af = rectf[0];
-        nval_af = rectf[skipx];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[skipx + 1];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[skipx + 2];
-        diff_gf = nval_gf - val_gf;
-
-        val_rf = rectf[3];
-        nval_rf = rectf[skipx + 3];
-        diff_rf = nval_rf - val_rf;
+    data.up_spans = scaleup_spans_new(size, newsize);
+  }
 
-        rectf += 2 * skipx;
-      }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 8;
+  BLI_task_parallel_range(0, newy, &data, row_func, &settings);
 
-      for (y = newy; y > 0; y--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += skipx;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += skipx;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += skipx;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += skipx;
-        }
-        sample += add;
-      }
-    }
-  }
+  MEM_SAFE_FREE(data.down_spans);
+  MEM_SAFE_FREE(data.up_spans);
 
   if (do_rect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)data.newrect;
   }
   if (do_float) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = data.newrectf;
   }
 
+  ibuf->x = newx;
   ibuf->y = newy;
   return ibuf;
 }
 
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+  return scale_axis(ibuf, newx, ibuf->y, true, scaledownx_row);
+}
+
+static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+{
+  return scale_axis(ibuf, ibuf->x, newy, false, scaledowny_row);
+}
+
+static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+{
+  if (ibuf == NULL) {
+    return NULL;
+  }
+  return scale_axis(ibuf, newx, ibuf->y, true, scaleupx_row);
+}
+
+static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+{
+  if (ibuf == NULL) {
+    return NULL;
+  }
+  return scale_axis(ibuf, ibuf->x, newy, false, scaleupy_row);
+}
+
+/** \} */
+
 static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
   int *zbuf, *newzbuf, *_newzbuf = NULL;
@@ -1682,37 +1458,55 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
   return true;
 }
 
-struct imbufRGBA {
-  float r, g, b, a;
-};
+typedef struct ScaleFastData {
+  const ImBuf *ibuf;
+  unsigned int newx;
+  unsigned int *newrect;
+  float *newrectf;
+  size_t stepx, stepy;
+} ScaleFastData;
+
+static void scalefast_row(void *__restrict data_v,
+                          const int y,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFastData *data = (const ScaleFastData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const size_t ofsy = 32768 + y * data->stepy;
+  const size_t src_offset = (ofsy >> 16) * ibuf->x;
+  const size_t dst_offset = (size_t)y * data->newx;
+
+  if (data->newrect) {
+    const unsigned int *rect = ibuf->rect + src_offset;
+    unsigned int *newrect = data->newrect + dst_offset;
+    size_t ofsx = 32768;
+
+    for (int x = 0; x < data->newx; x++, ofsx += data->stepx) {
+      newrect[x] = rect[ofsx >> 16];
+    }
+  }
+
+  if (data->newrectf) {
+    const float *rectf = ibuf->rect_float + src_offset * 4;
+    float *newrectf = data->newrectf + dst_offset * 4;
+    size_t ofsx = 32768;
+
+    for (int x = 0; x < data->newx; x++, ofsx += data->stepx) {
+      copy_v4_v4(newrectf + x * 4, rectf + (ofsx >> 16) * 4);
+    }
+  }
+}
 
 bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
   BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
 
-  unsigned int *rect, *_newrect, *newrect;
-  struct imbufRGBA *rectf, *_newrectf, *newrectf;
-  int x, y;
-  bool do_float = false, do_rect = false;
-  size_t ofsx, ofsy, stepx, stepy;
-
-  rect = NULL;
-  _newrect = NULL;
-  newrect = NULL;
-  rectf = NULL;
-  _newrectf = NULL;
-  newrectf = NULL;
+  ScaleFastData data = {NULL};
 
   if (ibuf == NULL) {
     return false;
   }
-  if (ibuf->rect) {
-    do_rect = true;
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-  }
-  if (do_rect == false && do_float == false) {
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
     return false;
   }
 
@@ -1720,61 +1514,43 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
     return false;
   }
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(newx * newy * sizeof(int), "scalefastimbuf");
-    if (_newrect == NULL) {
+  if (ibuf->rect) {
+    data.newrect = MEM_mallocN(newx * newy * sizeof(int), "scalefastimbuf");
+    if (data.newrect == NULL) {
       return false;
     }
-    newrect = _newrect;
   }
 
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scalefastimbuf f");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+  if (ibuf->rect_float) {
+    data.newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scalefastimbuf f");
+    if (data.newrectf == NULL) {
+      if (data.newrect) {
+        MEM_freeN(data.newrect);
       }
       return false;
     }
-    newrectf = _newrectf;
   }
 
-  stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
-  stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
-  ofsy = 32768;
-
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (do_rect) {
-      rect = ibuf->rect;
-      rect += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
+  data.ibuf = ibuf;
+  data.newx = newx;
+  data.stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
+  data.stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
 
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newrect++ = rect[ofsx >> 16];
-      }
-    }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  BLI_task_parallel_range(0, newy, &data, scalefast_row, &settings);
 
-    if (do_float) {
-      rectf = (struct imbufRGBA *)ibuf->rect_float;
-      rectf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newrectf++ = rectf[ofsx >> 16];
-      }
-    }
-  }
-
-  if (do_rect) {
+  if (data.newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = _newrect;
+    ibuf->rect = data.newrect;
   }
 
-  if (do_float) {
+  if (data.newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = data.newrectf;
   }
 
   scalefast_Z_ImBuf(ibuf, newx, newy);
@@ -1902,3 +1678,270 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
     ibuf->rect_float = init_data.float_buffer;
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Lanczos Scaling
+ *
+ * Separable Lanczos filter, rows are filtered horizontally into a float buffer which is then
+ * filtered vertically. When scaling down the filter is widened to cover all source pixels.
+ * \{ */
+
+#define LANCZOS_RADIUS 3
+
+/** Filter weights of all destination pixels along one axis. */
+typedef struct LanczosAxis {
+  /** First source pixel and number of source pixels of each destination pixel. */
+  int *start;
+  int *len;
+  /** Weights of each destination pixel, #taps apart. */
+  float *weights;
+  int taps;
+} LanczosAxis;
+
+static float lanczos_weight(const float x)
+{
+  if (x == 0.0f) {
+    return 1.0f;
+  }
+  if (fabsf(x) >= LANCZOS_RADIUS) {
+    return 0.0f;
+  }
+  const float pi_x = (float)M_PI * x;
+  return LANCZOS_RADIUS * sinf(pi_x) * sinf(pi_x / LANCZOS_RADIUS) / (pi_x * pi_x);
+}
+
+static void lanczos_axis_init(LanczosAxis *axis, const int size, const int newsize)
+{
+  const float scale = (float)size / newsize;
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = LANCZOS_RADIUS * filter_scale;
+
+  axis->taps = (int)ceilf(support) * 2 + 1;
+  axis->start = MEM_mallocN(sizeof(int) * newsize, __func__);
+  axis->len = MEM_mallocN(sizeof(int) * newsize, __func__);
+  axis->weights = MEM_mallocN(sizeof(float) * newsize * axis->taps, __func__);
+
+  for (int i = 0; i < newsize; i++) {
+    const float center = (i + 0.5f) * scale;
+    /* Pixels outside of the image are left out, the remaining weights are normalized. */
+    const int start = max_ii((int)(center - support + 0.5f), 0);
+    const int end = min_ii((int)(center + support + 0.5f), size);
+    float *weights = axis->weights + i * axis->taps;
+    float total = 0.0f;
+
+    BLI_assert(end - start <= axis->taps);
+    for (int j = start; j < end; j++) {
+      weights[j - start] = lanczos_weight((j + 0.5f - center) / filter_scale);
+      total += weights[j - start];
+    }
+    if (total != 0.0f) {
+      for (int j = start; j < end; j++) {
+        weights[j - start] /= total;
+      }
+    }
+
+    axis->start[i] = start;
+    axis->len[i] = end - start;
+  }
+}
+
+static void lanczos_axis_free(LanczosAxis *axis)
+{
+  MEM_freeN(axis->start);
+  MEM_freeN(axis->len);
+  MEM_freeN(axis->weights);
+}
+
+typedef struct LanczosData {
+  const ImBuf *ibuf;
+  int newx;
+  LanczosAxis axis_x;
+  LanczosAxis axis_y;
+  /** Horizontally filtered rows, `newx * ibuf->y` pixels. Byte buffers are premultiplied. */
+  float *tmp_byte;
+  float *tmp_float;
+  uchar *newrect;
+  float *newrectf;
+} LanczosData;
+
+/** Add weighted \a pixel of 4 channels to \a accum. */
+BLI_INLINE void lanczos_accumulate_v4(float accum[4], const float *pixel, const float weight)
+{
+#ifdef BLI_HAVE_SSE2
+  _mm_storeu_ps(accum,
+                _mm_add_ps(_mm_loadu_ps(accum),
+                           _mm_mul_ps(_mm_set1_ps(weight), _mm_loadu_ps(pixel))));
+#else
+  madd_v4_v4fl(accum, pixel, weight);
+#endif
+}
+
+static void lanczos_horizontal_row(void *__restrict data_v,
+                                   const int y,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const LanczosData *data = (const LanczosData *)data_v;
+  const ImBuf *ibuf = data->ibuf;
+  const LanczosAxis *axis = &data->axis_x;
+  const int channels = ibuf->channels;
+
+  for (int x = 0; x < data->newx; x++) {
+    const float *weights = axis->weights + x * axis->taps;
+    const size_t src_offset = (size_t)y * ibuf->x + axis->start[x];
+    const size_t dst_offset = (size_t)y * data->newx + x;
+
+    if (data->tmp_byte) {
+      const uchar *src = (const uchar *)ibuf->rect + src_offset * 4;
+      float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+      for (int i = 0; i < axis->len[x]; i++, src += 4) {
+        /* Premultiply, keeping the `[0, 255]` range of the channels. */
+        const float weight_alpha = weights[i] * src[3] * (1.0f / 255.0f);
+        accum[0] += weight_alpha * src[0];
+        accum[1] += weight_alpha * src[1];
+        accum[2] += weight_alpha * src[2];
+        accum[3] += weights[i] * src[3];
+      }
+      copy_v4_v4(data->tmp_byte + dst_offset * 4, accum);
+    }
+
+    if (data->tmp_float) {
+      const float *src = ibuf->rect_float + src_offset * channels;
+      float *dst = data->tmp_float + dst_offset * channels;
+
+      if (channels == 4) {
+        float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < axis->len[x]; i++, src += 4) {
+          lanczos_accumulate_v4(accum, src, weights[i]);
+        }
+        copy_v4_v4(dst, accum);
+      }
+      else {
+        copy_vn_fl(dst, channels, 0.0f);
+        for (int i = 0; i < axis->len[x]; i++, src += channels) {
+          for (int c = 0; c < channels; c++) {
+            dst[c] += weights[i] * src[c];
+          }
+        }
+      }
+    }
+  }
+}
+
+static void lanczos_vertical_row(void *__restrict data_v,
+                                 const int newy,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const LanczosData *data = (const LanczosData *)data_v;
+  const LanczosAxis *axis = &data->axis_y;
+  const float *weights = axis->weights + newy * axis->taps;
+  const int channels = data->ibuf->channels;
+  const size_t stride = data->newx;
+  const size_t src_offset = axis->start[newy] * stride;
+  const size_t dst_offset = newy * stride;
+
+  for (int x = 0; x < data->newx; x++) {
+    if (data->tmp_byte) {
+      const float *src = data->tmp_byte + (src_offset + x) * 4;
+      uchar *dst = data->newrect + (dst_offset + x) * 4;
+      float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+      for (int i = 0; i < axis->len[newy]; i++, src += stride * 4) {
+        lanczos_accumulate_v4(accum, src, weights[i]);
+      }
+
+      /* Filter ringing can push values outside of the byte range, clamp before unpremultiply. */
+      const float alpha = clamp_f(accum[3], 0.0f, 255.0f);
+      const float unpremultiply = (alpha > 0.0f) ? 255.0f / alpha : 0.0f;
+      for (int c = 0; c < 3; c++) {
+        dst[c] = (uchar)(clamp_f(accum[c] * unpremultiply, 0.0f, 255.0f) + 0.5f);
+      }
+      dst[3] = (uchar)(alpha + 0.5f);
+    }
+
+    if (data->tmp_float) {
+      const float *src = data->tmp_float + (src_offset + x) * channels;
+      float *dst = data->newrectf + (dst_offset + x) * channels;
+
+      if (channels == 4) {
+        float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < axis->len[newy]; i++, src += stride * 4) {
+          lanczos_accumulate_v4(accum, src, weights[i]);
+        }
+        copy_v4_v4(dst, accum);
+      }
+      else {
+        copy_vn_fl(dst, channels, 0.0f);
+        for (int i = 0; i < axis->len[newy]; i++, src += stride * channels) {
+          for (int c = 0; c < channels; c++) {
+            dst[c] += weights[i] * src[c];
+          }
+        }
+      }
+    }
+  }
+}
+
+bool IMB_scaleImBuf_lanczos(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
+
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+
+  /* Same as #IMB_scaleImBuf, scale the Z-buffer before the size changes. */
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  LanczosData data = {NULL};
+  const size_t tmp_len = (size_t)newx * ibuf->y;
+  const size_t new_len = (size_t)newx * newy;
+
+  data.ibuf = ibuf;
+  data.newx = newx;
+  if (ibuf->rect) {
+    data.tmp_byte = MEM_mallocN(sizeof(float[4]) * tmp_len, "lanczos tmp byte");
+    data.newrect = MEM_mallocN(sizeof(uchar[4]) * new_len, "lanczos byte");
+  }
+  if (ibuf->rect_float) {
+    data.tmp_float = MEM_mallocN(sizeof(float) * ibuf->channels * tmp_len, "lanczos tmp float");
+    data.newrectf = MEM_mallocN(sizeof(float) * ibuf->channels * new_len, "lanczos float");
+  }
+  lanczos_axis_init(&data.axis_x, ibuf->x, newx);
+  lanczos_axis_init(&data.axis_y, ibuf->y, newy);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 8;
+  BLI_task_parallel_range(0, ibuf->y, &data, lanczos_horizontal_row, &settings);
+  BLI_task_parallel_range(0, newy, &data, lanczos_vertical_row, &settings);
+
+  lanczos_axis_free(&data.axis_x);
+  lanczos_axis_free(&data.axis_y);
+  MEM_SAFE_FREE(data.tmp_byte);
+  MEM_SAFE_FREE(data.tmp_float);
+
+  if (data.newrect) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)data.newrect;
+  }
+  if (data.newrectf) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = data.newrectf;
+  }
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+  return true;
+}
+
+/** \} */
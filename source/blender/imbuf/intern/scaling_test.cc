@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * Tests of image buffer scaling, and benchmarks of 4K to 1080p downscales of all scaling
+ * methods and of #IMB_transform.
+ *
+ * Benchmarks are disabled by default, run with:
+ * `blender_test --gtest_also_run_disabled_tests --gtest_filter=imbuf_scaling.DISABLED_*`
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.hh"
+#include "BLI_threads.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+namespace blender::imbuf::tests {
+
+using ScaleFn = bool (*)(ImBuf *ibuf, unsigned int newx, unsigned int newy);
+
+static bool scale_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  IMB_scaleImBuf_threaded(ibuf, newx, newy);
+  return true;
+}
+
+static ImBuf *create_constant_buffer(const int x, const int y, const uchar color[4])
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, IB_rect | IB_rectfloat);
+  const float color_float[4] = {color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f, 1.0f};
+  for (size_t i = 0; i < size_t(x) * y; i++) {
+    memcpy((uchar *)ibuf->rect + i * 4, color, sizeof(uchar[4]));
+    copy_v4_v4(ibuf->rect_float + i * 4, color_float);
+  }
+  return ibuf;
+}
+
+static void test_constant(ScaleFn scale, const int newx, const int newy)
+{
+  const uchar color[4] = {10, 128, 250, 255};
+  ImBuf *ibuf = create_constant_buffer(37, 23, color);
+  EXPECT_TRUE(scale(ibuf, newx, newy));
+  EXPECT_EQ(ibuf->x, newx);
+  EXPECT_EQ(ibuf->y, newy);
+
+  for (size_t i = 0; i < size_t(newx) * newy; i++) {
+    const uchar *pixel = (const uchar *)ibuf->rect + i * 4;
+    const float *pixel_float = ibuf->rect_float + i * 4;
+    for (int c = 0; c < 4; c++) {
+      EXPECT_NEAR(pixel[c], color[c], 1);
+      EXPECT_NEAR(pixel_float[c], (c == 3) ? 1.0f : color[c] / 255.0f, 1e-4f);
+    }
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, constant_down)
+{
+  test_constant(IMB_scaleImBuf, 11, 7);
+  test_constant(IMB_scalefastImBuf, 11, 7);
+  test_constant(scale_threaded, 11, 7);
+  test_constant(IMB_scaleImBuf_lanczos, 11, 7);
+}
+
+TEST(imbuf_scaling, constant_up)
+{
+  /* Not the threaded bilinear scaling, it fades to black at the borders when scaling up. */
+  test_constant(IMB_scaleImBuf, 80, 50);
+  test_constant(IMB_scalefastImBuf, 80, 50);
+  test_constant(IMB_scaleImBuf_lanczos, 80, 50);
+}
+
+TEST(imbuf_scaling, box_average)
+{
+  ImBuf *ibuf = IMB_allocImBuf(4, 2, 32, IB_rectfloat);
+  const float values[4] = {0.0f, 1.0f, 0.25f, 0.75f};
+  for (int y = 0; y < 2; y++) {
+    for (int x = 0; x < 4; x++) {
+      copy_v4_fl(ibuf->rect_float + (y * 4 + x) * 4, values[x]);
+    }
+  }
+
+  IMB_scaleImBuf(ibuf, 2, 1);
+  for (int c = 0; c < 4; c++) {
+    EXPECT_NEAR(ibuf->rect_float[c], 0.5f, 0.01f);
+    EXPECT_NEAR(ibuf->rect_float[4 + c], 0.5f, 0.01f);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, lanczos_premultiplied_byte)
+{
+  /* Color of transparent pixels must not bleed into opaque ones. */
+  ImBuf *ibuf = IMB_allocImBuf(16, 16, 32, IB_rect);
+  for (int i = 0; i < 16 * 16; i++) {
+    uchar *pixel = (uchar *)ibuf->rect + i * 4;
+    const bool opaque = (i % 16) < 8;
+    pixel[0] = opaque ? 255 : 0;
+    pixel[1] = opaque ? 0 : 255;
+    pixel[2] = 0;
+    pixel[3] = opaque ? 255 : 0;
+  }
+
+  IMB_scaleImBuf_lanczos(ibuf, 8, 8);
+  for (int i = 0; i < 8 * 8; i++) {
+    const uchar *pixel = (const uchar *)ibuf->rect + i * 4;
+    if (pixel[3] > 0) {
+      EXPECT_EQ(pixel[1], 0);
+    }
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Benchmarks
+ * \{ */
+
+static ImBuf *create_random_buffer(const int x, const int y, const int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, flags);
+  RandomNumberGenerator rng(0);
+  for (size_t i = 0; i < size_t(x) * y * 4; i++) {
+    if (ibuf->rect) {
+      ((uchar *)ibuf->rect)[i] = uchar(rng.get_int32(256));
+    }
+    if (ibuf->rect_float) {
+      ibuf->rect_float[i] = rng.get_float();
+    }
+  }
+  return ibuf;
+}
+
+static void benchmark_scale(const char *name, ScaleFn scale, const int flags)
+{
+  ImBuf *src = create_random_buffer(3840, 2160, flags);
+  const int runs = 5;
+  double total_time = 0.0;
+
+  for (int i = 0; i < runs; i++) {
+    ImBuf *ibuf = IMB_dupImBuf(src);
+    const double start_time = PIL_check_seconds_timer();
+    scale(ibuf, 1920, 1080);
+    total_time += PIL_check_seconds_timer() - start_time;
+    IMB_freeImBuf(ibuf);
+  }
+
+  printf("%-24s %-6s 3840x2160 -> 1920x1080: %8.2f ms\n",
+         name,
+         (flags & IB_rectfloat) ? "float" : "byte",
+         total_time / runs * 1000.0);
+  IMB_freeImBuf(src);
+}
+
+static void benchmark_transform(const eIMBInterpolationFilterMode filter, const int flags)
+{
+  ImBuf *src = create_random_buffer(3840, 2160, flags);
+  ImBuf *dst = IMB_allocImBuf(1920, 1080, 32, flags);
+  float transform_matrix[4][4];
+  unit_m4(transform_matrix);
+  scale_m4_fl(transform_matrix, 2.0f);
+
+  const int runs = 5;
+  const double start_time = PIL_check_seconds_timer();
+  for (int i = 0; i < runs; i++) {
+    IMB_transform(src, dst, IMB_TRANSFORM_MODE_REGULAR, filter, transform_matrix, nullptr);
+  }
+  const double total_time = PIL_check_seconds_timer() - start_time;
+
+  printf("%-24s %-6s 3840x2160 -> 1920x1080: %8.2f ms\n",
+         (filter == IMB_FILTER_NEAREST) ? "IMB_transform nearest" : "IMB_transform bilinear",
+         (flags & IB_rectfloat) ? "float" : "byte",
+         total_time / runs * 1000.0);
+  IMB_freeImBuf(src);
+  IMB_freeImBuf(dst);
+}
+
+TEST(imbuf_scaling, DISABLED_benchmark_4k_to_1080p)
+{
+  BLI_threadapi_init();
+
+  for (const int flags : {IB_rect, IB_rectfloat}) {
+    benchmark_scale("IMB_scaleImBuf", IMB_scaleImBuf, flags);
+    benchmark_scale("IMB_scalefastImBuf", IMB_scalefastImBuf, flags);
+    benchmark_scale("IMB_scaleImBuf_threaded", scale_threaded, flags);
+    benchmark_scale("IMB_scaleImBuf_lanczos", IMB_scaleImBuf_lanczos, flags);
+    benchmark_transform(IMB_FILTER_NEAREST, flags);
+    benchmark_transform(IMB_FILTER_BILINEAR, flags);
+  }
+
+  BLI_threadapi_exit();
+}
+
+/** \} */
+
+}  // namespace blender::imbuf::tests
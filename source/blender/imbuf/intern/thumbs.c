@@ -16,6 +16,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_system.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include BLI_SYSTEM_PID_H
@@ -301,6 +302,20 @@ void IMB_thumb_makedirs(void)
   }
 }
 
+static void thumb_write(ImBuf *img, const char *temp, const char *tpath)
+{
+  if (IMB_saveiff(img, temp, IB_rect | IB_metadata)) {
+#ifndef WIN32
+    chmod(temp, S_IRUSR | S_IWUSR);
+#endif
+    // printf("%s saving thumb: '%s'\n", __func__, tpath);
+
+    BLI_rename(temp, tpath);
+  }
+}
+
+static bool thumb_write_async(ImBuf *img, const char *temp, const char *tpath);
+
 /* create thumbnail for file and returns new imbuf for thumbnail */
 static ImBuf *thumb_create_ex(const char *file_path,
                               const char *uri,
@@ -426,13 +441,8 @@ static ImBuf *thumb_create_ex(const char *file_path,
     IMB_rect_from_float(img);
     imb_freerectfloatImBuf(img);
 
-    if (IMB_saveiff(img, temp, IB_rect | IB_metadata)) {
-#ifndef WIN32
-      chmod(temp, S_IRUSR | S_IWUSR);
-#endif
-      // printf("%s saving thumb: '%s'\n", __func__, tpath);
-
-      BLI_rename(temp, tpath);
+    if (!thumb_write_async(img, temp, tpath)) {
+      thumb_write(img, temp, tpath);
     }
   }
   return img;
@@ -634,8 +644,54 @@ static struct IMBThumbLocks {
   GSet *locked_paths;
   int lock_counter;
   ThreadCondition cond;
+  /** Writes thumbnails to the cache, so generating the next one doesn't wait for it. */
+  TaskPool *write_pool;
 } thumb_locks = {0};
 
+typedef struct ThumbWriteTaskData {
+  ImBuf *img;
+  char temp[FILE_MAX];
+  char tpath[FILE_MAX];
+} ThumbWriteTaskData;
+
+static void thumb_write_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  ThumbWriteTaskData *data = taskdata;
+  thumb_write(data->img, data->temp, data->tpath);
+}
+
+static void thumb_write_task_free(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  ThumbWriteTaskData *data = taskdata;
+  IMB_freeImBuf(data->img);
+  MEM_freeN(data);
+}
+
+/**
+ * Write the thumbnail in the background when thumbnails are managed from multiple threads.
+ * \return false when it must be written by the caller.
+ */
+static bool thumb_write_async(ImBuf *img, const char *temp, const char *tpath)
+{
+  bool queued = false;
+
+  BLI_thread_lock(LOCK_IMAGE);
+  if (thumb_locks.write_pool) {
+    /* Copy, the caller owns the thumbnail and may change or free it. */
+    ThumbWriteTaskData *data = MEM_mallocN(sizeof(*data), __func__);
+    data->img = IMB_dupImBuf(img);
+    IMB_metadata_copy(data->img, img);
+    STRNCPY(data->temp, temp);
+    STRNCPY(data->tpath, tpath);
+    BLI_task_pool_push(
+        thumb_locks.write_pool, thumb_write_task, data, true, thumb_write_task_free);
+    queued = true;
+  }
+  BLI_thread_unlock(LOCK_IMAGE);
+
+  return queued;
+}
+
 void IMB_thumb_locks_acquire(void)
 {
   BLI_thread_lock(LOCK_IMAGE);
@@ -644,6 +700,8 @@ void IMB_thumb_locks_acquire(void)
     BLI_assert(thumb_locks.locked_paths == NULL);
     thumb_locks.locked_paths = BLI_gset_str_new(__func__);
     BLI_condition_init(&thumb_locks.cond);
+    thumb_locks.write_pool = BLI_task_pool_create_background(NULL, TASK_PRIORITY_LOW);
+    IMB_thumb_load_blend_cache_begin();
   }
   thumb_locks.lock_counter++;
 
@@ -654,6 +712,8 @@ void IMB_thumb_locks_acquire(void)
 
 void IMB_thumb_locks_release(void)
 {
+  TaskPool *write_pool = NULL;
+
   BLI_thread_lock(LOCK_IMAGE);
   BLI_assert((thumb_locks.locked_paths != NULL) && (thumb_locks.lock_counter > 0));
 
@@ -662,9 +722,18 @@ void IMB_thumb_locks_release(void)
     BLI_gset_free(thumb_locks.locked_paths, MEM_freeN);
     thumb_locks.locked_paths = NULL;
     BLI_condition_end(&thumb_locks.cond);
+    write_pool = thumb_locks.write_pool;
+    thumb_locks.write_pool = NULL;
+    IMB_thumb_load_blend_cache_end();
   }
 
   BLI_thread_unlock(LOCK_IMAGE);
+
+  /* Wait outside of the lock, new thumbnails are written directly from now on. */
+  if (write_pool) {
+    BLI_task_pool_work_and_wait(write_pool);
+    BLI_task_pool_free(write_pool);
+  }
 }
 
 void IMB_thumb_path_lock(const char *path)
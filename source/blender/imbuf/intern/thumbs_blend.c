@@ -8,8 +8,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "BLI_fileops.h"
 #include "BLI_linklist.h"
 #include "BLI_listbase.h" /* Needed due to import of BLO_readfile.h */
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLO_blend_defs.h"
@@ -27,24 +31,165 @@
 
 #include "MEM_guardedalloc.h"
 
-/* NOTE: we should handle all previews for a same group at once, would avoid reopening
- * `.blend` file for each and every ID. However, this adds some complexity,
- * so keep it for later. */
+/* -------------------------------------------------------------------- */
+/** \name Blend Handle Cache
+ *
+ * Opening a `.blend` file reads all its block headers, which is much slower than reading the
+ * preview of an ID from it. While the cache is active, opened files are kept so previews of all
+ * IDs of a file are read with a single open. Handles can't be read from multiple threads at
+ * once, threads reading previews of the same file take turns.
+ * \{ */
+
+/** Number of unused handles kept open, most recently used ones are kept. */
+#define BLEND_HANDLE_CACHE_SIZE 4
+
+typedef struct BlendHandleCacheEntry {
+  struct BlendHandleCacheEntry *next, *prev;
+  char filepath[FILE_MAX];
+  /** Modification time of the file when opened, to not use a handle of an older version. */
+  int64_t mtime;
+  /** Null until opened, or when the file failed to open. */
+  struct BlendHandle *handle;
+  /** Locked while the handle is opened or read. */
+  ThreadMutex mutex;
+  /** Number of threads using or waiting for the handle, protected by the cache mutex. */
+  int users;
+} BlendHandleCacheEntry;
+
+static struct {
+  /** Most recently used entries first. */
+  ListBase entries;
+  int users;
+} blend_handle_cache = {{NULL, NULL}, 0};
+
+static ThreadMutex blend_handle_cache_mutex = BLI_MUTEX_INITIALIZER;
+
+static void blend_handle_cache_entry_free(BlendHandleCacheEntry *entry)
+{
+  BLI_assert(entry->users == 0);
+  if (entry->handle) {
+    BLO_blendhandle_close(entry->handle);
+  }
+  BLI_mutex_end(&entry->mutex);
+  MEM_freeN(entry);
+}
+
+void IMB_thumb_load_blend_cache_begin(void)
+{
+  BLI_mutex_lock(&blend_handle_cache_mutex);
+  blend_handle_cache.users++;
+  BLI_mutex_unlock(&blend_handle_cache_mutex);
+}
+
+void IMB_thumb_load_blend_cache_end(void)
+{
+  BLI_mutex_lock(&blend_handle_cache_mutex);
+  BLI_assert(blend_handle_cache.users > 0);
+  blend_handle_cache.users--;
+  if (blend_handle_cache.users == 0) {
+    LISTBASE_FOREACH_MUTABLE (BlendHandleCacheEntry *, entry, &blend_handle_cache.entries) {
+      blend_handle_cache_entry_free(entry);
+    }
+    BLI_listbase_clear(&blend_handle_cache.entries);
+  }
+  BLI_mutex_unlock(&blend_handle_cache_mutex);
+}
+
+/**
+ * \return the locked cache entry of the file, or null when the cache isn't active.
+ * Release with #blend_handle_cache_release.
+ */
+static BlendHandleCacheEntry *blend_handle_cache_acquire(const char *blen_path)
+{
+  BLI_stat_t st;
+  if (BLI_stat(blen_path, &st) == -1) {
+    return NULL;
+  }
+
+  BLI_mutex_lock(&blend_handle_cache_mutex);
+  if (blend_handle_cache.users == 0) {
+    BLI_mutex_unlock(&blend_handle_cache_mutex);
+    return NULL;
+  }
+
+  BlendHandleCacheEntry *entry = NULL;
+  LISTBASE_FOREACH (BlendHandleCacheEntry *, iter, &blend_handle_cache.entries) {
+    if (iter->mtime == (int64_t)st.st_mtime && BLI_path_cmp(iter->filepath, blen_path) == 0) {
+      entry = iter;
+      break;
+    }
+  }
+
+  if (entry) {
+    BLI_remlink(&blend_handle_cache.entries, entry);
+  }
+  else {
+    entry = MEM_callocN(sizeof(*entry), __func__);
+    STRNCPY(entry->filepath, blen_path);
+    entry->mtime = (int64_t)st.st_mtime;
+    BLI_mutex_init(&entry->mutex);
+  }
+  BLI_addhead(&blend_handle_cache.entries, entry);
+  entry->users++;
+
+  /* Close least recently used handles, including the ones of files modified since. */
+  int index = 0;
+  LISTBASE_FOREACH_MUTABLE (BlendHandleCacheEntry *, iter, &blend_handle_cache.entries) {
+    if (index++ >= BLEND_HANDLE_CACHE_SIZE && iter->users == 0) {
+      BLI_remlink(&blend_handle_cache.entries, iter);
+      blend_handle_cache_entry_free(iter);
+    }
+  }
+  BLI_mutex_unlock(&blend_handle_cache_mutex);
+
+  /* Open outside of the cache lock, other threads only wait for it when reading the same file. */
+  BLI_mutex_lock(&entry->mutex);
+  if (entry->handle == NULL) {
+    BlendFileReadReport bf_reports = {.reports = NULL};
+    entry->handle = BLO_blendhandle_from_file(blen_path, &bf_reports);
+  }
+  return entry;
+}
+
+static void blend_handle_cache_release(BlendHandleCacheEntry *entry)
+{
+  BLI_mutex_unlock(&entry->mutex);
+
+  BLI_mutex_lock(&blend_handle_cache_mutex);
+  entry->users--;
+  BLI_mutex_unlock(&blend_handle_cache_mutex);
+}
+
+/** \} */
+
 static ImBuf *imb_thumb_load_from_blend_id(const char *blen_path,
                                            const char *blen_group,
                                            const char *blen_id)
 {
   ImBuf *ima = NULL;
-  BlendFileReadReport bf_reports = {.reports = NULL};
+  BlendHandleCacheEntry *cache_entry = blend_handle_cache_acquire(blen_path);
+  struct BlendHandle *libfiledata;
 
-  struct BlendHandle *libfiledata = BLO_blendhandle_from_file(blen_path, &bf_reports);
-  if (libfiledata == NULL) {
-    return NULL;
+  if (cache_entry) {
+    libfiledata = cache_entry->handle;
+  }
+  else {
+    BlendFileReadReport bf_reports = {.reports = NULL};
+    libfiledata = BLO_blendhandle_from_file(blen_path, &bf_reports);
+  }
+
+  PreviewImage *preview = NULL;
+  if (libfiledata) {
+    int idcode = BKE_idtype_idcode_from_name(blen_group);
+    preview = BLO_blendhandle_get_preview_for_id(libfiledata, idcode, blen_id);
   }
 
-  int idcode = BKE_idtype_idcode_from_name(blen_group);
-  PreviewImage *preview = BLO_blendhandle_get_preview_for_id(libfiledata, idcode, blen_id);
-  BLO_blendhandle_close(libfiledata);
+  if (cache_entry) {
+    blend_handle_cache_release(cache_entry);
+  }
+  else if (libfiledata) {
+    BLO_blendhandle_close(libfiledata);
+  }
 
   if (preview) {
     ima = BKE_previewimg_to_imbuf(preview, ICON_SIZE_PREVIEW);
@@ -127,6 +127,9 @@ typedef struct Image_Runtime {
   /** \brief Partial update user for GPUTextures stored inside the Image. */
   struct PartialUpdateUser *partial_update_user;
 
+  /** Converted tiles for sampling the image on the CPU, see `BKE_image_sampler.h`. */
+  struct ImageSampleCache *sample_cache;
+
 } Image_Runtime;
 
 typedef struct Image {
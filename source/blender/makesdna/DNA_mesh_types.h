@@ -128,14 +128,24 @@ typedef struct Mesh_Runtime {
    * the modifier in the object.
    */
   struct SubsurfRuntimeData *subsurf_runtime_data;
-  void *_pad1;
+
+  /**
+   * Lazily computed vertex/edge/face adjacency maps, shared by all users of the mesh and only
+   * cleared when the topology changes. See #BKE_mesh_runtime_vert_poly_map_ensure.
+   */
+  struct MeshTopologyMaps *topology_maps;
 
   /**
    * Caches for lazily computed vertex and polygon normals. These are stored here rather than in
    * #CustomData because they can be calculated on a const mesh, and adding custom data layers on a
    * const mesh is not thread-safe.
    */
-  char _pad2[6];
+  char _pad2[5];
+  /**
+   * Set when vertex positions changed after #looptris was calculated. Triangles stay valid, but
+   * quads and n-gons are tessellated again by #BKE_mesh_runtime_looptri_ensure.
+   */
+  char looptris_positions_dirty;
   char vert_normals_dirty;
   char poly_normals_dirty;
   float (*vert_normals)[3];
@@ -556,6 +556,7 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_HALF_STORAGE (1 << 6) /* store buffers awaiting readers in half float */
 
 /* tree->execution_mode */
 typedef enum eNodeTreeExecutionMode {
@@ -12621,6 +12621,13 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_GROUPNODE_BUFFER);
   RNA_def_property_ui_text(prop, "Buffer Groups", "Enable buffering of group nodes");
 
+  prop = RNA_def_property(srna, "use_half_float_buffers", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_HALF_STORAGE);
+  RNA_def_property_ui_text(prop,
+                           "Half Float Buffers",
+                           "Store color buffers in half float while waiting for the nodes reading "
+                           "them, to use less memory at the cost of precision (Full Frame only)");
+
   prop = RNA_def_property(srna, "use_two_pass", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_TWO_PASS);
   RNA_def_property_ui_text(prop,
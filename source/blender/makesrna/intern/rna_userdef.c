@@ -180,6 +180,8 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "GPU_select.h"
 #  include "GPU_texture.h"
 
+#  include "IMB_colormanagement.h"
+
 #  include "BLF_api.h"
 
 #  include "BLI_path_util.h"
@@ -581,6 +583,14 @@ static void rna_UserDef_audio_update(Main *bmain, Scene *UNUSED(scene), PointerR
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_display_lut_update(Main *UNUSED(bmain),
+                                           Scene *UNUSED(scene),
+                                           PointerRNA *UNUSED(ptr))
+{
+  IMB_colormanagement_display_lut_set_enabled((U.gpu_flag & USER_GPU_FLAG_NO_DISPLAY_LUT) == 0);
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
                                         Scene *UNUSED(scene),
                                         PointerRNA *UNUSED(ptr))
@@ -5660,6 +5670,17 @@ static void rna_def_userdef_system(BlenderRNA *brna)
                            "When making a selection in 3D View, use the GPU depth buffer to "
                            "ensure the frontmost object is selected first");
 
+  /* Display transform. */
+
+  prop = RNA_def_property(srna, "use_display_transform_lut", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_negative_sdna(prop, NULL, "gpu_flag", USER_GPU_FLAG_NO_DISPLAY_LUT);
+  RNA_def_property_ui_text(prop,
+                           "Fast Display Transform",
+                           "Display large images through a lookup table approximating the view "
+                           "transform, faster but slightly less accurate. Saved images always use "
+                           "the exact view transform");
+  RNA_def_property_update(prop, 0, "rna_Userdef_display_lut_update");
+
   /* GPU subdivision evaluation. */
 
   prop = RNA_def_property(srna, "use_gpu_subdivision", PROP_BOOLEAN, PROP_NONE);
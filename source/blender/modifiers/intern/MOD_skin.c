@@ -61,6 +61,7 @@
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_modifier.h"
 #include "BKE_screen.h"
 
@@ -1905,8 +1906,8 @@ static Mesh *base_skin(Mesh *origmesh, SkinModifierData *smd, eSkinErrorFlag *r_
   BMesh *bm;
   EMat *emat;
   SkinNode *skin_nodes;
-  MeshElemMap *emap;
-  int *emapmem;
+  const MeshTopologyMap *vert_edge_map;
+  const MeshElemMap *emap;
   MVert *mvert;
   MEdge *medge;
   MDeformVert *dvert;
@@ -1921,7 +1922,8 @@ static Mesh *base_skin(Mesh *origmesh, SkinModifierData *smd, eSkinErrorFlag *r_
   verts_num = origmesh->totvert;
   edges_num = origmesh->totedge;
 
-  BKE_mesh_vert_edge_map_create(&emap, &emapmem, medge, verts_num, edges_num);
+  vert_edge_map = BKE_mesh_runtime_vert_edge_map_acquire(origmesh);
+  emap = vert_edge_map->elem_map;
 
   emat = build_edge_mats(nodes, mvert, verts_num, medge, emap, edges_num, &has_valid_root);
   skin_nodes = build_frames(mvert, verts_num, nodes, emap, emat);
@@ -1931,8 +1933,7 @@ static Mesh *base_skin(Mesh *origmesh, SkinModifierData *smd, eSkinErrorFlag *r_
   bm = build_skin(skin_nodes, verts_num, emap, medge, edges_num, dvert, smd, r_error);
 
   MEM_freeN(skin_nodes);
-  MEM_freeN(emap);
-  MEM_freeN(emapmem);
+  BKE_mesh_topology_map_release(vert_edge_map);
 
   if (!has_valid_root) {
     *r_error |= SKIN_ERROR_NO_VALID_ROOT;
@@ -166,6 +166,12 @@ void ntreeCompositUpdateRLayers(struct bNodeTree *ntree);
 
 void ntreeCompositClearTags(struct bNodeTree *ntree);
 
+/**
+ * Free results the compositor keeps across executions, called when the data they were computed
+ * from is freed.
+ */
+void ntreeCompositClearCaches(void);
+
 struct bNodeSocket *ntreeCompositOutputFileAddSocket(struct bNodeTree *ntree,
                                                      struct bNode *node,
                                                      const char *name,
@@ -269,3 +269,10 @@ void ntreeCompositClearTags(bNodeTree *ntree)
     }
   }
 }
+
+void ntreeCompositClearCaches()
+{
+#ifdef WITH_COMPOSITOR
+  COM_clear_caches();
+#endif
+}
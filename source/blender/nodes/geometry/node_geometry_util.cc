@@ -39,6 +39,14 @@ std::optional<eCustomDataType> node_socket_to_custom_data_type(const bNodeSocket
   return node_data_type_to_custom_data_type(static_cast<eNodeSocketDatatype>(socket.type));
 }
 
+VArray<int> topology_map_counts(const MeshTopologyMap *map)
+{
+  std::shared_ptr<const MeshTopologyMap> map_ref(map, BKE_mesh_topology_map_release);
+  return VArray<int>::ForFunc(map->groups_num, [map_ref](const int64_t i) {
+    return map_ref->offsets[i + 1] - map_ref->offsets[i];
+  });
+}
+
 }  // namespace blender::nodes
 
 bool geo_node_poll_default(bNodeType *UNUSED(ntype),
@@ -22,6 +22,8 @@
 
 #include "node_util.h"
 
+struct MeshTopologyMap;
+
 void geo_node_type_base(struct bNodeType *ntype, int type, const char *name, short nclass);
 bool geo_node_poll_default(struct bNodeType *ntype,
                            struct bNodeTree *ntree,
@@ -78,4 +80,10 @@ void separate_geometry(GeometrySet &geometry_set,
 std::optional<eCustomDataType> node_data_type_to_custom_data_type(eNodeSocketDatatype type);
 std::optional<eCustomDataType> node_socket_to_custom_data_type(const bNodeSocket &socket);
 
+/**
+ * Number of indices of each element of an adjacency map, read from the map on demand. Takes over
+ * the reference of the caller, which is released when the virtual array is freed.
+ */
+VArray<int> topology_map_counts(const MeshTopologyMap *map);
+
 }  // namespace blender::nodes
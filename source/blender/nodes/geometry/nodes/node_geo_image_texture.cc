@@ -4,14 +4,11 @@
 #include "node_geometry_util.hh"
 
 #include "BKE_image.h"
+#include "BKE_image_sampler.h"
 
 #include "BLI_math_vec_types.hh"
-#include "BLI_threads.h"
-#include "BLI_timeit.hh"
 
 #include "IMB_colormanagement.h"
-#include "IMB_imbuf.h"
-#include "IMB_imbuf_types.h"
 
 #include "UI_interface.h"
 #include "UI_resources.h"
@@ -45,48 +42,28 @@ static void node_init(bNodeTree *UNUSED(ntree), bNode *node)
 
 class ImageFieldsFunction : public fn::MultiFunction {
  private:
-  const int interpolation_;
-  const int extension_;
   Image &image_;
-  ImageUser image_user_;
-  void *image_lock_;
-  ImBuf *image_buffer_;
+  ImageSampler *sampler_;
 
  public:
   ImageFieldsFunction(const int interpolation,
                       const int extension,
                       Image &image,
                       ImageUser image_user)
-      : interpolation_(interpolation),
-        extension_(extension),
-        image_(image),
-        image_user_(image_user)
+      : image_(image)
   {
     static fn::MFSignature signature = create_signature();
     this->set_signature(&signature);
 
-    image_buffer_ = BKE_image_acquire_ibuf(&image_, &image_user_, &image_lock_);
-    if (image_buffer_ == nullptr) {
-      throw std::runtime_error("cannot acquire image buffer");
-    }
-
-    if (image_buffer_->rect_float == nullptr) {
-      BLI_thread_lock(LOCK_IMAGE);
-      if (!image_buffer_->rect_float) {
-        IMB_float_from_rect(image_buffer_);
-      }
-      BLI_thread_unlock(LOCK_IMAGE);
-    }
-
-    if (image_buffer_->rect_float == nullptr) {
-      BKE_image_release_ibuf(&image_, image_buffer_, image_lock_);
-      throw std::runtime_error("cannot get float buffer");
-    }
+    /* Pixels are read through the image sample cache on demand, so only the UDIM tiles which are
+     * sampled get loaded, and byte images don't need a float copy of the whole buffer. */
+    sampler_ = BKE_image_sampler_new(
+        &image_, &image_user, sampler_interpolation(interpolation), sampler_extension(extension));
   }
 
   ~ImageFieldsFunction() override
   {
-    BKE_image_release_ibuf(&image_, image_buffer_, image_lock_);
+    BKE_image_sampler_free(sampler_);
   }
 
   static fn::MFSignature create_signature()
@@ -98,190 +75,30 @@ class ImageFieldsFunction : public fn::MultiFunction {
     return signature.build();
   }
 
-  static int wrap_periodic(int x, const int width)
-  {
-    x %= width;
-    if (x < 0) {
-      x += width;
-    }
-    return x;
-  }
-
-  static int wrap_clamp(const int x, const int width)
-  {
-    return std::clamp(x, 0, width - 1);
-  }
-
-  static float4 image_pixel_lookup(const ImBuf *ibuf, const int px, const int py)
-  {
-    if (px < 0 || py < 0 || px >= ibuf->x || py >= ibuf->y) {
-      return float4(0.0f, 0.0f, 0.0f, 0.0f);
-    }
-    return ((const float4 *)ibuf->rect_float)[px + py * ibuf->x];
-  }
-
-  static float frac(const float x, int *ix)
+  static eImageSamplerInterpolation sampler_interpolation(const int interpolation)
   {
-    const int i = (int)x - ((x < 0.0f) ? 1 : 0);
-    *ix = i;
-    return x - (float)i;
-  }
-
-  static float4 image_cubic_texture_lookup(const ImBuf *ibuf,
-                                           const float px,
-                                           const float py,
-                                           const int extension)
-  {
-    const int width = ibuf->x;
-    const int height = ibuf->y;
-    int pix, piy, nix, niy;
-    const float tx = frac(px * (float)width - 0.5f, &pix);
-    const float ty = frac(py * (float)height - 0.5f, &piy);
-    int ppix, ppiy, nnix, nniy;
-
-    switch (extension) {
-      case SHD_IMAGE_EXTENSION_REPEAT: {
-        pix = wrap_periodic(pix, width);
-        piy = wrap_periodic(piy, height);
-        ppix = wrap_periodic(pix - 1, width);
-        ppiy = wrap_periodic(piy - 1, height);
-        nix = wrap_periodic(pix + 1, width);
-        niy = wrap_periodic(piy + 1, height);
-        nnix = wrap_periodic(pix + 2, width);
-        nniy = wrap_periodic(piy + 2, height);
-        break;
-      }
-      case SHD_IMAGE_EXTENSION_CLIP: {
-        ppix = pix - 1;
-        ppiy = piy - 1;
-        nix = pix + 1;
-        niy = piy + 1;
-        nnix = pix + 2;
-        nniy = piy + 2;
-        break;
-      }
-      case SHD_IMAGE_EXTENSION_EXTEND: {
-        ppix = wrap_clamp(pix - 1, width);
-        ppiy = wrap_clamp(piy - 1, height);
-        nix = wrap_clamp(pix + 1, width);
-        niy = wrap_clamp(piy + 1, height);
-        nnix = wrap_clamp(pix + 2, width);
-        nniy = wrap_clamp(piy + 2, height);
-        pix = wrap_clamp(pix, width);
-        piy = wrap_clamp(piy, height);
-        break;
-      }
+    switch (interpolation) {
+      case SHD_INTERP_CLOSEST:
+        return IMAGE_SAMPLER_INTERPOLATION_CLOSEST;
+      case SHD_INTERP_CUBIC:
+      case SHD_INTERP_SMART:
+        return IMAGE_SAMPLER_INTERPOLATION_CUBIC;
+      case SHD_INTERP_LINEAR:
       default:
-        return float4(0.0f, 0.0f, 0.0f, 0.0f);
+        return IMAGE_SAMPLER_INTERPOLATION_LINEAR;
     }
-
-    const int xc[4] = {ppix, pix, nix, nnix};
-    const int yc[4] = {ppiy, piy, niy, nniy};
-    float u[4], v[4];
-
-    u[0] = (((-1.0f / 6.0f) * tx + 0.5f) * tx - 0.5f) * tx + (1.0f / 6.0f);
-    u[1] = ((0.5f * tx - 1.0f) * tx) * tx + (2.0f / 3.0f);
-    u[2] = ((-0.5f * tx + 0.5f) * tx + 0.5f) * tx + (1.0f / 6.0f);
-    u[3] = (1.0f / 6.0f) * tx * tx * tx;
-
-    v[0] = (((-1.0f / 6.0f) * ty + 0.5f) * ty - 0.5f) * ty + (1.0f / 6.0f);
-    v[1] = ((0.5f * ty - 1.0f) * ty) * ty + (2.0f / 3.0f);
-    v[2] = ((-0.5f * ty + 0.5f) * ty + 0.5f) * ty + (1.0f / 6.0f);
-    v[3] = (1.0f / 6.0f) * ty * ty * ty;
-
-    return (v[0] * (u[0] * (image_pixel_lookup(ibuf, xc[0], yc[0])) +
-                    u[1] * (image_pixel_lookup(ibuf, xc[1], yc[0])) +
-                    u[2] * (image_pixel_lookup(ibuf, xc[2], yc[0])) +
-                    u[3] * (image_pixel_lookup(ibuf, xc[3], yc[0])))) +
-           (v[1] * (u[0] * (image_pixel_lookup(ibuf, xc[0], yc[1])) +
-                    u[1] * (image_pixel_lookup(ibuf, xc[1], yc[1])) +
-                    u[2] * (image_pixel_lookup(ibuf, xc[2], yc[1])) +
-                    u[3] * (image_pixel_lookup(ibuf, xc[3], yc[1])))) +
-           (v[2] * (u[0] * (image_pixel_lookup(ibuf, xc[0], yc[2])) +
-                    u[1] * (image_pixel_lookup(ibuf, xc[1], yc[2])) +
-                    u[2] * (image_pixel_lookup(ibuf, xc[2], yc[2])) +
-                    u[3] * (image_pixel_lookup(ibuf, xc[3], yc[2])))) +
-           (v[3] * (u[0] * (image_pixel_lookup(ibuf, xc[0], yc[3])) +
-                    u[1] * (image_pixel_lookup(ibuf, xc[1], yc[3])) +
-                    u[2] * (image_pixel_lookup(ibuf, xc[2], yc[3])) +
-                    u[3] * (image_pixel_lookup(ibuf, xc[3], yc[3]))));
   }
 
-  static float4 image_linear_texture_lookup(const ImBuf *ibuf,
-                                            const float px,
-                                            const float py,
-                                            const int extension)
+  static eImageSamplerExtension sampler_extension(const int extension)
   {
-    const int width = ibuf->x;
-    const int height = ibuf->y;
-    int pix, piy, nix, niy;
-    const float nfx = frac(px * (float)width - 0.5f, &pix);
-    const float nfy = frac(py * (float)height - 0.5f, &piy);
-
     switch (extension) {
-      case SHD_IMAGE_EXTENSION_CLIP: {
-        nix = pix + 1;
-        niy = piy + 1;
-        break;
-      }
-      case SHD_IMAGE_EXTENSION_EXTEND: {
-        nix = wrap_clamp(pix + 1, width);
-        niy = wrap_clamp(piy + 1, height);
-        pix = wrap_clamp(pix, width);
-        piy = wrap_clamp(piy, height);
-        break;
-      }
-      default:
+      case SHD_IMAGE_EXTENSION_EXTEND:
+        return IMAGE_SAMPLER_EXTENSION_EXTEND;
+      case SHD_IMAGE_EXTENSION_CLIP:
+        return IMAGE_SAMPLER_EXTENSION_CLIP;
       case SHD_IMAGE_EXTENSION_REPEAT:
-        pix = wrap_periodic(pix, width);
-        piy = wrap_periodic(piy, height);
-        nix = wrap_periodic(pix + 1, width);
-        niy = wrap_periodic(piy + 1, height);
-        break;
-    }
-
-    const float ptx = 1.0f - nfx;
-    const float pty = 1.0f - nfy;
-
-    return image_pixel_lookup(ibuf, pix, piy) * ptx * pty +
-           image_pixel_lookup(ibuf, nix, piy) * nfx * pty +
-           image_pixel_lookup(ibuf, pix, niy) * ptx * nfy +
-           image_pixel_lookup(ibuf, nix, niy) * nfx * nfy;
-  }
-
-  static float4 image_closest_texture_lookup(const ImBuf *ibuf,
-                                             const float px,
-                                             const float py,
-                                             const int extension)
-  {
-    const int width = ibuf->x;
-    const int height = ibuf->y;
-    int ix, iy;
-    const float tx = frac(px * (float)width, &ix);
-    const float ty = frac(py * (float)height, &iy);
-
-    switch (extension) {
-      case SHD_IMAGE_EXTENSION_REPEAT: {
-        ix = wrap_periodic(ix, width);
-        iy = wrap_periodic(iy, height);
-        return image_pixel_lookup(ibuf, ix, iy);
-      }
-      case SHD_IMAGE_EXTENSION_CLIP: {
-        if (tx < 0.0f || ty < 0.0f || tx > 1.0f || ty > 1.0f) {
-          return float4(0.0f, 0.0f, 0.0f, 0.0f);
-        }
-        if (ix < 0 || iy < 0 || ix > width || iy > height) {
-          return float4(0.0f, 0.0f, 0.0f, 0.0f);
-        }
-        ATTR_FALLTHROUGH;
-      }
-      case SHD_IMAGE_EXTENSION_EXTEND: {
-        ix = wrap_clamp(ix, width);
-        iy = wrap_clamp(iy, height);
-        return image_pixel_lookup(ibuf, ix, iy);
-      }
       default:
-        return float4(0.0f, 0.0f, 0.0f, 0.0f);
+        return IMAGE_SAMPLER_EXTENSION_REPEAT;
     }
   }
 
@@ -295,26 +112,9 @@ class ImageFieldsFunction : public fn::MultiFunction {
     MutableSpan<float4> color_data{(float4 *)r_color.data(), r_color.size()};
 
     /* Sample image texture. */
-    switch (interpolation_) {
-      case SHD_INTERP_LINEAR:
-        for (const int64_t i : mask) {
-          const float3 p = vectors[i];
-          color_data[i] = image_linear_texture_lookup(image_buffer_, p.x, p.y, extension_);
-        }
-        break;
-      case SHD_INTERP_CLOSEST:
-        for (const int64_t i : mask) {
-          const float3 p = vectors[i];
-          color_data[i] = image_closest_texture_lookup(image_buffer_, p.x, p.y, extension_);
-        }
-        break;
-      case SHD_INTERP_CUBIC:
-      case SHD_INTERP_SMART:
-        for (const int64_t i : mask) {
-          const float3 p = vectors[i];
-          color_data[i] = image_cubic_texture_lookup(image_buffer_, p.x, p.y, extension_);
-        }
-        break;
+    for (const int64_t i : mask) {
+      const float3 p = vectors[i];
+      BKE_image_sampler_sample(sampler_, p, color_data[i]);
     }
 
     int alpha_mode = image_.alpha_mode;
@@ -372,16 +172,16 @@ static void node_geo_exec(GeoNodeExecParams params)
   image_user.sfra = 1;
   image_user.framenr = BKE_image_is_animated(image) ? params.get_input<int>("Frame") : 0;
 
-  std::unique_ptr<ImageFieldsFunction> image_fn;
-  try {
-    image_fn = std::make_unique<ImageFieldsFunction>(
-        storage.interpolation, storage.extension, *image, image_user);
-  }
-  catch (const std::runtime_error &) {
+  /* Samples of images that can't be loaded are black, let users know why. */
+  if (!BKE_image_has_ibuf(image, &image_user)) {
+    params.error_message_add(NodeWarningType::Error, TIP_("Image could not be loaded"));
     params.set_default_remaining_outputs();
     return;
   }
 
+  auto image_fn = std::make_unique<ImageFieldsFunction>(
+      storage.interpolation, storage.extension, *image, image_user);
+
   Field<float3> vector_field = params.extract_input<Field<float3>>("Vector");
 
   auto image_op = std::make_shared<FieldOperation>(
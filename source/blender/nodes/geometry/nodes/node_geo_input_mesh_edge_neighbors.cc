@@ -4,6 +4,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 
 #include "node_geometry_util.hh"
 
@@ -35,13 +36,10 @@ class EdgeNeighborCountFieldInput final : public GeometryFieldInput {
         return {};
       }
 
-      Array<int> face_count(mesh->totedge, 0);
-      for (const int i : IndexRange(mesh->totloop)) {
-        face_count[mesh->mloop[i].e]++;
-      }
-
       return mesh_component.attribute_try_adapt_domain<int>(
-          VArray<int>::ForContainer(std::move(face_count)), ATTR_DOMAIN_EDGE, domain);
+          topology_map_counts(BKE_mesh_runtime_edge_poly_map_acquire(mesh)),
+          ATTR_DOMAIN_EDGE,
+          domain);
     }
     return {};
   }
@@ -4,6 +4,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 
 #include "node_geometry_util.hh"
 
@@ -29,12 +30,7 @@ static VArray<int> construct_vertex_count_gvarray(const MeshComponent &component
   }
 
   if (domain == ATTR_DOMAIN_POINT) {
-    Array<int> vertices(mesh->totvert, 0);
-    for (const int i : IndexRange(mesh->totedge)) {
-      vertices[mesh->medge[i].v1]++;
-      vertices[mesh->medge[i].v2]++;
-    }
-    return VArray<int>::ForContainer(std::move(vertices));
+    return topology_map_counts(BKE_mesh_runtime_vert_edge_map_acquire(mesh));
   }
   return {};
 }
@@ -78,12 +74,7 @@ static VArray<int> construct_face_count_gvarray(const MeshComponent &component,
   }
 
   if (domain == ATTR_DOMAIN_POINT) {
-    Array<int> vertices(mesh->totvert, 0);
-    for (const int i : IndexRange(mesh->totloop)) {
-      int vertex = mesh->mloop[i].v;
-      vertices[vertex]++;
-    }
-    return VArray<int>::ForContainer(std::move(vertices));
+    return topology_map_counts(BKE_mesh_runtime_vert_poly_map_acquire(mesh));
   }
   return {};
 }
@@ -141,6 +141,12 @@ typedef struct RenderResult {
   struct StampData *stamp_data;
 
   bool passes_allocated;
+
+  /* OpenEXR file of multilayer images read lazily, passes without pixels are read from it. */
+  void *exrhandle;
+
+  /* Changes whenever pixels of the passes are written, unique among all render results. */
+  uint64_t update_id;
 } RenderResult;
 
 typedef struct RenderStats {
@@ -382,6 +388,21 @@ bool RE_ReadRenderResult(struct Scene *scene, struct Scene *scenode);
 
 struct RenderResult *RE_MultilayerConvert(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+/**
+ * Like #RE_MultilayerConvert, for a handle opened with #IMB_exr_begin_read_lazy. Passes are
+ * created without pixels and the render result takes ownership of the handle, to read them with
+ * #RE_RenderPassEnsureLoaded when needed.
+ */
+struct RenderResult *RE_MultilayerConvertLazy(void *exrhandle, int rectx, int recty);
+/**
+ * Read pixels of a pass of a lazily converted render result, if not read yet, converting them
+ * from `colorspace` to scene linear.
+ * \return false when the pass has no pixels and they can't be read.
+ */
+bool RE_RenderPassEnsureLoaded(struct RenderResult *rr,
+                               struct RenderPass *rpass,
+                               const char *colorspace,
+                               bool predivide);
 
 /* Display and event callbacks. */
 
@@ -253,6 +253,13 @@ RenderResult *RE_MultilayerConvert(
   return render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
 }
 
+RenderResult *RE_MultilayerConvertLazy(void *exrhandle, int rectx, int recty)
+{
+  RenderResult *rr = render_result_new_from_exr(exrhandle, NULL, false, rectx, recty);
+  rr->exrhandle = exrhandle;
+  return rr;
+}
+
 RenderLayer *render_get_active_layer(Render *re, RenderResult *rr)
 {
   ViewLayer *view_layer = BLI_findlink(&re->view_layers, re->active_view_layer);
@@ -2118,7 +2125,9 @@ static void re_movie_free_all(Render *re, bMovieHandle *mh, int totvideos)
   int i;
 
   for (i = 0; i < totvideos; i++) {
-    mh->end_movie(re->movie_ctx_arr[i]);
+    if (!mh->end_movie(re->movie_ctx_arr[i])) {
+      BKE_report(re->reports, RPT_ERROR, "Error writing movie file");
+    }
     mh->context_free(re->movie_ctx_arr[i]);
   }
 
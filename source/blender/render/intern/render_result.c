@@ -38,6 +38,8 @@
 
 #include "RE_engine.h"
 
+#include "atomic_ops.h"
+
 #include "render_result.h"
 #include "render_types.h"
 
@@ -108,6 +110,10 @@ void render_result_free(RenderResult *rr)
 
   BKE_stamp_data_free(rr->stamp_data);
 
+  if (rr->exrhandle) {
+    IMB_exr_close(rr->exrhandle);
+  }
+
   MEM_freeN(rr);
 }
 
@@ -419,6 +425,8 @@ RenderResult *render_result_new(Render *re,
     render_result_passes_allocated_ensure(rr);
   }
 
+  render_result_tag_update(rr);
+
   return rr;
 }
 
@@ -441,6 +449,13 @@ void render_result_passes_allocated_ensure(RenderResult *rr)
   }
 
   rr->passes_allocated = true;
+  render_result_tag_update(rr);
+}
+
+void render_result_tag_update(RenderResult *rr)
+{
+  static uint64_t last_update_id = 0;
+  rr->update_id = atomic_add_and_fetch_uint64(&last_update_id, 1);
 }
 
 void render_result_clone_passes(Render *re, RenderResult *rr, const char *viewname)
@@ -511,6 +526,8 @@ void RE_create_render_pass(RenderResult *rr,
       }
     }
   }
+
+  render_result_tag_update(rr);
 }
 
 void RE_render_result_full_channel_name(char *fullname,
@@ -716,14 +733,29 @@ static int order_render_passes(const void *a, const void *b)
   return (rpa->view_id < rpb->view_id);
 }
 
+static void render_result_pass_to_scene_linear(RenderPass *rpass,
+                                               const char *colorspace,
+                                               bool predivide)
+{
+  if (rpass->channels >= 3) {
+    const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
+        COLOR_ROLE_SCENE_LINEAR);
+    IMB_colormanagement_transform(rpass->rect,
+                                  rpass->rectx,
+                                  rpass->recty,
+                                  rpass->channels,
+                                  colorspace,
+                                  to_colorspace,
+                                  predivide);
+  }
+}
+
 RenderResult *render_result_new_from_exr(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty)
 {
   RenderResult *rr = MEM_callocN(sizeof(RenderResult), __func__);
   RenderLayer *rl;
   RenderPass *rpass;
-  const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
-      COLOR_ROLE_SCENE_LINEAR);
 
   rr->rectx = rectx;
   rr->recty = recty;
@@ -740,21 +772,41 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
-        IMB_colormanagement_transform(rpass->rect,
-                                      rpass->rectx,
-                                      rpass->recty,
-                                      rpass->channels,
-                                      colorspace,
-                                      to_colorspace,
-                                      predivide);
+      /* Passes of lazily read files have no pixels yet, see #RE_RenderPassEnsureLoaded. */
+      if (rpass->rect) {
+        render_result_pass_to_scene_linear(rpass, colorspace, predivide);
       }
     }
   }
 
+  render_result_tag_update(rr);
+
   return rr;
 }
 
+bool RE_RenderPassEnsureLoaded(RenderResult *rr,
+                               RenderPass *rpass,
+                               const char *colorspace,
+                               bool predivide)
+{
+  if (rpass->rect != NULL || rr->exrhandle == NULL) {
+    return rpass->rect != NULL;
+  }
+
+  LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+    if (BLI_findindex(&rl->passes, rpass) == -1) {
+      continue;
+    }
+    rpass->rect = IMB_exr_read_pass(rr->exrhandle, rl->name, rpass->name, rpass->view);
+    if (rpass->rect) {
+      render_result_pass_to_scene_linear(rpass, colorspace, predivide);
+    }
+    break;
+  }
+
+  return rpass->rect != NULL;
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
   RenderView *rv = MEM_callocN(sizeof(RenderView), "new render view");
@@ -837,6 +889,8 @@ void render_result_merge(RenderResult *rr, RenderResult *rrpart)
       }
     }
   }
+
+  render_result_tag_update(rr);
 }
 
 /**************************** Single Layer Rendering *************************/
@@ -894,6 +948,7 @@ void render_result_single_layer_end(Render *re)
 
   RE_FreeRenderResult(re->pushedresult);
   re->pushedresult = NULL;
+  render_result_tag_update(re->result);
 }
 
 int render_result_exr_file_read_path(RenderResult *rr,
@@ -947,6 +1002,7 @@ int render_result_exr_file_read_path(RenderResult *rr,
 
   IMB_exr_read_channels(exrhandle);
   IMB_exr_close(exrhandle);
+  render_result_tag_update(rr);
 
   return 1;
 }
@@ -1272,5 +1328,7 @@ RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
     new_rr->rectz = MEM_dupallocN(new_rr->rectz);
   }
   new_rr->stamp_data = BKE_stamp_data_copy(new_rr->stamp_data);
+  /* The file stays owned by the original, passes not read yet are left without pixels. */
+  new_rr->exrhandle = NULL;
   return new_rr;
 }
@@ -43,6 +43,12 @@ struct RenderResult *render_result_new(struct Render *re,
 
 void render_result_passes_allocated_ensure(struct RenderResult *rr);
 
+/**
+ * Give the render result a new #RenderResult.update_id, called after writing pixels of its
+ * passes.
+ */
+void render_result_tag_update(struct RenderResult *rr);
+
 /**
  * From `imbuf`, if a handle was returned and
  * it's not a single-layer multi-view we convert this to render result.
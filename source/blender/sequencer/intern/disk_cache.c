@@ -59,6 +59,12 @@
  * size specified in user preferences.
  * To distinguish 2 blend files with same name, scene->ed->disk_cache_timestamp
  * is used as UID. Blend file can still be copied manually which may cause conflict.
+ *
+ * Images are compressed and written by a worker thread, so that rendering threads never wait
+ * for the disk. Images waiting to be written can be read back from the queue.
+ * After an image is read, the worker reads images of following frames ahead of the playhead.
+ * Files and their headers are indexed in memory, the cache directory is only scanned once, when
+ * the disk cache is created.
  */
 
 /* Format string:
@@ -66,6 +72,9 @@
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
 #define DCACHE_CURRENT_VERSION 2
+#define DCACHE_READ_AHEAD_FRAMES 8
+/* Writes are skipped while this much image data is waiting to be written. */
+#define DCACHE_WRITE_QUEUE_SIZE_MAX ((size_t)512 * 1024 * 1024)
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in IMB intern. */
 
 typedef struct DiskCacheHeaderEntry {
@@ -81,14 +90,6 @@ typedef struct DiskCacheHeader {
   DiskCacheHeaderEntry entry[DCACHE_IMAGES_PER_FILE];
 } DiskCacheHeader;
 
-typedef struct SeqDiskCache {
-  Main *bmain;
-  int64_t timestamp;
-  ListBase files;
-  ThreadMutex read_write_mutex;
-  size_t size_total;
-} SeqDiskCache;
-
 typedef struct DiskCacheFile {
   struct DiskCacheFile *next, *prev;
   char path[FILE_MAX];
@@ -101,9 +102,47 @@ typedef struct DiskCacheFile {
   int render_size;
   int view_id;
   int start_frame;
+  /* Header of the file, read on first access. */
+  DiskCacheHeader *header;
+  /* Number of threads reading the file outside of `read_write_mutex`. */
+  int num_readers;
+  /* File was deleted while used with the mutex unlocked, the last user frees it when done. */
+  bool is_deleted;
 } DiskCacheFile;
 
-static ThreadMutex cache_create_lock = BLI_MUTEX_INITIALIZER;
+/* Image waiting to be written, or read ahead. */
+typedef struct DiskCacheImage {
+  struct DiskCacheImage *next, *prev;
+  DiskCacheFile *cache_file;
+  float frame_index;
+  ImBuf *ibuf;
+} DiskCacheImage;
+
+typedef struct SeqDiskCache {
+  Main *bmain;
+  int64_t timestamp;
+  ListBase files;
+  GHash *files_by_path;
+  ThreadMutex read_write_mutex;
+  size_t size_total;
+
+  ListBase worker_thread;
+  ThreadCondition worker_cond;
+  bool worker_stop;
+  /* File used by the worker thread while the mutex is unlocked. */
+  DiskCacheFile *worker_file;
+  /* Image being written by the worker thread. */
+  DiskCacheImage *worker_image;
+
+  ListBase write_queue;
+  size_t write_queue_size;
+
+  /* Images following the last read image are read ahead by the worker thread. */
+  ListBase read_ahead_images;
+  int read_ahead_images_len;
+  DiskCacheFile *read_ahead_file;
+  float read_ahead_frame_index;
+} SeqDiskCache;
 
 static char *seq_disk_cache_base_dir(void)
 {
@@ -155,6 +194,7 @@ static DiskCacheFile *seq_disk_cache_add_file_to_list(SeqDiskCache *disk_cache,
          &cache_file->start_frame);
   cache_file->start_frame *= DCACHE_IMAGES_PER_FILE;
   BLI_addtail(&disk_cache->files, cache_file);
+  BLI_ghash_insert(disk_cache->files_by_path, cache_file->path, cache_file);
   return cache_file;
 }
 
@@ -214,70 +254,111 @@ static DiskCacheFile *seq_disk_cache_get_oldest_file(SeqDiskCache *disk_cache)
   return oldest_file;
 }
 
-static void seq_disk_cache_delete_file(SeqDiskCache *disk_cache, DiskCacheFile *file)
+static void seq_disk_cache_image_free(DiskCacheImage *image)
 {
-  disk_cache->size_total -= file->fstat.st_size;
-  BLI_delete(file->path, false, false);
-  BLI_remlink(&disk_cache->files, file);
-  MEM_freeN(file);
+  IMB_freeImBuf(image->ibuf);
+  MEM_freeN(image);
 }
 
-bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
+static DiskCacheImage *seq_disk_cache_find_image(ListBase *images,
+                                                 DiskCacheFile *cache_file,
+                                                 float frame_index)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
-  while (disk_cache->size_total > seq_disk_cache_size_limit()) {
-    DiskCacheFile *oldest_file = seq_disk_cache_get_oldest_file(disk_cache);
-
-    if (!oldest_file) {
-      /* We shouldn't enforce limits with no files, do re-scan. */
-      seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
-      continue;
+  LISTBASE_FOREACH (DiskCacheImage *, image, images) {
+    if (image->cache_file == cache_file && image->frame_index == frame_index) {
+      return image;
     }
+  }
+  return NULL;
+}
 
-    if (BLI_exists(oldest_file->path) == 0) {
-      /* File may have been manually deleted during runtime, do re-scan. */
-      BLI_freelistN(&disk_cache->files);
-      seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
-      continue;
+/* Free queued images of given file, or all images when `cache_file` is NULL. */
+static void seq_disk_cache_discard_images(ListBase *images, DiskCacheFile *cache_file)
+{
+  LISTBASE_FOREACH_MUTABLE (DiskCacheImage *, image, images) {
+    if (cache_file == NULL || image->cache_file == cache_file) {
+      BLI_remlink(images, image);
+      seq_disk_cache_image_free(image);
     }
-
-    seq_disk_cache_delete_file(disk_cache, oldest_file);
   }
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+}
 
-  return true;
+static void seq_disk_cache_file_free(DiskCacheFile *file)
+{
+  BLI_delete(file->path, false, false);
+  MEM_SAFE_FREE(file->header);
+  MEM_freeN(file);
 }
 
-static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
+/* File is used by a thread while `read_write_mutex` is unlocked. */
+static bool seq_disk_cache_file_is_used(const SeqDiskCache *disk_cache, const DiskCacheFile *file)
 {
-  DiskCacheFile *cache_file = disk_cache->files.first;
+  return file == disk_cache->worker_file || file->num_readers > 0;
+}
 
-  for (; cache_file; cache_file = cache_file->next) {
-    if (BLI_strcasecmp(cache_file->path, path) == 0) {
-      return cache_file;
+static void seq_disk_cache_delete_file(SeqDiskCache *disk_cache, DiskCacheFile *file)
+{
+  disk_cache->size_total -= file->fstat.st_size;
+  BLI_ghash_remove(disk_cache->files_by_path, file->path, NULL, NULL);
+  BLI_remlink(&disk_cache->files, file);
+
+  LISTBASE_FOREACH (DiskCacheImage *, image, &disk_cache->write_queue) {
+    if (image->cache_file == file) {
+      disk_cache->write_queue_size -= IMB_get_size_in_memory(image->ibuf);
     }
   }
+  seq_disk_cache_discard_images(&disk_cache->write_queue, file);
+  seq_disk_cache_discard_images(&disk_cache->read_ahead_images, file);
+  disk_cache->read_ahead_images_len = BLI_listbase_count(&disk_cache->read_ahead_images);
+  if (disk_cache->read_ahead_file == file) {
+    disk_cache->read_ahead_file = NULL;
+  }
 
-  return NULL;
+  if (seq_disk_cache_file_is_used(disk_cache, file)) {
+    file->is_deleted = true;
+    return;
+  }
+  seq_disk_cache_file_free(file);
 }
 
-/* Update file size and timestamp. */
-static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, char *path)
+/* Must be called with `read_write_mutex` locked. */
+static void seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 {
-  DiskCacheFile *cache_file;
-  int64_t size_before;
-  int64_t size_after;
+  while (disk_cache->size_total > seq_disk_cache_size_limit()) {
+    DiskCacheFile *oldest_file = seq_disk_cache_get_oldest_file(disk_cache);
 
-  cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
-  size_before = cache_file->fstat.st_size;
+    if (!oldest_file) {
+      /* All files are indexed in memory, nothing is left to delete. */
+      disk_cache->size_total = 0;
+      break;
+    }
 
-  if (BLI_stat(path, &cache_file->fstat) == -1) {
-    BLI_assert(false);
-    memset(&cache_file->fstat, 0, sizeof(BLI_stat_t));
+    seq_disk_cache_delete_file(disk_cache, oldest_file);
   }
+}
 
-  size_after = cache_file->fstat.st_size;
-  disk_cache->size_total += size_after - size_before;
+static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
+{
+  return BLI_ghash_lookup(disk_cache->files_by_path, path);
+}
+
+/* Get file containing given frame, with same cache type, resolution and view as `cache_file`. */
+static DiskCacheFile *seq_disk_cache_get_file_for_frame(SeqDiskCache *disk_cache,
+                                                        const DiskCacheFile *cache_file,
+                                                        float frame_index)
+{
+  char cache_filename[FILE_MAXFILE];
+  char path[FILE_MAX];
+  sprintf(cache_filename,
+          DCACHE_FNAME_FORMAT,
+          cache_file->cache_type,
+          cache_file->rectx,
+          cache_file->recty,
+          cache_file->render_size,
+          cache_file->view_id,
+          (int)frame_index / DCACHE_IMAGES_PER_FILE);
+  BLI_join_dirfile(path, sizeof(path), cache_file->dir, cache_filename);
+  return seq_disk_cache_get_file_entry_by_path(disk_cache, path);
 }
 
 /* Path format:
@@ -483,7 +564,9 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(float frame_index,
+                                           ImBuf *ibuf,
+                                           DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -516,7 +599,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   }
 
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->frame_index;
+  header->entry[i].frameno = frame_index;
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
@@ -534,10 +617,10 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   return i;
 }
 
-static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *header)
+static int seq_disk_cache_get_header_entry(float frame_index, DiskCacheHeader *header)
 {
   for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
-    if (header->entry[i].frameno == key->frame_index) {
+    if (header->entry[i].frameno == frame_index) {
       return i;
     }
   }
@@ -545,121 +628,340 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Get header of the file, it's read from the file on first access.
+ * Returns NULL and deletes the file if the header can't be read. */
+static DiskCacheHeader *seq_disk_cache_get_file_header(SeqDiskCache *disk_cache,
+                                                       DiskCacheFile *cache_file)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  if (cache_file->header != NULL) {
+    return cache_file->header;
+  }
 
-  char filepath[FILE_MAX];
+  DiskCacheHeader *header = MEM_callocN(sizeof(DiskCacheHeader), "DiskCacheHeader");
+  /* Files created by this session are empty until their first image is written. */
+  if (cache_file->fstat.st_size != 0) {
+    FILE *file = BLI_fopen(cache_file->path, "rb");
+    const bool is_valid = file != NULL && seq_disk_cache_read_header(file, header);
+    if (file != NULL) {
+      fclose(file);
+    }
+    if (!is_valid) {
+      MEM_freeN(header);
+      seq_disk_cache_delete_file(disk_cache, cache_file);
+      return NULL;
+    }
+  }
 
-  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
-  BLI_make_existing_file(filepath);
+  cache_file->header = header;
+  return header;
+}
 
-  FILE *file = BLI_fopen(filepath, "rb+");
+static ImBuf *seq_disk_cache_read_image(DiskCacheFile *cache_file,
+                                        DiskCacheHeaderEntry *header_entry)
+{
+  FILE *file = BLI_fopen(cache_file->path, "rb");
   if (!file) {
-    file = BLI_fopen(filepath, "wb+");
-    if (!file) {
-      BLI_mutex_unlock(&disk_cache->read_write_mutex);
-      return false;
-    }
-    seq_disk_cache_add_file_to_list(disk_cache, filepath);
+    return NULL;
   }
 
-  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, filepath);
-  DiskCacheHeader header;
-  memset(&header, 0, sizeof(header));
-  /* #BLI_make_existing_file() above may create an empty file. This is fine, don't attempt reading
-   * the header in that case. */
-  if (cache_file->fstat.st_size != 0 && !seq_disk_cache_read_header(file, &header)) {
+  ImBuf *ibuf;
+  uint64_t size_char = (uint64_t)cache_file->rectx * cache_file->recty * 4;
+  uint64_t size_float = (uint64_t)cache_file->rectx * cache_file->recty * 16;
+  size_t expected_size;
+
+  if (header_entry->size_raw == size_char) {
+    expected_size = size_char;
+    ibuf = IMB_allocImBuf(cache_file->rectx, cache_file->recty, 32, IB_rect);
+    IMB_colormanagement_assign_rect_colorspace(ibuf, header_entry->colorspace_name);
+  }
+  else if (header_entry->size_raw == size_float) {
+    expected_size = size_float;
+    ibuf = IMB_allocImBuf(cache_file->rectx, cache_file->recty, 32, IB_rectfloat);
+    IMB_colormanagement_assign_float_colorspace(ibuf, header_entry->colorspace_name);
+  }
+  else {
     fclose(file);
-    seq_disk_cache_delete_file(disk_cache, cache_file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return false;
+    return NULL;
   }
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
 
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, header_entry);
+  fclose(file);
 
-  if (bytes_written != 0) {
-    /* Last step is writing header, as image data can be overwritten,
-     * but missing data would cause problems.
-     */
-    header.entry[entry_index].size_compressed = bytes_written;
-    seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, filepath);
-    fclose(file);
+  /* Sanity check. */
+  if (bytes_read != expected_size) {
+    IMB_freeImBuf(ibuf);
+    return NULL;
+  }
 
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return true;
+  return ibuf;
+}
+
+/* Write image taken from the write queue. Called from the worker thread with `read_write_mutex`
+ * locked, which is unlocked while compressing and writing. */
+static void seq_disk_cache_write_image(SeqDiskCache *disk_cache, DiskCacheImage *image)
+{
+  DiskCacheFile *cache_file = image->cache_file;
+  DiskCacheHeader *file_header = seq_disk_cache_get_file_header(disk_cache, cache_file);
+  if (file_header == NULL) {
+    return;
+  }
+
+  DiskCacheHeader header = *file_header;
+  int entry_index = seq_disk_cache_add_header_entry(image->frame_index, image->ibuf, &header);
+  if (entry_index == 0 && cache_file->num_readers > 0) {
+    /* Don't overwrite images which are being read, this image is not cached on disk. */
+    return;
+  }
+  if (entry_index == 0) {
+    /* File is written from the beginning, existing images must not be read anymore. */
+    memset(file_header, 0, sizeof(*file_header));
   }
 
+  disk_cache->worker_file = cache_file;
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
-  return false;
+
+  bool success = false;
+  BLI_stat_t fstat;
+  BLI_make_existing_file(cache_file->path);
+  FILE *file = BLI_fopen(cache_file->path, "rb+");
+  if (!file) {
+    file = BLI_fopen(cache_file->path, "wb+");
+  }
+  if (file) {
+    size_t bytes_written = deflate_imbuf_to_file(
+        image->ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+
+    if (bytes_written != 0) {
+      /* Last step is writing header, as image data can be overwritten,
+       * but missing data would cause problems.
+       */
+      header.entry[entry_index].size_compressed = bytes_written;
+      seq_disk_cache_write_header(file, &header);
+      success = true;
+    }
+    fclose(file);
+    success = success && BLI_stat(cache_file->path, &fstat) != -1;
+  }
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  disk_cache->worker_file = NULL;
+
+  if (cache_file->is_deleted) {
+    if (!seq_disk_cache_file_is_used(disk_cache, cache_file)) {
+      seq_disk_cache_file_free(cache_file);
+    }
+    return;
+  }
+
+  if (success) {
+    *cache_file->header = header;
+    disk_cache->size_total += fstat.st_size - cache_file->fstat.st_size;
+    cache_file->fstat = fstat;
+  }
 }
 
-ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+/* Read images of frames following the last read image. Called from the worker thread with
+ * `read_write_mutex` locked, which is unlocked while reading. */
+static void seq_disk_cache_read_ahead(SeqDiskCache *disk_cache)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  /* Copy, the file may be deleted while reading other files. */
+  DiskCacheFile last_file = *disk_cache->read_ahead_file;
+  const float frame_index = disk_cache->read_ahead_frame_index;
+  disk_cache->read_ahead_file = NULL;
+
+  for (int i = 1; i <= DCACHE_READ_AHEAD_FRAMES; i++) {
+    /* Start over when another image was read in the meantime. */
+    if (disk_cache->worker_stop || disk_cache->read_ahead_file != NULL) {
+      return;
+    }
 
-  char filepath[FILE_MAX];
-  DiskCacheHeader header;
+    const float next_frame_index = frame_index + i;
+    DiskCacheFile *cache_file = seq_disk_cache_get_file_for_frame(
+        disk_cache, &last_file, next_frame_index);
+    if (cache_file == NULL) {
+      return;
+    }
+    if (seq_disk_cache_find_image(
+            &disk_cache->read_ahead_images, cache_file, next_frame_index) != NULL) {
+      continue;
+    }
 
-  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
-  BLI_make_existing_file(filepath);
+    DiskCacheHeader *header = seq_disk_cache_get_file_header(disk_cache, cache_file);
+    const int entry_index = header ? seq_disk_cache_get_header_entry(next_frame_index, header) :
+                                     -1;
+    if (entry_index < 0) {
+      continue;
+    }
+    DiskCacheHeaderEntry header_entry = header->entry[entry_index];
 
-  FILE *file = BLI_fopen(filepath, "rb");
-  if (!file) {
+    disk_cache->worker_file = cache_file;
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+    ImBuf *ibuf = seq_disk_cache_read_image(cache_file, &header_entry);
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    disk_cache->worker_file = NULL;
+
+    if (cache_file->is_deleted) {
+      IMB_freeImBuf(ibuf);
+      if (!seq_disk_cache_file_is_used(disk_cache, cache_file)) {
+        seq_disk_cache_file_free(cache_file);
+      }
+      return;
+    }
+
+    if (ibuf != NULL) {
+      DiskCacheImage *image = MEM_callocN(sizeof(DiskCacheImage), "DiskCacheImage");
+      image->cache_file = cache_file;
+      image->frame_index = next_frame_index;
+      image->ibuf = ibuf;
+      BLI_addtail(&disk_cache->read_ahead_images, image);
+      disk_cache->read_ahead_images_len++;
+
+      /* Discard images that were not used. */
+      if (disk_cache->read_ahead_images_len > DCACHE_READ_AHEAD_FRAMES) {
+        seq_disk_cache_image_free(BLI_pophead(&disk_cache->read_ahead_images));
+        disk_cache->read_ahead_images_len--;
+      }
+    }
   }
+}
 
-  if (!seq_disk_cache_read_header(file, &header)) {
-    fclose(file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+static void *seq_disk_cache_worker(void *data)
+{
+  SeqDiskCache *disk_cache = (SeqDiskCache *)data;
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  while (!disk_cache->worker_stop) {
+    /* Reading ahead has priority, images are needed for playback. */
+    if (disk_cache->read_ahead_file != NULL) {
+      seq_disk_cache_read_ahead(disk_cache);
+    }
+    else if (disk_cache->write_queue.first != NULL) {
+      DiskCacheImage *image = BLI_pophead(&disk_cache->write_queue);
+      disk_cache->write_queue_size -= IMB_get_size_in_memory(image->ibuf);
+      disk_cache->worker_image = image;
+      seq_disk_cache_write_image(disk_cache, image);
+      disk_cache->worker_image = NULL;
+      seq_disk_cache_image_free(image);
+      seq_disk_cache_enforce_limits(disk_cache);
+    }
+    else {
+      BLI_condition_wait(&disk_cache->worker_cond, &disk_cache->read_write_mutex);
+    }
   }
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
 
-  /* Item not found. */
-  if (entry_index < 0) {
-    fclose(file);
+  return NULL;
+}
+
+bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+
+  /* Disk can't keep up, don't hold more images in memory. */
+  if (disk_cache->write_queue_size > DCACHE_WRITE_QUEUE_SIZE_MAX) {
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+    return false;
   }
 
-  ImBuf *ibuf;
-  uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
-  uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
-  size_t expected_size;
+  char filepath[FILE_MAX];
+  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
 
-  if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, filepath);
+  if (cache_file == NULL) {
+    cache_file = seq_disk_cache_add_file_to_list(disk_cache, filepath);
+    cache_file->fstat.st_mtime = time(NULL);
   }
-  else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+
+  DiskCacheImage *image = MEM_callocN(sizeof(DiskCacheImage), "DiskCacheImage");
+  image->cache_file = cache_file;
+  image->frame_index = key->frame_index;
+  image->ibuf = ibuf;
+  IMB_refImBuf(ibuf);
+  BLI_addtail(&disk_cache->write_queue, image);
+  disk_cache->write_queue_size += IMB_get_size_in_memory(ibuf);
+
+  BLI_condition_notify_one(&disk_cache->worker_cond);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  return true;
+}
+
+/* Get image which is waiting to be written or was read ahead. */
+static ImBuf *seq_disk_cache_get_queued_image(SeqDiskCache *disk_cache,
+                                             DiskCacheFile *cache_file,
+                                             float frame_index)
+{
+  DiskCacheImage *image = disk_cache->worker_image;
+  if (image == NULL || image->cache_file != cache_file || image->frame_index != frame_index) {
+    image = seq_disk_cache_find_image(&disk_cache->write_queue, cache_file, frame_index);
   }
-  else {
-    fclose(file);
+  if (image != NULL) {
+    IMB_refImBuf(image->ibuf);
+    return image->ibuf;
+  }
+
+  image = seq_disk_cache_find_image(&disk_cache->read_ahead_images, cache_file, frame_index);
+  if (image != NULL) {
+    ImBuf *ibuf = image->ibuf;
+    BLI_remlink(&disk_cache->read_ahead_images, image);
+    disk_cache->read_ahead_images_len--;
+    MEM_freeN(image);
+    return ibuf;
+  }
+
+  return NULL;
+}
+
+ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+
+  char filepath[FILE_MAX];
+  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
+
+  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, filepath);
+  if (cache_file == NULL) {
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  ImBuf *ibuf = seq_disk_cache_get_queued_image(disk_cache, cache_file, key->frame_index);
+  if (ibuf == NULL) {
+    DiskCacheHeader *header = seq_disk_cache_get_file_header(disk_cache, cache_file);
+    const int entry_index = header ? seq_disk_cache_get_header_entry(key->frame_index, header) :
+                                     -1;
+    /* Item not found. */
+    if (entry_index < 0) {
+      BLI_mutex_unlock(&disk_cache->read_write_mutex);
+      return NULL;
+    }
+    DiskCacheHeaderEntry header_entry = header->entry[entry_index];
 
-  /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
-    IMB_freeImBuf(ibuf);
+    /* Read without blocking the worker thread and other readers. The worker may append images to
+     * the file meanwhile, which leaves the data of existing entries untouched. It doesn't rewrite
+     * the file from the beginning while it's being read. */
+    cache_file->num_readers++;
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+    ibuf = seq_disk_cache_read_image(cache_file, &header_entry);
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    cache_file->num_readers--;
+
+    if (cache_file->is_deleted) {
+      if (!seq_disk_cache_file_is_used(disk_cache, cache_file)) {
+        seq_disk_cache_file_free(cache_file);
+      }
+      BLI_mutex_unlock(&disk_cache->read_write_mutex);
+      return ibuf;
+    }
+  }
+
+  if (ibuf != NULL) {
+    /* Modification time is used to delete least recently used files. */
+    cache_file->fstat.st_mtime = time(NULL);
+
+    disk_cache->read_ahead_file = cache_file;
+    disk_cache->read_ahead_frame_index = key->frame_index;
+    BLI_condition_notify_one(&disk_cache->worker_cond);
   }
-  BLI_file_touch(filepath);
-  seq_disk_cache_update_file(disk_cache, filepath);
-  fclose(file);
 
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
   return ibuf;
@@ -669,17 +971,35 @@ SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene)
 {
   SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
   disk_cache->bmain = bmain;
+  disk_cache->files_by_path = BLI_ghash_str_new("SeqDiskCache files");
   BLI_mutex_init(&disk_cache->read_write_mutex);
+  BLI_condition_init(&disk_cache->worker_cond);
   seq_disk_cache_handle_versioning(disk_cache);
   seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
   disk_cache->timestamp = scene->ed->disk_cache_timestamp;
-  BLI_mutex_unlock(&cache_create_lock);
+
+  BLI_threadpool_init(&disk_cache->worker_thread, seq_disk_cache_worker, 1);
+  BLI_threadpool_insert(&disk_cache->worker_thread, disk_cache);
   return disk_cache;
 }
 
 void seq_disk_cache_free(SeqDiskCache *disk_cache)
 {
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  disk_cache->worker_stop = true;
+  BLI_condition_notify_one(&disk_cache->worker_cond);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  BLI_threadpool_end(&disk_cache->worker_thread);
+
+  /* Images that were not written yet are lost. */
+  seq_disk_cache_discard_images(&disk_cache->write_queue, NULL);
+  seq_disk_cache_discard_images(&disk_cache->read_ahead_images, NULL);
+  LISTBASE_FOREACH (DiskCacheFile *, cache_file, &disk_cache->files) {
+    MEM_SAFE_FREE(cache_file->header);
+  }
+  BLI_ghash_free(disk_cache->files_by_path, NULL, NULL);
   BLI_freelistN(&disk_cache->files);
+  BLI_condition_end(&disk_cache->worker_cond);
   BLI_mutex_end(&disk_cache->read_write_mutex);
   MEM_freeN(disk_cache);
 }
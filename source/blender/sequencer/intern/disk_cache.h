@@ -25,11 +25,17 @@ struct Sequence;
 struct SeqDiskCache *seq_disk_cache_create(struct Main *bmain, struct Scene *scene);
 void seq_disk_cache_free(struct SeqDiskCache *disk_cache);
 bool seq_disk_cache_is_enabled(struct Main *bmain);
+/**
+ * Read image from disk cache. Reading ahead of this image is started in the background.
+ */
 struct ImBuf *seq_disk_cache_read_file(struct SeqDiskCache *disk_cache, struct SeqCacheKey *key);
+/**
+ * Queue image to be written to disk cache in the background. Cache size limit is enforced after
+ * writing. Returns false when the image was skipped, because too many images are queued.
+ */
 bool seq_disk_cache_write_file(struct SeqDiskCache *disk_cache,
                                struct SeqCacheKey *key,
                                struct ImBuf *ibuf);
-bool seq_disk_cache_enforce_limits(struct SeqDiskCache *disk_cache);
 void seq_disk_cache_invalidate(struct SeqDiskCache *disk_cache,
                                struct Scene *scene,
                                struct Sequence *seq,
@@ -215,11 +215,8 @@ static void do_alphaover_effect_byte(
     for (int j = 0; j < x; j++) {
       /* rt = rt1 over rt2  (alpha from rt1) */
 
-      float tempc[4], rt1[4], rt2[4];
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      float mfac = 1.0f - fac * rt1[3];
+      /* Same as premultiplied alpha of rt1. */
+      float mfac = 1.0f - fac * (cp1[3] * (1.0f / 255.0f));
 
       if (fac <= 0.0f) {
         *((unsigned int *)rt) = *((unsigned int *)cp2);
@@ -228,12 +225,25 @@ static void do_alphaover_effect_byte(
         *((unsigned int *)rt) = *((unsigned int *)cp1);
       }
       else {
+#ifdef BLI_HAVE_SSE2
+        const __m128 rt1 = straight_uchar_to_premul_float_simd(cp1);
+        const __m128 rt2 = straight_uchar_to_premul_float_simd(cp2);
+        const __m128 tempc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fac), rt1),
+                                        _mm_mul_ps(_mm_set1_ps(mfac), rt2));
+
+        premul_float_to_straight_uchar_simd(rt, tempc);
+#else
+        float tempc[4], rt1[4], rt2[4];
+        straight_uchar_to_premul_float(rt1, cp1);
+        straight_uchar_to_premul_float(rt2, cp2);
+
         tempc[0] = fac * rt1[0] + mfac * rt2[0];
         tempc[1] = fac * rt1[1] + mfac * rt2[1];
         tempc[2] = fac * rt1[2] + mfac * rt2[2];
         tempc[3] = fac * rt1[3] + mfac * rt2[3];
 
         premul_float_to_straight_uchar(rt, tempc);
+#endif
       }
       cp1 += 4;
       cp2 += 4;
@@ -262,10 +272,16 @@ static void do_alphaover_effect_float(
         memcpy(rt, rt1, sizeof(float[4]));
       }
       else {
+#ifdef BLI_HAVE_SSE2
+        _mm_storeu_ps(rt,
+                      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fac), _mm_loadu_ps(rt1)),
+                                 _mm_mul_ps(_mm_set1_ps(mfac), _mm_loadu_ps(rt2))));
+#else
         rt[0] = fac * rt1[0] + mfac * rt2[0];
         rt[1] = fac * rt1[1] + mfac * rt2[1];
         rt[2] = fac * rt1[2] + mfac * rt2[2];
         rt[3] = fac * rt1[3] + mfac * rt2[3];
+#endif
       }
       rt1 += 4;
       rt2 += 4;
@@ -320,32 +336,43 @@ static void do_alphaunder_effect_byte(
     for (int j = 0; j < x; j++) {
       /* rt = rt1 under rt2  (alpha from rt2) */
 
-      float tempc[4], rt1[4], rt2[4];
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
+      /* Same as premultiplied alpha of rt2. */
+      const float alpha2 = cp2[3] * (1.0f / 255.0f);
 
       /* this complex optimization is because the
        * 'skybuf' can be crossed in
        */
-      if (rt2[3] <= 0.0f && fac >= 1.0f) {
+      if (alpha2 <= 0.0f && fac >= 1.0f) {
         *((unsigned int *)rt) = *((unsigned int *)cp1);
       }
-      else if (rt2[3] >= 1.0f) {
+      else if (alpha2 >= 1.0f) {
         *((unsigned int *)rt) = *((unsigned int *)cp2);
       }
       else {
-        float temp_fac = (fac * (1.0f - rt2[3]));
+        float temp_fac = (fac * (1.0f - alpha2));
 
         if (fac <= 0) {
           *((unsigned int *)rt) = *((unsigned int *)cp2);
         }
         else {
+#ifdef BLI_HAVE_SSE2
+          const __m128 rt1 = straight_uchar_to_premul_float_simd(cp1);
+          const __m128 rt2 = straight_uchar_to_premul_float_simd(cp2);
+          const __m128 tempc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(temp_fac), rt1), rt2);
+
+          premul_float_to_straight_uchar_simd(rt, tempc);
+#else
+          float tempc[4], rt1[4], rt2[4];
+          straight_uchar_to_premul_float(rt1, cp1);
+          straight_uchar_to_premul_float(rt2, cp2);
+
           tempc[0] = (temp_fac * rt1[0] + rt2[0]);
           tempc[1] = (temp_fac * rt1[1] + rt2[1]);
           tempc[2] = (temp_fac * rt1[2] + rt2[2]);
           tempc[3] = (temp_fac * rt1[3] + rt2[3]);
 
           premul_float_to_straight_uchar(rt, tempc);
+#endif
         }
       }
       cp1 += 4;
@@ -382,10 +409,16 @@ static void do_alphaunder_effect_float(
           memcpy(rt, rt2, sizeof(float[4]));
         }
         else {
+#ifdef BLI_HAVE_SSE2
+          _mm_storeu_ps(
+              rt,
+              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(temp_fac), _mm_loadu_ps(rt1)), _mm_loadu_ps(rt2)));
+#else
           rt[0] = temp_fac * rt1[0] + rt2[0];
           rt[1] = temp_fac * rt1[1] + rt2[1];
           rt[2] = temp_fac * rt1[2] + rt2[2];
           rt[3] = temp_fac * rt1[3] + rt2[3];
+#endif
         }
       }
       rt1 += 4;
@@ -440,8 +473,28 @@ static void do_cross_effect_byte(
   int temp_fac = (int)(256.0f * fac);
   int temp_mfac = 256 - temp_fac;
 
+#ifdef BLI_HAVE_SSE2
+  /* Weighted sums fit in 16 bits for factors in the usual [0, 1] range. */
+  const bool use_simd = temp_fac >= 0 && temp_fac <= 256;
+  const __m128i fac_v = _mm_set1_epi16((short)temp_fac);
+  const __m128i mfac_v = _mm_set1_epi16((short)temp_mfac);
+#endif
+
   for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
+    int j = 0;
+#ifdef BLI_HAVE_SSE2
+    /* Four pixels at a time. */
+    for (; use_simd && j + 4 <= x; j += 4) {
+      const __m128i c1 = _mm_loadu_si128((const __m128i *)rt1);
+      const __m128i c2 = _mm_loadu_si128((const __m128i *)rt2);
+      _mm_storeu_si128((__m128i *)rt, blend_color_cross_byte4_simd(c1, c2, fac_v, mfac_v));
+
+      rt1 += 16;
+      rt2 += 16;
+      rt += 16;
+    }
+#endif
+    for (; j < x; j++) {
       rt[0] = (temp_mfac * rt1[0] + temp_fac * rt2[0]) >> 8;
       rt[1] = (temp_mfac * rt1[1] + temp_fac * rt2[1]) >> 8;
       rt[2] = (temp_mfac * rt1[2] + temp_fac * rt2[2]) >> 8;
@@ -464,10 +517,16 @@ static void do_cross_effect_float(float fac, int x, int y, float *rect1, float *
 
   for (int i = 0; i < y; i++) {
     for (int j = 0; j < x; j++) {
+#ifdef BLI_HAVE_SSE2
+      _mm_storeu_ps(rt,
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mfac), _mm_loadu_ps(rt1)),
+                               _mm_mul_ps(_mm_set1_ps(fac), _mm_loadu_ps(rt2))));
+#else
       rt[0] = mfac * rt1[0] + fac * rt2[0];
       rt[1] = mfac * rt1[1] + fac * rt2[1];
       rt[2] = mfac * rt1[2] + fac * rt2[2];
       rt[3] = mfac * rt1[3] + fac * rt2[3];
+#endif
 
       rt1 += 4;
       rt2 += 4;
@@ -768,8 +827,27 @@ static void do_add_effect_byte(
 
   int temp_fac = (int)(256.0f * fac);
 
+#ifdef BLI_HAVE_SSE2
+  const bool use_simd = temp_fac >= 0 && temp_fac <= 256;
+  const __m128i fac_v = _mm_set1_epi16((short)temp_fac);
+#endif
+
   for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
+    int j = 0;
+#ifdef BLI_HAVE_SSE2
+    /* Four pixels at a time, saturated add keeping the alpha of rect1. */
+    for (; use_simd && j + 4 <= x; j += 4) {
+      const __m128i c1 = _mm_loadu_si128((const __m128i *)cp1);
+      const __m128i c2 = _mm_loadu_si128((const __m128i *)cp2);
+      const __m128i sum = _mm_adds_epu8(c1, blend_color_alpha_scale_byte4_simd(c2, fac_v));
+      _mm_storeu_si128((__m128i *)rt, blend_color_rgb_alpha_byte4_simd(sum, c1));
+
+      cp1 += 16;
+      cp2 += 16;
+      rt += 16;
+    }
+#endif
+    for (; j < x; j++) {
       const int temp_fac2 = temp_fac * (int)cp2[3];
       rt[0] = min_ii(cp1[0] + ((temp_fac2 * cp2[0]) >> 16), 255);
       rt[1] = min_ii(cp1[1] + ((temp_fac2 * cp2[1]) >> 16), 255);
@@ -792,10 +870,16 @@ static void do_add_effect_float(float fac, int x, int y, float *rect1, float *re
   for (int i = 0; i < y; i++) {
     for (int j = 0; j < x; j++) {
       const float temp_fac = (1.0f - (rt1[3] * (1.0f - fac))) * rt2[3];
+#ifdef BLI_HAVE_SSE2
+      const __m128 c1 = _mm_loadu_ps(rt1);
+      const __m128 sum = _mm_add_ps(c1, _mm_mul_ps(_mm_set1_ps(temp_fac), _mm_loadu_ps(rt2)));
+      _mm_storeu_ps(rt, blend_color_rgb_alpha_simd(sum, c1));
+#else
       rt[0] = rt1[0] + temp_fac * rt2[0];
       rt[1] = rt1[1] + temp_fac * rt2[1];
       rt[2] = rt1[2] + temp_fac * rt2[2];
       rt[3] = rt1[3];
+#endif
 
       rt1 += 4;
       rt2 += 4;
@@ -848,8 +932,27 @@ static void do_sub_effect_byte(
 
   int temp_fac = (int)(256.0f * fac);
 
+#ifdef BLI_HAVE_SSE2
+  const bool use_simd = temp_fac >= 0 && temp_fac <= 256;
+  const __m128i fac_v = _mm_set1_epi16((short)temp_fac);
+#endif
+
   for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
+    int j = 0;
+#ifdef BLI_HAVE_SSE2
+    /* Four pixels at a time, saturated subtract keeping the alpha of rect1. */
+    for (; use_simd && j + 4 <= x; j += 4) {
+      const __m128i c1 = _mm_loadu_si128((const __m128i *)cp1);
+      const __m128i c2 = _mm_loadu_si128((const __m128i *)cp2);
+      const __m128i diff = _mm_subs_epu8(c1, blend_color_alpha_scale_byte4_simd(c2, fac_v));
+      _mm_storeu_si128((__m128i *)rt, blend_color_rgb_alpha_byte4_simd(diff, c1));
+
+      cp1 += 16;
+      cp2 += 16;
+      rt += 16;
+    }
+#endif
+    for (; j < x; j++) {
       const int temp_fac2 = temp_fac * (int)cp2[3];
       rt[0] = max_ii(cp1[0] - ((temp_fac2 * cp2[0]) >> 16), 0);
       rt[1] = max_ii(cp1[1] - ((temp_fac2 * cp2[1]) >> 16), 0);
@@ -874,10 +977,17 @@ static void do_sub_effect_float(float fac, int x, int y, float *rect1, float *re
   for (int i = 0; i < y; i++) {
     for (int j = 0; j < x; j++) {
       const float temp_fac = (1.0f - (rt1[3] * mfac)) * rt2[3];
+#ifdef BLI_HAVE_SSE2
+      const __m128 c1 = _mm_loadu_ps(rt1);
+      const __m128 diff = _mm_max_ps(
+          _mm_sub_ps(c1, _mm_mul_ps(_mm_set1_ps(temp_fac), _mm_loadu_ps(rt2))), _mm_setzero_ps());
+      _mm_storeu_ps(rt, blend_color_rgb_alpha_simd(diff, c1));
+#else
       rt[0] = max_ff(rt1[0] - temp_fac * rt2[0], 0.0f);
       rt[1] = max_ff(rt1[1] - temp_fac * rt2[1], 0.0f);
       rt[2] = max_ff(rt1[2] - temp_fac * rt2[2], 0.0f);
       rt[3] = rt1[3];
+#endif
 
       rt1 += 4;
       rt2 += 4;
@@ -3232,6 +3342,10 @@ static void init_text_effect(Sequence *seq)
   data->wrap_width = 1.0f;
 }
 
+/* BLF fonts and their buffer drawing state are global, text strips rendered by prefetch workers
+ * and the main thread at the same time must not use them concurrently. */
+static ThreadMutex text_effect_mutex = BLI_MUTEX_INITIALIZER;
+
 void SEQ_effect_text_font_unload(TextVars *data, const bool do_id_user)
 {
   if (data == NULL) {
@@ -3246,11 +3360,13 @@ void SEQ_effect_text_font_unload(TextVars *data, const bool do_id_user)
 
   /* Unload the BLF font. */
   if (data->text_blf_id >= 0) {
+    BLI_mutex_lock(&text_effect_mutex);
     BLF_unload_id(data->text_blf_id);
+    BLI_mutex_unlock(&text_effect_mutex);
   }
 }
 
-void SEQ_effect_text_font_load(TextVars *data, const bool do_id_user)
+static void text_effect_font_load(TextVars *data, const bool do_id_user)
 {
   VFont *vfont = data->text_font;
   if (vfont == NULL) {
@@ -3280,6 +3396,13 @@ void SEQ_effect_text_font_load(TextVars *data, const bool do_id_user)
   }
 }
 
+void SEQ_effect_text_font_load(TextVars *data, const bool do_id_user)
+{
+  BLI_mutex_lock(&text_effect_mutex);
+  text_effect_font_load(data, do_id_user);
+  BLI_mutex_unlock(&text_effect_mutex);
+}
+
 static void free_text_effect(Sequence *seq, const bool do_id_user)
 {
   TextVars *data = seq->effectdata;
@@ -3341,10 +3464,12 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
   int y_ofs, x, y;
   double proxy_size_comp;
 
+  BLI_mutex_lock(&text_effect_mutex);
+
   if (data->text_blf_id == SEQ_FONT_NOT_LOADED) {
     data->text_blf_id = -1;
 
-    SEQ_effect_text_font_load(data, false);
+    text_effect_font_load(data, false);
   }
 
   if (data->text_blf_id >= 0) {
@@ -3439,6 +3564,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
 
   BLF_disable(font, font_flags);
 
+  BLI_mutex_unlock(&text_effect_mutex);
+
   return out;
 }
 
@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+#include "SEQ_effects.h"
+#include "SEQ_render.h"
+
+namespace blender::seq::tests {
+
+class SequencerEffectsTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    IMB_init();
+  }
+
+  void TearDown() override
+  {
+    IMB_exit();
+  }
+
+  /** Image with random pixels, so the effects blend instead of copying at the ends of the range.
+   */
+  static ImBuf *create_noise_image(const int width,
+                                   const int height,
+                                   const bool is_float,
+                                   RandomNumberGenerator &rng)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 32, is_float ? IB_rectfloat : IB_rect);
+    const int64_t size = int64_t(width) * height * 4;
+    for (int64_t i = 0; i < size; i++) {
+      if (is_float) {
+        ibuf->rect_float[i] = rng.get_float();
+      }
+      else {
+        ((uchar *)ibuf->rect)[i] = uchar(rng.get_int32(256));
+      }
+    }
+    return ibuf;
+  }
+};
+
+/**
+ * Times the effects that have SIMD kernels through their effect handles, for byte and float
+ * images. Gamma cross is measured for comparison, its lookup tables keep it scalar.
+ */
+TEST_F(SequencerEffectsTest, DISABLED_benchmark_4k)
+{
+  const int width = 3840;
+  const int height = 2160;
+  const float fac = 0.6f;
+  const int runs = 5;
+
+  Scene scene = {{nullptr}};
+  SeqRenderData context = {nullptr};
+  context.scene = &scene;
+  context.rectx = width;
+  context.recty = height;
+
+  const struct {
+    const char *name;
+    int type;
+  } effects[] = {
+      {"alpha over", SEQ_TYPE_ALPHAOVER},
+      {"alpha under", SEQ_TYPE_ALPHAUNDER},
+      {"cross", SEQ_TYPE_CROSS},
+      {"add", SEQ_TYPE_ADD},
+      {"subtract", SEQ_TYPE_SUB},
+      {"gamma cross", SEQ_TYPE_GAMCROSS},
+  };
+
+  RandomNumberGenerator rng(0);
+  for (const bool is_float : {false, true}) {
+    ImBuf *ibuf1 = create_noise_image(width, height, is_float, rng);
+    ImBuf *ibuf2 = create_noise_image(width, height, is_float, rng);
+
+    for (const auto &effect : effects) {
+      Sequence seq = {nullptr};
+      seq.type = effect.type;
+      SeqEffectHandle handle = SEQ_effect_handle_get(&seq);
+      handle.init(&seq);
+
+      ImBuf *out = handle.init_execution(&context, ibuf1, ibuf2, nullptr);
+      const double start_time = PIL_check_seconds_timer();
+      for (int i = 0; i < runs; i++) {
+        handle.execute_slice(&context, &seq, 0.0f, fac, ibuf1, ibuf2, nullptr, 0, height, out);
+      }
+      const double time = (PIL_check_seconds_timer() - start_time) / runs;
+      IMB_freeImBuf(out);
+
+      handle.free(&seq, true);
+
+      printf("%-11s %-5s %dx%d: %8.2f ms\n",
+             effect.name,
+             is_float ? "float" : "byte",
+             width,
+             height,
+             time * 1000.0);
+    }
+
+    IMB_freeImBuf(ibuf1);
+    IMB_freeImBuf(ibuf2);
+  }
+}
+
+}  // namespace blender::seq::tests
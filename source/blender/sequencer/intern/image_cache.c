@@ -61,6 +61,8 @@
  * Entries are linked in order as they are put into cache.
  * Only permanent (is_temp_cache = 0) cache entries are linked.
  * Putting #SEQ_CACHE_STORE_FINAL_OUT will reset linking
+ * Each task (see #eSeqTaskId) links its own entries, so that frames rendered at the same time
+ * by main thread and prefetch workers are not linked together.
  *
  * Only entire frame can be freed to release resources for new entries (recycling).
  * Once again, this is to reduce number of iterations, but also more controllable than removing
@@ -70,6 +72,7 @@
  */
 
 #define THUMB_CACHE_LIMIT 5000
+#define SEQ_CACHE_TASK_COUNT (SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_MAX_WORKERS)
 
 typedef struct SeqCache {
   Main *bmain;
@@ -77,7 +80,7 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  struct SeqCacheKey *last_key[SEQ_CACHE_TASK_COUNT];
   struct SeqDiskCache *disk_cache;
   int thumbnail_count;
 } SeqCache;
@@ -215,9 +218,17 @@ static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
   return flag;
 }
 
+static void seq_cache_reset_linking(SeqCache *cache)
+{
+  for (int i = 0; i < SEQ_CACHE_TASK_COUNT; i++) {
+    cache->last_key[i] = NULL;
+  }
+}
+
 static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
+  SeqCacheKey **last_key = &cache->last_key[key->task_id];
   SeqCacheItem *item;
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
@@ -228,30 +239,30 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   /* Item stored for later use. */
   if (stored_types_flag & key->type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = *last_key;
   }
 
   /* Store pointer to last cached key. */
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = *last_key;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
 
     if (!key->is_temp_cache || key->type != SEQ_CACHE_STORE_THUMBNAIL) {
-      cache->last_key = key;
+      *last_key = key;
     }
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key points to current key.
    */
   if (!key->is_temp_cache && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = *last_key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    *last_key = NULL;
   }
 }
 
@@ -496,7 +507,7 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
+    seq_cache_reset_linking(cache);
     cache->bmain = bmain;
     cache->thumbnail_count = 0;
     BLI_mutex_init(&cache->iterator_mutex);
@@ -538,6 +549,18 @@ static SeqCacheKey *seq_cache_allocate_key(SeqCache *cache,
   return key;
 }
 
+/* Disk cache is created on first use, possibly from multiple prefetch threads. */
+static struct SeqDiskCache *seq_cache_get_disk_cache(SeqCache *cache,
+                                                     const SeqRenderData *context)
+{
+  BLI_mutex_lock(&cache_create_lock);
+  if (cache->disk_cache == NULL) {
+    cache->disk_cache = seq_disk_cache_create(context->bmain, context->scene);
+  }
+  BLI_mutex_unlock(&cache_create_lock);
+  return cache->disk_cache;
+}
+
 /* ***************************** API ****************************** */
 
 void seq_cache_free_temp_cache(Scene *scene, short id, int timeline_frame)
@@ -614,7 +637,7 @@ void SEQ_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
   cache->thumbnail_count = 0;
   seq_cache_unlock(scene);
 }
@@ -674,7 +697,7 @@ void seq_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
   seq_cache_unlock(scene);
 }
 
@@ -716,7 +739,7 @@ void seq_cache_thumbnail_cleanup(Scene *scene, rctf *view_area_safe)
       cache->thumbnail_count--;
     }
   }
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
 }
 
 struct ImBuf *seq_cache_get(const SeqRenderData *context,
@@ -763,11 +786,7 @@ struct ImBuf *seq_cache_get(const SeqRenderData *context,
 
   /* Try disk cache: */
   if (seq_disk_cache_is_enabled(context->bmain)) {
-    if (cache->disk_cache == NULL) {
-      cache->disk_cache = seq_disk_cache_create(context->bmain, context->scene);
-    }
-
-    ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
+    ibuf = seq_disk_cache_read_file(seq_cache_get_disk_cache(cache, context), &key);
 
     if (ibuf == NULL) {
       return NULL;
@@ -803,8 +822,9 @@ bool seq_cache_put_if_possible(
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = NULL;
+  SeqCacheKey **last_key = &scene->ed->cache->last_key[context->task_id];
+  seq_cache_set_temp_cache_linked(scene, *last_key);
+  *last_key = NULL;
   return false;
 }
 
@@ -874,12 +894,7 @@ void seq_cache_put(
 
   if (!key->is_temp_cache) {
     if (seq_disk_cache_is_enabled(context->bmain)) {
-      if (cache->disk_cache == NULL) {
-        seq_disk_cache_create(context->bmain, context->scene);
-      }
-
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_file(seq_cache_get_disk_cache(cache, context), key, i);
     }
   }
 }
@@ -908,7 +923,7 @@ void SEQ_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->timeline_frame, key->type);
   }
 
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
   seq_cache_unlock(scene);
 }
 
@@ -18,6 +18,7 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -48,34 +49,51 @@
 #include "prefetch.h"
 #include "render.h"
 
+
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* Frame being rendered. */
+  float cfra;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
-  struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
+
+  /* Each worker renders one frame at a time, with its own evaluated scene. */
+  PrefetchWorker workers[SEQ_PREFETCH_MAX_WORKERS];
+  int num_workers;
 
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
+  /* Notified when a frame is stored in cache, or when the prefetch area changes. */
+  ThreadCondition prefetch_order_cond;
 
   ListBase threads;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
-
   /* prefetch area */
   float cfra;
+  /* Frames are stored in cache in order, `cfra + num_frames_prefetched` is stored next. */
   int num_frames_prefetched;
+  /* Frames before `cfra + num_frames_scheduled` are assigned to workers. */
+  int num_frames_scheduled;
 
   /* control */
   bool running;
-  bool waiting;
   bool stop;
+  int num_workers_running;
+  int num_workers_waiting;
 } PrefetchJob;
 
 static bool seq_prefetch_is_playing(const Main *bmain)
@@ -126,7 +144,9 @@ static bool seq_prefetch_job_is_waiting(Scene *scene)
     return false;
   }
 
-  return pfjob->waiting;
+  /* All workers are suspended. */
+  return pfjob->num_workers_waiting > 0 &&
+         pfjob->num_workers_waiting == pfjob->num_workers_running;
 }
 
 static Sequence *sequencer_prefetch_get_original_sequence(Sequence *seq, ListBase *seqbase)
@@ -156,8 +176,10 @@ Sequence *seq_prefetch_get_original_sequence(Sequence *seq, Scene *scene)
 SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  const int worker_index = context->task_id - SEQ_TASK_PREFETCH_RENDER;
+  BLI_assert(worker_index >= 0 && worker_index < pfjob->num_workers);
 
-  return &pfjob->context;
+  return &pfjob->workers[worker_index].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -175,52 +197,60 @@ static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
 }
 
 void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
+  /* Include frames being rendered, so they are not recycled as soon as they are stored. */
   *start = pfjob->cfra;
-  *end = seq_prefetch_cfra(pfjob);
+  *end = pfjob->cfra + pfjob->num_frames_scheduled;
+}
+
+static int seq_prefetch_workers_count(void)
+{
+  /* Rendering of each frame is multi-threaded too, leave most threads for it. */
+  return min_ii(max_ii(BLI_system_thread_count() / 4, 1), SEQ_PREFETCH_MAX_WORKERS);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
-  Scene *scene = pfjob->scene;
+  Main *bmain = worker->bmain_eval;
+  Scene *scene = worker->pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
 }
 
+/* Must be called with `prefetch_suspend_mutex` locked. */
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
 {
   int cfra = pfjob->scene->r.cfra;
@@ -230,16 +260,22 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
     int delta = cfra - pfjob->cfra;
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched -= delta;
+    pfjob->num_frames_scheduled -= delta;
 
     if (pfjob->num_frames_prefetched <= 1) {
       pfjob->num_frames_prefetched = 1;
     }
+    pfjob->num_frames_scheduled = max_ii(pfjob->num_frames_scheduled,
+                                         pfjob->num_frames_prefetched);
+    BLI_condition_notify_all(&pfjob->prefetch_order_cond);
   }
 
   /* reset */
   if (cfra < pfjob->cfra) {
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched = 1;
+    pfjob->num_frames_scheduled = 1;
+    BLI_condition_notify_all(&pfjob->prefetch_order_cond);
   }
 }
 
@@ -263,63 +299,62 @@ void SEQ_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_order_cond);
   }
 }
 
-static void seq_prefetch_update_context(const SeqRenderData *context)
+static void seq_prefetch_update_context(PrefetchWorker *worker, const SeqRenderData *context)
 {
-  PrefetchJob *pfjob;
-  pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchJob *pfjob = worker->pfjob;
+  const eSeqTaskId task_id = SEQ_TASK_PREFETCH_RENDER + (int)(worker - pfjob->workers);
 
-  SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
+  SEQ_render_new_render_data(worker->bmain_eval,
+                             worker->depsgraph,
+                             worker->scene_eval,
                              context->rectx,
                              context->recty,
                              context->preview_render_size,
                              false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
+                             &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = task_id;
 
   SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
+                             worker->depsgraph,
                              pfjob->scene,
                              context->rectx,
                              context->recty,
                              context->preview_render_size,
                              false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
+                             &worker->context);
+  worker->context.is_prefetch_render = false;
 
   /* Same ID as prefetch context, because context will be swapped, but we still
    * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
+   * This is to allow "temp cache" work correctly for all threads.
    */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  worker->context.task_id = task_id;
 }
 
-static void seq_prefetch_update_scene(Scene *scene)
+static void seq_prefetch_update_scene(PrefetchJob *pfjob, Scene *scene)
 {
-  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
-
-  if (!pfjob) {
-    return;
-  }
-
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    worker->cfra = seq_prefetch_cfra(pfjob);
+    seq_prefetch_free_depsgraph(worker);
+    seq_prefetch_init_depsgraph(worker);
+  }
 }
 
-static void seq_prefetch_update_active_seqbase(PrefetchJob *pfjob)
+static void seq_prefetch_update_active_seqbase(PrefetchWorker *worker)
 {
-  MetaStack *ms_orig = SEQ_meta_stack_active_get(SEQ_editing_get(pfjob->scene));
-  Editing *ed_eval = SEQ_editing_get(pfjob->scene_eval);
+  MetaStack *ms_orig = SEQ_meta_stack_active_get(SEQ_editing_get(worker->pfjob->scene));
+  Editing *ed_eval = SEQ_editing_get(worker->scene_eval);
 
   if (ms_orig != NULL) {
-    Sequence *meta_eval = seq_prefetch_get_original_sequence(ms_orig->parseq, pfjob->scene_eval);
+    Sequence *meta_eval = seq_prefetch_get_original_sequence(ms_orig->parseq, worker->scene_eval);
     SEQ_seqbase_active_set(ed_eval, &meta_eval->seqbase);
   }
   else {
@@ -331,8 +366,8 @@ static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->num_workers_waiting > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -345,22 +380,25 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
+  BLI_condition_end(&pfjob->prefetch_order_cond);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    seq_prefetch_free_depsgraph(worker);
+    BKE_main_free(worker->bmain_eval);
+  }
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
-static bool seq_prefetch_seq_has_disk_cache(PrefetchJob *pfjob,
+static bool seq_prefetch_seq_has_disk_cache(PrefetchWorker *worker,
                                             Sequence *seq,
                                             bool can_have_final_image)
 {
-  SeqRenderData *ctx = &pfjob->context_cpy;
-  float cfra = seq_prefetch_cfra(pfjob);
+  SeqRenderData *ctx = &worker->context_cpy;
+  float cfra = worker->cfra;
 
   ImBuf *ibuf = seq_cache_get(ctx, seq, cfra, SEQ_CACHE_STORE_PREPROCESSED);
   if (ibuf != NULL) {
@@ -387,13 +425,13 @@ static bool seq_prefetch_seq_has_disk_cache(PrefetchJob *pfjob,
   return false;
 }
 
-static bool seq_prefetch_scene_strip_is_rendered(PrefetchJob *pfjob,
+static bool seq_prefetch_scene_strip_is_rendered(PrefetchWorker *worker,
                                                  ListBase *channels,
                                                  ListBase *seqbase,
                                                  SeqCollection *scene_strips,
                                                  bool is_recursive_check)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
+  float cfra = worker->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = seq_get_shown_sequences(channels, seqbase, cfra, 0, seq_arr);
 
@@ -401,13 +439,14 @@ static bool seq_prefetch_scene_strip_is_rendered(PrefetchJob *pfjob,
   for (int i = 0; i < count; i++) {
     Sequence *seq = seq_arr[i];
     if (seq->type == SEQ_TYPE_META &&
-        seq_prefetch_scene_strip_is_rendered(pfjob, channels, &seq->seqbase, scene_strips, true)) {
+        seq_prefetch_scene_strip_is_rendered(
+            worker, channels, &seq->seqbase, scene_strips, true)) {
       return true;
     }
 
     /* Disable prefetching 3D scene strips, but check for disk cache. */
     if (seq->type == SEQ_TYPE_SCENE && (seq->flag & SEQ_SCENE_STRIPS) == 0 &&
-        !seq_prefetch_seq_has_disk_cache(pfjob, seq, !is_recursive_check)) {
+        !seq_prefetch_seq_has_disk_cache(worker, seq, !is_recursive_check)) {
       return true;
     }
 
@@ -435,10 +474,12 @@ static SeqCollection *query_scene_strips(ListBase *seqbase)
 
 /* Prefetch must avoid rendering scene strips, because rendering in background locks UI and can
  * make it unresponsive for long time periods. */
-static bool seq_prefetch_must_skip_frame(PrefetchJob *pfjob, ListBase *channels, ListBase *seqbase)
+static bool seq_prefetch_must_skip_frame(PrefetchWorker *worker,
+                                         ListBase *channels,
+                                         ListBase *seqbase)
 {
   SeqCollection *scene_strips = query_scene_strips(seqbase);
-  if (seq_prefetch_scene_strip_is_rendered(pfjob, channels, seqbase, scene_strips, false)) {
+  if (seq_prefetch_scene_strip_is_rendered(worker, channels, seqbase, scene_strips, false)) {
     SEQ_collection_free(scene_strips);
     return true;
   }
@@ -446,77 +487,156 @@ static bool seq_prefetch_must_skip_frame(PrefetchJob *pfjob, ListBase *channels,
   return false;
 }
 
+static bool seq_prefetch_is_enabled(PrefetchJob *pfjob)
+{
+  return (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop;
+}
+
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (pfjob->cfra + pfjob->num_frames_scheduled > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+/**
+ * Assign next frame to be prefetched to the worker. Suspends the worker while there is nothing
+ * to be prefetched. Must be called with `prefetch_suspend_mutex` locked.
+ *
+ * \return false when the worker should stop.
+ */
+static bool seq_prefetch_schedule_frame(PrefetchWorker *worker)
 {
-  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
+  PrefetchJob *pfjob = worker->pfjob;
+
+  seq_prefetch_update_area(pfjob);
+  while (seq_prefetch_need_suspend(pfjob) && seq_prefetch_is_enabled(pfjob)) {
+    pfjob->num_workers_waiting++;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->num_workers_waiting--;
     seq_prefetch_update_area(pfjob);
   }
-  pfjob->waiting = false;
-  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  if (!seq_prefetch_is_enabled(pfjob)) {
+    return false;
+  }
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  if (pfjob->num_frames_prefetched > 5 && (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
+    return false;
+  }
+
+  worker->cfra = pfjob->cfra + pfjob->num_frames_scheduled;
+  pfjob->num_frames_scheduled++;
+  return true;
 }
 
-static void *seq_prefetch_frames(void *job)
+/**
+ * Render frame assigned to the worker.
+ *
+ * \param r_seq: Strip the final image is stored for, NULL when nothing was rendered.
+ */
+static ImBuf *seq_prefetch_render_frame(PrefetchWorker *worker, Sequence **r_seq)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchJob *pfjob = worker->pfjob;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  worker->scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
-    BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+  seq_prefetch_update_depsgraph(worker);
+  AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+  AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
+  BKE_animsys_evaluate_animdata(
+      &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
-    /* This is quite hacky solution:
-     * We need cross-reference original scene with copy for cache.
-     * However depsgraph must not have this data, because it will try to kill this job.
-     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
-     * Set to NULL before return!
-     */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+  /* This is quite hacky solution:
+   * We need cross-reference original scene with copy for cache.
+   * However depsgraph must not have this data, because it will try to kill this job.
+   * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
+   * Set to NULL before return!
+   */
+  worker->scene_eval->ed->prefetch_job = pfjob;
 
-    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene_eval));
-    ListBase *channels = SEQ_channels_displayed_get(SEQ_editing_get(pfjob->scene_eval));
-    if (seq_prefetch_must_skip_frame(pfjob, channels, seqbase)) {
-      pfjob->num_frames_prefetched++;
-      continue;
-    }
+  *r_seq = NULL;
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-    IMB_freeImBuf(ibuf);
+  ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(worker->scene_eval));
+  ListBase *channels = SEQ_channels_displayed_get(SEQ_editing_get(worker->scene_eval));
+  if (seq_prefetch_must_skip_frame(worker, channels, seqbase)) {
+    return NULL;
+  }
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
+  Sequence *seq_arr[MAXSEQ + 1];
+  int count = seq_get_shown_sequences(channels, seqbase, worker->cfra, 0, seq_arr);
+  if (count) {
+    *r_seq = seq_arr[count - 1];
+  }
 
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
+  ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  return ibuf;
+}
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+/**
+ * Store final image of frame rendered by the worker, once all previous frames are stored. This
+ * keeps prefetched frames contiguous, so that cache recycling and playback don't see gaps.
+ * Frames outside of scheduled area are discarded, this happens when the area is rebased or reset
+ * and when the cache is full. Must be called with `prefetch_suspend_mutex` locked.
+ */
+static void seq_prefetch_store_frame(PrefetchWorker *worker, Sequence *seq, ImBuf *ibuf)
+{
+  PrefetchJob *pfjob = worker->pfjob;
 
-    seq_prefetch_update_area(pfjob);
+  while (!pfjob->stop && worker->cfra > seq_prefetch_cfra(pfjob) &&
+         worker->cfra < pfjob->cfra + pfjob->num_frames_scheduled) {
+    BLI_condition_wait(&pfjob->prefetch_order_cond, &pfjob->prefetch_suspend_mutex);
+  }
+
+  if (pfjob->stop || worker->cfra != seq_prefetch_cfra(pfjob)) {
+    return;
+  }
+
+  if (seq_prefetch_is_cache_full(pfjob->scene)) {
+    /* Frames being rendered by other workers won't fit either. */
+    pfjob->num_frames_scheduled = pfjob->num_frames_prefetched;
+    BLI_condition_notify_all(&pfjob->prefetch_order_cond);
+    return;
+  }
+
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+  seq_cache_put(&worker->context_cpy, seq, worker->cfra, SEQ_CACHE_STORE_FINAL_OUT, ibuf);
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+
+  if (worker->cfra == seq_prefetch_cfra(pfjob)) {
     pfjob->num_frames_prefetched++;
   }
+  BLI_condition_notify_all(&pfjob->prefetch_order_cond);
+}
+
+static void *seq_prefetch_frames(void *job)
+{
+  PrefetchWorker *worker = (PrefetchWorker *)job;
+  PrefetchJob *pfjob = worker->pfjob;
 
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  while (seq_prefetch_schedule_frame(worker)) {
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+    Sequence *seq;
+    ImBuf *ibuf = seq_prefetch_render_frame(worker, &seq);
+
+    BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+    seq_prefetch_store_frame(worker, seq, ibuf);
+    IMB_freeImBuf(ibuf);
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  worker->scene_eval->ed->prefetch_job = NULL;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->num_workers_running--;
+  if (pfjob->num_workers_running == 0) {
+    pfjob->running = false;
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return NULL;
 }
@@ -529,31 +649,43 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
     if (context->scene->ed) {
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
+      pfjob->num_workers = seq_prefetch_workers_count();
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->num_workers);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
+      BLI_condition_init(&pfjob->prefetch_order_cond);
 
-      pfjob->bmain_eval = BKE_main_new();
-      pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      for (int i = 0; i < pfjob->num_workers; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+        pfjob->workers[i].bmain_eval = BKE_main_new();
+      }
     }
   }
+
+  /* Finish threads of previous run. */
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
+
   pfjob->bmain = context->bmain;
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->num_frames_scheduled = 1;
 
-  pfjob->waiting = false;
+  pfjob->num_workers_waiting = 0;
+  pfjob->num_workers_running = pfjob->num_workers;
   pfjob->stop = false;
   pfjob->running = true;
 
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
-  seq_prefetch_update_active_seqbase(pfjob);
-
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  seq_prefetch_update_scene(pfjob, context->scene);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    seq_prefetch_update_context(worker, context);
+    seq_prefetch_update_active_seqbase(worker);
+    BLI_threadpool_insert(&pfjob->threads, worker);
+  }
 
   return pfjob;
 }
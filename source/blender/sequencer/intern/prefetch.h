@@ -19,6 +19,12 @@ struct Sequence;
 }
 #endif
 
+/**
+ * Maximum number of frames rendered at once by prefetch, each by its own worker thread with its
+ * own evaluated scene. Workers use task IDs starting with #SEQ_TASK_PREFETCH_RENDER.
+ */
+#define SEQ_PREFETCH_MAX_WORKERS 8
+
 /**
  * Start or resume prefetching.
  */
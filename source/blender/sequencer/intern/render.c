@@ -1951,17 +1951,19 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
   SEQ_relations_free_all_anim_ibufs(context->scene, timeline_frame);
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
-    out = seq_render_strip_stack(context, &state, channels, seqbasep, timeline_frame, chanshown);
-
+    /* Prefetch workers render their own evaluated scene copies at the same time, and store final
+     * images in the cache themselves, in frame order. Global state used by effects, like BLF
+     * fonts of text strips, is locked by the effects. */
     if (context->is_prefetch_render) {
-      seq_cache_put(context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
+      out = seq_render_strip_stack(context, &state, channels, seqbasep, timeline_frame, chanshown);
     }
     else {
+      BLI_mutex_lock(&seq_render_mutex);
+      out = seq_render_strip_stack(context, &state, channels, seqbasep, timeline_frame, chanshown);
       seq_cache_put_if_possible(
           context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
+      BLI_mutex_unlock(&seq_render_mutex);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
   }
 
   seq_prefetch_start(context, timeline_frame);
@@ -393,7 +393,7 @@ void SEQ_relations_sequence_free_anim(Sequence *seq)
     StripAnim *sanim = seq->anims.last;
 
     if (sanim->anim) {
-      IMB_free_anim(sanim->anim);
+      IMB_anim_pool_release(sanim->anim);
       sanim->anim = NULL;
     }
 
@@ -272,11 +272,11 @@ void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
                                  seq->strip->colorspace_settings.name);
         }
         else {
-          sanim->anim = openanim_noload(str,
-                                        IB_rect |
-                                            ((seq->flag & SEQ_FILTERY) ? IB_animdeinterlace : 0),
-                                        seq->streamindex,
-                                        seq->strip->colorspace_settings.name);
+          sanim->anim = IMB_anim_pool_acquire(
+              str,
+              IB_rect | ((seq->flag & SEQ_FILTERY) ? IB_animdeinterlace : 0),
+              seq->streamindex,
+              seq->strip->colorspace_settings.name);
         }
 
         if (sanim->anim) {
@@ -291,11 +291,11 @@ void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
                                    seq->strip->colorspace_settings.name);
           }
           else {
-            sanim->anim = openanim_noload(name,
-                                          IB_rect |
-                                              ((seq->flag & SEQ_FILTERY) ? IB_animdeinterlace : 0),
-                                          seq->streamindex,
-                                          seq->strip->colorspace_settings.name);
+            sanim->anim = IMB_anim_pool_acquire(
+                name,
+                IB_rect | ((seq->flag & SEQ_FILTERY) ? IB_animdeinterlace : 0),
+                seq->streamindex,
+                seq->strip->colorspace_settings.name);
           }
 
           /* No individual view files - monoscopic, stereo 3d or EXR multi-view. */
@@ -323,10 +323,11 @@ void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
                              seq->strip->colorspace_settings.name);
     }
     else {
-      sanim->anim = openanim_noload(name,
-                                    IB_rect | ((seq->flag & SEQ_FILTERY) ? IB_animdeinterlace : 0),
-                                    seq->streamindex,
-                                    seq->strip->colorspace_settings.name);
+      sanim->anim = IMB_anim_pool_acquire(
+          name,
+          IB_rect | ((seq->flag & SEQ_FILTERY) ? IB_animdeinterlace : 0),
+          seq->streamindex,
+          seq->strip->colorspace_settings.name);
     }
 
     if (sanim->anim && use_proxy) {
@@ -86,6 +86,7 @@
 #include "RNA_access.h"
 #include "RNA_define.h"
 
+#include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_thumbs.h"
@@ -112,6 +113,10 @@
 /* only to report a missing engine */
 #include "RE_engine.h"
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 #ifdef WITH_PYTHON
 #  include "BPY_extern_python.h"
 #  include "BPY_extern_run.h"
@@ -450,6 +455,7 @@ static void wm_init_userdef(Main *bmain)
   }
 
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  IMB_colormanagement_display_lut_set_enabled((U.gpu_flag & USER_GPU_FLAG_NO_DISPLAY_LUT) == 0);
   BKE_sound_init(bmain);
 
   /* Update the temporary directory from the preferences or fallback to the system default. */
@@ -600,6 +606,10 @@ static void wm_file_read_pre(bContext *C, bool use_data, bool UNUSED(use_userdef
   if (use_data) {
     BKE_callback_exec_null(CTX_data_main(C), BKE_CB_EVT_LOAD_PRE);
     BLI_timer_on_file_load();
+#ifdef WITH_COMPOSITOR
+    /* Compositor results of the previous file are never used again. */
+    COM_clear_caches();
+#endif
   }
 
   /* Always do this as both startup and preferences may have loaded in many font's